@@ -0,0 +1,137 @@
+// Host benchmark and exhaustive equivalence check: scalar vs 12-bit LUT 3-of-6 coding.
+// Every one of the 2^24 encoded triples (and 2^16 last-byte pairs) must decode to the
+// same status and bytes on both paths; every byte pair must encode identically.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/3of6_bench [rounds]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "wmbus/3of6.h"
+
+typedef uint8_t (*decode_fn_t)(const uint8_t *encoded, uint8_t *decoded, uint8_t last_byte);
+typedef void (*encode_fn_t)(const uint8_t *uncoded, uint8_t *encoded, uint8_t last_byte);
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int check_equivalence(void)
+{
+    uint32_t valid = 0;
+    for (uint32_t v = 0; v < (1u << 24); v++)
+    {
+        const uint8_t enc[3] = {(uint8_t)(v >> 16), (uint8_t)(v >> 8), (uint8_t)v};
+        uint8_t a[2] = {0};
+        uint8_t b[2] = {0};
+        uint8_t c[2] = {0};
+        const uint8_t sa = wmbus_decode_3of6_scalar(enc, a, 0);
+        const uint8_t sb = wmbus_decode_3of6_lut(enc, b, 0);
+        const bool pc = wmbus_decode_3of6_pair(enc, c);
+        if (sa != sb || (sa == WMBUS_3OF6_OK && (memcmp(a, b, 2) != 0 || memcmp(a, c, 2) != 0)) || pc != (sa == WMBUS_3OF6_OK))
+        {
+            fprintf(stderr, "decode mismatch at %06X: scalar=%u lut=%u pair=%d\n", v, sa, sb, pc);
+            return 1;
+        }
+        valid += (sa == WMBUS_3OF6_OK);
+    }
+    for (uint32_t v = 0; v < (1u << 16); v++)
+    {
+        const uint8_t enc[2] = {(uint8_t)(v >> 8), (uint8_t)v};
+        uint8_t a = 0;
+        uint8_t b = 0;
+        const uint8_t sa = wmbus_decode_3of6_scalar(enc, &a, 1);
+        const uint8_t sb = wmbus_decode_3of6_lut(enc, &b, 1);
+        if (sa != sb || (sa == WMBUS_3OF6_OK && a != b))
+        {
+            fprintf(stderr, "last-byte decode mismatch at %04X\n", v);
+            return 1;
+        }
+    }
+    for (uint32_t v = 0; v < (1u << 16); v++)
+    {
+        const uint8_t raw[2] = {(uint8_t)(v >> 8), (uint8_t)v};
+        uint8_t a[3] = {0};
+        uint8_t b[3] = {0};
+        wmbus_encode_3of6_scalar(raw, a, 0);
+        wmbus_encode_3of6_lut(raw, b, 0);
+        uint8_t a1[3] = {0};
+        uint8_t b1[3] = {0};
+        wmbus_encode_3of6_scalar(raw, a1, 1);
+        wmbus_encode_3of6_lut(raw, b1, 1);
+        if (memcmp(a, b, 3) != 0 || memcmp(a1, b1, 2) != 0)
+        {
+            fprintf(stderr, "encode mismatch at %04X\n", v);
+            return 1;
+        }
+    }
+    printf("equivalence: 2^24 triples (%u valid), 2^16 last-byte pairs, 2^16 encode pairs OK\n", valid);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const unsigned rounds = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 10) : 2000;
+    if (check_equivalence() != 0)
+    {
+        return 1;
+    }
+
+    // A long frame worth of valid groups (L=255 -> 290 bytes -> 145 groups)
+    enum { GROUPS = 145 };
+    uint8_t raw[GROUPS * 2];
+    uint8_t encoded[GROUPS * 3];
+    srand(1);
+    for (size_t i = 0; i < sizeof(raw); i++)
+    {
+        raw[i] = (uint8_t)rand();
+    }
+    for (size_t g = 0; g < GROUPS; g++)
+    {
+        wmbus_encode_3of6_scalar(raw + g * 2, encoded + g * 3, 0);
+    }
+
+    static const struct
+    {
+        const char *name;
+        decode_fn_t decode;
+        encode_fn_t encode;
+    } variants[] = {
+        {"scalar", wmbus_decode_3of6_scalar, wmbus_encode_3of6_scalar},
+        {"lut", wmbus_decode_3of6_lut, wmbus_encode_3of6_lut},
+    };
+
+    volatile uint8_t sink = 0;
+    for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++)
+    {
+        uint8_t out[GROUPS * 3];
+        uint64_t start = now_ns();
+        for (unsigned r = 0; r < rounds; r++)
+        {
+            for (size_t g = 0; g < GROUPS; g++)
+            {
+                sink ^= variants[v].decode(encoded + g * 3, out + g * 2, 0);
+            }
+            sink ^= out[r % (GROUPS * 2)];
+        }
+        const double dec_ns = (double)(now_ns() - start) / ((double)rounds * GROUPS * 2);
+
+        start = now_ns();
+        for (unsigned r = 0; r < rounds; r++)
+        {
+            for (size_t g = 0; g < GROUPS; g++)
+            {
+                variants[v].encode(raw + g * 2, out + g * 3, 0);
+            }
+            sink ^= out[r % (GROUPS * 3)];
+        }
+        const double enc_ns = (double)(now_ns() - start) / ((double)rounds * GROUPS * 2);
+        printf("%-8s decode %6.2f ns/byte   encode %6.2f ns/byte\n", variants[v].name, dec_ns, enc_ns);
+    }
+    (void)sink;
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "bench_corpus.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include "wmbus/packet.h"
+
+bench_frame_t bench_frames[BENCH_MAX_FRAMES];
+size_t bench_frame_count;
+
+static int hex_nibble(int c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    c = tolower(c);
+    return (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+}
+
+// Rebuild the on-air encoding (CRC blocks + 3-of-6) of a logical frame.
+static bool frame_from_logical(bench_frame_t *f)
+{
+    WmbusFrameHeaderRaw hdr;
+    const uint8_t *payload = NULL;
+    uint16_t payload_len = 0;
+    if (!wmbus_parse_frame_header(f->logical, f->logical_len, &hdr, &payload, &payload_len) ||
+        f->logical_len != (uint16_t)(hdr.length + 1))
+    {
+        return false;
+    }
+    uint8_t packet[BENCH_MAX_PACKET];
+    wmbus_encode_tx_packet_with_header(packet, &hdr, payload, (uint8_t)payload_len);
+    f->packet_size = wmbus_packet_size(hdr.length);
+    f->encoded_len = wmbus_byte_size_tmode(false, f->packet_size);
+    uint8_t encoded[BENCH_MAX_ENCODED + 1];
+    wmbus_encode_tx_bytes_tmode(encoded, packet, f->packet_size);
+    memcpy(f->encoded, encoded, f->encoded_len);
+    return true;
+}
+
+static bool has_suffix(const char *s, const char *suffix)
+{
+    const size_t n = strlen(s);
+    const size_t m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+// Binary capture: logical frames back to back, each delimited by its own L-field.
+static bool load_binary(FILE *fp)
+{
+    int l;
+    while ((l = fgetc(fp)) != EOF && bench_frame_count < BENCH_MAX_FRAMES)
+    {
+        bench_frame_t *f = &bench_frames[bench_frame_count];
+        f->logical[0] = (uint8_t)l;
+        f->logical_len = (uint16_t)(l + 1);
+        if (fread(&f->logical[1], 1, (size_t)l, fp) != (size_t)l)
+        {
+            fprintf(stderr, "truncated frame at end of capture\n");
+            break;
+        }
+        if (!frame_from_logical(f))
+        {
+            fprintf(stderr, "skipping malformed frame (len=%u)\n", f->logical_len);
+            continue;
+        }
+        bench_frame_count++;
+    }
+    return bench_frame_count > 0;
+}
+
+bool bench_load_corpus(const char *path)
+{
+    const bool binary = has_suffix(path, ".bin");
+    FILE *fp = fopen(path, binary ? "rb" : "r");
+    if (!fp)
+    {
+        perror(path);
+        return false;
+    }
+    if (binary)
+    {
+        const bool ok = load_binary(fp);
+        fclose(fp);
+        return ok;
+    }
+    char line[1024];
+    while (fgets(line, sizeof(line), fp) && bench_frame_count < BENCH_MAX_FRAMES)
+    {
+        bench_frame_t *f = &bench_frames[bench_frame_count];
+        f->logical_len = 0;
+        for (const char *p = line; *p && *p != '#'; p++)
+        {
+            const int hi = hex_nibble((unsigned char)p[0]);
+            if (hi < 0)
+            {
+                continue;
+            }
+            const int lo = hex_nibble((unsigned char)p[1]);
+            if (lo < 0 || f->logical_len >= BENCH_MAX_LOGICAL)
+            {
+                break;
+            }
+            f->logical[f->logical_len++] = (uint8_t)((hi << 4) | lo);
+            p++;
+        }
+        if (f->logical_len == 0)
+        {
+            continue;
+        }
+        if (!frame_from_logical(f))
+        {
+            fprintf(stderr, "skipping malformed frame (len=%u)\n", f->logical_len);
+            continue;
+        }
+        bench_frame_count++;
+    }
+    fclose(fp);
+    return bench_frame_count > 0;
+}
@@ -0,0 +1,30 @@
+// Frame corpus shared by the host benches. Text files hold one CRC-free logical
+// frame per line as hex (L first), '#' starts a comment; "*.bin" captures hold
+// the logical frames back to back (each L+1 bytes). Frames are re-encoded on load.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BENCH_MAX_FRAMES   512
+#define BENCH_MAX_LOGICAL  256
+#define BENCH_MAX_PACKET   291
+#define BENCH_MAX_ENCODED  584
+
+#define BENCH_DEFAULT_CORPUS "host/bench/corpus/sample_frames.hex"
+
+typedef struct
+{
+    uint8_t logical[BENCH_MAX_LOGICAL];
+    uint16_t logical_len;
+    uint8_t encoded[BENCH_MAX_ENCODED]; // On-air bytes after the sync word
+    uint16_t encoded_len;
+    uint16_t packet_size;               // Incl. block CRCs
+} bench_frame_t;
+
+extern bench_frame_t bench_frames[BENCH_MAX_FRAMES];
+extern size_t bench_frame_count;
+
+// Load (and append to) the corpus; false when nothing could be loaded.
+bool bench_load_corpus(const char *path);
@@ -0,0 +1,299 @@
+// Host benchmark of the receive chain after the radio, stage by stage:
+//   decode     wmbus_decode_rx_bytes_tmode (3-of-6 + block CRCs)
+//   extract    wmbus_extract_frame_info (strip CRCs, parse header)
+//   dedup      wmbus_dedup_make_key + wmbus_dedup_check (duplicate suppression)
+//   meta       wmbus_parsed_frame_init + wmbus_parsed_frame_parse_meta
+//   dispatch   wmbus_packet_router_dispatch (one counting sink)
+//   uplink     uplink_format_json (backend JSON body)
+// Reports throughput, per-stage mean/p50/p99 ns per frame and a latency
+// histogram of the whole chain; --json writes the same numbers for tracking.
+// Corpus format: see bench_corpus.h.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/chain_bench [--json results.json] [corpus] [rounds]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench_corpus.h"
+#include "wmbus/packet.h"
+#include "wmbus/pipeline.h"
+#include "app/wmbus/dedup.h"
+#include "app/wmbus/packet_router.h"
+#include "app/wmbus/parsed_frame.h"
+#include "app/net/uplink_format.h"
+
+enum
+{
+    STAGE_DECODE,
+    STAGE_EXTRACT,
+    STAGE_DEDUP,
+    STAGE_META,
+    STAGE_DISPATCH,
+    STAGE_UPLINK,
+    STAGE_COUNT,
+};
+
+static const char *const s_stage_names[STAGE_COUNT] = {"decode", "extract", "dedup", "meta", "dispatch", "uplink"};
+
+#define HIST_BUCKETS 24 // Power-of-two ns buckets: [2^k, 2^(k+1))
+
+typedef struct
+{
+    double mean_ns;
+    uint32_t p50_ns;
+    uint32_t p99_ns;
+    uint32_t max_ns;
+} stage_stats_t;
+
+static uint32_t s_sink_hits;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void counting_sink(const WmbusPacketEvent *evt, void *user)
+{
+    (void)user;
+    if (evt->frame_info.parsed)
+    {
+        s_sink_hits++;
+    }
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Sorts samples in place.
+static stage_stats_t summarize(uint32_t *samples, size_t n)
+{
+    stage_stats_t st = {0};
+    if (n == 0)
+    {
+        return st;
+    }
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        sum += samples[i];
+    }
+    qsort(samples, n, sizeof(samples[0]), cmp_u32);
+    st.mean_ns = (double)sum / n;
+    st.p50_ns = samples[(n - 1) / 2];
+    st.p99_ns = samples[((n - 1) * 99) / 100];
+    st.max_ns = samples[n - 1];
+    return st;
+}
+
+static unsigned hist_bucket(uint32_t ns)
+{
+    unsigned b = 0;
+    while ((ns >> 1) && b < HIST_BUCKETS - 1)
+    {
+        ns >>= 1;
+        b++;
+    }
+    return b;
+}
+
+// One pass of the chain over frame f; per-stage times go to t[]. Returns false on any failure.
+static wmbus_dedup_t s_dedup;
+static uint32_t s_now_ms;
+
+static bool run_chain(const bench_frame_t *f, uint32_t t[STAGE_COUNT])
+{
+    uint8_t packet[BENCH_MAX_PACKET];
+    uint8_t logical[BENCH_MAX_PACKET];
+    char json[UPLINK_JSON_FIXED_LEN + 2 * BENCH_MAX_PACKET + 1];
+    WmbusFrameInfo info;
+    wmbus_parsed_frame_t pf;
+    bool ok = true;
+
+    uint64_t t0 = now_ns();
+    ok &= wmbus_decode_rx_bytes_tmode(f->encoded, packet, f->packet_size) == WMBUS_PKT_OK;
+    uint64_t t1 = now_ns();
+    ok &= wmbus_extract_frame_info(packet, f->packet_size, logical, sizeof(logical), &info);
+    uint64_t t2 = now_ns();
+    // One frame per virtual second against a 10 s window: repeats of small corpora hit, others insert
+    wmbus_dedup_key_t key;
+    ok &= wmbus_dedup_make_key(&info, logical, info.logical_len, &key);
+    (void)wmbus_dedup_check(&s_dedup, &key, s_now_ms += 1000, APP_DEDUP_WINDOW_S * 1000);
+    uint64_t t2d = now_ns();
+    const wmbus_raw_frame_t raw = {.bytes = logical, .len = info.logical_len};
+    wmbus_parsed_frame_init(&pf, &raw, &info);
+    wmbus_parsed_frame_parse_meta(&pf);
+    uint64_t t3 = now_ns();
+    const WmbusPacketEvent evt = {
+        .frame_info = info,
+        .status = WMBUS_PKT_OK,
+        .rssi_dbm = -70.5f,
+        .lqi = 32,
+        .logical_packet = logical,
+        .logical_len = info.logical_len,
+        .gateway_name = "bench",
+    };
+    wmbus_packet_router_dispatch(&evt);
+    uint64_t t4 = now_ns();
+    ok &= uplink_format_json(&evt, json, sizeof(json)) > 0;
+    uint64_t t5 = now_ns();
+
+    t[STAGE_DECODE] = (uint32_t)(t1 - t0);
+    t[STAGE_EXTRACT] = (uint32_t)(t2 - t1);
+    t[STAGE_DEDUP] = (uint32_t)(t2d - t2);
+    t[STAGE_META] = (uint32_t)(t3 - t2d);
+    t[STAGE_DISPATCH] = (uint32_t)(t4 - t3);
+    t[STAGE_UPLINK] = (uint32_t)(t5 - t4);
+    return ok && info.logical_len == f->logical_len && memcmp(logical, f->logical, f->logical_len) == 0;
+}
+
+static bool write_json(const char *path, const char *corpus, unsigned rounds, size_t samples, double frames_per_s,
+                       double timer_ns, const stage_stats_t *stages, const stage_stats_t *total,
+                       const uint32_t *hist)
+{
+    FILE *fp = fopen(path, "w");
+    if (!fp)
+    {
+        perror(path);
+        return false;
+    }
+    fprintf(fp, "{\n  \"bench\": \"chain\",\n  \"corpus\": \"%s\",\n  \"frames\": %zu,\n  \"rounds\": %u,\n",
+            corpus, bench_frame_count, rounds);
+    fprintf(fp, "  \"samples\": %zu,\n  \"frames_per_s\": %.0f,\n  \"timer_overhead_ns\": %.1f,\n", samples,
+            frames_per_s, timer_ns);
+    fprintf(fp, "  \"stages\": [\n");
+    for (int s = 0; s < STAGE_COUNT; s++)
+    {
+        fprintf(fp, "    {\"name\": \"%s\", \"mean_ns\": %.1f, \"p50_ns\": %u, \"p99_ns\": %u, \"max_ns\": %u}%s\n",
+                s_stage_names[s], stages[s].mean_ns, stages[s].p50_ns, stages[s].p99_ns, stages[s].max_ns,
+                (s + 1 < STAGE_COUNT) ? "," : "");
+    }
+    fprintf(fp, "  ],\n  \"total\": {\"mean_ns\": %.1f, \"p50_ns\": %u, \"p99_ns\": %u, \"max_ns\": %u},\n",
+            total->mean_ns, total->p50_ns, total->p99_ns, total->max_ns);
+    fprintf(fp, "  \"histogram\": [");
+    bool first = true;
+    for (unsigned b = 0; b < HIST_BUCKETS; b++)
+    {
+        if (hist[b])
+        {
+            fprintf(fp, "%s\n    {\"lt_ns\": %lu, \"count\": %u}", first ? "" : ",", 2ul << b, hist[b]);
+            first = false;
+        }
+    }
+    fprintf(fp, "\n  ]\n}\n");
+    fclose(fp);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *json_path = NULL;
+    int argi = 1;
+    if (argc > 2 && strcmp(argv[1], "--json") == 0)
+    {
+        json_path = argv[2];
+        argi = 3;
+    }
+    const char *path = (argc > argi) ? argv[argi] : BENCH_DEFAULT_CORPUS;
+    const unsigned rounds = (argc > argi + 1) ? (unsigned)strtoul(argv[argi + 1], NULL, 10) : 5000;
+    if (!bench_load_corpus(path) || rounds == 0)
+    {
+        fprintf(stderr, "no frames loaded from %s\n", path);
+        return 1;
+    }
+
+    wmbus_packet_router_init();
+    wmbus_packet_router_register(counting_sink, NULL);
+
+    const size_t n = (size_t)rounds * bench_frame_count;
+    uint32_t *samples[STAGE_COUNT + 1];
+    for (int s = 0; s <= STAGE_COUNT; s++)
+    {
+        samples[s] = malloc(n * sizeof(uint32_t));
+        if (!samples[s])
+        {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+    }
+
+    // Cost of one clock read, included in every stage sample
+    const uint64_t c0 = now_ns();
+    for (int i = 0; i < 100000; i++)
+    {
+        (void)now_ns();
+    }
+    const double timer_ns = (double)(now_ns() - c0) / 100000.0;
+
+    uint32_t hist[HIST_BUCKETS] = {0};
+    size_t k = 0;
+    const uint64_t start = now_ns();
+    for (unsigned r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < bench_frame_count; i++, k++)
+        {
+            uint32_t t[STAGE_COUNT];
+            if (!run_chain(&bench_frames[i], t))
+            {
+                fprintf(stderr, "chain failed on frame %zu (L=%u)\n", i, bench_frames[i].logical[0]);
+                return 1;
+            }
+            uint32_t total = 0;
+            for (int s = 0; s < STAGE_COUNT; s++)
+            {
+                samples[s][k] = t[s];
+                total += t[s];
+            }
+            samples[STAGE_COUNT][k] = total;
+            hist[hist_bucket(total)]++;
+        }
+    }
+    const double elapsed_s = (double)(now_ns() - start) / 1e9;
+    const double frames_per_s = (double)n / elapsed_s;
+    if (s_sink_hits != n)
+    {
+        fprintf(stderr, "sink saw %u of %zu frames\n", s_sink_hits, n);
+        return 1;
+    }
+
+    stage_stats_t stages[STAGE_COUNT];
+    for (int s = 0; s < STAGE_COUNT; s++)
+    {
+        stages[s] = summarize(samples[s], n);
+    }
+    const stage_stats_t total = summarize(samples[STAGE_COUNT], n);
+
+    printf("%zu frames x %u rounds, %.0f frames/s (timer overhead %.1f ns per stage)\n", bench_frame_count, rounds,
+           frames_per_s, timer_ns);
+    printf("%-10s %10s %8s %8s %8s\n", "stage", "mean ns", "p50", "p99", "max");
+    for (int s = 0; s < STAGE_COUNT; s++)
+    {
+        printf("%-10s %10.1f %8u %8u %8u\n", s_stage_names[s], stages[s].mean_ns, stages[s].p50_ns, stages[s].p99_ns,
+               stages[s].max_ns);
+    }
+    printf("%-10s %10.1f %8u %8u %8u\n", "total", total.mean_ns, total.p50_ns, total.p99_ns, total.max_ns);
+    printf("latency histogram (whole chain):\n");
+    for (unsigned b = 0; b < HIST_BUCKETS; b++)
+    {
+        if (hist[b])
+        {
+            printf("  < %8lu ns %9u  %5.1f%%\n", 2ul << b, hist[b], 100.0 * hist[b] / n);
+        }
+    }
+
+    if (json_path && !write_json(json_path, path, rounds, n, frames_per_s, timer_ns, stages, &total, hist))
+    {
+        return 1;
+    }
+    for (int s = 0; s <= STAGE_COUNT; s++)
+    {
+        free(samples[s]);
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+// Host benchmark for the wM-Bus CRC16 variants on real EN 13757 block layouts.
+// Cross-checks every variant against the bitwise reference before timing.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/crc16_bench [iterations]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "wmbus/crc16.h"
+
+typedef uint16_t (*crc_fn_t)(uint16_t crc, const uint8_t *data, size_t len);
+
+typedef struct
+{
+    const char *name;
+    crc_fn_t fn;
+} crc_variant_t;
+
+static const crc_variant_t s_variants[] = {
+    {"bitwise", wmbus_crc16_update_bitwise},
+    {"nibble", wmbus_crc16_update_nibble},
+    {"table", wmbus_crc16_update_table},
+    {"slice2", wmbus_crc16_update_slice2},
+};
+#define VARIANT_COUNT (sizeof(s_variants) / sizeof(s_variants[0]))
+
+static uint16_t reference_crc(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = wmbus_crc16_step(crc, data[i]);
+    }
+    return crc;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// CRC every block of a frame with the given L-field, the way RX/TX do (10-byte
+// first block, then 16-byte blocks; the final block may be shorter).
+static uint16_t crc_frame(crc_fn_t fn, const uint8_t *logical, uint8_t l_field)
+{
+    uint16_t acc = 0;
+    size_t remaining = (size_t)l_field + 1;
+    size_t block = 10;
+    while (remaining)
+    {
+        const size_t len = remaining < block ? remaining : block;
+        acc ^= fn(0, logical, len);
+        logical += len;
+        remaining -= len;
+        block = 16;
+    }
+    return acc;
+}
+
+int main(int argc, char **argv)
+{
+    const unsigned iterations = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 10) : 20000;
+    static const uint8_t l_fields[] = {9, 26, 44, 78, 127, 200, 255};
+
+    uint8_t logical[256];
+    srand(0x3D65);
+    for (size_t i = 0; i < sizeof(logical); i++)
+    {
+        logical[i] = (uint8_t)rand();
+    }
+
+    // Cross-check all variants against the reference for every length and seed.
+    for (unsigned seed = 0; seed < 64; seed++)
+    {
+        for (size_t len = 0; len <= sizeof(logical); len++)
+        {
+            const uint16_t init = (uint16_t)(seed * 0x9E37u);
+            uint16_t expected = init;
+            for (size_t i = 0; i < len; i++)
+            {
+                expected = wmbus_crc16_step(expected, logical[i]);
+            }
+            for (size_t v = 0; v < VARIANT_COUNT; v++)
+            {
+                const uint16_t got = s_variants[v].fn(init, logical, len);
+                if (got != expected)
+                {
+                    fprintf(stderr, "%s mismatch: len=%zu init=0x%04X got=0x%04X want=0x%04X\n",
+                            s_variants[v].name, len, init, got, expected);
+                    return 1;
+                }
+            }
+        }
+        logical[seed] ^= (uint8_t)seed;
+    }
+    if (wmbus_crc16(logical, 10) != reference_crc(logical, 10))
+    {
+        fprintf(stderr, "configured wmbus_crc16 mismatch\n");
+        return 1;
+    }
+
+    printf("%-8s", "L");
+    for (size_t v = 0; v < VARIANT_COUNT; v++)
+    {
+        printf(" %12s", s_variants[v].name);
+    }
+    printf("   (ns/frame)\n");
+
+    volatile uint16_t sink = 0;
+    for (size_t l = 0; l < sizeof(l_fields); l++)
+    {
+        printf("%-8u", l_fields[l]);
+        for (size_t v = 0; v < VARIANT_COUNT; v++)
+        {
+            const uint64_t start = now_ns();
+            for (unsigned i = 0; i < iterations; i++)
+            {
+                logical[0] = (uint8_t)i;
+                sink ^= crc_frame(s_variants[v].fn, logical, l_fields[l]);
+            }
+            const double ns = (double)(now_ns() - start) / iterations;
+            printf(" %12.1f", ns);
+        }
+        printf("\n");
+    }
+    (void)sink;
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Host benchmark: three-pass RX decode (3-of-6 + CRC -> strip CRCs -> parse header)
+// versus the fused single-pass wmbus_decode_tmode_frame, on a frame corpus.
+// Corpus format: see bench_corpus.h.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/decode_bench [corpus.hex] [iterations]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench_corpus.h"
+#include "wmbus/packet.h"
+#include "wmbus/tmode_stream.h"
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint16_t decode_three_pass(const bench_frame_t *f, uint8_t *logical, WmbusFrameInfo *info)
+{
+    uint8_t packet[BENCH_MAX_PACKET];
+    if (wmbus_decode_rx_bytes_tmode(f->encoded, packet, f->packet_size) != WMBUS_PKT_OK)
+    {
+        return 0;
+    }
+    return wmbus_extract_frame_info(packet, f->packet_size, logical, BENCH_MAX_LOGICAL, info) ? info->logical_len : 0;
+}
+
+static uint16_t decode_fused(const bench_frame_t *f, uint8_t *logical, WmbusFrameInfo *info)
+{
+    uint16_t len = 0;
+    if (wmbus_decode_tmode_frame(f->encoded, f->encoded_len, logical, BENCH_MAX_LOGICAL, &len, info, NULL) != WMBUS_PKT_OK)
+    {
+        return 0;
+    }
+    return len;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : BENCH_DEFAULT_CORPUS;
+    const unsigned iterations = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 20000;
+    if (!bench_load_corpus(path))
+    {
+        fprintf(stderr, "no frames loaded from %s\n", path);
+        return 1;
+    }
+
+    size_t encoded_total = 0;
+    for (size_t i = 0; i < bench_frame_count; i++)
+    {
+        const bench_frame_t *f = &bench_frames[i];
+        uint8_t a[BENCH_MAX_LOGICAL];
+        uint8_t b[BENCH_MAX_LOGICAL];
+        WmbusFrameInfo ia;
+        WmbusFrameInfo ib;
+        const uint16_t la = decode_three_pass(f, a, &ia);
+        const uint16_t lb = decode_fused(f, b, &ib);
+        if (la != f->logical_len || lb != la || memcmp(a, b, la) != 0 || memcmp(a, f->logical, la) != 0 ||
+            !ib.parsed || ia.payload_len != ib.payload_len || memcmp(&ia.header, &ib.header, sizeof(ia.header)) != 0)
+        {
+            fprintf(stderr, "decode mismatch on frame %zu (L=%u)\n", i, f->logical[0]);
+            return 1;
+        }
+        encoded_total += f->encoded_len;
+    }
+
+    typedef uint16_t (*decode_fn_t)(const bench_frame_t *f, uint8_t *logical, WmbusFrameInfo *info);
+    static const struct
+    {
+        const char *name;
+        decode_fn_t fn;
+    } paths[] = {
+        {"three-pass", decode_three_pass},
+        {"fused", decode_fused},
+    };
+
+    printf("%zu frames, %zu encoded bytes per round, %u rounds\n", bench_frame_count, encoded_total, iterations);
+    double base = 0;
+    volatile uint16_t sink = 0;
+    for (size_t p = 0; p < sizeof(paths) / sizeof(paths[0]); p++)
+    {
+        uint8_t logical[BENCH_MAX_LOGICAL];
+        WmbusFrameInfo info;
+        const uint64_t start = now_ns();
+        for (unsigned it = 0; it < iterations; it++)
+        {
+            for (size_t i = 0; i < bench_frame_count; i++)
+            {
+                sink ^= paths[p].fn(&bench_frames[i], logical, &info);
+            }
+        }
+        const double us = (double)(now_ns() - start) / 1000.0;
+        const double bytes_per_us = (double)encoded_total * iterations / us;
+        if (p == 0)
+        {
+            base = bytes_per_us;
+        }
+        printf("%-12s %8.1f encoded bytes/us  %8.1f ns/frame  x%.2f\n", paths[p].name, bytes_per_us,
+               us * 1000.0 / ((double)iterations * bench_frame_count), bytes_per_us / base);
+    }
+    (void)sink;
+    return 0;
+}
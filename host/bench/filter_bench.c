@@ -0,0 +1,165 @@
+// Host benchmark of frame_filter_match: compiles a few expressions, evaluates them
+// over the corpus and cross-checks every verdict against the same predicate written
+// in C. Layer fields read the parsed frame like a WMBUS_SINK_FLAG_META sink would.
+// Corpus format: see bench_corpus.h.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/filter_bench [corpus] [rounds]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench_corpus.h"
+#include "wmbus/packet.h"
+#include "app/wmbus/frame_filter.h"
+#include "app/wmbus/parsed_frame.h"
+
+#define RSSI_DBM -70.5f
+#define LQI      32
+
+typedef bool (*predicate_fn)(const WmbusFrameInfo *info, const wmbus_parsed_frame_t *pf);
+
+typedef struct
+{
+    const char *expr;
+    predicate_fn want;
+} filter_case_t;
+
+static WmbusFrameInfo s_infos[BENCH_MAX_FRAMES];
+static wmbus_parsed_frame_t s_parsed[BENCH_MAX_FRAMES];
+
+static bool p_all(const WmbusFrameInfo *info, const wmbus_parsed_frame_t *pf)
+{
+    return true;
+}
+
+static bool p_ci_short(const WmbusFrameInfo *info, const wmbus_parsed_frame_t *pf)
+{
+    return info->header.ci_field == 0x7A && info->header.device_type != 7;
+}
+
+static bool p_dev_in(const WmbusFrameInfo *info, const wmbus_parsed_frame_t *pf)
+{
+    const uint8_t t = info->header.device_type;
+    return (t == 2 || t == 7 || t == 13 || t == 22) && RSSI_DBM > -95;
+}
+
+static bool p_manuf(const WmbusFrameInfo *info, const wmbus_parsed_frame_t *pf)
+{
+    return info->header.manufacturer_le == 0x2C2D || info->payload_len > 100;
+}
+
+static bool p_layers(const WmbusFrameInfo *info, const wmbus_parsed_frame_t *pf)
+{
+    const int32_t acc = pf->tpl.has_tpl ? pf->tpl.tpl.acc : (pf->ell.has_ell ? pf->ell.ell.acc : -1);
+    return !(acc < 64) && (pf->tpl.tpl.header_type == 1 || pf->ell.has_ell);
+}
+
+static bool p_nested(const WmbusFrameInfo *info, const wmbus_parsed_frame_t *pf)
+{
+    const uint8_t v = info->header.version;
+    return !((v >= 0x20 && v <= 0x80) || info->logical_len < 40) && LQI == 32;
+}
+
+static const filter_case_t CASES[] = {
+    {"", p_all},
+    {"ci == 0x7A && dev_type != 7", p_ci_short},
+    {"dev_type in (2, 7, 13, 22) && rssi > -95", p_dev_in},
+    {"manuf == KAM || payload_len > 100", p_manuf},
+    {"!(acc < 64) && (hdr == 1 || ell)", p_layers},
+    {"!((version >= 0x20 && version <= 0x80) || len < 40) && lqi == 32", p_nested},
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static bool run_case(const filter_case_t *tc, unsigned rounds)
+{
+    frame_filter_t f;
+    size_t pos = 0;
+    if (frame_filter_compile(tc->expr, &f, &pos) != ESP_OK)
+    {
+        fprintf(stderr, "\"%s\": compile error at %zu\n", tc->expr, pos);
+        return false;
+    }
+
+    uint32_t matched = 0;
+    uint32_t mismatched = 0;
+    for (size_t i = 0; i < bench_frame_count; i++)
+    {
+        const frame_filter_input_t in = {.info = &s_infos[i], .rssi_dbm = RSSI_DBM, .lqi = LQI, .parsed = &s_parsed[i]};
+        const bool got = frame_filter_match(&f, &in);
+        matched += got;
+        if (got != tc->want(&s_infos[i], &s_parsed[i]))
+        {
+            fprintf(stderr, "\"%s\": frame %zu gives %d\n", tc->expr, i, got);
+            mismatched++;
+        }
+    }
+
+    volatile uint32_t sink = 0;
+    const uint64_t t0 = now_ns();
+    for (unsigned r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < bench_frame_count; i++)
+        {
+            const frame_filter_input_t in = {.info = &s_infos[i], .rssi_dbm = RSSI_DBM, .lqi = LQI, .parsed = &s_parsed[i]};
+            sink += frame_filter_match(&f, &in);
+        }
+    }
+    const uint64_t elapsed = now_ns() - t0;
+    printf("%-64s %5u %6zu %8.1f\n", tc->expr[0] ? tc->expr : "(empty)", f.len, (size_t)matched,
+           (double)elapsed / ((double)rounds * bench_frame_count));
+    return mismatched == 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : BENCH_DEFAULT_CORPUS;
+    const unsigned rounds = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 20000;
+    if (!bench_load_corpus(path) || rounds == 0)
+    {
+        fprintf(stderr, "no frames loaded from %s\n", path);
+        return 1;
+    }
+    for (size_t i = 0; i < bench_frame_count; i++)
+    {
+        const bench_frame_t *bf = &bench_frames[i];
+        WmbusFrameInfo *info = &s_infos[i];
+        info->parsed = wmbus_parse_frame_header(bf->logical, bf->logical_len, &info->header, NULL, &info->payload_len);
+        info->logical_len = bf->logical_len;
+        const wmbus_raw_frame_t raw = {.bytes = bf->logical, .len = bf->logical_len};
+        wmbus_parsed_frame_init(&s_parsed[i], &raw, info);
+        wmbus_parsed_frame_parse_meta(&s_parsed[i]);
+    }
+
+    bool ok = true;
+    printf("%zu frames x %u rounds\n", bench_frame_count, rounds);
+    printf("%-64s %5s %6s %8s\n", "filter", "insns", "match", "ns/frame");
+    for (size_t c = 0; c < sizeof(CASES) / sizeof(CASES[0]); c++)
+    {
+        ok &= run_case(&CASES[c], rounds);
+    }
+
+    // Rejected expressions must report where they went wrong
+    static const struct
+    {
+        const char *expr;
+        size_t pos;
+    } BAD[] = {{"ci ==", 5}, {"bogus > 1", 0}, {"id < 12", 3}, {"(ci == 1", 8}};
+    for (size_t b = 0; b < sizeof(BAD) / sizeof(BAD[0]); b++)
+    {
+        frame_filter_t f;
+        size_t pos = 0;
+        if (frame_filter_compile(BAD[b].expr, &f, &pos) != ESP_ERR_INVALID_ARG || pos != BAD[b].pos)
+        {
+            fprintf(stderr, "\"%s\": expected a syntax error at %zu, got %zu\n", BAD[b].expr, BAD[b].pos, pos);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
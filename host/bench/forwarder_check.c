@@ -0,0 +1,196 @@
+// Host check of the batching forwarder (main/app/net/forwarder.c) against a real
+// HTTP server, normally host/tools/backend_stub.py started by
+// host/tools/forwarder_check.py. The forwarder runs unchanged on the pthread
+// RTOS shim, the POSIX esp_http_client and a RAM frame log; the uptime clock
+// is virtual, so age flushes and replay delays happen when this program says.
+//   size     4 x max_frames corpus frames: one batch each, nothing waits for age
+//   age      a few frames, then the clock passes max_age_ms: one batch with all
+//   offline  Wi-Fi down: a full batch goes to the frame log; Wi-Fi back and the
+//            retry delay over: the frames are replayed as one batch
+// Exits non-zero unless every frame was sent or replayed exactly once with no
+// failed batch; the last line sums up what the server should have seen.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/forwarder_check http://127.0.0.1:8080/ingest [json|cbor] [corpus]
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench_corpus.h"
+#include "esp_log.h"
+#include "sim/flash_sim.h"
+#include "sim/host_port.h"
+#include "wmbus/packet.h"
+#include "app/config.h"
+#include "app/net/forwarder.h"
+#include "app/net/wifi.h"
+
+#define PART_SIZE 0x40000
+
+static atomic_bool s_wifi_up = true;
+
+bool wifi_sta_is_connected(void)
+{
+    return atomic_load(&s_wifi_up);
+}
+
+static backend_config_t s_cfg;
+static size_t s_next; // Next corpus frame to submit
+static uint32_t s_submitted;
+
+static void submit(uint32_t n)
+{
+    for (uint32_t k = 0; k < n; k++)
+    {
+        const bench_frame_t *f = &bench_frames[s_next++ % bench_frame_count];
+        WmbusPacketEvent evt = {
+            .status = WMBUS_PKT_OK,
+            .rssi_dbm = -71.5f,
+            .lqi = 30,
+            .logical_packet = f->logical,
+            .logical_len = f->logical_len,
+            .gateway_name = "check",
+        };
+        evt.frame_info.logical_len = f->logical_len;
+        evt.frame_info.parsed =
+            wmbus_parse_frame_header(f->logical, f->logical_len, &evt.frame_info.header, NULL, &evt.frame_info.payload_len);
+        if (forwarder_submit(&evt) != ESP_OK)
+        {
+            fprintf(stderr, "submit failed\n");
+            exit(1);
+        }
+        s_submitted++;
+    }
+}
+
+// Polls (real time) until field of the stats reaches want; false after 5 s.
+static bool wait_stat(size_t offset, uint32_t want, forwarder_stats_t *st)
+{
+    for (int tries = 0; tries < 5000; tries++)
+    {
+        forwarder_get_stats(st);
+        uint32_t v;
+        memcpy(&v, (const uint8_t *)st + offset, sizeof(v));
+        if (v >= want)
+        {
+            return true;
+        }
+        usleep(1000);
+    }
+    return false;
+}
+
+#define WAIT(field, want, st) wait_stat(offsetof(forwarder_stats_t, field), (want), (st))
+
+static void advance_ms(uint32_t ms)
+{
+    host_port_set_now_us(host_port_now_us() + (int64_t)ms * 1000);
+    forwarder_kick();
+}
+
+static bool fail(const char *phase, const forwarder_stats_t *st)
+{
+    fprintf(stderr, "%s: queued %u sent %u batches %u last %u failed %u dropped %u spooled %u replayed %u\n", phase,
+            st->queued, st->sent, st->batches, st->last_batch_frames, st->failed, st->dropped, st->spooled, st->replayed);
+    return false;
+}
+
+static bool run_size(forwarder_stats_t *st)
+{
+    const uint32_t per = s_cfg.batch.max_frames;
+    for (uint32_t b = 1; b <= 4; b++)
+    {
+        submit(per);
+        if (!WAIT(batches, b, st) || st->last_batch_frames != per)
+        {
+            return fail("size", st);
+        }
+    }
+    printf("size     4 batches of %u frames\n", per);
+    return true;
+}
+
+static bool run_age(forwarder_stats_t *st)
+{
+    const uint32_t before = st->batches;
+    submit(5);
+    usleep(200000);
+    forwarder_get_stats(st);
+    if (st->batches != before)
+    {
+        return fail("age (sent early)", st);
+    }
+    advance_ms(s_cfg.batch.max_age_ms);
+    if (!WAIT(batches, before + 1, st) || st->last_batch_frames != 5)
+    {
+        return fail("age", st);
+    }
+    printf("age      1 batch of 5 frames after %u ms\n", s_cfg.batch.max_age_ms);
+    return true;
+}
+
+static bool run_offline(forwarder_stats_t *st)
+{
+    const uint32_t per = s_cfg.batch.max_frames;
+    const uint32_t before = st->batches;
+    atomic_store(&s_wifi_up, false);
+    submit(per);
+    if (!WAIT(spooled, per, st) || st->batches != before)
+    {
+        return fail("offline (spool)", st);
+    }
+    atomic_store(&s_wifi_up, true);
+    advance_ms(APP_FRAMELOG_RETRY_MS);
+    if (!WAIT(replayed, per, st) || st->batches != before + 1)
+    {
+        return fail("offline (replay)", st);
+    }
+    printf("offline  %u frames kept in flash, replayed as 1 batch\n", per);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <url> [json|cbor] [corpus]\n", argv[0]);
+        return 2;
+    }
+    const bool cbor = argc > 2 && strcmp(argv[2], "cbor") == 0;
+    const char *path = (argc > 3) ? argv[3] : BENCH_DEFAULT_CORPUS;
+    if (!bench_load_corpus(path))
+    {
+        fprintf(stderr, "no frames loaded from %s\n", path);
+        return 1;
+    }
+    if (!flash_sim_init(APP_FRAMELOG_PARTITION, PART_SIZE))
+    {
+        fprintf(stderr, "flash sim failed\n");
+        return 1;
+    }
+
+    host_port_set_now_us(1000000);
+    strncpy(s_cfg.url, argv[1], sizeof(s_cfg.url) - 1);
+    s_cfg.batch = (backend_batch_t){
+        .max_frames = APP_FORWARD_BATCH_FRAMES,
+        .max_age_ms = APP_FORWARD_BATCH_MS,
+        .max_bytes = APP_FORWARD_BATCH_BYTES_MAX,
+    };
+    s_cfg.format = cbor ? UPLINK_FORMAT_CBOR : UPLINK_FORMAT_JSON;
+    if (forwarder_start(&s_cfg, "check") != ESP_OK)
+    {
+        fprintf(stderr, "forwarder_start failed\n");
+        return 1;
+    }
+
+    forwarder_stats_t st = {0};
+    const bool ok = run_size(&st) && run_age(&st) && run_offline(&st);
+    forwarder_get_stats(&st);
+    const bool clean = ok && st.sent + st.replayed == s_submitted && st.failed == 0 && st.dropped == 0;
+    printf("total    frames=%u batches=%u failed=%u dropped=%u %s\n", st.sent + st.replayed, st.batches, st.failed,
+           st.dropped, cbor ? "cbor" : "json");
+    flash_sim_free();
+    return clean ? 0 : 1;
+}
@@ -0,0 +1,287 @@
+// Host benchmark and consistency check for the store-and-forward frame log
+// (main/app/net/framelog.c) on a simulated 448 KiB flash partition:
+// outage fill, remount, batched replay with a remount in the middle, ring
+// overflow, power cuts in the middle of appends and sector wear.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/framelog_bench [cycles=20]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_log.h"
+#include "app/net/framelog.h"
+#include "sim/flash_sim.h"
+#include "sim/host_port.h"
+
+#define PART_LABEL "framelog"
+#define PART_SIZE 0x70000
+#define REPLAY_BATCH 16
+
+static uint32_t s_next_seq; // Sequence number of the next appended frame
+static uint32_t s_want_seq; // Sequence number the next replayed frame must carry
+static uint64_t s_append_ns;
+static uint64_t s_append_count;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Logical frame of varying length carrying its sequence number after the L-field.
+static uint16_t make_frame(uint32_t seq, uint8_t *out)
+{
+    const uint16_t len = (uint16_t)(12 + (seq * 7) % 120);
+    out[0] = (uint8_t)(len - 1);
+    memcpy(&out[1], &seq, sizeof(seq));
+    for (uint16_t i = 5; i < len; i++)
+    {
+        out[i] = (uint8_t)(seq * 31 + i);
+    }
+    return len;
+}
+
+static int fail(const char *what)
+{
+    fprintf(stderr, "FAIL: %s (next_seq=%u want_seq=%u)\n", what, s_next_seq, s_want_seq);
+    return 1;
+}
+
+static void mount(void)
+{
+    framelog_deinit();
+    if (framelog_init(PART_LABEL) != ESP_OK)
+    {
+        fprintf(stderr, "mount failed\n");
+        exit(1);
+    }
+}
+
+static esp_err_t append_next(void)
+{
+    uint8_t frame[FRAMELOG_FRAME_MAX];
+    const uint16_t len = make_frame(s_next_seq, frame);
+    host_port_set_now_us(host_port_now_us() + 1000);
+    const framelog_meta_t meta = {.rx_ms = framelog_now_ms(), .rssi_ddbm = -700, .lqi = 40, .status = 0};
+    const uint64_t start = now_ns();
+    esp_err_t err = framelog_append(&meta, frame, len);
+    s_append_ns += now_ns() - start;
+    s_append_count++;
+    s_next_seq++;
+    return err;
+}
+
+// Replay up to max frames in batches; every frame must be the expected next one.
+static int replay(uint32_t max)
+{
+    uint32_t last_ms = 0;
+    uint32_t done = 0;
+    while (done < max)
+    {
+        framelog_stats_t st;
+        framelog_get_stats(&st);
+        uint32_t n = 0;
+        for (; n < REPLAY_BATCH && done + n < max; n++)
+        {
+            framelog_meta_t meta;
+            uint8_t frame[FRAMELOG_FRAME_MAX];
+            uint8_t want[FRAMELOG_FRAME_MAX];
+            uint16_t len = 0;
+            esp_err_t err = framelog_peek(n, &meta, frame, sizeof(frame), &len);
+            if (err == ESP_ERR_NOT_FOUND)
+            {
+                break;
+            }
+            if (err != ESP_OK)
+            {
+                return fail("peek error");
+            }
+            if (n == 0 && meta.rx_ms != st.oldest_ms)
+            {
+                return fail("oldest_ms does not match the first pending frame");
+            }
+            if (done + n > 0 && (int32_t)(meta.rx_ms - last_ms) <= 0)
+            {
+                return fail("rx_ms not increasing");
+            }
+            last_ms = meta.rx_ms;
+            const uint16_t want_len = make_frame(s_want_seq + n, want);
+            if (len != want_len || memcmp(frame, want, len) != 0)
+            {
+                return fail("replayed frame differs from the appended one");
+            }
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        if (framelog_consume(n) != ESP_OK)
+        {
+            return fail("consume");
+        }
+        s_want_seq += n;
+        done += n;
+    }
+    return 0;
+}
+
+static uint32_t backlog(void)
+{
+    framelog_stats_t st;
+    framelog_get_stats(&st);
+    return st.backlog;
+}
+
+int main(int argc, char **argv)
+{
+    const unsigned cycles = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 10) : 20;
+    host_port_reset();
+    host_log_level = ESP_LOG_ERROR; // Overflow warnings are expected below
+    if (!flash_sim_init(PART_LABEL, PART_SIZE))
+    {
+        return 1;
+    }
+    mount();
+    framelog_stats_t st;
+    framelog_get_stats(&st);
+    printf("partition %u KiB, %u bytes usable\n", PART_SIZE / 1024, st.capacity_bytes);
+
+    // 1. Outage: fill half the log, remount, everything must still be pending
+    const uint32_t outage = 2000;
+    for (uint32_t i = 0; i < outage; i++)
+    {
+        if (append_next() != ESP_OK)
+        {
+            return fail("append");
+        }
+    }
+    const uint32_t used_before = (framelog_get_stats(&st), st.used_bytes);
+    mount();
+    framelog_get_stats(&st);
+    if (st.backlog != outage || st.used_bytes != used_before)
+    {
+        return fail("backlog lost over remount");
+    }
+    printf("outage: %u frames, %u bytes pending after remount, log clock resumed at %u ms\n",
+           st.backlog, st.used_bytes, framelog_now_ms());
+
+    // 2. Replay half, remount (consumed marker must survive), replay the rest
+    if (replay(outage / 2 + 5) != 0)
+    {
+        return 1;
+    }
+    mount();
+    if (backlog() != outage - (outage / 2 + 5))
+    {
+        return fail("consume marker lost over remount");
+    }
+    if (replay(UINT32_MAX) != 0 || backlog() != 0 || s_want_seq != s_next_seq)
+    {
+        return fail("replay after remount");
+    }
+    printf("replay: %u frames in batches of %d, remount in the middle ok\n", outage, REPLAY_BATCH);
+
+    // 3. Overflow: write twice the capacity; the newest frames survive, in order
+    framelog_stats_t before;
+    framelog_get_stats(&before);
+    const uint32_t flood = 2 * (PART_SIZE / 80);
+    for (uint32_t i = 0; i < flood; i++)
+    {
+        if (append_next() != ESP_OK)
+        {
+            return fail("append during flood");
+        }
+    }
+    framelog_get_stats(&st);
+    const uint32_t lost = st.lost - before.lost;
+    if (lost == 0 || st.backlog + lost != flood)
+    {
+        return fail("overflow accounting");
+    }
+    mount();
+    if (backlog() != st.backlog)
+    {
+        return fail("backlog after overflow remount");
+    }
+    s_want_seq = s_next_seq - st.backlog;
+    if (replay(UINT32_MAX) != 0 || backlog() != 0)
+    {
+        return 1;
+    }
+    printf("overflow: %u appended, %u oldest dropped, %u replayed in order\n", flood, lost, flood - lost);
+
+    // 4. Power cuts at every few bytes of an append: all earlier frames survive,
+    //    the torn one is skipped and logging continues behind it
+    unsigned cuts = 0;
+    for (uint64_t at = 1; at < 200; at += 13)
+    {
+        const uint32_t keep = 50;
+        for (uint32_t i = 0; i < keep; i++)
+        {
+            append_next();
+        }
+        flash_sim_cut_after(at);
+        append_next();
+        const bool cut = flash_sim_cut_done();
+        flash_sim_cut_after(0);
+        mount();
+        const uint32_t pending = backlog();
+        if (pending != keep + (cut ? 0 : 1))
+        {
+            return fail("unexpected backlog after power cut");
+        }
+        if (replay(keep) != 0)
+        {
+            return 1;
+        }
+        if (cut)
+        {
+            s_want_seq++; // The torn frame is gone for good
+            cuts++;
+        }
+        else if (replay(1) != 0)
+        {
+            return 1;
+        }
+        if (append_next() != ESP_OK || replay(1) != 0 || backlog() != 0)
+        {
+            return fail("append after power cut");
+        }
+    }
+    printf("power cuts: %u torn appends skipped, no earlier frame lost\n", cuts);
+
+    // 5. Steady outage/replay cycles for wear and throughput
+    for (unsigned c = 0; c < cycles; c++)
+    {
+        for (uint32_t i = 0; i < 3000; i++)
+        {
+            append_next();
+        }
+        if (replay(UINT32_MAX) != 0)
+        {
+            return 1;
+        }
+    }
+    mount();
+    framelog_get_stats(&st);
+    flash_sim_stats_t fs;
+    flash_sim_get_stats(&fs);
+    if (fs.max_sector_erases - fs.min_sector_erases > 1)
+    {
+        return fail("uneven sector wear");
+    }
+    printf("wear: %u erases, per-sector min %u max %u\n", fs.erases, fs.min_sector_erases, fs.max_sector_erases);
+    printf("flash: %llu bytes written, %llu bytes read\n", (unsigned long long)fs.bytes_written,
+           (unsigned long long)fs.bytes_read);
+    printf("append: %.0f ns/frame on the host (%llu frames)\n", (double)s_append_ns / (double)s_append_count,
+           (unsigned long long)s_append_count);
+
+    const uint64_t start = now_ns();
+    mount();
+    printf("mount scan: %.2f ms on the host\n", (double)(now_ns() - start) / 1e6);
+    framelog_deinit();
+    flash_sim_free();
+    return 0;
+}
@@ -0,0 +1,176 @@
+// Host benchmark of the web UI packet history (wmbus_frame_history), a byte ring
+// of 16-byte headers plus logical frames:
+//   capacity  frames held by a 32 KB ring for the corpus, against the previous
+//             history of 16 pool-frame references (each pinning a whole frame)
+//   push      ns per appended frame once the ring is full (recycling included)
+//   readers   an unpaced writer against readers walking the ring newest first
+//             and fetching recent frames by sequence number
+// Every record a reader gets back is checked against the corpus frame it was
+// written from; a reader may lose a record to the writer, never see a torn one.
+// Corpus format: see bench_corpus.h.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/history_bench [corpus] [frames] [readers]
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench_corpus.h"
+#include "app/wmbus/frame_history.h"
+#include "app/wmbus/frame_pool.h"
+
+#define RING_BYTES  32768
+#define OLD_FRAMES  16 // Frame references held by the previous history
+#define READERS_MAX 4
+
+static uint8_t s_ring[RING_BYTES];
+static wmbus_frame_history_t s_history;
+static volatile bool s_stop;
+
+typedef struct
+{
+    uint64_t walks;
+    uint64_t records;
+    uint64_t gets;
+    uint64_t torn;
+} reader_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t push(uint32_t n)
+{
+    const bench_frame_t *f = &bench_frames[n % bench_frame_count];
+    const wmbus_history_meta_t meta = {
+        .rx_ms = n,
+        .rssi_ddbm = (int16_t)(-700 - (int16_t)(n % 300)),
+        .lqi = (uint8_t)n,
+    };
+    return wmbus_frame_history_push(&s_history, &meta, f->logical, f->logical_len);
+}
+
+// Frame n (seq n + 1 from a fresh ring) as push() wrote it
+static bool matches(const wmbus_history_entry_t *e)
+{
+    const uint32_t n = e->meta.seq - 1;
+    const bench_frame_t *f = &bench_frames[n % bench_frame_count];
+    return e->meta.rx_ms == n && e->meta.lqi == (uint8_t)n && e->len == f->logical_len &&
+           memcmp(e->bytes, f->logical, e->len) == 0;
+}
+
+static void *reader_main(void *arg)
+{
+    reader_t *r = arg;
+    wmbus_history_entry_t e;
+    while (!s_stop)
+    {
+        wmbus_frame_history_iter_t it;
+        wmbus_frame_history_iter_begin(&s_history, &it);
+        uint32_t prev = 0;
+        while (wmbus_frame_history_iter_next(&s_history, &it, &e))
+        {
+            if (!matches(&e) || (prev && e.meta.seq + 1 != prev))
+            {
+                r->torn++;
+            }
+            prev = e.meta.seq;
+            r->records++;
+        }
+        r->walks++;
+
+        wmbus_frame_history_stats_t info;
+        wmbus_frame_history_get_stats(&s_history, &info);
+        if (info.seq > 4 && wmbus_frame_history_get(&s_history, info.seq - 4, &e))
+        {
+            r->torn += (e.meta.seq != info.seq - 4 || !matches(&e)) ? 1 : 0;
+            r->gets++;
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : BENCH_DEFAULT_CORPUS;
+    const uint32_t frames = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10) : 2000000;
+    const unsigned readers = (argc > 3) ? (unsigned)strtoul(argv[3], NULL, 10) : 2;
+    if (!bench_load_corpus(path) || frames == 0 || readers == 0 || readers > READERS_MAX)
+    {
+        fprintf(stderr, "no frames loaded from %s (or readers not 1..%d)\n", path, READERS_MAX);
+        return 1;
+    }
+    size_t logical_bytes = 0;
+    for (size_t i = 0; i < bench_frame_count; i++)
+    {
+        logical_bytes += bench_frames[i].logical_len;
+    }
+
+    // Capacity and push cost, single-threaded
+    wmbus_frame_history_init(&s_history, s_ring, sizeof(s_ring));
+    for (uint32_t n = 0; n < 4 * RING_BYTES / 16; n++)
+    {
+        push(n);
+    }
+    wmbus_frame_history_stats_t full;
+    wmbus_frame_history_get_stats(&s_history, &full);
+    const uint32_t rounds = 1000000;
+    const uint64_t t0 = now_ns();
+    for (uint32_t n = 0; n < rounds; n++)
+    {
+        push(n);
+    }
+    const double push_ns = (double)(now_ns() - t0) / rounds;
+
+    printf("%zu frames (%.1f logical bytes avg)\n", bench_frame_count, (double)logical_bytes / bench_frame_count);
+    printf("%-22s %8s %10s %12s\n", "history", "frames", "RAM bytes", "bytes/frame");
+    printf("%-22s %8d %10zu %12zu\n", "pool references (old)", OLD_FRAMES, OLD_FRAMES * sizeof(wmbus_frame_t),
+           sizeof(wmbus_frame_t));
+    printf("%-22s %8u %10u %12.1f\n", "packed byte ring", full.count, RING_BYTES, (double)full.used_bytes / full.count);
+    printf("push: %.1f ns/frame with recycling\n", push_ns);
+
+    // Concurrent readers; sequence numbers restart so matches() can map them back
+    wmbus_frame_history_init(&s_history, s_ring, sizeof(s_ring));
+    s_stop = false;
+    reader_t state[READERS_MAX] = {0};
+    pthread_t threads[READERS_MAX];
+    for (unsigned i = 0; i < readers; i++)
+    {
+        pthread_create(&threads[i], NULL, reader_main, &state[i]);
+    }
+    uint64_t worst_ns = 0;
+    for (uint32_t n = 0; n < frames; n++)
+    {
+        const uint64_t t = now_ns();
+        push(n);
+        const uint64_t dt = now_ns() - t;
+        worst_ns = (dt > worst_ns) ? dt : worst_ns;
+    }
+    s_stop = true;
+    reader_t sum = {0};
+    for (unsigned i = 0; i < readers; i++)
+    {
+        pthread_join(threads[i], NULL);
+        sum.walks += state[i].walks;
+        sum.records += state[i].records;
+        sum.gets += state[i].gets;
+        sum.torn += state[i].torn;
+    }
+    wmbus_frame_history_stats_t stats;
+    wmbus_frame_history_get_stats(&s_history, &stats);
+    printf("%u frames vs %u readers: %llu walks (%.1f records each), %llu gets, %u records lost to the writer, "
+           "%llu torn, writer worst %.1f us\n",
+           frames, readers, (unsigned long long)sum.walks, sum.walks ? (double)sum.records / sum.walks : 0.0,
+           (unsigned long long)sum.gets, stats.overwritten, (unsigned long long)sum.torn, worst_ns / 1000.0);
+
+    const bool ok = sum.torn == 0 && stats.seq == frames && full.count > OLD_FRAMES;
+    if (!ok)
+    {
+        fprintf(stderr, "%llu torn records, seq %u of %u\n", (unsigned long long)sum.torn, stats.seq, frames);
+    }
+    return ok ? 0 : 1;
+}
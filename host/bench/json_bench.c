@@ -0,0 +1,331 @@
+// Host benchmark of the streaming JSON writer (main/app/json_writer.c) against
+// the snprintf formatting it replaced:
+//   uplink   one backend record per corpus frame (uplink_format_json vs the old
+//            snprintf + hex loop, kept below as the reference); outputs must match
+//   status   a status-like document from X-macro field descriptors, streamed
+//            through a 512-byte chunk and a flush callback, vs one snprintf into
+//            a 4 KiB buffer
+// Prints bytes/us and the peak stack of each variant, measured by running it on
+// a painted pthread stack, minus what an idle thread touches.
+// Corpus format: see bench_corpus.h.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/json_bench [corpus] [rounds]
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench_corpus.h"
+#include "wmbus/packet.h"
+#include "app/config.h"
+#include "app/json_writer.h"
+#include "app/net/uplink_format.h"
+
+#define STACK_SIZE (64 * 1024)
+#define STACK_PAINT 0xA5
+
+static WmbusPacketEvent s_events[BENCH_MAX_FRAMES];
+static unsigned s_rounds;
+static volatile size_t s_sink; // Keeps the output from being optimized out
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// The uplink record as it was formatted before the writer
+static size_t snprintf_uplink(const WmbusPacketEvent *evt, char *out, size_t out_cap)
+{
+    const uint8_t *logical = NULL;
+    const uint16_t logical_len = uplink_logical_len(evt, &logical);
+    const uint8_t *id = evt->frame_info.header.id;
+    int written = snprintf(out, out_cap,
+                           "{\"gateway\":\"%s\",\"status\":%u,\"rssi\":%.1f,\"lqi\":%u,"
+                           "\"manuf\":%u,\"id\":\"%02X%02X%02X%02X\",\"dev_type\":%u,"
+                           "\"version\":%u,\"ci\":%u,\"payload_len\":%u,"
+                           "\"logical_hex\":\"",
+                           evt->gateway_name, evt->status, evt->rssi_dbm, evt->lqi,
+                           evt->frame_info.header.manufacturer_le, id[3], id[2], id[1], id[0],
+                           evt->frame_info.header.device_type, evt->frame_info.header.version,
+                           evt->frame_info.header.ci_field, evt->frame_info.payload_len);
+    size_t pos = (size_t)written;
+    if (written <= 0 || pos + ((size_t)logical_len * 2) + 3 > out_cap)
+    {
+        return 0;
+    }
+    static const char hex[] = "0123456789ABCDEF";
+    for (uint16_t i = 0; i < logical_len; i++)
+    {
+        out[pos++] = hex[(logical[i] >> 4) & 0xF];
+        out[pos++] = hex[logical[i] & 0xF];
+    }
+    out[pos++] = '"';
+    out[pos++] = '}';
+    out[pos] = '\0';
+    return pos;
+}
+
+static size_t run_uplink_writer(void)
+{
+    char out[UPLINK_JSON_FIXED_LEN + 2 * BENCH_MAX_LOGICAL + 1];
+    size_t bytes = 0;
+    for (unsigned r = 0; r < s_rounds; r++)
+    {
+        for (size_t i = 0; i < bench_frame_count; i++)
+        {
+            bytes += uplink_format_json(&s_events[i], out, sizeof(out));
+        }
+    }
+    s_sink += out[0];
+    return bytes;
+}
+
+static size_t run_uplink_snprintf(void)
+{
+    char out[UPLINK_JSON_FIXED_LEN + 2 * BENCH_MAX_LOGICAL + 1];
+    size_t bytes = 0;
+    for (unsigned r = 0; r < s_rounds; r++)
+    {
+        for (size_t i = 0; i < bench_frame_count; i++)
+        {
+            bytes += snprintf_uplink(&s_events[i], out, sizeof(out));
+        }
+    }
+    s_sink += out[0];
+    return bytes;
+}
+
+// Status-like document: the rx and backend DTOs, eight sinks
+#define RX_FIELDS(X)                                 \
+    X("queue_capacity", U32, queue_capacity)         \
+    X("queue_depth", U32, queue_depth)               \
+    X("queue_high_water", U32, queue_high_water)     \
+    X("queue_drops", U32, queue_drops)               \
+    X("frames", U32, frames)                         \
+    X("rearms", U32, rearms)                         \
+    X("aborted", U32, aborted)                       \
+    X("filtered", U32, filtered)                     \
+    X("filtered_bytes", U32, filtered_bytes)         \
+    X("dead_time_last_us", U32, dead_time_last_us)   \
+    X("dead_time_avg_us", U32, dead_time_avg_us)     \
+    X("dead_time_max_us", U32, dead_time_max_us)
+
+#define SINK_FIELDS(X)                   \
+    X("name", STR, name)                 \
+    X("async", BOOL, async)              \
+    X("calls", U32, calls)               \
+    X("avg_us", U32, avg_us)             \
+    X("max_us", U32, max_us)             \
+    X("queued", U32, queued)             \
+    X("high_water", U32, high_water)     \
+    X("dropped", U32, dropped)           \
+    X("filter", BOOL, has_filter)        \
+    X("filtered", U32, filtered)
+
+#define RX_FIELD(key, type, member) JSON_FIELD(app_rx_status_t, type, key, member),
+#define SINK_FIELD(key, type, member) JSON_FIELD(app_sink_status_t, type, key, member),
+
+static const json_field_t RX_JSON[] = {RX_FIELDS(RX_FIELD)};
+static const json_field_t SINK_JSON[] = {SINK_FIELDS(SINK_FIELD)};
+
+static app_rx_status_t s_rx;
+static app_sinks_status_t s_sinks;
+static char s_doc_writer[4096];
+static char s_doc_snprintf[4096];
+static size_t s_doc_len;
+
+// Flush callback standing in for httpd_resp_send_chunk: collects the document
+static esp_err_t collect(void *ctx, const char *data, size_t len)
+{
+    (void)ctx;
+    if (s_doc_len + len <= sizeof(s_doc_writer))
+    {
+        memcpy(s_doc_writer + s_doc_len, data, len);
+    }
+    s_doc_len += len;
+    return ESP_OK;
+}
+
+static size_t run_status_writer(void)
+{
+    size_t bytes = 0;
+    for (unsigned r = 0; r < s_rounds; r++)
+    {
+        char chunk[APP_JSON_CHUNK];
+        json_writer_t w;
+        s_doc_len = 0;
+        json_init(&w, chunk, sizeof(chunk), collect, NULL);
+        json_obj_begin(&w, NULL);
+        json_obj_begin(&w, "rx");
+        json_write_fields(&w, &s_rx, RX_JSON, sizeof(RX_JSON) / sizeof(RX_JSON[0]));
+        json_obj_end(&w);
+        json_arr_begin(&w, "sinks");
+        for (uint8_t i = 0; i < s_sinks.count; i++)
+        {
+            json_obj_begin(&w, NULL);
+            json_write_fields(&w, &s_sinks.sinks[i], SINK_JSON, sizeof(SINK_JSON) / sizeof(SINK_JSON[0]));
+            json_obj_end(&w);
+        }
+        json_arr_end(&w);
+        json_obj_end(&w);
+        json_finish(&w);
+        bytes += json_size(&w);
+    }
+    return bytes;
+}
+
+static size_t run_status_snprintf(void)
+{
+    size_t bytes = 0;
+    for (unsigned r = 0; r < s_rounds; r++)
+    {
+        char json[4096];
+        const app_rx_status_t *rx = &s_rx;
+        int n = snprintf(json, sizeof(json),
+                         "{\"rx\":{\"queue_capacity\":%" PRIu32 ",\"queue_depth\":%" PRIu32 ",\"queue_high_water\":%" PRIu32
+                         ",\"queue_drops\":%" PRIu32 ",\"frames\":%" PRIu32 ",\"rearms\":%" PRIu32 ",\"aborted\":%" PRIu32
+                         ",\"filtered\":%" PRIu32 ",\"filtered_bytes\":%" PRIu32 ",\"dead_time_last_us\":%" PRIu32
+                         ",\"dead_time_avg_us\":%" PRIu32 ",\"dead_time_max_us\":%" PRIu32 "},\"sinks\":[",
+                         rx->queue_capacity, rx->queue_depth, rx->queue_high_water, rx->queue_drops, rx->frames,
+                         rx->rearms, rx->aborted, rx->filtered, rx->filtered_bytes, rx->dead_time_last_us,
+                         rx->dead_time_avg_us, rx->dead_time_max_us);
+        for (uint8_t i = 0; i < s_sinks.count && n > 0 && n < (int)sizeof(json); i++)
+        {
+            const app_sink_status_t *k = &s_sinks.sinks[i];
+            n += snprintf(json + n, sizeof(json) - n,
+                          "%s{\"name\":\"%s\",\"async\":%s,\"calls\":%" PRIu32 ",\"avg_us\":%" PRIu32 ",\"max_us\":%" PRIu32 ","
+                          "\"queued\":%" PRIu32 ",\"high_water\":%" PRIu32 ",\"dropped\":%" PRIu32 ","
+                          "\"filter\":%s,\"filtered\":%" PRIu32 "}",
+                          i ? "," : "", k->name, k->async ? "true" : "false", k->calls, k->avg_us, k->max_us, k->queued,
+                          k->high_water, k->dropped, k->has_filter ? "true" : "false", k->filtered);
+        }
+        if (n > 0 && n < (int)sizeof(json))
+        {
+            n += snprintf(json + n, sizeof(json) - n, "]}");
+        }
+        memcpy(s_doc_snprintf, json, sizeof(json));
+        bytes += (size_t)n;
+    }
+    return bytes;
+}
+
+static size_t run_idle(void)
+{
+    return 1;
+}
+
+typedef struct
+{
+    const char *name;
+    size_t (*fn)(void);
+    size_t bytes;
+    uint64_t ns;
+} variant_t;
+
+static void *variant_thread(void *arg)
+{
+    variant_t *v = arg;
+    const uint64_t t0 = now_ns();
+    v->bytes = v->fn();
+    v->ns = now_ns() - t0;
+    return NULL;
+}
+
+// Run v on a fresh stack painted with STACK_PAINT; returns the deepest byte touched.
+static size_t run_measured(variant_t *v)
+{
+    uint8_t *stack = aligned_alloc(4096, STACK_SIZE);
+    memset(stack, STACK_PAINT, STACK_SIZE);
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, STACK_SIZE);
+    pthread_t t;
+    pthread_create(&t, &attr, variant_thread, v);
+    pthread_join(t, NULL);
+    pthread_attr_destroy(&attr);
+    size_t untouched = 0;
+    while (untouched < STACK_SIZE && stack[untouched] == STACK_PAINT)
+    {
+        untouched++;
+    }
+    free(stack);
+    return STACK_SIZE - untouched;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : BENCH_DEFAULT_CORPUS;
+    s_rounds = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 20000;
+    if (!bench_load_corpus(path) || s_rounds == 0)
+    {
+        fprintf(stderr, "no frames loaded from %s\n", path);
+        return 1;
+    }
+    bool ok = true;
+    for (size_t i = 0; i < bench_frame_count; i++)
+    {
+        const bench_frame_t *f = &bench_frames[i];
+        WmbusPacketEvent *evt = &s_events[i];
+        evt->frame_info.parsed = wmbus_parse_frame_header(f->logical, f->logical_len, &evt->frame_info.header, NULL,
+                                                          &evt->frame_info.payload_len);
+        evt->frame_info.logical_len = f->logical_len;
+        evt->rssi_dbm = -60.0f - (float)(i % 40) * 0.7f;
+        evt->lqi = (uint8_t)(i * 7);
+        evt->logical_packet = f->logical;
+        evt->logical_len = f->logical_len;
+        evt->gateway_name = "oms-gateway";
+
+        char a[UPLINK_JSON_FIXED_LEN + 2 * BENCH_MAX_LOGICAL + 1];
+        char b[sizeof(a)];
+        if (uplink_format_json(evt, a, sizeof(a)) == 0 || snprintf_uplink(evt, b, sizeof(b)) == 0 || strcmp(a, b) != 0)
+        {
+            fprintf(stderr, "frame %zu: writer output differs\n  %s\n  %s\n", i, a, b);
+            ok = false;
+        }
+    }
+
+    s_rx = (app_rx_status_t){8, 1, 5, 0, 28, 3, 9, 1, 12345, 678, 2, 0, 120, 98, 140, 3100};
+    s_sinks.count = APP_SINKS_MAX;
+    for (uint8_t i = 0; i < s_sinks.count; i++)
+    {
+        app_sink_status_t *k = &s_sinks.sinks[i];
+        snprintf(k->name, sizeof(k->name), "sink%u", i);
+        k->async = i & 1;
+        k->calls = 100000u * i + 17;
+        k->avg_us = 40 + i;
+        k->max_us = 900 + i;
+        k->high_water = i;
+        k->has_filter = i == 3;
+        k->filtered = i * 11;
+    }
+
+    variant_t variants[] = {
+        {"uplink snprintf", run_uplink_snprintf, 0, 0},
+        {"uplink writer", run_uplink_writer, 0, 0},
+        {"status snprintf", run_status_snprintf, 0, 0},
+        {"status writer", run_status_writer, 0, 0},
+    };
+    variant_t idle = {"idle", run_idle, 0, 0};
+    run_measured(&idle); // The first thread also pays for one-time libc setup
+    const size_t idle_stack = run_measured(&idle);
+    printf("%zu frames x %u rounds\n", bench_frame_count, s_rounds);
+    printf("%-16s %10s %12s %12s\n", "variant", "bytes/us", "bytes/call", "stack bytes");
+    for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++)
+    {
+        const size_t stack = run_measured(&variants[v]);
+        const size_t calls = (size_t)s_rounds * ((v < 2) ? bench_frame_count : 1);
+        printf("%-16s %10.1f %12.1f %12zu\n", variants[v].name, (double)variants[v].bytes * 1000.0 / (double)variants[v].ns,
+               (double)variants[v].bytes / (double)calls, stack - idle_stack);
+    }
+    if (s_doc_len >= sizeof(s_doc_writer) || strncmp(s_doc_writer, s_doc_snprintf, s_doc_len) != 0 ||
+        s_doc_snprintf[s_doc_len] != '\0')
+    {
+        fprintf(stderr, "status documents differ\n  %.*s\n  %s\n", (int)s_doc_len, s_doc_writer, s_doc_snprintf);
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
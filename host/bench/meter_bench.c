@@ -0,0 +1,339 @@
+// Host benchmark of the per-meter statistics table (wmbus_meter_table):
+//   churn     a population larger than the table, checked after every frame
+//             against a plain array that scans for the meter and for the least
+//             recently heard one; both must hold the same meters and counts
+//   interval  simulated meters with known transmit intervals, jitter and lost
+//             frames; the estimate must land within 5 % of the true interval
+//   loss      26 h of meters losing 0-40 % of their frames, with repeater copies
+//             (same and older ACC), a 3 h outage wrapping the 8-bit ACC and one
+//             of 251 transmissions (ACC step just short of a wrap, which looks
+//             like an older ACC); the missed count must be exact, the 1 h / 24 h
+//             ratios close to the truth
+//   cost      ns per update (hash index) against the linear scan, both full
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/meter_bench [population] [frames]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "app/wmbus/meter_table.h"
+
+typedef struct
+{
+    uint16_t manuf;
+    uint8_t id[4];
+    uint32_t frames;
+    uint32_t crc_errors;
+    uint32_t last;
+} ref_meter_t;
+
+static wmbus_meter_table_t s_table;
+static ref_meter_t s_ref[APP_METERS];
+static uint32_t s_ref_count;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t rng_state = 0x12345678u;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// Meter n of the population: BCD-like ID, a handful of manufacturers
+static void meter_sample(uint32_t n, wmbus_meter_sample_t *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->manuf = (uint16_t)(0x2C2D + (n % 5) * 0x0421);
+    s->id[0] = (uint8_t)n;
+    s->id[1] = (uint8_t)(n >> 8);
+    s->id[2] = 0x34;
+    s->id[3] = 0x12;
+    s->dev_type = 7;
+    s->intact = true;
+    s->rssi_ddbm = -800;
+    s->lqi = 40;
+}
+
+// The previous approach: one array, scanned for the meter and for the victim.
+static void ref_update(const wmbus_meter_sample_t *s, uint32_t tick)
+{
+    ref_meter_t *victim = NULL;
+    for (uint32_t i = 0; i < s_ref_count; i++)
+    {
+        ref_meter_t *m = &s_ref[i];
+        if (m->manuf == s->manuf && memcmp(m->id, s->id, sizeof(m->id)) == 0)
+        {
+            m->frames += s->intact ? 1 : 0;
+            m->crc_errors += s->intact ? 0 : 1;
+            m->last = tick;
+            return;
+        }
+        if (!victim || m->last < victim->last)
+        {
+            victim = m;
+        }
+    }
+    ref_meter_t *m = (s_ref_count < APP_METERS) ? &s_ref[s_ref_count++] : victim;
+    m->manuf = s->manuf;
+    memcpy(m->id, s->id, sizeof(m->id));
+    m->frames = s->intact ? 1 : 0;
+    m->crc_errors = s->intact ? 0 : 1;
+    m->last = tick;
+}
+
+// Same meters with the same counters, and a consistent recency list
+static bool same_as_ref(void)
+{
+    if (s_table.count != s_ref_count)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < s_ref_count; i++)
+    {
+        const wmbus_meter_t *m = wmbus_meter_table_find(&s_table, s_ref[i].manuf, s_ref[i].id);
+        if (!m || m->frames != s_ref[i].frames || m->crc_errors != s_ref[i].crc_errors)
+        {
+            return false;
+        }
+    }
+    uint32_t listed = 0;
+    for (uint16_t r = s_table.newest; r != WMBUS_METER_NONE && listed <= APP_METERS; r = s_table.meters[r].older)
+    {
+        listed++;
+    }
+    return listed == s_table.count;
+}
+
+static bool run_churn(uint32_t population, uint32_t frames)
+{
+    wmbus_meter_table_init(&s_table);
+    s_ref_count = 0;
+    uint32_t mismatches = 0;
+    for (uint32_t n = 0; n < frames; n++)
+    {
+        // Skewed toward low meter numbers so some meters stay while others churn
+        const uint32_t r = rng();
+        const uint32_t meter = (r & 1) ? (r >> 1) % (population / 4 + 1) : (r >> 1) % population;
+        wmbus_meter_sample_t s;
+        meter_sample(meter, &s);
+        s.intact = (r % 11) != 0;
+        wmbus_meter_table_update(&s_table, &s, n);
+        ref_update(&s, n + 1);
+        mismatches += same_as_ref() ? 0 : 1;
+    }
+    printf("churn: %u meters over %d rows, %u frames, %u evicted, %u mismatches\n", population, APP_METERS, frames,
+           s_table.evicted, mismatches);
+    return mismatches == 0;
+}
+
+static bool run_interval(void)
+{
+    enum
+    {
+        METERS = 64,
+        HOURS = 6,
+    };
+    uint32_t interval[METERS];
+    uint32_t next_ms[METERS];
+    uint8_t acc[METERS];
+    wmbus_meter_table_init(&s_table);
+    for (uint32_t i = 0; i < METERS; i++)
+    {
+        interval[i] = 8000 + (rng() % 112000);
+        next_ms[i] = rng() % interval[i];
+        acc[i] = (uint8_t)rng();
+    }
+    for (uint32_t t = 0; t < HOURS * 3600u * 1000u; t += 100)
+    {
+        for (uint32_t i = 0; i < METERS; i++)
+        {
+            if (t < next_ms[i])
+            {
+                continue;
+            }
+            // +-0.5 s jitter, every 5th frame lost on average
+            next_ms[i] += interval[i] + (rng() % 1000) - 500;
+            acc[i]++;
+            if (rng() % 5 == 0)
+            {
+                continue;
+            }
+            wmbus_meter_sample_t s;
+            meter_sample(i, &s);
+            s.has_acc = true;
+            s.acc = acc[i];
+            wmbus_meter_table_update(&s_table, &s, t);
+        }
+    }
+    double worst = 0;
+    for (uint32_t i = 0; i < METERS; i++)
+    {
+        wmbus_meter_sample_t s;
+        meter_sample(i, &s);
+        const wmbus_meter_t *m = wmbus_meter_table_find(&s_table, s.manuf, s.id);
+        const double err = m ? (double)((int64_t)m->interval_ms - interval[i]) / interval[i] : 1.0;
+        worst = (err < 0 ? -err : err) > worst ? (err < 0 ? -err : err) : worst;
+    }
+    printf("interval: %d meters, 8-120 s, 20 %% lost, %d h: worst estimate error %.2f %%\n", METERS, HOURS,
+           worst * 100.0);
+    return worst < 0.05;
+}
+
+static bool run_loss(void)
+{
+    enum
+    {
+        METERS = 40,
+        HOURS = 26,
+        SILENT = 7,      // Meter that goes quiet for 3 h in hour 10
+        NEAR_WRAP = 10,  // Loses 251 transmissions in hour 15 (no other loss)
+        NEAR_WRAP_MS = 251 * 20000,
+    };
+    const uint32_t end_ms = HOURS * WMBUS_METER_HOUR_MS;
+    uint32_t interval[METERS];
+    uint32_t next_ms[METERS];
+    uint8_t acc[METERS];
+    uint32_t missed[METERS] = {0};
+    bool heard[METERS] = {false};
+    // Truth for the windows: transmissions and receptions per meter in the last hour / day
+    uint32_t sent_1h[METERS] = {0};
+    uint32_t got_1h[METERS] = {0};
+    uint32_t sent_24h[METERS] = {0};
+    uint32_t got_24h[METERS] = {0};
+    wmbus_meter_table_init(&s_table);
+    for (uint32_t i = 0; i < METERS; i++)
+    {
+        interval[i] = (i == SILENT || i == NEAR_WRAP) ? 20000 : 8000 + (rng() % 112000);
+        next_ms[i] = rng() % interval[i];
+        acc[i] = (uint8_t)rng();
+    }
+    for (uint32_t t = 0; t < end_ms; t += 250)
+    {
+        for (uint32_t i = 0; i < METERS; i++)
+        {
+            if (t < next_ms[i])
+            {
+                continue;
+            }
+            next_ms[i] += interval[i] + (rng() % 1000) - 500;
+            acc[i]++;
+            const bool outage = i == SILENT && t >= 10 * WMBUS_METER_HOUR_MS && t < 13 * WMBUS_METER_HOUR_MS;
+            const bool short_outage = i == NEAR_WRAP && t >= 15 * WMBUS_METER_HOUR_MS &&
+                                      t < 15 * WMBUS_METER_HOUR_MS + NEAR_WRAP_MS;
+            const bool lost = outage || short_outage || (rng() % 100) < (i % 5) * 10;
+            const bool counted = heard[i]; // Counting starts with the first frame received
+            if (counted && t >= end_ms - 24 * WMBUS_METER_HOUR_MS)
+            {
+                sent_24h[i]++;
+                got_24h[i] += lost ? 0 : 1;
+            }
+            if (counted && t >= end_ms - WMBUS_METER_HOUR_MS)
+            {
+                sent_1h[i]++;
+                got_1h[i] += lost ? 0 : 1;
+            }
+            if (lost)
+            {
+                missed[i] += counted ? 1 : 0;
+                continue;
+            }
+            heard[i] = true;
+            wmbus_meter_sample_t s;
+            meter_sample(i, &s);
+            s.has_acc = true;
+            s.acc = acc[i];
+            wmbus_meter_table_update(&s_table, &s, t);
+            const uint32_t r = rng() % 10;
+            if (r < 2)
+            {
+                // Repeater copy of this telegram (r 0) or of the one before (r 1), shortly after
+                s.acc = (uint8_t)(acc[i] - r);
+                wmbus_meter_table_update(&s_table, &s, t + 50);
+            }
+        }
+    }
+    // Transmissions after each meter's last received frame are not detectable yet
+    uint32_t exact = 0;
+    double worst_1h = 0;
+    double worst_24h = 0;
+    for (uint32_t i = 0; i < METERS; i++)
+    {
+        wmbus_meter_sample_t s;
+        meter_sample(i, &s);
+        const wmbus_meter_t *m = wmbus_meter_table_find(&s_table, s.manuf, s.id);
+        if (!m)
+        {
+            continue;
+        }
+        const uint32_t pending = (uint8_t)(acc[i] - m->acc); // Sent after the last reception
+        exact += (m->missed + pending == missed[i]) ? 1 : 0;
+        wmbus_meter_loss_t loss;
+        wmbus_meter_get_loss(m, end_ms - 1, &loss);
+        const double r1 = (double)loss.received_1h / (loss.expected_1h ? loss.expected_1h : 1);
+        const double r24 = (double)loss.received_24h / (loss.expected_24h ? loss.expected_24h : 1);
+        const double t1 = (double)got_1h[i] / (sent_1h[i] ? sent_1h[i] : 1);
+        const double t24 = (double)got_24h[i] / (sent_24h[i] ? sent_24h[i] : 1);
+        worst_1h = (r1 - t1 > worst_1h) ? r1 - t1 : (t1 - r1 > worst_1h) ? t1 - r1 : worst_1h;
+        worst_24h = (r24 - t24 > worst_24h) ? r24 - t24 : (t24 - r24 > worst_24h) ? t24 - r24 : worst_24h;
+    }
+    printf("loss: %d meters, 0-40 %% lost, 20 %% repeater copies, outages of 3 h and 251 frames, %d h: "
+           "%u/%d exact missed counts, ratio error 1 h %.1f pts, 24 h %.1f pts\n",
+           METERS, HOURS, exact, METERS, worst_1h * 100.0, worst_24h * 100.0);
+    return exact == METERS && worst_1h < 0.10 && worst_24h < 0.02;
+}
+
+static void run_cost(uint32_t population)
+{
+    const uint32_t rounds = 2000000;
+    wmbus_meter_sample_t *samples = malloc(sizeof(*samples) * 4096);
+    for (uint32_t i = 0; i < 4096; i++)
+    {
+        meter_sample(rng() % population, &samples[i]);
+    }
+
+    wmbus_meter_table_init(&s_table);
+    uint64_t t0 = now_ns();
+    for (uint32_t n = 0; n < rounds; n++)
+    {
+        wmbus_meter_table_update(&s_table, &samples[n & 4095], n);
+    }
+    const double hash_ns = (double)(now_ns() - t0) / rounds;
+
+    s_ref_count = 0;
+    t0 = now_ns();
+    for (uint32_t n = 0; n < rounds; n++)
+    {
+        ref_update(&samples[n & 4095], n + 1);
+    }
+    const double scan_ns = (double)(now_ns() - t0) / rounds;
+    free(samples);
+    printf("cost: %u meters, %d rows (%zu bytes): hash index %.1f ns/frame, linear scan %.1f ns/frame\n", population,
+           APP_METERS, sizeof(s_table), hash_ns, scan_ns);
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t population = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 3 * APP_METERS;
+    const uint32_t frames = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10) : 200000;
+    if (population == 0 || population > 65535 || frames == 0)
+    {
+        fprintf(stderr, "population 1..65535 and frames > 0\n");
+        return 1;
+    }
+    bool ok = run_churn(APP_METERS / 2, frames / 4);
+    ok = run_churn(population, frames) && ok;
+    ok = run_interval() && ok;
+    ok = run_loss() && ok;
+    run_cost(population);
+    return ok ? 0 : 1;
+}
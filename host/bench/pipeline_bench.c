@@ -0,0 +1,182 @@
+// Host replay of the complete RX state machine (wmbus_pipeline_receive) against
+// the simulated CC1101: corpus frames are put on air back to back, every frame
+// handed out is checked against its source, and the radio/pipeline counters
+// are reported together with the host CPU time per frame.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/pipeline_bench [corpus.hex] [rounds] [gap_us] [corrupt_every] [deny_every]
+//
+// gap_us is the silence between frames on air; corrupt_every=N flips one bit in
+// every Nth frame so the mid-frame abort path is exercised (0 disables).
+// deny_every=N puts the address of every Nth corpus frame on a deny list, so the
+// header filter drops those frames after block 0 (0 disables).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench_corpus.h"
+#include "sim/cc1101_sim.h"
+#include "radio/cc1101_hal.h"
+#include "wmbus/pipeline.h"
+#include "app/wmbus/addr_filter.h"
+
+#define RX_TIMEOUT_MS 1500
+#define BLOCK0_ENCODED_BYTES 18 // 12 packet bytes
+
+static uint8_t s_corrupted[BENCH_MAX_FRAMES][BENCH_MAX_ENCODED];
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t s_deny_keys[BENCH_MAX_FRAMES];
+static addr_filter_t s_deny = {.mode = ADDR_FILTER_DENY, .keys = s_deny_keys};
+
+static bool is_corrupted(uint32_t seq, unsigned corrupt_every)
+{
+    return corrupt_every && (seq % corrupt_every) == corrupt_every - 1;
+}
+
+static bool bench_header_filter(const WmbusFrameHeaderRaw *hdr, void *ctx)
+{
+    return addr_filter_accept((const addr_filter_t *)ctx, hdr);
+}
+
+static bool is_denied(const bench_frame_t *f)
+{
+    const uint16_t manuf = (uint16_t)f->logical[2] | ((uint16_t)f->logical[3] << 8);
+    return addr_filter_contains(&s_deny, manuf, &f->logical[4]);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : BENCH_DEFAULT_CORPUS;
+    const unsigned rounds = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 100;
+    const uint32_t gap_us = (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 10) : 2000;
+    const unsigned corrupt_every = (argc > 4) ? (unsigned)strtoul(argv[4], NULL, 10) : 7;
+    const unsigned deny_every = (argc > 5) ? (unsigned)strtoul(argv[5], NULL, 10) : 0;
+    if (!bench_load_corpus(path))
+    {
+        fprintf(stderr, "no frames loaded from %s\n", path);
+        return 1;
+    }
+
+    for (size_t i = 0; i < bench_frame_count; i++)
+    {
+        const bench_frame_t *f = &bench_frames[i];
+        memcpy(s_corrupted[i], f->encoded, f->encoded_len);
+        s_corrupted[i][f->encoded_len / 2] ^= 0x01;
+    }
+
+    if (deny_every)
+    {
+        for (size_t i = deny_every - 1; i < bench_frame_count; i += deny_every)
+        {
+            s_deny_keys[s_deny.count++] = addr_filter_key((uint16_t)bench_frames[i].logical[2] | ((uint16_t)bench_frames[i].logical[3] << 8),
+                                                          &bench_frames[i].logical[4]);
+        }
+        s_deny.count = addr_filter_sort(s_deny_keys, s_deny.count);
+    }
+
+    cc1101_sim_reset(NULL);
+    cc1101_pin_config_t pins = cc1101_default_pins();
+    cc1101_hal_t dev;
+    if (cc1101_hal_init(&pins, &dev) != ESP_OK || wmbus_pipeline_init(&dev) != ESP_OK)
+    {
+        fprintf(stderr, "init failed\n");
+        return 1;
+    }
+    if (deny_every)
+    {
+        wmbus_rx_set_header_filter(bench_header_filter, &s_deny);
+    }
+
+    const uint32_t total = (uint32_t)(rounds * bench_frame_count);
+    uint32_t want_filtered = 0; // Denied frames whose block 0 arrives intact
+    uint64_t denied_bytes = 0;
+    for (uint32_t seq = 0; seq < total; seq++)
+    {
+        const size_t i = seq % bench_frame_count;
+        const bench_frame_t *f = &bench_frames[i];
+        const uint8_t *air = is_corrupted(seq, corrupt_every) ? s_corrupted[i] : f->encoded;
+        cc1101_sim_queue_frame(air, f->encoded_len, gap_us, 0x40, seq);
+        if (is_denied(f) && !(is_corrupted(seq, corrupt_every) && f->encoded_len / 2 < BLOCK0_ENCODED_BYTES))
+        {
+            want_filtered++;
+            denied_bytes += f->encoded_len;
+        }
+    }
+
+    static uint8_t logical[WMBUS_MAX_PACKET_BYTES];
+    wmbus_rx_result_t res;
+    memset(&res, 0, sizeof(res));
+    res.rx_logical = logical;
+
+    uint32_t ok = 0;
+    uint32_t rejected = 0;
+    uint32_t errors = 0;
+    uint32_t mismatches = 0;
+    uint64_t cpu_ns = 0;
+    while (cc1101_sim_busy())
+    {
+        const uint64_t t0 = now_ns();
+        wmbus_pipeline_receive(&dev, &res, RX_TIMEOUT_MS);
+        cpu_ns += now_ns() - t0;
+        if (!res.complete)
+        {
+            continue;
+        }
+
+        const uint32_t seq = cc1101_sim_current_tag();
+        const bench_frame_t *f = &bench_frames[seq % bench_frame_count];
+        if (res.status != WMBUS_PKT_OK)
+        {
+            if (is_corrupted(seq, corrupt_every))
+            {
+                rejected++;
+            }
+            else
+            {
+                errors++;
+            }
+            continue;
+        }
+        if (is_corrupted(seq, corrupt_every) || is_denied(f) || res.logical_len != f->logical_len ||
+            memcmp(res.rx_logical, f->logical, f->logical_len) != 0)
+        {
+            fprintf(stderr, "mismatch on frame %u (L=%u)\n", seq, f->logical[0]);
+            mismatches++;
+            continue;
+        }
+        ok++;
+    }
+
+    cc1101_sim_stats_t sim;
+    wmbus_rx_stats_t rx;
+    cc1101_sim_get_stats(&sim);
+    wmbus_pipeline_get_stats(&rx);
+    const uint32_t handled = ok + rejected + errors + mismatches;
+
+    printf("frames   queued %u  ok %u  rejected %u (corrupted on air)  errors %u  mismatches %u  missed %u\n",
+           sim.frames_queued, ok, rejected, errors, mismatches, sim.frames_missed);
+    printf("radio    overflows %u  underflows %u  spi %u transactions, %llu bytes, %llu us busy\n", sim.overflows,
+           sim.underflows, sim.spi_transactions, (unsigned long long)sim.spi_bytes,
+           (unsigned long long)sim.spi_busy_us);
+    printf("pipeline rearms %u  aborted %u  dead time last/avg/max %u/%u/%u us\n", rx.rearms, rx.aborted,
+           rx.dead_time_last_us, rx.dead_time_avg_us, rx.dead_time_max_us);
+    if (deny_every)
+    {
+        printf("filter   %u addresses denied, %u/%u frames dropped after block 0, %u of %llu encoded bytes left unread\n",
+               s_deny.count, rx.filtered, want_filtered, rx.filtered_bytes, (unsigned long long)denied_bytes);
+    }
+    if (handled)
+    {
+        printf("host     %.0f ns CPU per frame\n", (double)cpu_ns / handled);
+    }
+
+    const bool filter_ok = (rx.filtered + sim.frames_missed >= want_filtered) && rx.filtered <= want_filtered;
+    return (mismatches == 0 && errors == 0 && ok > 0 && filter_ok) ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+// Host stress test of the RX -> dispatch frame ring (wmbus_frame_queue) with a
+// producer and a consumer thread, frames taken from a frame pool like on the
+// device. Each frame carries a sequence number in its logical bytes:
+//   lossless  the producer retries while the ring is full; every sequence number
+//             must arrive exactly once and in order
+//   drop      the producer discards a frame when the ring is full (like the RX
+//             task) and the consumer stalls now and then; sequence numbers must
+//             still rise, and the gaps must add up to the drops
+// In both, committed must equal the frames popped, committed + drops the frames
+// produced, and the high-water mark must stay within the capacity.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/queue_bench [frames]
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "app/wmbus/frame_pool.h"
+#include "app/wmbus/frame_queue.h"
+
+#define RING_SLOTS 8
+#define POOL_FRAMES 16
+
+typedef struct
+{
+    const char *name;
+    bool drop;
+} scenario_t;
+
+static const scenario_t SCENARIOS[] = {
+    {"lossless", false},
+    {"drop", true},
+};
+
+static wmbus_frame_t s_frames[POOL_FRAMES];
+static wmbus_frame_pool_t s_pool;
+static wmbus_frame_t *s_slots[RING_SLOTS];
+static wmbus_frame_queue_t s_queue;
+
+typedef struct
+{
+    const scenario_t *sc;
+    uint32_t frames;
+    // Consumer results
+    uint32_t popped;
+    uint32_t last;      // Sequence number of the latest pop
+    uint32_t gaps;      // Sequence numbers skipped between pops (and after the last)
+    uint32_t bad;       // Out of order, repeated, or not a pool frame with one reference
+} run_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void *producer(void *arg)
+{
+    run_t *run = arg;
+    for (uint32_t seq = 1; seq <= run->frames; seq++)
+    {
+        wmbus_frame_t *frame;
+        while ((frame = wmbus_frame_alloc(&s_pool)) == NULL)
+        {
+            sched_yield(); // Every frame is in the ring or with the consumer
+        }
+        memcpy(frame->logical, &seq, sizeof(seq));
+        while (!wmbus_frame_queue_push(&s_queue, frame))
+        {
+            if (run->sc->drop)
+            {
+                wmbus_frame_queue_note_drop(&s_queue);
+                wmbus_frame_unref(frame);
+                sched_yield(); // The RX task would wait for the next telegram here
+                break;
+            }
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    run_t *run = arg;
+    wmbus_frame_queue_stats_t st;
+    do
+    {
+        wmbus_frame_t *frame;
+        while ((frame = wmbus_frame_queue_pop(&s_queue)) != NULL)
+        {
+            uint32_t seq;
+            memcpy(&seq, frame->logical, sizeof(seq));
+            if (frame->pool != &s_pool || atomic_load(&frame->refs) != 1 || seq <= run->last)
+            {
+                run->bad++;
+            }
+            else
+            {
+                run->gaps += seq - run->last - 1;
+            }
+            run->last = seq;
+            run->popped++;
+            wmbus_frame_unref(frame);
+            if (run->sc->drop && (run->popped & 1023) == 0)
+            {
+                for (volatile int spin = 0; spin < 20000; spin++)
+                {
+                }
+            }
+        }
+        wmbus_frame_queue_get_stats(&s_queue, &st);
+        sched_yield(); // Ring empty: let the producer run (matters on a single core)
+    } while (st.committed + st.drops < run->frames || st.depth > 0);
+    return NULL;
+}
+
+static bool run_scenario(const scenario_t *sc, uint32_t frames)
+{
+    wmbus_frame_pool_init(&s_pool, s_frames, POOL_FRAMES);
+    wmbus_frame_queue_init(&s_queue, s_slots, RING_SLOTS);
+    run_t run = {.sc = sc, .frames = frames};
+
+    const uint64_t t0 = now_ns();
+    pthread_t prod, cons;
+    pthread_create(&cons, NULL, consumer, &run);
+    pthread_create(&prod, NULL, producer, &run);
+    pthread_join(prod, NULL);
+    pthread_join(cons, NULL);
+    const uint64_t elapsed = now_ns() - t0;
+    run.gaps += frames - run.last;
+
+    wmbus_frame_queue_stats_t st;
+    wmbus_frame_queue_get_stats(&s_queue, &st);
+    wmbus_frame_pool_stats_t pool;
+    wmbus_frame_pool_get_stats(&s_pool, &pool);
+    printf("%-10s %10u %10u %10u %10u %12.1f\n", sc->name, st.committed, st.drops, run.gaps, st.high_water,
+           (double)elapsed / frames);
+
+    const bool ok = run.bad == 0 && run.popped == st.committed && st.committed + st.drops == frames &&
+                    run.gaps == st.drops && (sc->drop || st.drops == 0) && st.depth == 0 && st.high_water >= 1 &&
+                    st.high_water <= RING_SLOTS && pool.in_use == 0;
+    if (!ok)
+    {
+        fprintf(stderr,
+                "%s: %u popped, %u committed, %u drops, %u gaps, %u bad, high water %u of %d, %u frames leaked\n",
+                sc->name, run.popped, st.committed, st.drops, run.gaps, run.bad, st.high_water, RING_SLOTS,
+                pool.in_use);
+    }
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t frames = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 2000000;
+    if (frames == 0)
+    {
+        fprintf(stderr, "frames must be positive\n");
+        return 1;
+    }
+
+    bool ok = true;
+    printf("%u frames, ring of %d, pool of %d\n", frames, RING_SLOTS, POOL_FRAMES);
+    printf("%-10s %10s %10s %10s %10s %12s\n", "scenario", "committed", "drops", "gaps", "high water", "ns/frame");
+    for (size_t s = 0; s < sizeof(SCENARIOS) / sizeof(SCENARIOS[0]); s++)
+    {
+        ok &= run_scenario(&SCENARIOS[s], frames);
+    }
+    return ok ? 0 : 1;
+}
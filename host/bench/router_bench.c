@@ -0,0 +1,275 @@
+// Host benchmark of wmbus_packet_router_dispatch with four sinks, counting layer
+// parses (wmbus_parsed_frame_parse_meta) per frame and exercising async sinks:
+//   header     4 header-only sinks                       -> no parse
+//   mixed      2 header-only + 2 WMBUS_SINK_FLAG_META      -> one shared parse
+//   meta       4 WMBUS_SINK_FLAG_META sinks               -> one shared parse
+//   per-sink   4 header-only sinks that each parse        -> one parse per sink (old way)
+//   async      2 header-only + 2 async (one META), block  -> every event delivered, no router parse
+//   drop       2 header-only + 2 slow async, drop newest  -> delivered + dropped = dispatched
+// Frames are dispatched from a frame pool like on the device. META sinks check that
+// evt->parsed matches a standalone parse of the frame; the pool must be empty at the end.
+// Corpus format: see bench_corpus.h.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/router_bench [corpus] [rounds]
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "bench_corpus.h"
+#include "wmbus/packet.h"
+#include "app/wmbus/frame_pool.h"
+#include "app/wmbus/packet_router.h"
+#include "app/wmbus/parsed_frame.h"
+
+#define SINKS 4
+#define POOL_FRAMES 32
+
+typedef enum
+{
+    KIND_HEADER,
+    KIND_SELF_PARSE,
+    KIND_META,
+    KIND_ASYNC,
+    KIND_ASYNC_META,
+    KIND_ASYNC_SLOW,
+} sink_kind_t;
+
+typedef struct
+{
+    const char *name;
+    sink_kind_t kinds[SINKS];
+    uint32_t want_parses; // Per frame, by the router or header-only sinks
+    bool may_drop;
+} scenario_t;
+
+static const scenario_t SCENARIOS[] = {
+    {"header", {KIND_HEADER, KIND_HEADER, KIND_HEADER, KIND_HEADER}, 0, false},
+    {"mixed", {KIND_HEADER, KIND_HEADER, KIND_META, KIND_META}, 1, false},
+    {"meta", {KIND_META, KIND_META, KIND_META, KIND_META}, 1, false},
+    {"per-sink", {KIND_SELF_PARSE, KIND_SELF_PARSE, KIND_SELF_PARSE, KIND_SELF_PARSE}, SINKS, false},
+    {"async", {KIND_HEADER, KIND_HEADER, KIND_ASYNC, KIND_ASYNC_META}, 0, false},
+    {"drop", {KIND_HEADER, KIND_HEADER, KIND_ASYNC_SLOW, KIND_ASYNC_SLOW}, 0, true},
+};
+
+static wmbus_frame_t s_frames[POOL_FRAMES];
+static wmbus_frame_pool_t s_pool;
+static WmbusFrameInfo s_infos[BENCH_MAX_FRAMES];
+static wmbus_parsed_frame_t s_expected[BENCH_MAX_FRAMES];
+static size_t s_frame_src[POOL_FRAMES]; // Corpus index held by each pooled frame
+
+static atomic_uint s_self_parses;
+static atomic_uint s_bad_events;
+static atomic_uint s_sink_checksum; // Keeps the sink bodies from being optimized out
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void header_sink(const WmbusPacketEvent *evt, void *user)
+{
+    (void)user;
+    atomic_fetch_add_explicit(&s_sink_checksum, evt->frame_info.header.manufacturer_le + evt->frame_info.header.id[0],
+                              memory_order_relaxed);
+}
+
+static void slow_sink(const WmbusPacketEvent *evt, void *user)
+{
+    header_sink(evt, user);
+    usleep(50);
+}
+
+static void self_parse_sink(const WmbusPacketEvent *evt, void *user)
+{
+    (void)user;
+    wmbus_parsed_frame_t pf;
+    const wmbus_raw_frame_t raw = {.bytes = evt->logical_packet, .len = evt->logical_len};
+    wmbus_parsed_frame_init(&pf, &raw, &evt->frame_info);
+    wmbus_parsed_frame_parse_meta(&pf);
+    atomic_fetch_add_explicit(&s_self_parses, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s_sink_checksum, pf.tpl.tpl.acc + pf.ell.ell.acc, memory_order_relaxed);
+}
+
+static void meta_sink(const WmbusPacketEvent *evt, void *user)
+{
+    (void)user;
+    const wmbus_parsed_frame_t *pf = evt->parsed;
+    const wmbus_parsed_frame_t *want = &s_expected[s_frame_src[evt->frame->index]];
+    if (!pf || pf->tpl.has_tpl != want->tpl.has_tpl || pf->tpl.tpl.acc != want->tpl.tpl.acc ||
+        pf->ell.has_ell != want->ell.has_ell || pf->afl.has_afl != want->afl.has_afl ||
+        pf->dll.manuf != want->dll.manuf || strcmp(pf->dll.gateway, "bench") != 0)
+    {
+        atomic_fetch_add_explicit(&s_bad_events, 1, memory_order_relaxed);
+        return;
+    }
+    atomic_fetch_add_explicit(&s_sink_checksum, pf->tpl.tpl.acc + pf->ell.ell.acc, memory_order_relaxed);
+}
+
+static void register_sink(sink_kind_t kind)
+{
+    wmbus_sink_opts_t opts = {.name = "bench", .queue_depth = 8, .drop = WMBUS_SINK_BLOCK, .block_ms = 1000};
+    wmbus_packet_sink_fn fn = header_sink;
+    switch (kind)
+    {
+    case KIND_HEADER:
+        break;
+    case KIND_SELF_PARSE:
+        fn = self_parse_sink;
+        break;
+    case KIND_META:
+        opts.flags = WMBUS_SINK_FLAG_META;
+        fn = meta_sink;
+        break;
+    case KIND_ASYNC:
+        opts.flags = WMBUS_SINK_FLAG_ASYNC;
+        break;
+    case KIND_ASYNC_META:
+        opts.flags = WMBUS_SINK_FLAG_ASYNC | WMBUS_SINK_FLAG_META;
+        fn = meta_sink;
+        break;
+    case KIND_ASYNC_SLOW:
+        opts.flags = WMBUS_SINK_FLAG_ASYNC;
+        opts.queue_depth = 2;
+        opts.drop = WMBUS_SINK_DROP_NEWEST;
+        fn = slow_sink;
+        break;
+    }
+    if (wmbus_packet_router_register_ex(fn, NULL, &opts) != ESP_OK)
+    {
+        fprintf(stderr, "register failed\n");
+        exit(1);
+    }
+}
+
+// Waits until every async sink has handled or dropped all dispatched events.
+static bool wait_async(uint32_t frames, wmbus_sink_stats_t *stats, size_t *n)
+{
+    for (int tries = 0; tries < 5000; tries++)
+    {
+        *n = wmbus_packet_router_get_sink_stats(stats, SINKS);
+        bool settled = true;
+        for (size_t k = 0; k < *n; k++)
+        {
+            settled &= !stats[k].async || stats[k].calls + stats[k].dropped == frames;
+        }
+        if (settled)
+        {
+            return true;
+        }
+        usleep(1000);
+    }
+    return false;
+}
+
+static bool run_scenario(const scenario_t *sc, unsigned rounds)
+{
+    wmbus_frame_pool_init(&s_pool, s_frames, POOL_FRAMES);
+    wmbus_packet_router_init();
+    for (unsigned k = 0; k < SINKS; k++)
+    {
+        register_sink(sc->kinds[k]);
+    }
+    atomic_store(&s_self_parses, 0);
+    atomic_store(&s_bad_events, 0);
+
+    const uint32_t frames = (uint32_t)(rounds * bench_frame_count);
+    uint32_t no_frame = 0;
+    const uint64_t t0 = now_ns();
+    for (unsigned r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < bench_frame_count; i++)
+        {
+            const bench_frame_t *f = &bench_frames[i];
+            wmbus_frame_t *frame = wmbus_frame_alloc(&s_pool);
+            if (!frame)
+            {
+                no_frame++;
+                continue;
+            }
+            memcpy(frame->logical, f->logical, f->logical_len);
+            s_frame_src[frame->index] = i;
+            const WmbusPacketEvent evt = {
+                .frame_info = s_infos[i],
+                .status = WMBUS_PKT_OK,
+                .rssi_dbm = -70.5f,
+                .lqi = 32,
+                .logical_packet = frame->logical,
+                .logical_len = f->logical_len,
+                .gateway_name = "bench",
+                .frame = frame,
+            };
+            wmbus_packet_router_dispatch(&evt);
+            wmbus_frame_unref(frame);
+        }
+    }
+    const uint64_t elapsed = now_ns() - t0;
+
+    wmbus_sink_stats_t stats[SINKS];
+    size_t n = 0;
+    const bool settled = wait_async(frames, stats, &n);
+    uint32_t dropped = 0;
+    for (size_t k = 0; k < n; k++)
+    {
+        dropped += stats[k].dropped;
+    }
+    wmbus_packet_router_stats_t st;
+    wmbus_packet_router_get_stats(&st);
+    const uint32_t parses = st.parsed + atomic_load(&s_self_parses);
+    wmbus_packet_router_init(); // Stops the workers and drops their references
+
+    wmbus_frame_pool_stats_t pool;
+    wmbus_frame_pool_get_stats(&s_pool, &pool);
+    printf("%-10s %12.2f %14.1f %10u %10u\n", sc->name, (double)parses / frames, (double)elapsed / frames, dropped,
+           pool.high_water);
+
+    const uint32_t bad = atomic_load(&s_bad_events);
+    if (!settled || no_frame || st.dispatched != frames || parses != sc->want_parses * frames || bad ||
+        (!sc->may_drop && dropped) || pool.in_use != 0)
+    {
+        fprintf(stderr, "%s: %u dispatched, %u parses (want %u), %u bad events, %u dropped, %u without frame, %u frames leaked%s\n",
+                sc->name, st.dispatched, parses, sc->want_parses * frames, bad, dropped, no_frame, pool.in_use,
+                settled ? "" : ", async sinks stalled");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : BENCH_DEFAULT_CORPUS;
+    const unsigned rounds = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 5000;
+    if (!bench_load_corpus(path) || rounds == 0)
+    {
+        fprintf(stderr, "no frames loaded from %s\n", path);
+        return 1;
+    }
+    for (size_t i = 0; i < bench_frame_count; i++)
+    {
+        const bench_frame_t *f = &bench_frames[i];
+        WmbusFrameInfo *info = &s_infos[i];
+        info->parsed = wmbus_parse_frame_header(f->logical, f->logical_len, &info->header, NULL, &info->payload_len);
+        info->logical_len = f->logical_len;
+        const wmbus_raw_frame_t raw = {.bytes = f->logical, .len = f->logical_len};
+        wmbus_parsed_frame_init(&s_expected[i], &raw, info);
+        wmbus_parsed_frame_parse_meta(&s_expected[i]);
+        if (!info->parsed)
+        {
+            fprintf(stderr, "header parse failed on frame %zu\n", i);
+            return 1;
+        }
+    }
+
+    bool ok = true;
+    printf("%zu frames x %u rounds, %d sinks\n", bench_frame_count, rounds, SINKS);
+    printf("%-10s %12s %14s %10s %10s\n", "scenario", "parses/frame", "dispatch ns", "dropped", "pool max");
+    for (size_t s = 0; s < sizeof(SCENARIOS) / sizeof(SCENARIOS[0]); s++)
+    {
+        ok &= run_scenario(&SCENARIOS[s], rounds);
+    }
+    return ok ? 0 : 1;
+}
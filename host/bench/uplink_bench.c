@@ -0,0 +1,238 @@
+// Host benchmark of the backend uplink encodings: bytes on the wire and encode
+// time per frame for the JSON object (logical frame as hex) and the CBOR map
+// (logical frame as a byte string), single and in batches of `batch` frames.
+// Every CBOR batch is decoded again and checked field by field against the event.
+// Corpus format: see bench_corpus.h.
+//
+//   cmake -S host -B build-host && cmake --build build-host
+//   ./build-host/uplink_bench [corpus] [rounds] [batch]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench_corpus.h"
+#include "wmbus/packet.h"
+#include "app/net/uplink_format.h"
+#include "app/wmbus/meter_table.h"
+
+#define BATCH_MAX 64
+#define BODY_MAX  (BATCH_MAX * (UPLINK_JSON_FIXED_LEN + 2 * BENCH_MAX_LOGICAL + 2) + 4)
+
+static WmbusPacketEvent s_events[BENCH_MAX_FRAMES];
+static wmbus_meter_loss_t s_loss[BENCH_MAX_FRAMES]; // Attached to every other event (keys 12-14)
+static uint8_t s_body[BODY_MAX];
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Build a batch of `count` frames starting at corpus index `first`, the way the forwarder does.
+static size_t encode_batch(uplink_format_t format, size_t first, size_t count)
+{
+    size_t len = 0;
+    s_body[len++] = uplink_batch_open(format);
+    for (size_t k = 0; k < count; k++)
+    {
+        if (k > 0 && uplink_batch_separator(format))
+        {
+            s_body[len++] = uplink_batch_separator(format);
+        }
+        const WmbusPacketEvent *evt = &s_events[(first + k) % bench_frame_count];
+        const size_t n = uplink_format_record(format, evt, 0, s_body + len, sizeof(s_body) - len - 1);
+        if (n == 0)
+        {
+            return 0;
+        }
+        len += n;
+    }
+    s_body[len++] = uplink_batch_close(format);
+    return len;
+}
+
+// Minimal reader for the CBOR the encoder emits (definite heads up to 32 bits).
+static bool cbor_read(const uint8_t *buf, size_t len, size_t *pos, uint8_t *major, uint32_t *arg)
+{
+    if (*pos >= len)
+    {
+        return false;
+    }
+    const uint8_t ib = buf[(*pos)++];
+    const uint8_t info = ib & 0x1F;
+    *major = ib >> 5;
+    if (info < 24)
+    {
+        *arg = info;
+        return true;
+    }
+    if (info > 26)
+    {
+        return false;
+    }
+    const size_t size = (size_t)1 << (info - 24);
+    if (*pos + size > len)
+    {
+        return false;
+    }
+    *arg = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        *arg = (*arg << 8) | buf[(*pos)++];
+    }
+    return true;
+}
+
+static bool check_record(const uint8_t *buf, size_t len, size_t *pos, const WmbusPacketEvent *evt)
+{
+    uint8_t major;
+    uint32_t entries;
+    if (!cbor_read(buf, len, pos, &major, &entries) || major != 5 || entries != (evt->loss ? 14u : 11u))
+    {
+        return false;
+    }
+    const WmbusFrameHeaderRaw *h = &evt->frame_info.header;
+    const wmbus_meter_loss_t *loss = evt->loss;
+    const int64_t want[] = {
+        -1, evt->status, -705, evt->lqi, h->manufacturer_le,
+        (int64_t)((uint32_t)h->id[0] | ((uint32_t)h->id[1] << 8) | ((uint32_t)h->id[2] << 16) | ((uint32_t)h->id[3] << 24)),
+        h->device_type, h->version, h->ci_field, evt->frame_info.payload_len, -1, -1,
+        loss ? loss->gap : -1,
+        loss ? wmbus_meter_ratio_permille(loss->received_1h, loss->expected_1h) : -1,
+        loss ? wmbus_meter_ratio_permille(loss->received_24h, loss->expected_24h) : -1,
+    };
+    for (uint32_t e = 0; e < entries; e++)
+    {
+        uint32_t key;
+        uint32_t arg;
+        const uint32_t want_key = (e < 11) ? e : e + 1; // No delay_ms (11) for live frames
+        if (!cbor_read(buf, len, pos, &major, &key) || major != 0 || key != want_key ||
+            !cbor_read(buf, len, pos, &major, &arg))
+        {
+            return false;
+        }
+        if (key == 0 || key == 10)
+        {
+            const char *want_bytes = (key == 0) ? evt->gateway_name : (const char *)evt->logical_packet;
+            const size_t want_len = (key == 0) ? strlen(evt->gateway_name) : evt->logical_len;
+            if (major != ((key == 0) ? 3 : 2) || arg != want_len || *pos + arg > len ||
+                memcmp(buf + *pos, want_bytes, arg) != 0)
+            {
+                return false;
+            }
+            *pos += arg;
+            continue;
+        }
+        const int64_t got = (major == 1) ? -1 - (int64_t)arg : (int64_t)arg;
+        if ((major != 0 && major != 1) || got != want[key])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool check_batch(size_t first, size_t count, size_t len)
+{
+    size_t pos = 1;
+    if (s_body[0] != 0x9F)
+    {
+        return false;
+    }
+    for (size_t k = 0; k < count; k++)
+    {
+        if (!check_record(s_body, len, &pos, &s_events[(first + k) % bench_frame_count]))
+        {
+            fprintf(stderr, "CBOR record %zu (frame %zu) does not decode to its event\n", k, (first + k) % bench_frame_count);
+            return false;
+        }
+    }
+    return pos + 1 == len && s_body[pos] == 0xFF;
+}
+
+static void run(uplink_format_t format, unsigned rounds, size_t batch, double *bytes_single, double *bytes_batch, double *ns)
+{
+    uint64_t single = 0;
+    uint64_t batched = 0;
+    size_t batches = 0;
+    for (size_t i = 0; i < bench_frame_count; i++)
+    {
+        single += uplink_format_record(format, &s_events[i], 0, s_body, sizeof(s_body));
+    }
+    for (size_t i = 0; i < bench_frame_count; i += batch, batches++)
+    {
+        batched += encode_batch(format, i, batch);
+    }
+
+    volatile size_t sink = 0;
+    const uint64_t t0 = now_ns();
+    for (unsigned r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < bench_frame_count; i++)
+        {
+            sink += uplink_format_record(format, &s_events[i], 0, s_body, sizeof(s_body));
+        }
+    }
+    *ns = (double)(now_ns() - t0) / ((double)rounds * bench_frame_count);
+    *bytes_single = (double)single / bench_frame_count;
+    *bytes_batch = (double)batched / ((double)batches * batch);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : BENCH_DEFAULT_CORPUS;
+    const unsigned rounds = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 20000;
+    const size_t batch = (argc > 3) ? (size_t)strtoul(argv[3], NULL, 10) : 16;
+    if (!bench_load_corpus(path) || rounds == 0 || batch == 0 || batch > BATCH_MAX)
+    {
+        fprintf(stderr, "no frames loaded from %s (or batch not 1..%d)\n", path, BATCH_MAX);
+        return 1;
+    }
+    size_t logical_bytes = 0;
+    for (size_t i = 0; i < bench_frame_count; i++)
+    {
+        const bench_frame_t *f = &bench_frames[i];
+        WmbusPacketEvent *evt = &s_events[i];
+        evt->frame_info.parsed = wmbus_parse_frame_header(f->logical, f->logical_len, &evt->frame_info.header, NULL,
+                                                          &evt->frame_info.payload_len);
+        evt->frame_info.logical_len = f->logical_len;
+        evt->status = WMBUS_PKT_OK;
+        evt->rssi_dbm = -70.5f;
+        evt->lqi = 32;
+        evt->logical_packet = f->logical;
+        evt->logical_len = f->logical_len;
+        evt->gateway_name = "oms-gateway";
+        if (i & 1)
+        {
+            s_loss[i] = (wmbus_meter_loss_t){
+                .expected_1h = 40,
+                .received_1h = (uint32_t)(30 + i % 10),
+                .expected_24h = 960,
+                .received_24h = (uint32_t)(900 + i % 60),
+                .gap = (uint16_t)(i % 3),
+            };
+            evt->loss = &s_loss[i];
+        }
+        logical_bytes += f->logical_len;
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < bench_frame_count && ok; i += batch)
+    {
+        const size_t len = encode_batch(UPLINK_FORMAT_CBOR, i, batch);
+        ok = len > 0 && check_batch(i, batch, len);
+    }
+
+    printf("%zu frames (%.1f logical bytes avg) x %u rounds, batches of %zu\n", bench_frame_count,
+           (double)logical_bytes / bench_frame_count, rounds, batch);
+    printf("%-6s %12s %14s %12s\n", "format", "bytes/frame", "batched/frame", "encode ns");
+    double json[3];
+    double cbor[3];
+    run(UPLINK_FORMAT_JSON, rounds, batch, &json[0], &json[1], &json[2]);
+    run(UPLINK_FORMAT_CBOR, rounds, batch, &cbor[0], &cbor[1], &cbor[2]);
+    printf("%-6s %12.1f %14.1f %12.1f\n", "json", json[0], json[1], json[2]);
+    printf("%-6s %12.1f %14.1f %12.1f\n", "cbor", cbor[0], cbor[1], cbor[2]);
+    printf("cbor/json: %.2f bytes, %.2f time\n", cbor[1] / json[1], cbor[2] / json[2]);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,9 @@
+// Host build stand-in for driver/spi_common.h.
+#pragma once
+
+typedef enum
+{
+    SPI1_HOST = 0,
+    SPI2_HOST = 1,
+    SPI3_HOST = 2,
+} spi_host_device_t;
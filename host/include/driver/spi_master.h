@@ -0,0 +1,6 @@
+// Host build stand-in for driver/spi_master.h (types only; the simulated HAL has no bus).
+#pragma once
+
+#include "driver/spi_common.h"
+
+typedef struct spi_device_t *spi_device_handle_t;
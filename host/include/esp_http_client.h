@@ -0,0 +1,34 @@
+// Host build stand-in for esp_http_client.h: the calls the forwarder makes,
+// over plain POSIX sockets (http:// only, HTTP/1.1 keep-alive, Content-Length
+// bodies). See host/sim/http_client_posix.c.
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef struct esp_http_client *esp_http_client_handle_t;
+
+typedef enum
+{
+    HTTP_METHOD_GET,
+    HTTP_METHOD_POST,
+    HTTP_METHOD_HEAD,
+} esp_http_client_method_t;
+
+typedef struct
+{
+    const char *url;
+    int timeout_ms;
+    esp_http_client_method_t method;
+    bool keep_alive_enable;
+} esp_http_client_config_t;
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config);
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key, const char *value);
+esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t client, const char *data, int len);
+// Connects if needed, sends the request and reads the whole response; the
+// connection is kept unless the server asked to close it.
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client);
+int esp_http_client_get_status_code(esp_http_client_handle_t client);
+esp_err_t esp_http_client_close(esp_http_client_handle_t client);
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client);
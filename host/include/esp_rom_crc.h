@@ -0,0 +1,6 @@
+// Host build stand-in for esp_rom_crc.h (same semantics as the ROM routine).
+#pragma once
+
+#include <stdint.h>
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
@@ -0,0 +1,6 @@
+// Host build stand-in for esp_timer.h: returns the simulation's virtual clock.
+#pragma once
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
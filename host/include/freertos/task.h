@@ -0,0 +1,17 @@
+// Host build stand-in for freertos/task.h: tasks are detached pthreads, priorities
+// and stack sizes are ignored (see host/sim/host_rtos.c).
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority,
+                       TaskHandle_t *out);
+void vTaskDelete(TaskHandle_t task); // Only NULL (the calling task) is supported
+void vTaskDelay(TickType_t ticks);
+
+// Direct-to-task notification used as a counting semaphore.
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks); // Only from a task made by xTaskCreate
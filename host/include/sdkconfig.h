@@ -0,0 +1,6 @@
+// Host build stand-in for the ESP-IDF generated sdkconfig.h.
+#pragma once
+
+#define CONFIG_WMBUS_CRC16_TABLE 1
+#define CONFIG_CC1101_SPI_CLOCK_HZ 6000000
+#define CONFIG_CC1101_SPI_QUEUED_MIN_BYTES 16
@@ -0,0 +1,545 @@
+#include "sim/cc1101_sim.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "radio/cc1101_hal.h"
+#include "sim/host_port.h"
+#include "sdkconfig.h"
+
+#define SIM_FIFO_SIZE 64
+#define SIM_NO_EVENT INT64_MAX
+
+#define MARC_IDLE        0x01
+#define MARC_RX          0x0D
+#define MARC_RX_OVERFLOW 0x11
+
+typedef struct
+{
+    const uint8_t *encoded;
+    size_t len;
+    int64_t sync_us;
+    uint8_t rssi_raw;
+    uint32_t tag;
+} sim_frame_t;
+
+typedef struct
+{
+    cc1101_sim_config_t cfg;
+    cc1101_sim_stats_t stats;
+    uint8_t regs[0x30];
+    uint8_t marc_state;
+    int64_t rx_ready_us; // RX state entered but sync search starts at this time
+
+    uint8_t fifo[SIM_FIFO_SIZE];
+    size_t fifo_head;
+    size_t fifo_len;
+    bool overflow;
+    uint8_t dma_buf[SIM_FIFO_SIZE];
+
+    sim_frame_t *frames;
+    size_t frame_count;
+    size_t frame_cap;
+    size_t next_frame;
+    int64_t air_end_us; // End of the last queued frame on air
+
+    bool in_packet;
+    const sim_frame_t *cur;
+    size_t pos;
+    uint32_t rx_count;
+    int64_t next_byte_us;
+    uint32_t cur_tag;
+    uint32_t noise;
+
+    bool gdo0;
+    gpio_num_t pin_gdo0;
+    gpio_num_t pin_gdo2;
+} cc1101_sim_t;
+
+static cc1101_sim_t s_sim;
+
+void cc1101_sim_default_config(cc1101_sim_config_t *cfg)
+{
+    cfg->byte_us = 80;
+    cfg->idle_to_rx_us = 800;
+    cfg->spi_clock_hz = CONFIG_CC1101_SPI_CLOCK_HZ;
+    cfg->spi_overhead_us = 5;
+    cfg->noise_rssi_raw = 0xB0;
+}
+
+// Pins
+
+static void update_gdo0(void)
+{
+    const size_t thr = 4u * ((s_sim.regs[CC1101_FIFOTHR] & 0x0F) + 1u);
+    const bool level = s_sim.fifo_len >= thr;
+    if (level != s_sim.gdo0)
+    {
+        s_sim.gdo0 = level;
+        host_port_gpio_edge(s_sim.pin_gdo0, level);
+    }
+}
+
+static void end_packet(void)
+{
+    s_sim.in_packet = false;
+    s_sim.next_byte_us = SIM_NO_EVENT;
+    host_port_gpio_edge(s_sim.pin_gdo2, false);
+}
+
+// FIFO
+
+static void fifo_clear(void)
+{
+    s_sim.fifo_head = 0;
+    s_sim.fifo_len = 0;
+    s_sim.overflow = false;
+    update_gdo0();
+}
+
+static void fifo_push(uint8_t b)
+{
+    s_sim.fifo[(s_sim.fifo_head + s_sim.fifo_len) % SIM_FIFO_SIZE] = b;
+    s_sim.fifo_len++;
+}
+
+static size_t fifo_pop(uint8_t *out, size_t len)
+{
+    size_t n = (len > s_sim.fifo_len) ? s_sim.fifo_len : len;
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = s_sim.fifo[s_sim.fifo_head];
+        s_sim.fifo_head = (s_sim.fifo_head + 1) % SIM_FIFO_SIZE;
+    }
+    s_sim.fifo_len -= n;
+    if (n < len)
+    {
+        // The real FIFO underflows and returns stale bytes
+        s_sim.stats.underflows++;
+        memset(out + n, 0, len - n);
+    }
+    update_gdo0();
+    return n;
+}
+
+// Air
+
+static bool listening(void)
+{
+    return s_sim.marc_state == MARC_RX && host_port_now_us() >= s_sim.rx_ready_us && !s_sim.in_packet;
+}
+
+static void on_sync(void)
+{
+    const sim_frame_t *f = &s_sim.frames[s_sim.next_frame++];
+    if (!listening())
+    {
+        s_sim.stats.frames_missed++;
+        return;
+    }
+    s_sim.stats.frames_synced++;
+    s_sim.in_packet = true;
+    s_sim.cur = f;
+    s_sim.cur_tag = f->tag;
+    s_sim.pos = 0;
+    s_sim.rx_count = 0;
+    s_sim.next_byte_us = f->sync_us + s_sim.cfg.byte_us;
+    host_port_gpio_edge(s_sim.pin_gdo2, true);
+}
+
+static void on_byte(void)
+{
+    uint8_t b;
+    if (s_sim.pos < s_sim.cur->len)
+    {
+        b = s_sim.cur->encoded[s_sim.pos];
+    }
+    else
+    {
+        // Past the frame the demodulator keeps producing noise
+        s_sim.noise = s_sim.noise * 1103515245u + 12345u;
+        b = (uint8_t)(s_sim.noise >> 16);
+    }
+    s_sim.pos++;
+
+    if (s_sim.fifo_len == SIM_FIFO_SIZE)
+    {
+        s_sim.overflow = true;
+        s_sim.marc_state = MARC_RX_OVERFLOW;
+        s_sim.stats.overflows++;
+        end_packet();
+        return;
+    }
+    fifo_push(b);
+    s_sim.rx_count++;
+    update_gdo0();
+
+    const bool fixed = (s_sim.regs[CC1101_PKTCTRL0] & 0x03) == 0x00;
+    if (fixed && (s_sim.rx_count & 0xFF) == s_sim.regs[CC1101_PKTLEN])
+    {
+        end_packet();
+        // MCSM1.RXOFF_MODE: 11 stays in RX, anything else is treated as IDLE
+        if (((s_sim.regs[CC1101_MCSM1] >> 2) & 0x03) != 0x03)
+        {
+            s_sim.marc_state = MARC_IDLE;
+        }
+        return;
+    }
+    s_sim.next_byte_us += s_sim.cfg.byte_us;
+}
+
+static int64_t next_event_us(void)
+{
+    int64_t t = SIM_NO_EVENT;
+    if (s_sim.in_packet)
+    {
+        t = s_sim.next_byte_us;
+    }
+    if (s_sim.next_frame < s_sim.frame_count && s_sim.frames[s_sim.next_frame].sync_us < t)
+    {
+        t = s_sim.frames[s_sim.next_frame].sync_us;
+    }
+    return t;
+}
+
+// Run one pending event if it is due by limit_us; the clock ends at its time.
+static bool step(int64_t limit_us)
+{
+    const int64_t t = next_event_us();
+    if (t == SIM_NO_EVENT || t > limit_us)
+    {
+        return false;
+    }
+    host_port_set_now_us(t);
+    if (s_sim.in_packet && t == s_sim.next_byte_us)
+    {
+        on_byte();
+    }
+    else
+    {
+        on_sync();
+    }
+    return true;
+}
+
+static void advance_to(int64_t t)
+{
+    while (step(t))
+    {
+    }
+    host_port_set_now_us(t);
+}
+
+static void wait_hook(int64_t deadline_us, void *user)
+{
+    (void)user;
+    step(deadline_us);
+}
+
+// SPI: effects happen at the start of a transaction, then the bus time passes.
+static void spi_charge(size_t bytes)
+{
+    const uint64_t bus_us = (uint64_t)bytes * 8u * 1000000u / s_sim.cfg.spi_clock_hz;
+    const uint64_t us = s_sim.cfg.spi_overhead_us + bus_us;
+    s_sim.stats.spi_transactions++;
+    s_sim.stats.spi_bytes += bytes;
+    s_sim.stats.spi_busy_us += us;
+    advance_to(host_port_now_us() + (int64_t)us);
+}
+
+static uint8_t status_byte(void)
+{
+    uint8_t state = 0;
+    if (s_sim.marc_state == MARC_RX)
+    {
+        state = 1;
+    }
+    else if (s_sim.marc_state == MARC_RX_OVERFLOW)
+    {
+        state = 6;
+    }
+    return (uint8_t)((state << 4) | (s_sim.fifo_len > 15 ? 15 : s_sim.fifo_len));
+}
+
+static uint8_t read_status_reg(uint8_t addr)
+{
+    switch (addr)
+    {
+    case CC1101_PARTNUM:
+        return 0x00;
+    case CC1101_VERSION:
+        return 0x14;
+    case CC1101_LQI:
+        return 0x20;
+    case CC1101_RSSI:
+        return s_sim.in_packet ? s_sim.cur->rssi_raw : s_sim.cfg.noise_rssi_raw;
+    case CC1101_MARCSTATE:
+        return s_sim.marc_state;
+    case CC1101_PKTSTATUS:
+        return (uint8_t)((s_sim.in_packet ? 0x04 : 0x00) | (s_sim.gdo0 ? 0x01 : 0x00));
+    case CC1101_RXBYTES:
+        return (uint8_t)((s_sim.overflow ? CC1101_RX_OVERFLOW_BM : 0) | s_sim.fifo_len);
+    default:
+        return 0x00;
+    }
+}
+
+// Public simulator API
+
+void cc1101_sim_reset(const cc1101_sim_config_t *cfg)
+{
+    free(s_sim.frames);
+    memset(&s_sim, 0, sizeof(s_sim));
+    if (cfg)
+    {
+        s_sim.cfg = *cfg;
+    }
+    else
+    {
+        cc1101_sim_default_config(&s_sim.cfg);
+    }
+    s_sim.marc_state = MARC_IDLE;
+    s_sim.next_byte_us = SIM_NO_EVENT;
+    s_sim.cur_tag = UINT32_MAX;
+    s_sim.noise = 0x2545F491u;
+    s_sim.pin_gdo0 = GPIO_NUM_NC;
+    s_sim.pin_gdo2 = GPIO_NUM_NC;
+
+    host_port_reset();
+    host_port_set_wait_hook(wait_hook, NULL);
+}
+
+esp_err_t cc1101_sim_queue_frame(const uint8_t *encoded, size_t len, uint32_t gap_us, uint8_t rssi_raw, uint32_t tag)
+{
+    if (!encoded || len == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_sim.frame_count == s_sim.frame_cap)
+    {
+        const size_t cap = s_sim.frame_cap ? s_sim.frame_cap * 2 : 64;
+        sim_frame_t *frames = realloc(s_sim.frames, cap * sizeof(*frames));
+        if (!frames)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+        s_sim.frames = frames;
+        s_sim.frame_cap = cap;
+    }
+
+    const int64_t now = host_port_now_us();
+    const int64_t start = (s_sim.air_end_us > now) ? s_sim.air_end_us : now;
+    sim_frame_t *f = &s_sim.frames[s_sim.frame_count++];
+    f->encoded = encoded;
+    f->len = len;
+    f->sync_us = start + gap_us;
+    f->rssi_raw = rssi_raw;
+    f->tag = tag;
+    s_sim.air_end_us = f->sync_us + (int64_t)len * s_sim.cfg.byte_us;
+    s_sim.stats.frames_queued++;
+    return ESP_OK;
+}
+
+bool cc1101_sim_busy(void)
+{
+    return s_sim.in_packet || s_sim.next_frame < s_sim.frame_count;
+}
+
+uint32_t cc1101_sim_current_tag(void)
+{
+    return s_sim.cur_tag;
+}
+
+void cc1101_sim_get_stats(cc1101_sim_stats_t *out)
+{
+    if (out)
+    {
+        *out = s_sim.stats;
+    }
+}
+
+// cc1101_hal_* on top of the model
+
+esp_err_t cc1101_hal_init(const cc1101_pin_config_t *pins, cc1101_hal_t *out)
+{
+    if (!pins || !out)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(out, 0, sizeof(*out));
+    out->pins = *pins;
+    out->spi = (spi_device_handle_t)&s_sim;
+    out->dma_rx = s_sim.dma_buf;
+    s_sim.pin_gdo0 = pins->gdo0;
+    s_sim.pin_gdo2 = pins->gdo2;
+    return ESP_OK;
+}
+
+void cc1101_hal_deinit(cc1101_hal_t *dev)
+{
+    if (dev)
+    {
+        dev->spi = NULL;
+        dev->dma_rx = NULL;
+    }
+}
+
+esp_err_t cc1101_hal_strobe(cc1101_hal_t *dev, uint8_t strobe, uint8_t *status_out)
+{
+    if (!dev)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    switch (strobe)
+    {
+    case CC1101_SRES:
+        memset(s_sim.regs, 0, sizeof(s_sim.regs));
+        s_sim.marc_state = MARC_IDLE;
+        if (s_sim.in_packet)
+        {
+            end_packet();
+        }
+        fifo_clear();
+        break;
+    case CC1101_SRX:
+        if (s_sim.marc_state == MARC_IDLE)
+        {
+            s_sim.marc_state = MARC_RX;
+            s_sim.rx_ready_us = host_port_now_us() + s_sim.cfg.idle_to_rx_us;
+        }
+        break;
+    case CC1101_SIDLE:
+        if (s_sim.in_packet)
+        {
+            end_packet();
+        }
+        s_sim.marc_state = MARC_IDLE;
+        break;
+    case CC1101_SFRX:
+        // Only honoured in IDLE or RX overflow, as on the chip
+        if (s_sim.marc_state == MARC_IDLE || s_sim.marc_state == MARC_RX_OVERFLOW)
+        {
+            s_sim.marc_state = MARC_IDLE;
+            fifo_clear();
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (status_out)
+    {
+        *status_out = status_byte();
+    }
+    spi_charge(1);
+    return ESP_OK;
+}
+
+esp_err_t cc1101_hal_write_reg(cc1101_hal_t *dev, uint8_t addr, uint8_t value)
+{
+    if (!dev || addr >= sizeof(s_sim.regs))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_sim.regs[addr] = value;
+    if (addr == CC1101_FIFOTHR)
+    {
+        update_gdo0();
+    }
+    spi_charge(2);
+    return ESP_OK;
+}
+
+esp_err_t cc1101_hal_read_reg(cc1101_hal_t *dev, uint8_t addr, uint8_t *value)
+{
+    if (!dev || !value)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *value = (addr < sizeof(s_sim.regs)) ? s_sim.regs[addr] : read_status_reg(addr);
+    spi_charge(2);
+    return ESP_OK;
+}
+
+esp_err_t cc1101_hal_write_fifo(cc1101_hal_t *dev, const uint8_t *data, size_t len)
+{
+    // TX is not simulated
+    (void)dev;
+    (void)data;
+    (void)len;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t cc1101_hal_read_fifo(cc1101_hal_t *dev, uint8_t *data, size_t len)
+{
+    if (!dev || !data || len == 0 || len > SIM_FIFO_SIZE)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    fifo_pop(data, len);
+    spi_charge(len + 1);
+    return ESP_OK;
+}
+
+esp_err_t cc1101_hal_drain_rx(cc1101_hal_t *dev, size_t min_len, size_t max_len, const uint8_t **data, size_t *len, uint8_t *rxbytes)
+{
+    if (!dev || !data || !len || !rxbytes || max_len > SIM_FIFO_SIZE)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *data = s_sim.dma_buf;
+    *len = 0;
+
+    *rxbytes = read_status_reg(CC1101_RXBYTES);
+    size_t n = *rxbytes & CC1101_RXBYTES_NUM_MASK;
+    if (n > max_len)
+    {
+        n = max_len;
+    }
+    if (!(*rxbytes & CC1101_RX_OVERFLOW_BM) && n && n >= min_len)
+    {
+        fifo_pop(s_sim.dma_buf, n);
+        *len = n;
+        spi_charge(2 + 1 + n);
+    }
+    else
+    {
+        spi_charge(3);
+    }
+    return ESP_OK;
+}
+
+esp_err_t cc1101_hal_configure_tmode(cc1101_hal_t *dev)
+{
+    if (!dev)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < (sizeof(cc1101_tmode_reg_config) / sizeof(cc1101_tmode_reg_config[0])); i++)
+    {
+        ESP_ERROR_CHECK(cc1101_hal_write_reg(dev, cc1101_tmode_reg_config[i].addr, cc1101_tmode_reg_config[i].value));
+    }
+    return cc1101_hal_write_reg(dev, CC1101_PKTCTRL0, 0x02);
+}
+
+esp_err_t cc1101_hal_load_pa_table(cc1101_hal_t *dev, const uint8_t *table, size_t len)
+{
+    if (!dev || !table || len == 0 || len > 8)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    spi_charge(len + 1);
+    return ESP_OK;
+}
+
+esp_err_t cc1101_hal_set_cs_threshold(cc1101_hal_t *dev, cc1101_cs_level_t level)
+{
+    static const uint8_t agcctrl0[] = {0xB5, 0xB7, 0xBF, 0xB1};
+    return cc1101_hal_write_reg(dev, CC1101_AGCCTRL0, agcctrl0[level <= CC1101_CS_LEVEL_LOW ? level : 0]);
+}
+
+esp_err_t cc1101_hal_set_sync_mode(cc1101_hal_t *dev, cc1101_sync_mode_t mode)
+{
+    static const uint8_t mdmcfg2[] = {0x05, 0x06, 0x07};
+    return cc1101_hal_write_reg(dev, CC1101_MDMCFG2, mdmcfg2[mode <= CC1101_SYNC_MODE_STRICT ? mode : 0]);
+}
@@ -0,0 +1,55 @@
+// Software CC1101 behind the cc1101_hal_* API for host builds.
+//
+// Models what the RX pipeline relies on: register file, IDLE/RX states with
+// MCSM1.RXOFF_MODE, the 64-byte RX FIFO with overflow, FIFOTHR, fixed/infinite
+// packet length (PKTLEN counted modulo 256), GDO0 (IOCFG0=0x00, RX FIFO
+// threshold) and GDO2 (IOCFG2=0x06, sync .. packet end) edges into the GPIO
+// ISRs, and SPI transfer time. Queued encoded frames arrive one byte per
+// byte_us of virtual time once their sync word has been seen; a frame whose
+// sync word arrives while the radio is not listening is missed, as on air.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef struct
+{
+    uint32_t byte_us;         // On-air time per encoded byte (T-mode 100 kcps: 80 us)
+    uint32_t idle_to_rx_us;   // SRX from IDLE until sync search starts (incl. FS calibration)
+    uint32_t spi_clock_hz;    // SCLK used to charge SPI transfer time
+    uint32_t spi_overhead_us; // Fixed cost per SPI transaction (driver + CS setup)
+    uint8_t noise_rssi_raw;   // RSSI register value while no frame is on air
+} cc1101_sim_config_t;
+
+typedef struct
+{
+    uint32_t frames_queued;
+    uint32_t frames_synced;  // Sync word seen while listening
+    uint32_t frames_missed;  // Sync word arrived while idle, calibrating or still in a packet
+    uint32_t overflows;      // RX FIFO overflows
+    uint32_t underflows;     // FIFO reads past the fill level
+    uint32_t spi_transactions;
+    uint64_t spi_bytes;
+    uint64_t spi_busy_us;    // Virtual time spent on the SPI bus
+} cc1101_sim_stats_t;
+
+void cc1101_sim_default_config(cc1101_sim_config_t *cfg);
+
+// Reset radio, virtual clock and frame queue. cfg may be NULL for defaults.
+void cc1101_sim_reset(const cc1101_sim_config_t *cfg);
+
+// Queue the encoded bytes that follow a sync word. Its sync word arrives gap_us
+// after the previous queued frame ends on air (after "now" for the first one).
+// The caller keeps encoded alive until the frame has been received or missed.
+// tag is reported back through cc1101_sim_current_tag.
+esp_err_t cc1101_sim_queue_frame(const uint8_t *encoded, size_t len, uint32_t gap_us, uint8_t rssi_raw, uint32_t tag);
+
+// True while queued frames have not started yet or a packet is being received.
+bool cc1101_sim_busy(void);
+
+// Tag of the frame whose sync word was seen last (UINT32_MAX before the first).
+uint32_t cc1101_sim_current_tag(void);
+
+void cc1101_sim_get_stats(cc1101_sim_stats_t *out);
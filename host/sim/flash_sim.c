@@ -0,0 +1,170 @@
+#include "sim/flash_sim.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+#define SIM_SECTOR_SIZE 4096
+
+static esp_partition_t s_part;
+static uint8_t *s_mem;
+static uint32_t *s_sector_erases;
+static flash_sim_stats_t s_stats;
+static uint64_t s_cut_budget;
+static bool s_cut_armed;
+static bool s_cut_done;
+
+bool flash_sim_init(const char *label, size_t size)
+{
+    flash_sim_free();
+    if (!label || size == 0 || (size % SIM_SECTOR_SIZE) != 0)
+    {
+        return false;
+    }
+    s_mem = malloc(size);
+    s_sector_erases = calloc(size / SIM_SECTOR_SIZE, sizeof(*s_sector_erases));
+    if (!s_mem || !s_sector_erases)
+    {
+        flash_sim_free();
+        return false;
+    }
+    memset(s_mem, 0xFF, size);
+    s_part = (esp_partition_t){
+        .type = ESP_PARTITION_TYPE_DATA,
+        .subtype = (esp_partition_subtype_t)0x40,
+        .size = (uint32_t)size,
+        .erase_size = SIM_SECTOR_SIZE,
+    };
+    strncpy(s_part.label, label, sizeof(s_part.label) - 1);
+    s_stats = (flash_sim_stats_t){0};
+    s_cut_armed = false;
+    s_cut_done = false;
+    return true;
+}
+
+void flash_sim_free(void)
+{
+    free(s_mem);
+    free(s_sector_erases);
+    s_mem = NULL;
+    s_sector_erases = NULL;
+    s_part = (esp_partition_t){0};
+}
+
+void flash_sim_cut_after(uint64_t bytes)
+{
+    s_cut_armed = (bytes != 0);
+    s_cut_budget = bytes;
+    s_cut_done = false;
+}
+
+bool flash_sim_cut_done(void)
+{
+    return s_cut_done;
+}
+
+void flash_sim_get_stats(flash_sim_stats_t *out)
+{
+    if (!out)
+    {
+        return;
+    }
+    *out = s_stats;
+    const size_t sectors = s_part.size / SIM_SECTOR_SIZE;
+    out->min_sector_erases = sectors ? UINT32_MAX : 0;
+    for (size_t i = 0; i < sectors; i++)
+    {
+        if (s_sector_erases[i] > out->max_sector_erases)
+        {
+            out->max_sector_erases = s_sector_erases[i];
+        }
+        if (s_sector_erases[i] < out->min_sector_erases)
+        {
+            out->min_sector_erases = s_sector_erases[i];
+        }
+    }
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char *label)
+{
+    if (!s_mem || type != s_part.type || (subtype != ESP_PARTITION_SUBTYPE_ANY && subtype != s_part.subtype))
+    {
+        return NULL;
+    }
+    return (!label || strcmp(label, s_part.label) == 0) ? &s_part : NULL;
+}
+
+static bool in_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    return partition == &s_part && s_mem && offset <= s_part.size && size <= s_part.size - offset;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    if (!dst || !in_range(partition, src_offset, size))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(dst, s_mem + src_offset, size);
+    s_stats.bytes_read += size;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    if (!src || !in_range(partition, dst_offset, size))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const uint8_t *in = src;
+    for (size_t i = 0; i < size; i++)
+    {
+        if (s_cut_armed)
+        {
+            if (s_cut_budget == 0)
+            {
+                s_cut_done = true;
+                return ESP_OK; // The caller never learns; the rest is simply missing
+            }
+            s_cut_budget--;
+        }
+        s_mem[dst_offset + i] &= in[i];
+    }
+    s_stats.bytes_written += size;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    if (!in_range(partition, offset, size) || (offset % SIM_SECTOR_SIZE) != 0 || (size % SIM_SECTOR_SIZE) != 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_cut_armed && s_cut_budget == 0)
+    {
+        s_cut_done = true;
+        return ESP_OK;
+    }
+    memset(s_mem + offset, 0xFF, size);
+    for (size_t s = offset / SIM_SECTOR_SIZE; s < (offset + size) / SIM_SECTOR_SIZE; s++)
+    {
+        s_sector_erases[s]++;
+        s_stats.erases++;
+    }
+    return ESP_OK;
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= buf[i];
+        for (int b = 0; b < 8; b++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
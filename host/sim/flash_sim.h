@@ -0,0 +1,28 @@
+// RAM-backed SPI flash for the host build: one data partition behind the
+// esp_partition_* API with NOR rules (program clears bits, erase is per 4 KiB
+// sector and sets 0xFF), per-sector erase counters and power-cut injection.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    uint32_t erases;
+    uint32_t max_sector_erases;
+    uint32_t min_sector_erases;
+} flash_sim_stats_t;
+
+// Create (or re-create, erased) the partition `label` of `size` bytes.
+bool flash_sim_init(const char *label, size_t size);
+void flash_sim_free(void);
+
+// After `bytes` more programmed bytes, drop every later write and erase, as if
+// power was cut mid-operation. 0 disables. Returns true once the cut happened.
+void flash_sim_cut_after(uint64_t bytes);
+bool flash_sim_cut_done(void);
+
+void flash_sim_get_stats(flash_sim_stats_t *out);
@@ -0,0 +1,262 @@
+#include "sim/host_port.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/event_groups.h"
+
+esp_log_level_t host_log_level = ESP_LOG_WARN;
+
+struct host_event_group
+{
+    EventBits_t bits;
+};
+
+typedef struct
+{
+    gpio_isr_t handler;
+    void *arg;
+    gpio_int_type_t type;
+    bool enabled;
+} host_gpio_t;
+
+static int64_t s_now_us;
+static host_port_wait_hook_t s_wait_hook;
+static void *s_wait_user;
+static host_gpio_t s_gpio[GPIO_NUM_MAX];
+
+void host_port_reset(void)
+{
+    s_now_us = 0;
+    s_wait_hook = NULL;
+    s_wait_user = NULL;
+    for (int i = 0; i < GPIO_NUM_MAX; i++)
+    {
+        s_gpio[i] = (host_gpio_t){0};
+    }
+}
+
+void host_port_set_wait_hook(host_port_wait_hook_t hook, void *user)
+{
+    s_wait_hook = hook;
+    s_wait_user = user;
+}
+
+int64_t host_port_now_us(void)
+{
+    return s_now_us;
+}
+
+void host_port_set_now_us(int64_t now_us)
+{
+    if (now_us > s_now_us)
+    {
+        s_now_us = now_us;
+    }
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return s_now_us;
+}
+
+void host_log_write(esp_log_level_t level, const char *tag, const char *fmt, ...)
+{
+    if (level > host_log_level)
+    {
+        return;
+    }
+    static const char letters[] = "NEWIDV";
+    fprintf(stderr, "%c (%lld) %s: ", letters[level], (long long)(s_now_us / 1000), tag);
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code)
+    {
+    case ESP_OK:
+        return "ESP_OK";
+    case ESP_FAIL:
+        return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+        return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+        return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:
+        return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:
+        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:
+        return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:
+        return "ESP_ERR_TIMEOUT";
+    default:
+        return "UNKNOWN ERROR";
+    }
+}
+
+// GPIO: ISR bookkeeping only; levels live in the simulator.
+
+static host_gpio_t *gpio_slot(gpio_num_t pin)
+{
+    return (pin >= 0 && pin < GPIO_NUM_MAX) ? &s_gpio[pin] : NULL;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags)
+{
+    (void)intr_alloc_flags;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    host_gpio_t *g = gpio_slot(gpio_num);
+    if (!g)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g->type = intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+{
+    host_gpio_t *g = gpio_slot(gpio_num);
+    if (!g)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g->handler = isr_handler;
+    g->arg = args;
+    g->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num)
+{
+    host_gpio_t *g = gpio_slot(gpio_num);
+    if (!g)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g->handler = NULL;
+    g->arg = NULL;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num)
+{
+    host_gpio_t *g = gpio_slot(gpio_num);
+    if (!g)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num)
+{
+    host_gpio_t *g = gpio_slot(gpio_num);
+    if (!g)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g->enabled = false;
+    return ESP_OK;
+}
+
+void host_port_gpio_edge(gpio_num_t pin, bool rising)
+{
+    host_gpio_t *g = gpio_slot(pin);
+    if (!g || !g->handler || !g->enabled)
+    {
+        return;
+    }
+    const bool match = (g->type == GPIO_INTR_ANYEDGE) || (rising && g->type == GPIO_INTR_POSEDGE) ||
+                       (!rising && g->type == GPIO_INTR_NEGEDGE);
+    if (match)
+    {
+        g->handler(g->arg);
+    }
+}
+
+// Event groups: a bit mask; waiting runs the simulator instead of blocking.
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    return calloc(1, sizeof(struct host_event_group));
+}
+
+void vEventGroupDelete(EventGroupHandle_t group)
+{
+    free(group);
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    group->bits |= bits;
+    return group->bits;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t group, EventBits_t bits, BaseType_t *higher_prio_woken)
+{
+    group->bits |= bits;
+    if (higher_prio_woken)
+    {
+        *higher_prio_woken = pdFALSE;
+    }
+    return pdPASS;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    const EventBits_t prev = group->bits;
+    group->bits &= ~bits;
+    return prev;
+}
+
+static bool wait_satisfied(EventBits_t have, EventBits_t want, BaseType_t wait_for_all)
+{
+    return wait_for_all ? ((have & want) == want) : ((have & want) != 0);
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks)
+{
+    const int64_t deadline_us = (ticks == portMAX_DELAY) ? INT64_MAX : s_now_us + (int64_t)ticks * 1000;
+    while (!wait_satisfied(group->bits, bits, wait_for_all) && s_now_us < deadline_us)
+    {
+        const int64_t before = s_now_us;
+        if (s_wait_hook)
+        {
+            s_wait_hook(deadline_us, s_wait_user);
+        }
+        if (s_now_us == before)
+        {
+            // Nothing scheduled: the wait simply times out
+            if (deadline_us == INT64_MAX)
+            {
+                fprintf(stderr, "xEventGroupWaitBits: infinite wait with nothing scheduled\n");
+                abort();
+            }
+            s_now_us = deadline_us;
+        }
+    }
+
+    const EventBits_t result = group->bits;
+    if (clear_on_exit && wait_satisfied(result, bits, wait_for_all))
+    {
+        group->bits &= ~bits;
+    }
+    return result;
+}
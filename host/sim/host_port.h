@@ -0,0 +1,21 @@
+// Host port of the few ESP-IDF/FreeRTOS services the RX pipeline uses.
+// Time is virtual: it only advances when the simulator says so, which makes
+// replays deterministic and independent of the host's speed.
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+
+// Called by xEventGroupWaitBits while the awaited bits are not set: advance the
+// virtual clock to the next simulated event, but not past deadline_us.
+typedef void (*host_port_wait_hook_t)(int64_t deadline_us, void *user);
+
+void host_port_reset(void);
+void host_port_set_wait_hook(host_port_wait_hook_t hook, void *user);
+
+int64_t host_port_now_us(void);
+void host_port_set_now_us(int64_t now_us);
+
+// Deliver a GPIO edge to the registered ISR handler (if enabled and matching the trigger).
+void host_port_gpio_edge(gpio_num_t pin, bool rising);
@@ -0,0 +1,318 @@
+// FreeRTOS semaphores, queues and tasks for host tools on top of pthreads.
+// Unlike the event groups in host_port.c these block in real time; they back
+// code that runs worker tasks (e.g. asynchronous router sinks), not the
+// virtual-time RX simulation.
+#include <errno.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+struct host_sem
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    unsigned count;
+};
+
+struct host_queue
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond; // Signalled on every push and pop
+    uint8_t *items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+// Kept for the life of the process: the handle stays valid for notifications.
+struct host_task
+{
+    TaskFunction_t fn;
+    void *arg;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notified;
+};
+
+static __thread struct host_task *s_self;
+
+static void deadline_after(TickType_t ticks, struct timespec *ts)
+{
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += ticks / 1000;
+    ts->tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L)
+    {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+// Waits on cond (lock held) until ready() or the timeout; false on timeout.
+static bool wait_until(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks, bool (*ready)(void *), void *ctx)
+{
+    struct timespec deadline;
+    if (ticks != portMAX_DELAY)
+    {
+        deadline_after(ticks, &deadline);
+    }
+    while (!ready(ctx))
+    {
+        if (ticks == 0)
+        {
+            return false;
+        }
+        if (ticks == portMAX_DELAY)
+        {
+            pthread_cond_wait(cond, lock);
+        }
+        else if (pthread_cond_timedwait(cond, lock, &deadline) == ETIMEDOUT)
+        {
+            return ready(ctx);
+        }
+    }
+    return true;
+}
+
+static SemaphoreHandle_t sem_create(unsigned count)
+{
+    SemaphoreHandle_t sem = calloc(1, sizeof(*sem));
+    if (sem)
+    {
+        pthread_mutex_init(&sem->lock, NULL);
+        pthread_cond_init(&sem->cond, NULL);
+        sem->count = count;
+    }
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return sem_create(1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return sem_create(0);
+}
+
+static bool sem_ready(void *ctx)
+{
+    return ((SemaphoreHandle_t)ctx)->count > 0;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    pthread_mutex_lock(&sem->lock);
+    const bool ok = wait_until(&sem->cond, &sem->lock, ticks, sem_ready, sem);
+    if (ok)
+    {
+        sem->count--;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    pthread_mutex_lock(&sem->lock);
+    const bool ok = sem->count == 0;
+    if (ok)
+    {
+        sem->count = 1;
+        pthread_cond_signal(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    if (sem)
+    {
+        pthread_cond_destroy(&sem->cond);
+        pthread_mutex_destroy(&sem->lock);
+        free(sem);
+    }
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    QueueHandle_t q = calloc(1, sizeof(*q));
+    if (!q)
+    {
+        return NULL;
+    }
+    q->items = malloc((size_t)length * item_size);
+    if (!q->items)
+    {
+        free(q);
+        return NULL;
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->cond, NULL);
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    if (q)
+    {
+        pthread_cond_destroy(&q->cond);
+        pthread_mutex_destroy(&q->lock);
+        free(q->items);
+        free(q);
+    }
+}
+
+static bool queue_has_room(void *ctx)
+{
+    const QueueHandle_t q = ctx;
+    return q->count < q->length;
+}
+
+static bool queue_has_item(void *ctx)
+{
+    return ((QueueHandle_t)ctx)->count > 0;
+}
+
+static BaseType_t queue_send(QueueHandle_t q, const void *item, TickType_t ticks, bool front)
+{
+    pthread_mutex_lock(&q->lock);
+    const bool ok = wait_until(&q->cond, &q->lock, ticks, queue_has_room, q);
+    if (ok)
+    {
+        UBaseType_t slot;
+        if (front)
+        {
+            q->head = (q->head + q->length - 1) % q->length;
+            slot = q->head;
+        }
+        else
+        {
+            slot = (q->head + q->count) % q->length;
+        }
+        memcpy(q->items + (size_t)slot * q->item_size, item, q->item_size);
+        q->count++;
+        pthread_cond_broadcast(&q->cond);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    return queue_send(q, item, ticks, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    return queue_send(q, item, ticks, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks)
+{
+    pthread_mutex_lock(&q->lock);
+    const bool ok = wait_until(&q->cond, &q->lock, ticks, queue_has_item, q);
+    if (ok)
+    {
+        memcpy(item, q->items + (size_t)q->head * q->item_size, q->item_size);
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+        pthread_cond_broadcast(&q->cond);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->lock);
+    const UBaseType_t count = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return count;
+}
+
+static void *task_main(void *ctx)
+{
+    s_self = ctx;
+    s_self->fn(s_self->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority,
+                       TaskHandle_t *out)
+{
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+    struct host_task *task = calloc(1, sizeof(*task));
+    if (!task)
+    {
+        return pdFALSE;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, task_main, task) != 0)
+    {
+        free(task);
+        return pdFALSE;
+    }
+    pthread_detach(thread);
+    if (out)
+    {
+        *out = task;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    (void)task;
+    pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    usleep((useconds_t)ticks * 1000u);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notified++;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+static bool task_notified(void *ctx)
+{
+    return ((struct host_task *)ctx)->notified > 0;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct host_task *task = s_self;
+    pthread_mutex_lock(&task->lock);
+    wait_until(&task->cond, &task->lock, ticks, task_notified, task);
+    const uint32_t value = task->notified;
+    if (value > 0)
+    {
+        task->notified = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
@@ -0,0 +1,294 @@
+// esp_http_client for the host build over POSIX sockets. Enough of HTTP/1.1 for
+// the forwarder against a local server: one connection kept open across
+// requests, Content-Length bodies, "Connection: close" honoured.
+#include "esp_http_client.h"
+
+#include <errno.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define MAX_HEADERS 4
+
+struct esp_http_client
+{
+    char host[64];
+    char port[8];
+    char path[128];
+    int timeout_ms;
+    esp_http_client_method_t method;
+    bool keep_alive;
+    int fd; // -1 while not connected
+    int status;
+    const char *body;
+    int body_len;
+    char header_key[MAX_HEADERS][32];
+    char header_value[MAX_HEADERS][64];
+};
+
+static bool parse_url(esp_http_client_handle_t c, const char *url)
+{
+    const char *p = (strncmp(url, "http://", 7) == 0) ? url + 7 : NULL;
+    if (!p)
+    {
+        return false;
+    }
+    const size_t host_len = strcspn(p, ":/");
+    if (host_len == 0 || host_len >= sizeof(c->host))
+    {
+        return false;
+    }
+    memcpy(c->host, p, host_len);
+    c->host[host_len] = '\0';
+    p += host_len;
+    strcpy(c->port, "80");
+    if (*p == ':')
+    {
+        const size_t port_len = strcspn(++p, "/");
+        if (port_len == 0 || port_len >= sizeof(c->port))
+        {
+            return false;
+        }
+        memcpy(c->port, p, port_len);
+        c->port[port_len] = '\0';
+        p += port_len;
+    }
+    snprintf(c->path, sizeof(c->path), "%s", *p ? p : "/");
+    return true;
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config)
+{
+    if (!config || !config->url)
+    {
+        return NULL;
+    }
+    esp_http_client_handle_t c = calloc(1, sizeof(*c));
+    if (!c)
+    {
+        return NULL;
+    }
+    if (!parse_url(c, config->url))
+    {
+        free(c);
+        return NULL;
+    }
+    c->timeout_ms = config->timeout_ms ? config->timeout_ms : 5000;
+    c->method = config->method;
+    c->keep_alive = config->keep_alive_enable;
+    c->fd = -1;
+    return c;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t c, const char *key, const char *value)
+{
+    if (!c || !key || !value)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < MAX_HEADERS; i++)
+    {
+        if (c->header_key[i][0] == '\0' || strcasecmp(c->header_key[i], key) == 0)
+        {
+            snprintf(c->header_key[i], sizeof(c->header_key[i]), "%s", key);
+            snprintf(c->header_value[i], sizeof(c->header_value[i]), "%s", value);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t c, const char *data, int len)
+{
+    if (!c)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    c->body = data;
+    c->body_len = data ? len : 0;
+    return ESP_OK;
+}
+
+static bool connect_server(esp_http_client_handle_t c)
+{
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM};
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(c->host, c->port, &hints, &res) != 0)
+    {
+        return false;
+    }
+    for (struct addrinfo *ai = res; ai && c->fd < 0; ai = ai->ai_next)
+    {
+        const int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)
+        {
+            continue;
+        }
+        const struct timeval tv = {.tv_sec = c->timeout_ms / 1000, .tv_usec = (c->timeout_ms % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+        {
+            c->fd = fd;
+        }
+        else
+        {
+            close(fd);
+        }
+    }
+    freeaddrinfo(res);
+    return c->fd >= 0;
+}
+
+static bool send_all(int fd, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        const ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+// Status line and headers; the body (Content-Length bytes) is read and discarded.
+static bool read_response(esp_http_client_handle_t c, bool *server_close)
+{
+    char buf[2048];
+    size_t have = 0;
+    char *end = NULL;
+    while (!end)
+    {
+        if (have == sizeof(buf) - 1)
+        {
+            return false;
+        }
+        const ssize_t n = recv(c->fd, buf + have, sizeof(buf) - 1 - have, 0);
+        if (n <= 0)
+        {
+            return false; // Closed (e.g. a stale keep-alive connection) or timed out
+        }
+        have += (size_t)n;
+        buf[have] = '\0';
+        end = strstr(buf, "\r\n\r\n");
+    }
+    *end = '\0';
+    const size_t head_len = (size_t)(end - buf) + 4;
+
+    int major = 0, minor = 0;
+    if (sscanf(buf, "HTTP/%d.%d %d", &major, &minor, &c->status) != 3)
+    {
+        return false;
+    }
+    long content_len = 0;
+    *server_close = (major == 1 && minor == 0);
+    for (char *line = strstr(buf, "\r\n"); line; line = strstr(line, "\r\n"))
+    {
+        line += 2;
+        if (strncasecmp(line, "Content-Length:", 15) == 0)
+        {
+            content_len = strtol(line + 15, NULL, 10);
+        }
+        else if (strncasecmp(line, "Connection:", 11) == 0)
+        {
+            const char *v = line + 11 + strspn(line + 11, " ");
+            *server_close = strncasecmp(v, "close", 5) == 0;
+        }
+    }
+    long left = content_len - (long)(have - head_len);
+    while (left > 0)
+    {
+        const ssize_t n = recv(c->fd, buf, (size_t)left < sizeof(buf) ? (size_t)left : sizeof(buf), 0);
+        if (n <= 0)
+        {
+            return false;
+        }
+        left -= n;
+    }
+    return true;
+}
+
+esp_err_t esp_http_client_perform(esp_http_client_handle_t c)
+{
+    if (!c)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    c->status = 0;
+    if (c->fd < 0 && !connect_server(c))
+    {
+        return ESP_FAIL;
+    }
+
+    static const char *const METHODS[] = {"GET", "POST", "HEAD"};
+    char head[512];
+    int n = snprintf(head, sizeof(head), "%s %s HTTP/1.1\r\nHost: %s:%s\r\nContent-Length: %d\r\n%s",
+                     METHODS[c->method], c->path, c->host, c->port, c->body_len,
+                     c->keep_alive ? "" : "Connection: close\r\n");
+    for (int i = 0; i < MAX_HEADERS && c->header_key[i][0] && n < (int)sizeof(head); i++)
+    {
+        n += snprintf(head + n, sizeof(head) - (size_t)n, "%s: %s\r\n", c->header_key[i], c->header_value[i]);
+    }
+    if (n + 2 >= (int)sizeof(head))
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(head + n, "\r\n", 2);
+    n += 2;
+
+    bool server_close = false;
+    if (!send_all(c->fd, head, (size_t)n) || (c->body_len > 0 && !send_all(c->fd, c->body, (size_t)c->body_len)) ||
+        !read_response(c, &server_close))
+    {
+        esp_http_client_close(c);
+        return ESP_FAIL;
+    }
+    if (server_close || !c->keep_alive)
+    {
+        esp_http_client_close(c);
+    }
+    return ESP_OK;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t c)
+{
+    return c ? c->status : 0;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t c)
+{
+    if (!c)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (c->fd >= 0)
+    {
+        close(c->fd);
+        c->fd = -1;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t c)
+{
+    if (!c)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_http_client_close(c);
+    free(c);
+    return ESP_OK;
+}
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Local stand-in for the uplink backend.
+
+Accepts the gateway's batched POSTs (a JSON array of frame objects, or the
+CBOR array of integer-keyed maps described in main/app/net/uplink_format.h
+when sent as application/cbor) over HTTP/1.1 keep-alive, checks every batch, and prints one line per request with
+the number of requests seen on that connection, so connection reuse is visible.
+
+    python3 host/tools/backend_stub.py --port 8080 [--close-every N] [--fail-every N] [--drop-every N]
+
+Point the gateway at it with POST /api/backend?url=http://<host>:8080/ingest.
+--close-every drops the connection after every Nth request (exercises the
+forwarder's reconnect), --fail-every answers every Nth request with 503,
+--drop-every closes the connection on every Nth request without answering
+(a kept-alive connection the server gave up on). host/tools/forwarder_check.py
+runs the host build of the forwarder against this stub.
+"""
+import argparse
+import json
+import sys
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+REQUIRED = ("gateway", "status", "rssi", "manuf", "id", "ci", "payload_len", "logical_hex")
+# CBOR map keys (uplink_format.h) to the JSON field names
+CBOR_KEYS = ("gateway", "status", "rssi", "lqi", "manuf", "id", "dev_type", "version", "ci", "payload_len",
+             "logical", "delay_ms")
+
+
+class Totals:
+    requests = 0
+    frames = 0
+    connections = 0
+    rejected = 0
+    failed = 0   # Answered 503 (--fail-every)
+    dropped = 0  # Closed without an answer (--drop-every)
+
+    @classmethod
+    def reset(cls):
+        cls.requests = cls.frames = cls.connections = cls.rejected = cls.failed = cls.dropped = 0
+
+
+def cbor_decode(data, pos=0):
+    """Decode the CBOR subset the gateway sends; returns (value, next position)."""
+    ib = data[pos]
+    major, info = ib >> 5, ib & 0x1F
+    pos += 1
+    if ib == 0x9F:
+        items = []
+        while data[pos] != 0xFF:
+            item, pos = cbor_decode(data, pos)
+            items.append(item)
+        return items, pos + 1
+    if info < 24:
+        arg = info
+    elif info in (24, 25, 26, 27):
+        size = 1 << (info - 24)
+        arg = int.from_bytes(data[pos:pos + size], "big")
+        pos += size
+    else:
+        raise ValueError(f"unsupported CBOR initial byte 0x{ib:02X} at {pos - 1}")
+    if major == 0:
+        return arg, pos
+    if major == 1:
+        return -1 - arg, pos
+    if major in (2, 3):
+        raw = bytes(data[pos:pos + arg])
+        if len(raw) != arg:
+            raise ValueError("truncated CBOR string")
+        return (raw if major == 2 else raw.decode()), pos + arg
+    if major == 4:
+        items = []
+        for _ in range(arg):
+            item, pos = cbor_decode(data, pos)
+            items.append(item)
+        return items, pos
+    if major == 5:
+        out = {}
+        for _ in range(arg):
+            key, pos = cbor_decode(data, pos)
+            out[key], pos = cbor_decode(data, pos)
+        return out, pos
+    raise ValueError(f"unsupported CBOR major type {major}")
+
+
+def from_cbor(body):
+    batch, end = cbor_decode(body)
+    if end != len(body):
+        raise ValueError(f"{len(body) - end} trailing bytes after the CBOR array")
+    frames = []
+    for item in batch if isinstance(batch, list) else []:
+        frame = {CBOR_KEYS[k]: v for k, v in item.items() if isinstance(k, int) and k < len(CBOR_KEYS)}
+        if "rssi" in frame:
+            frame["rssi"] /= 10.0
+        if "id" in frame:
+            frame["id"] = f"{frame['id']:08X}"
+        if "logical" in frame:
+            frame["logical_hex"] = frame.pop("logical").hex().upper()
+        frames.append(frame)
+    return frames if isinstance(batch, list) else batch
+
+
+def check_batch(body, content_type="application/json"):
+    try:
+        batch = from_cbor(body) if content_type.startswith("application/cbor") else json.loads(body)
+    except (IndexError, UnicodeDecodeError) as exc:
+        raise ValueError(f"malformed body: {exc}") from exc
+    if not isinstance(batch, list) or not batch:
+        raise ValueError("body is not a non-empty JSON array")
+    for i, frame in enumerate(batch):
+        missing = [k for k in REQUIRED if k not in frame]
+        if missing:
+            raise ValueError(f"frame {i} lacks {', '.join(missing)}")
+        raw = bytes.fromhex(frame["logical_hex"])
+        if not raw or raw[0] + 1 != len(raw):
+            raise ValueError(f"frame {i}: L-field does not match logical_hex length")
+    return batch
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # keep-alive unless the client closes
+
+    def setup(self):
+        super().setup()
+        Totals.connections += 1
+        self.conn_id = Totals.connections
+        self.conn_requests = 0
+
+    def reply(self, code, text):
+        data = text.encode()
+        self.send_response(code)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(data)))
+        close = self.server.close_every and self.conn_requests % self.server.close_every == 0
+        if close:
+            self.send_header("Connection", "close")
+            self.close_connection = True
+        self.end_headers()
+        self.wfile.write(data)
+
+    def do_HEAD(self):
+        self.send_response(200)
+        self.send_header("Content-Length", "0")
+        self.end_headers()
+
+    def do_POST(self):
+        body = self.rfile.read(int(self.headers.get("Content-Length", 0)))
+        self.conn_requests += 1
+        Totals.requests += 1
+        if self.server.fail_every and Totals.requests % self.server.fail_every == 0:
+            Totals.failed += 1
+            print(f"conn {self.conn_id} req {self.conn_requests}: answering 503 (--fail-every)")
+            self.reply(503, '{"ok":false}')
+            return
+        if self.server.drop_every and Totals.requests % self.server.drop_every == 0:
+            Totals.dropped += 1
+            print(f"conn {self.conn_id} req {self.conn_requests}: closing without an answer (--drop-every)")
+            self.close_connection = True
+            return
+        try:
+            batch = check_batch(body, self.headers.get("Content-Type", "application/json"))
+        except ValueError as exc:
+            Totals.rejected += 1
+            print(f"conn {self.conn_id} req {self.conn_requests}: REJECTED {exc}", file=sys.stderr)
+            self.reply(400, json.dumps({"error": str(exc)}))
+            return
+        Totals.frames += len(batch)
+        kind = "cbor" if self.headers.get("Content-Type", "").startswith("application/cbor") else "json"
+        print(f"conn {self.conn_id} req {self.conn_requests}: {len(batch)} frames, {len(body)} bytes {kind} "
+              f"(total {Totals.frames} frames in {Totals.requests} requests over {Totals.connections} connections)")
+        self.reply(200, '{"ok":true}')
+
+    def log_message(self, fmt, *args):
+        pass
+
+
+def make_server(host, port, close_every=0, fail_every=0, drop_every=0):
+    server = ThreadingHTTPServer((host, port), Handler)
+    server.close_every = close_every
+    server.fail_every = fail_every
+    server.drop_every = drop_every
+    return server
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--host", default="0.0.0.0")
+    ap.add_argument("--port", type=int, default=8080)
+    ap.add_argument("--close-every", type=int, default=0)
+    ap.add_argument("--fail-every", type=int, default=0)
+    ap.add_argument("--drop-every", type=int, default=0)
+    args = ap.parse_args()
+
+    server = make_server(args.host, args.port, args.close_every, args.fail_every, args.drop_every)
+    print(f"backend stub on {args.host}:{args.port}")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
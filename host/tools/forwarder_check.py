@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""Run the host build of the forwarder against the backend stub.
+
+Starts backend_stub.py in-process on a free local port once per scenario, runs
+build-host/forwarder_check against it, and compares what the stub received
+with what the forwarder reports:
+
+    keep-alive      JSON and CBOR: every batch over a single connection
+    close-every 2   server closes after every 2nd request: one connection per 2
+    fail-every 4    every 4th request answered 503: the batch is retried once
+                    on a fresh connection and delivered
+    drop-every 4    every 4th request closed without an answer (stale
+                    keep-alive connection): same retry
+
+Every frame must reach the stub exactly once, no batch may be rejected, and
+the request and connection counts must match the scenario.
+
+    cmake -S host -B build-host && cmake --build build-host
+    python3 host/tools/forwarder_check.py [build-host/forwarder_check] [-v]
+"""
+import argparse
+import contextlib
+import io
+import math
+import os
+import re
+import subprocess
+import sys
+import threading
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from backend_stub import Totals, make_server  # noqa: E402
+
+# name, format, close_every, fail_every, drop_every, expected connections(requests)
+SCENARIOS = (
+    ("keep-alive", "json", 0, 0, 0, lambda t: 1),
+    ("keep-alive", "cbor", 0, 0, 0, lambda t: 1),
+    ("close-every 2", "json", 2, 0, 0, lambda t: math.ceil(t.requests / 2)),
+    ("fail-every 4", "json", 0, 4, 0, lambda t: 1 + t.failed),
+    ("drop-every 4", "cbor", 0, 0, 4, lambda t: 1 + t.dropped),
+)
+
+
+def run(binary, scenario, verbose):
+    name, fmt, close_every, fail_every, drop_every, want_conns = scenario
+    Totals.reset()
+    server = make_server("127.0.0.1", 0, close_every, fail_every, drop_every)
+    url = f"http://127.0.0.1:{server.server_address[1]}/ingest"
+    log = io.StringIO()
+    with contextlib.redirect_stdout(log), contextlib.redirect_stderr(log):
+        thread = threading.Thread(target=server.serve_forever, daemon=True)
+        thread.start()
+        try:
+            proc = subprocess.run([binary, url, fmt], capture_output=True, text=True, timeout=120)
+        finally:
+            server.shutdown()
+            server.server_close()
+    if verbose:
+        sys.stdout.write(log.getvalue() + proc.stdout + proc.stderr)
+
+    m = re.search(r"total\s+frames=(\d+) batches=(\d+) failed=(\d+) dropped=(\d+)", proc.stdout)
+    problems = []
+    if proc.returncode != 0 or not m:
+        problems.append(f"forwarder_check exited with {proc.returncode}")
+    else:
+        frames, batches = int(m.group(1)), int(m.group(2))
+        if Totals.frames != frames:
+            problems.append(f"stub got {Totals.frames} frames, forwarder sent {frames}")
+        if Totals.requests != batches + Totals.failed + Totals.dropped:
+            problems.append(f"{Totals.requests} requests for {batches} batches, "
+                            f"{Totals.failed} answered 503, {Totals.dropped} dropped")
+        if Totals.connections != want_conns(Totals):
+            problems.append(f"{Totals.connections} connections, expected {want_conns(Totals)}")
+    if Totals.rejected:
+        problems.append(f"{Totals.rejected} batches rejected by the stub")
+
+    print(f"{name:<14} {fmt:<5} {Totals.frames:>7} {Totals.requests:>9} {Totals.connections:>12} "
+          f"{Totals.failed + Totals.dropped:>8}  {'ok' if not problems else 'FAIL'}")
+    for p in problems:
+        print(f"    {p}")
+    if problems and not verbose:
+        sys.stdout.write(proc.stdout + proc.stderr)
+    return not problems
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("binary", nargs="?", default="build-host/forwarder_check")
+    ap.add_argument("-v", "--verbose", action="store_true", help="show the stub and forwarder output")
+    args = ap.parse_args()
+
+    print(f"{'scenario':<14} {'body':<5} {'frames':>7} {'requests':>9} {'connections':>12} {'retries':>8}")
+    ok = True
+    for scenario in SCENARIOS:
+        ok &= run(args.binary, scenario, args.verbose)
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -8,8 +8,42 @@
 #define APP_HOSTNAME_MAX 32
 #define APP_LOG_RX_MODULE "app"
 #define APP_RX_TIMEOUT_MS 1500
-#define APP_RX_INCOMPLETE_DELAY_MS 20
-#define APP_RX_LOOP_DELAY_MS 10
+#define APP_RX_QUEUE_DEPTH 8 // Frame slots between RX and dispatch task (power of two)
+#define APP_FRAME_POOL_SIZE 28 // Refcounted frame buffers: RX + queue + frames kept by sinks (max 32)
+#define APP_UI_PACKETS 40      // Default /api/packets page (newest frames)
+#define APP_UI_PACKETS_MAX 256 // Largest ?limit= accepted by /api/packets (within what the history ring holds)
+#define APP_UI_HISTORY_BYTES 32768 // Packet history ring (~286 bench frames): 16 B header + logical frame per entry (power of two, max 64 KB)
+#define APP_JSON_CHUNK 512     // Stack buffer of the streamed JSON responses (one httpd chunk)
+#define APP_SSE_CLIENTS 3      // Concurrent /api/packets/stream clients (others get 503 and poll)
+#define APP_SSE_BACKLOG 8      // Frames a stream client may lag behind before it is evicted
+#define APP_RX_TASK_PRIORITY 10
+#define APP_RX_TASK_STACK 4096
+#define APP_DISPATCH_TASK_PRIORITY 5
+#define APP_DISPATCH_TASK_STACK 6144
+#define APP_DISPATCH_IDLE_MS 500
+#define APP_LOG_SINK_DEPTH 2    // Frames queued for the asynchronous log sink (oldest dropped)
+#define APP_LOG_SINK_PRIORITY 2 // Below the dispatch task: UART logging never delays the sinks
+#define APP_SINKS_MAX 8         // Router sinks reported in /api/status
+#define APP_DEDUP_SLOTS 64       // Telegrams remembered for duplicate suppression (power of two)
+#define APP_DEDUP_METERS 16      // Meters with per-meter duplicate counters
+#define APP_DEDUP_WINDOW_S 10    // Default window; a copy within it is a duplicate (0 = off)
+#define APP_METERS 128           // Meters with reception statistics (least recently heard replaced)
+#define APP_METER_SLOTS 256      // Hash index of the meter table (power of two, >= 2 * APP_METERS)
+#define APP_UI_METERS 32         // Default /api/meters page
+#define APP_ADDR_FILTER_MAX 2048  // Meters in the address allow/deny list (6 bytes each in NVS)
+#define APP_FORWARD_TASK_PRIORITY 4
+#define APP_FORWARD_TASK_STACK 6144
+#define APP_FORWARD_HTTP_TIMEOUT_MS 3000
+#define APP_FORWARD_BATCH_FRAMES 16      // Default flush thresholds (whichever is hit first)
+#define APP_FORWARD_BATCH_MS 2000
+#define APP_FORWARD_BATCH_BYTES 4096
+#define APP_FORWARD_BATCH_FRAMES_MAX 64
+#define APP_FORWARD_BATCH_MS_MAX 60000
+#define APP_FORWARD_BATCH_BYTES_MIN 512
+#define APP_FORWARD_BATCH_BYTES_MAX 8192 // Sizes the two batch buffers
+#define APP_FRAMELOG_PARTITION "framelog"  // Data partition for frames kept while offline
+#define APP_FRAMELOG_REPLAY_FPS 25         // Replay rate limit after reconnecting (frames/s)
+#define APP_FRAMELOG_RETRY_MS 10000        // Replay retry delay while offline or after a failed POST
 
 typedef struct
 {
@@ -31,12 +65,132 @@ typedef struct
 
 typedef struct
 {
-    char url[192];
-    bool reachable;
+    uint16_t batch_frames;
+    uint16_t batch_ms;
+    uint16_t batch_bytes;
+    const char *format; // Uplink body encoding ("json" / "cbor")
+    uint32_t queued;   // Frames accepted into a batch
+    uint32_t sent;     // Frames delivered with a 2xx response
+    uint32_t dropped;  // Frames lost (buffer full, or no network/failed POST and no flash log)
+    uint32_t batches;  // Successful POSTs
+    uint32_t failed;   // Failed POSTs (after one reconnect attempt)
+    uint32_t last_post_ms;
+    bool log_mounted;
+    uint32_t log_capacity;  // Bytes of the flash frame log
+    uint32_t log_used;      // Bytes held by frames not yet delivered
+    uint32_t log_backlog;   // Frames waiting for replay
+    uint32_t log_oldest_s;  // Age of the oldest waiting frame
+    uint32_t log_spooled;   // Frames written to flash instead of being dropped
+    uint32_t log_replayed;  // Frames delivered from flash
+    uint32_t log_lost;      // Waiting frames overwritten because the log was full
+    uint16_t replay_fps;    // Replay rate limit
 } app_backend_status_t;
 
 typedef struct
 {
     uint8_t cs_level;
     uint8_t sync_mode;
+    uint8_t dedup_window_s;
 } app_radio_status_t;
+
+typedef struct
+{
+    uint32_t queue_capacity;
+    uint32_t queue_depth;
+    uint32_t queue_high_water;
+    uint32_t queue_drops;
+    uint32_t pool_capacity;
+    uint32_t pool_in_use;     // Frames referenced by the queue or a sink
+    uint32_t pool_high_water;
+    uint32_t pool_exhausted;  // Allocation attempts that found no free frame
+    uint32_t frames;
+    uint32_t rearms;
+    uint32_t aborted;
+    uint32_t filtered;       // Frames dropped by the address filter after block 0
+    uint32_t filtered_bytes; // Encoded bytes of those frames not read from the radio
+    uint32_t dead_time_last_us;
+    uint32_t dead_time_avg_us;
+    uint32_t dead_time_max_us;
+} app_rx_status_t;
+
+typedef struct
+{
+    uint8_t mode;      // addr_filter_mode_t: 0 off, 1 allow, 2 deny
+    uint32_t count;    // Entries in the list
+    uint32_t capacity; // APP_ADDR_FILTER_MAX
+} app_filter_status_t;
+
+typedef struct
+{
+    char name[16];
+    bool async;
+    uint32_t calls;
+    uint32_t avg_us;
+    uint32_t max_us;
+    uint32_t queued;     // Async: events waiting
+    uint32_t high_water;
+    uint32_t dropped;    // Async: events discarded because the queue was full
+    uint32_t filtered;   // Events rejected by the sink's filter expression
+    bool has_filter;
+} app_sink_status_t;
+
+typedef struct
+{
+    uint8_t count;
+    app_sink_status_t sinks[APP_SINKS_MAX];
+} app_sinks_status_t;
+
+typedef struct
+{
+    uint16_t manuf;
+    uint8_t id[4];
+    uint32_t duplicates;
+} app_dedup_meter_t;
+
+typedef struct
+{
+    uint32_t checked;    // Frames looked up in the cache
+    uint32_t duplicates; // Frames dropped before the sinks
+    uint32_t evicted;    // Cache entries replaced before their window ended
+    uint8_t meter_count;
+    app_dedup_meter_t meters[APP_DEDUP_METERS];
+} app_dedup_status_t;
+
+typedef struct
+{
+    uint16_t manuf;
+    uint8_t id[4];
+    uint8_t dev_type;
+    uint32_t first_ms;    // Uptime of the first and latest frame
+    uint32_t last_ms;
+    uint32_t frames;      // Intact frames
+    uint32_t crc_errors;  // Frames that failed a CRC after the address block
+    int16_t rssi_avg;     // 0.1 dBm, over all frames of the meter
+    int16_t rssi_min;
+    int16_t rssi_max;
+    uint8_t lqi_avg;
+    uint8_t lqi_min;
+    uint8_t lqi_max;
+    bool has_acc;
+    uint8_t acc;          // Last access number
+    uint32_t interval_ms; // Estimated transmit interval (0 = unknown)
+    uint32_t missed;      // Frames lost according to ACC gaps
+    uint32_t repeats;     // Frames with an ACC already seen
+    uint32_t expected_1h; // Frames sent (by ACC) and received intact in the last hour / day
+    uint32_t received_1h;
+    uint32_t expected_24h;
+    uint32_t received_24h;
+} app_meter_status_t;
+
+typedef struct
+{
+    uint32_t count;        // Meters in the table
+    uint32_t capacity;
+    uint32_t evicted;      // Meters replaced by a new one
+    uint32_t unattributed; // Frames that failed before the address was verified
+    uint32_t missed;       // Sums over the meters in the table
+    uint32_t expected_1h;
+    uint32_t received_1h;
+    uint32_t expected_24h;
+    uint32_t received_24h;
+} app_meters_status_t;
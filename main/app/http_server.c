@@ -2,16 +2,24 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_http_server.h"
 #include "app/config.h"
+#include "app/json_writer.h"
+#include "app/runtime.h"
 #include <inttypes.h>
 #include "app/net/backend.h"
 #include "app/net/wifi.h"
 #include "app/wmbus/frame_parse.h"
 #include "app/wmbus/parsed_frame.h"
 #include "app/wmbus/packet_router.h"
-#include "freertos/semphr.h"
+#include "app/wmbus/frame_history.h"
+#include "app/wmbus/meter_table.h"
+#include "app/wmbus/addr_filter.h"
+#include "app/wmbus/frame_filter.h"
+#include "freertos/FreeRTOS.h"
 
 extern const unsigned char index_html_start[] asm("_binary_index_html_start");
 extern const unsigned char index_html_end[] asm("_binary_index_html_end");
@@ -57,7 +65,6 @@ static const icon_entry_t ICONS[] = {
 static const char *TAG = "http";
 static httpd_handle_t s_server = NULL;
 static services_state_t *s_services = NULL;
-static SemaphoreHandle_t s_pkt_mutex = NULL;
 static bool s_sink_registered = false;
 static bool s_backend_reachable = false;
 static bool s_backend_has_probe = false;
@@ -104,18 +111,46 @@ typedef struct
 
 #define PKT_RAW_MAX (WMBUS_FIXED_HEADER_BYTES + 300)
 
+// One /api/packets entry, parsed from a history record when the list is requested.
 typedef struct
 {
     wmbus_parsed_frame_t frame;
+    uint32_t seq;
     float rssi;
+    uint8_t lqi;
     uint32_t payload_len;
-    uint8_t raw[PKT_RAW_MAX];
+    const uint8_t *raw;
     uint16_t raw_len;
 } pkt_entry_t;
 
-#define PKT_BUF_MAX 40
-static pkt_entry_t s_pkt_buf[PKT_BUF_MAX];
-static size_t s_pkt_count = 0;
+// Recent frames packed into a byte ring (logical frame + 16-byte header each).
+// The sink appends without waiting; handlers copy records out.
+static uint8_t s_pkt_ring[APP_UI_HISTORY_BYTES];
+static wmbus_frame_history_t s_pkt_history;
+static bool s_pkt_ready = false;
+
+// Live /api/packets/stream clients. Each only keeps the sequence number of the
+// next frame to send and reads the frames from the history. Guarded by
+// s_sse_lock (short critical sections, no I/O); sockets are written from httpd work.
+typedef struct
+{
+    int fd;           // -1: slot free
+    uint32_t gen;     // Tells a stale work item from the slot's next client
+    bool closing;     // Evicted or failed; the slot is freed when the socket closes
+    bool work_queued; // A send work item is pending in the httpd task
+    uint32_t next;    // Sequence number of the next frame to send
+    frame_filter_t filter;
+} sse_client_t;
+
+_Static_assert(APP_SSE_CLIENTS <= 16, "work items carry the slot in 4 bits");
+
+static sse_client_t s_sse[APP_SSE_CLIENTS];
+static portMUX_TYPE s_sse_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_sse_gen = 0;
+static uint32_t s_sse_sent = 0;
+static uint32_t s_sse_evicted = 0;
+
+static void sse_work(void *arg);
 
 static esp_err_t send_ok(httpd_req_t *req)
 {
@@ -130,87 +165,181 @@ static esp_err_t send_err(httpd_req_t *req, const char *code, const char *msg)
     return httpd_resp_sendstr(req, msg);
 }
 
-static void bytes_to_hex(const uint8_t *in, uint16_t len, char *out, size_t out_len)
+void http_server_record_packet(const WmbusPacketEvent *evt)
 {
-    if (!out || out_len == 0)
+    if (!evt || !evt->frame_info.parsed || !s_pkt_ready)
     {
         return;
     }
-    if (!in || len == 0)
+    if (!evt->logical_packet || evt->logical_len == 0)
     {
-        out[0] = '\0';
         return;
     }
-    static const char *hex = "0123456789ABCDEF";
-    size_t idx = 0;
-    for (uint16_t i = 0; i < len && (idx + 2) < out_len; ++i)
-    {
-        uint8_t byte = in[i];
-        out[idx++] = hex[(byte >> 4) & 0x0F];
-        out[idx++] = hex[byte & 0x0F];
-    }
-    out[idx] = '\0';
-}
 
-void http_server_record_packet(const WmbusPacketEvent *evt)
-{
-    if (!evt || !evt->frame_info.parsed)
+    // Never waits: the history is lock-free and stream clients only need a wake-up
+    const wmbus_history_meta_t meta = {
+        .rx_ms = (uint32_t)(esp_timer_get_time() / 1000),
+        .rssi_ddbm = (int16_t)(evt->rssi_dbm * 10.0f + ((evt->rssi_dbm < 0) ? -0.5f : 0.5f)),
+        .lqi = evt->lqi,
+        .status = evt->status,
+    };
+    const uint32_t seq = wmbus_frame_history_push(&s_pkt_history, &meta, evt->logical_packet, evt->logical_len);
+    if (seq == 0)
     {
         return;
     }
-    if (!s_pkt_mutex)
+    uintptr_t wake[APP_SSE_CLIENTS];
+    int close_fds[APP_SSE_CLIENTS];
+    size_t n_wake = 0;
+    size_t n_close = 0;
+    portENTER_CRITICAL(&s_sse_lock);
+    // Wake every stream client; one that fell a full backlog behind is evicted
+    for (size_t i = 0; i < APP_SSE_CLIENTS; i++)
     {
-        return;
+        sse_client_t *c = &s_sse[i];
+        if (c->fd < 0 || c->closing)
+        {
+            continue;
+        }
+        if (seq - c->next >= APP_SSE_BACKLOG)
+        {
+            c->closing = true;
+            s_sse_evicted++;
+            close_fds[n_close++] = c->fd;
+            continue;
+        }
+        if (!c->work_queued)
+        {
+            c->work_queued = true;
+            wake[n_wake++] = ((uintptr_t)c->gen << 4) | i;
+        }
     }
-    if (!evt->logical_packet || evt->logical_len == 0)
+    portEXIT_CRITICAL(&s_sse_lock);
+
+    for (size_t i = 0; i < n_wake; i++)
     {
-        return;
+        if (httpd_queue_work(s_server, sse_work, (void *)wake[i]) != ESP_OK)
+        {
+            // Retried with the next frame
+            portENTER_CRITICAL(&s_sse_lock);
+            s_sse[wake[i] & 0xF].work_queued = false;
+            portEXIT_CRITICAL(&s_sse_lock);
+        }
     }
+    for (size_t i = 0; i < n_close; i++)
+    {
+        ESP_LOGW(TAG, "packet stream client %d too slow, closing", close_fds[i]);
+        httpd_sess_trigger_close(s_server, close_fds[i]);
+    }
+}
 
-    wmbus_raw_frame_t raw = {
-        .bytes = evt->logical_packet,
-        .len = evt->logical_len,
+// Parse a history record again; e points into r, which must outlive it.
+static void pkt_entry_from_record(const wmbus_history_entry_t *r, pkt_entry_t *e)
+{
+    WmbusFrameInfo info = {.logical_len = r->len};
+    info.parsed = wmbus_parse_frame_header(r->bytes, r->len, &info.header, NULL, &info.payload_len);
+    const wmbus_raw_frame_t raw = {
+        .bytes = r->bytes,
+        .len = r->len,
     };
-    wmbus_parsed_frame_t pf;
-    wmbus_parsed_frame_init(&pf, &raw, &evt->frame_info);
-    wmbus_parsed_frame_parse_meta(&pf);
+    wmbus_parsed_frame_init(&e->frame, &raw, &info);
+    wmbus_parsed_frame_parse_meta(&e->frame);
+    strlcpy(e->frame.dll.gateway, services_hostname(s_services), sizeof(e->frame.dll.gateway));
+    e->seq = r->meta.seq;
+    e->rssi = (float)r->meta.rssi_ddbm / 10.0f;
+    e->lqi = r->meta.lqi;
+    e->payload_len = info.payload_len;
+    e->raw = r->bytes;
+    e->raw_len = (r->len > PKT_RAW_MAX) ? PKT_RAW_MAX : r->len;
+}
 
-    pkt_entry_t e = {0};
-    e.frame = pf;
-    e.rssi = evt->rssi_dbm;
-    e.payload_len = evt->frame_info.payload_len;
-    if (evt->gateway_name)
+static bool pkt_entry_match(const frame_filter_t *filter, const pkt_entry_t *e)
+{
+    const frame_filter_input_t in = {
+        .info = &e->frame.info,
+        .rssi_dbm = e->rssi,
+        .lqi = e->lqi,
+        .parsed = &e->frame,
+    };
+    return frame_filter_match(filter, &in);
+}
+
+// Optional numeric field: the value, or null when the layer is absent
+static void json_u32_opt(json_writer_t *w, const char *key, bool present, uint32_t v)
+{
+    if (present)
     {
-        strlcpy(e.frame.dll.gateway, evt->gateway_name, sizeof(e.frame.dll.gateway));
+        json_u32(w, key, v);
     }
     else
     {
-        e.frame.dll.gateway[0] = '\0';
+        json_null(w, key);
     }
-    e.raw_len = evt->logical_len > PKT_RAW_MAX ? PKT_RAW_MAX : evt->logical_len;
-    if (e.raw_len && evt->logical_packet)
+}
+
+static void pkt_entry_write(json_writer_t *w, const pkt_entry_t *p)
+{
+    const wmbus_parsed_frame_t *f = &p->frame;
+    const bool tpl = f->tpl.has_tpl;
+    const bool ell = f->ell.has_ell;
+    const bool afl = f->afl.has_afl;
+    const char *hdr = "none";
+    if (f->tpl.tpl.header_type == WMBUS_TPL_HDR_SHORT)
     {
-        memcpy(e.raw, evt->logical_packet, e.raw_len);
+        hdr = "tpl_short";
     }
-    e.frame.raw.bytes = e.raw;
-    e.frame.raw.len = e.raw_len;
-    e.frame.info.logical_len = e.raw_len;
-
-    if (xSemaphoreTake(s_pkt_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
+    else if (f->tpl.tpl.header_type == WMBUS_TPL_HDR_LONG)
     {
-        if (s_pkt_count < PKT_BUF_MAX)
-        {
-            memmove(&s_pkt_buf[1], &s_pkt_buf[0], s_pkt_count * sizeof(pkt_entry_t));
-            s_pkt_buf[0] = e;
-            s_pkt_count++;
-        }
-        else
-        {
-            memmove(&s_pkt_buf[1], &s_pkt_buf[0], (PKT_BUF_MAX - 1) * sizeof(pkt_entry_t));
-            s_pkt_buf[0] = e;
-        }
-        xSemaphoreGive(s_pkt_mutex);
+        hdr = "tpl_long";
     }
+    json_obj_begin(w, NULL);
+    json_u32(w, "seq", p->seq);
+    json_str(w, "gateway", f->dll.gateway);
+    json_u32(w, "manuf", f->dll.manuf);
+    json_str(w, "id", f->dll.id_str);
+    json_u32(w, "control", f->dll.c);
+    json_u32(w, "dev_type", f->dll.dev_type);
+    json_u32(w, "version", f->dll.version);
+    json_u32(w, "ci", f->dll.ci);
+    json_u32(w, "ci_class", f->ci_class);
+    json_str(w, "hdr", hdr);
+    json_u32_opt(w, "acc", tpl, f->tpl.tpl.acc);
+    json_u32_opt(w, "status", tpl, f->tpl.tpl.status);
+    json_u32_opt(w, "cfg", tpl, f->tpl.tpl.cfg);
+    json_u32_opt(w, "tpl_ci", tpl, f->tpl.tpl.ci);
+    json_u32_opt(w, "tpl_mode", tpl && f->tpl.tpl.cfg_info.mode, f->tpl.tpl.cfg_info.mode);
+    json_u32_opt(w, "tpl_content", tpl, f->tpl.tpl.cfg_info.content);
+    json_u32_opt(w, "tpl_index", tpl, f->tpl.tpl.cfg_info.content_index);
+    json_u32_opt(w, "sec_mode", f->tpl.tpl.header_type && f->tpl.sec.security_mode, f->tpl.sec.security_mode);
+    json_u32_opt(w, "sec_len", f->tpl.sec.enc_len, f->tpl.sec.enc_len);
+    json_bool(w, "encrypted", f->encrypted);
+    json_u32_opt(w, "ell_cc", ell, f->ell.ell.cc);
+    json_u32_opt(w, "ell_acc", ell, f->ell.ell.acc);
+    if (ell && f->ell.ell.ext_len)
+    {
+        const size_t ext_len = (f->ell.ell.ext_len < sizeof(f->ell.ell.ext)) ? f->ell.ell.ext_len : sizeof(f->ell.ell.ext);
+        json_hex(w, "ell_ext", f->ell.ell.ext, ext_len);
+    }
+    else
+    {
+        json_null(w, "ell_ext");
+    }
+    json_u32_opt(w, "afl_tag", afl, f->afl.afl.tag);
+    json_u32_opt(w, "afl_afll", afl, f->afl.afl.afll);
+    json_u32_opt(w, "afl_mcl", afl, f->afl.afl.mcl);
+    json_u32(w, "afl_offset", f->afl.afl.offset);
+    json_u32(w, "afl_payload_len", f->afl.afl.payload_len);
+    if (p->raw_len > 0)
+    {
+        json_hex(w, "raw_hex", p->raw, p->raw_len);
+    }
+    else
+    {
+        json_null(w, "raw_hex");
+    }
+    json_fixed1(w, "rssi", (int32_t)(p->rssi * 10.0f + ((p->rssi < 0) ? -0.5f : 0.5f)));
+    json_u32(w, "payload_len", p->payload_len);
+    json_obj_end(w);
 }
 
 static void http_pkt_sink(const WmbusPacketEvent *evt, void *user)
@@ -290,6 +419,149 @@ static esp_err_t handle_static_icon(httpd_req_t *req)
     return httpd_resp_send_404(req);
 }
 
+// Field lists of the /api/status objects: X(key, type, member)
+#define WIFI_FIELDS(X)                   \
+    X("connected", BOOL, connected)      \
+    X("ssid", STR, ssid)                 \
+    X("ip", STR, ip)                     \
+    X("has_pass", BOOL, has_pass)        \
+    X("rssi", INT, rssi)                 \
+    X("gateway", STR, gateway)           \
+    X("dns", STR, dns)
+
+#define AP_FIELDS(X)                     \
+    X("ssid", STR, ssid)                 \
+    X("channel", U8, channel)            \
+    X("has_pass", BOOL, has_pass)
+
+#define BACKEND_FIELDS(X)                \
+    X("batch_frames", U16, batch_frames) \
+    X("batch_ms", U16, batch_ms)         \
+    X("batch_bytes", U16, batch_bytes)   \
+    X("format", CSTR, format)            \
+    X("queued", U32, queued)             \
+    X("sent", U32, sent)                 \
+    X("dropped", U32, dropped)           \
+    X("batches", U32, batches)           \
+    X("failed", U32, failed)             \
+    X("last_post_ms", U32, last_post_ms)
+
+#define BACKEND_LOG_FIELDS(X)            \
+    X("mounted", BOOL, log_mounted)      \
+    X("capacity", U32, log_capacity)     \
+    X("used", U32, log_used)             \
+    X("backlog", U32, log_backlog)       \
+    X("oldest_s", U32, log_oldest_s)     \
+    X("spooled", U32, log_spooled)       \
+    X("replayed", U32, log_replayed)     \
+    X("lost", U32, log_lost)             \
+    X("replay_fps", U16, replay_fps)
+
+#define RADIO_FIELDS(X)                      \
+    X("cs_level", U8, cs_level)              \
+    X("sync_mode", U8, sync_mode)            \
+    X("dedup_window_s", U8, dedup_window_s)
+
+#define RX_FIELDS(X)                                 \
+    X("queue_capacity", U32, queue_capacity)         \
+    X("queue_depth", U32, queue_depth)               \
+    X("queue_high_water", U32, queue_high_water)     \
+    X("queue_drops", U32, queue_drops)               \
+    X("frames", U32, frames)                         \
+    X("rearms", U32, rearms)                         \
+    X("aborted", U32, aborted)                       \
+    X("filtered", U32, filtered)                     \
+    X("filtered_bytes", U32, filtered_bytes)         \
+    X("dead_time_last_us", U32, dead_time_last_us)   \
+    X("dead_time_avg_us", U32, dead_time_avg_us)     \
+    X("dead_time_max_us", U32, dead_time_max_us)
+
+#define RX_POOL_FIELDS(X)                    \
+    X("capacity", U32, pool_capacity)        \
+    X("in_use", U32, pool_in_use)            \
+    X("high_water", U32, pool_high_water)    \
+    X("exhausted", U32, pool_exhausted)
+
+#define DEDUP_FIELDS(X)                  \
+    X("checked", U32, checked)           \
+    X("duplicates", U32, duplicates)     \
+    X("evicted", U32, evicted)
+
+#define METERS_FIELDS(X)                 \
+    X("count", U32, count)               \
+    X("capacity", U32, capacity)         \
+    X("evicted", U32, evicted)           \
+    X("unattributed", U32, unattributed) \
+    X("missed", U32, missed)
+
+#define METER_FIELDS(X)                  \
+    X("dev_type", U8, dev_type)          \
+    X("first_ms", U32, first_ms)         \
+    X("last_ms", U32, last_ms)           \
+    X("frames", U32, frames)             \
+    X("crc_errors", U32, crc_errors)     \
+    X("lqi_avg", U8, lqi_avg)            \
+    X("lqi_min", U8, lqi_min)            \
+    X("lqi_max", U8, lqi_max)            \
+    X("interval_ms", U32, interval_ms)   \
+    X("missed", U32, missed)             \
+    X("repeats", U32, repeats)
+
+#define SINK_FIELDS(X)                   \
+    X("name", STR, name)                 \
+    X("async", BOOL, async)              \
+    X("calls", U32, calls)               \
+    X("avg_us", U32, avg_us)             \
+    X("max_us", U32, max_us)             \
+    X("queued", U32, queued)             \
+    X("high_water", U32, high_water)     \
+    X("dropped", U32, dropped)           \
+    X("filter", BOOL, has_filter)        \
+    X("filtered", U32, filtered)
+
+#define WIFI_FIELD(key, type, member) JSON_FIELD(app_wifi_status_t, type, key, member),
+#define AP_FIELD(key, type, member) JSON_FIELD(app_ap_status_t, type, key, member),
+#define BACKEND_FIELD(key, type, member) JSON_FIELD(app_backend_status_t, type, key, member),
+#define RADIO_FIELD(key, type, member) JSON_FIELD(app_radio_status_t, type, key, member),
+#define RX_FIELD(key, type, member) JSON_FIELD(app_rx_status_t, type, key, member),
+#define DEDUP_FIELD(key, type, member) JSON_FIELD(app_dedup_status_t, type, key, member),
+#define METERS_FIELD(key, type, member) JSON_FIELD(app_meters_status_t, type, key, member),
+#define METER_FIELD(key, type, member) JSON_FIELD(app_meter_status_t, type, key, member),
+#define SINK_FIELD(key, type, member) JSON_FIELD(app_sink_status_t, type, key, member),
+
+static const json_field_t WIFI_JSON[] = {WIFI_FIELDS(WIFI_FIELD)};
+static const json_field_t AP_JSON[] = {AP_FIELDS(AP_FIELD)};
+static const json_field_t BACKEND_JSON[] = {BACKEND_FIELDS(BACKEND_FIELD)};
+static const json_field_t BACKEND_LOG_JSON[] = {BACKEND_LOG_FIELDS(BACKEND_FIELD)};
+static const json_field_t RADIO_JSON[] = {RADIO_FIELDS(RADIO_FIELD)};
+static const json_field_t RX_JSON[] = {RX_FIELDS(RX_FIELD)};
+static const json_field_t RX_POOL_JSON[] = {RX_POOL_FIELDS(RX_FIELD)};
+static const json_field_t DEDUP_JSON[] = {DEDUP_FIELDS(DEDUP_FIELD)};
+static const json_field_t METERS_JSON[] = {METERS_FIELDS(METERS_FIELD)};
+static const json_field_t METER_JSON[] = {METER_FIELDS(METER_FIELD)};
+static const json_field_t SINK_JSON[] = {SINK_FIELDS(SINK_FIELD)};
+
+#define JSON_FIELDS(w, obj, fields) json_write_fields((w), (obj), (fields), sizeof(fields) / sizeof((fields)[0]))
+
+// Reception ratio in percent with one decimal, null when nothing was expected
+static void json_ratio(json_writer_t *w, const char *key, uint32_t received, uint32_t expected)
+{
+    const int32_t permille = wmbus_meter_ratio_permille(received, expected);
+    if (permille < 0)
+    {
+        json_null(w, key);
+    }
+    else
+    {
+        json_fixed1(w, key, permille);
+    }
+}
+
+static esp_err_t json_send_chunk(void *ctx, const char *data, size_t len)
+{
+    return httpd_resp_send_chunk((httpd_req_t *)ctx, data, len);
+}
+
 static esp_err_t handle_status(httpd_req_t *req)
 {
     app_wifi_status_t wifi = {0};
@@ -301,34 +573,132 @@ static esp_err_t handle_status(httpd_req_t *req)
     char backend_url[192] = {0};
     services_get_backend_url(s_services, backend_url, sizeof(backend_url));
     bool backend_ok = (backend_url[0] != '\0') && s_backend_has_probe && s_backend_reachable;
+    app_rx_status_t rx = {0};
+    app_get_rx_status(&rx);
+    app_backend_status_t fwd = {0};
+    services_get_backend_status(s_services, &fwd);
+    app_dedup_status_t dedup = {0};
+    app_get_dedup_status(&dedup);
+    app_sinks_status_t sinks = {0};
+    app_get_sink_status(&sinks);
+    app_meters_status_t meters = {0};
+    app_get_meters_status(&meters);
 
-    char json[2048];
-    int n = snprintf(json, sizeof(json),
-                     "{\"hostname\":\"%s\",\"wifi\":{\"connected\":%s,\"ssid\":\"%s\",\"ip\":\"%s\",\"has_pass\":%s,"
-                     "\"rssi\":%d,\"gateway\":\"%s\",\"dns\":\"%s\"},"
-                     "\"ap\":{\"ssid\":\"%s\",\"channel\":%u,\"has_pass\":%s},"
-                     "\"backend\":{\"url\":\"%s\",\"reachable\":%s},\"radio\":{\"cs_level\":%u,\"sync_mode\":%u}}",
-                     services_hostname(s_services),
-                     wifi.connected ? "true" : "false",
-                     wifi.ssid,
-                     wifi.ip,
-                     wifi.has_pass ? "true" : "false",
-                     wifi.rssi,
-                     wifi.gateway,
-                     wifi.dns,
-                     ap.ssid,
-                     ap.channel,
-                     ap.has_pass ? "true" : "false",
-                     backend_url,
-                     backend_ok ? "true" : "false",
-                     radio.cs_level,
-                     radio.sync_mode);
-    if (n < 0 || n >= (int)sizeof(json))
-    {
-        return httpd_resp_send_500(req);
-    }
     httpd_resp_set_type(req, "application/json");
-    return httpd_resp_send(req, json, n);
+    char chunk[APP_JSON_CHUNK];
+    json_writer_t w;
+    json_init(&w, chunk, sizeof(chunk), json_send_chunk, req);
+    json_obj_begin(&w, NULL);
+    json_str(&w, "hostname", services_hostname(s_services));
+    json_obj_begin(&w, "wifi");
+    JSON_FIELDS(&w, &wifi, WIFI_JSON);
+    json_obj_end(&w);
+    json_obj_begin(&w, "ap");
+    JSON_FIELDS(&w, &ap, AP_JSON);
+    json_obj_end(&w);
+
+    json_obj_begin(&w, "backend");
+    json_str(&w, "url", backend_url);
+    json_bool(&w, "reachable", backend_ok);
+    JSON_FIELDS(&w, &fwd, BACKEND_JSON);
+    json_obj_begin(&w, "log");
+    JSON_FIELDS(&w, &fwd, BACKEND_LOG_JSON);
+    json_obj_end(&w);
+    json_obj_end(&w);
+
+    json_obj_begin(&w, "radio");
+    JSON_FIELDS(&w, &radio, RADIO_JSON);
+    json_obj_end(&w);
+
+    json_obj_begin(&w, "rx");
+    JSON_FIELDS(&w, &rx, RX_JSON);
+    json_obj_begin(&w, "pool");
+    JSON_FIELDS(&w, &rx, RX_POOL_JSON);
+    json_obj_end(&w);
+    json_obj_end(&w);
+
+    json_obj_begin(&w, "dedup");
+    JSON_FIELDS(&w, &dedup, DEDUP_JSON);
+    json_arr_begin(&w, "meters");
+    for (uint8_t i = 0; i < dedup.meter_count; i++)
+    {
+        const app_dedup_meter_t *m = &dedup.meters[i];
+        const uint8_t id[4] = {m->id[3], m->id[2], m->id[1], m->id[0]};
+        json_obj_begin(&w, NULL);
+        json_u32(&w, "manuf", m->manuf);
+        json_hex(&w, "id", id, sizeof(id));
+        json_u32(&w, "duplicates", m->duplicates);
+        json_obj_end(&w);
+    }
+    json_arr_end(&w);
+    json_obj_end(&w);
+
+    json_obj_begin(&w, "meters");
+    JSON_FIELDS(&w, &meters, METERS_JSON);
+    json_ratio(&w, "rx_1h", meters.received_1h, meters.expected_1h);
+    json_ratio(&w, "rx_24h", meters.received_24h, meters.expected_24h);
+    json_obj_end(&w);
+
+    json_arr_begin(&w, "sinks");
+    for (uint8_t i = 0; i < sinks.count; i++)
+    {
+        json_obj_begin(&w, NULL);
+        JSON_FIELDS(&w, &sinks.sinks[i], SINK_JSON);
+        json_obj_end(&w);
+    }
+    json_arr_end(&w);
+
+    wmbus_frame_history_stats_t history;
+    wmbus_frame_history_get_stats(&s_pkt_history, &history);
+    json_obj_begin(&w, "history");
+    json_u32(&w, "frames", history.count);
+    json_u32(&w, "seq", history.seq);
+    json_u32(&w, "bytes", history.used_bytes);
+    json_u32(&w, "capacity", history.capacity_bytes);
+    json_u32(&w, "overwritten", history.overwritten);
+    json_obj_end(&w);
+
+    uint32_t sse_clients = 0;
+    portENTER_CRITICAL(&s_sse_lock);
+    for (size_t i = 0; i < APP_SSE_CLIENTS; i++)
+    {
+        sse_clients += (s_sse[i].fd >= 0) ? 1 : 0;
+    }
+    const uint32_t sse_sent = s_sse_sent;
+    const uint32_t sse_evicted = s_sse_evicted;
+    portEXIT_CRITICAL(&s_sse_lock);
+    json_obj_begin(&w, "stream");
+    json_u32(&w, "clients", sse_clients);
+    json_u32(&w, "sent", sse_sent);
+    json_u32(&w, "evicted", sse_evicted);
+    json_obj_end(&w);
+    json_obj_end(&w);
+    if (json_finish(&w) != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Optional decimal query value: *out is left alone when the key is missing,
+// false when the value is empty, not a number, too long or above UINT16_MAX.
+static bool query_u16(const char *query, const char *key, uint16_t *out, bool *present)
+{
+    char num[8] = {0};
+    const esp_err_t err = httpd_query_key_value(query, key, num, sizeof(num));
+    if (err == ESP_ERR_NOT_FOUND)
+    {
+        return true;
+    }
+    char *end = NULL;
+    const unsigned long v = strtoul(num, &end, 10);
+    if (err != ESP_OK || num[0] < '0' || num[0] > '9' || *end != '\0' || v > UINT16_MAX)
+    {
+        return false;
+    }
+    *out = (uint16_t)v;
+    *present = true;
+    return true;
 }
 
 static esp_err_t handle_backend(httpd_req_t *req)
@@ -344,6 +714,30 @@ static esp_err_t handle_backend(httpd_req_t *req)
             s_backend_has_probe = false;
             s_backend_reachable = false;
         }
+
+        // Batching thresholds: any subset, missing ones keep their value
+        app_backend_status_t cur = {0};
+        services_get_backend_status(s_services, &cur);
+        uint16_t frames = cur.batch_frames;
+        uint16_t ms = cur.batch_ms;
+        uint16_t bytes = cur.batch_bytes;
+        bool any = false;
+        if (!query_u16(query, "batch_frames", &frames, &any) || !query_u16(query, "batch_ms", &ms, &any) ||
+            !query_u16(query, "batch_bytes", &bytes, &any))
+        {
+            return send_err(req, "400", "{\"error\":\"batch values must be numbers up to 65535\"}");
+        }
+        if (any && services_set_backend_batch(s_services, frames, ms, bytes) != ESP_OK)
+        {
+            return send_err(req, "400", "{\"error\":\"batch out of range\"}");
+        }
+
+        char format[8] = {0};
+        if (httpd_query_key_value(query, "format", format, sizeof(format)) == ESP_OK &&
+            services_set_backend_format(s_services, format) != ESP_OK)
+        {
+            return send_err(req, "400", "{\"error\":\"format must be json or cbor\"}");
+        }
     }
     return send_ok(req);
 }
@@ -419,10 +813,12 @@ static esp_err_t handle_radio(httpd_req_t *req)
     char query[128] = {0};
     char cs[8] = {0};
     char sync[8] = {0};
+    char dedup[8] = {0};
     if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
     {
         httpd_query_key_value(query, "cs", cs, sizeof(cs));
         httpd_query_key_value(query, "sync", sync, sizeof(sync));
+        httpd_query_key_value(query, "dedup", dedup, sizeof(dedup));
     }
     if (cs[0])
     {
@@ -432,140 +828,533 @@ static esp_err_t handle_radio(httpd_req_t *req)
     {
         services_set_radio_sync_mode(s_services, (uint8_t)atoi(sync));
     }
+    if (dedup[0])
+    {
+        const int seconds = atoi(dedup);
+        if (seconds < 0 || seconds > UINT8_MAX)
+        {
+            return send_err(req, "400", "{\"error\":\"dedup out of range\"}");
+        }
+        services_set_radio_dedup_window(s_services, (uint8_t)seconds);
+    }
     return send_ok(req);
 }
 
-static esp_err_t handle_packets_stream(httpd_req_t *req)
+// Add one list token; false for a malformed entry or a full list.
+static bool filter_add_token(const char *tok, size_t len, uint64_t *keys, uint32_t *count)
 {
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
-    const char *start = "{\"packets\":[";
-    if (httpd_resp_send_chunk(req, start, strlen(start)) != ESP_OK)
+    if (len == 0)
     {
-        return ESP_FAIL;
+        return true;
     }
-    if (s_pkt_mutex && xSemaphoreTake(s_pkt_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
+    uint64_t key;
+    if (*count >= APP_ADDR_FILTER_MAX || !addr_filter_parse_entry(tok, len, &key))
     {
-        size_t limit = s_pkt_count;
-        if (limit > 25)
+        return false;
+    }
+    keys[(*count)++] = key;
+    return true;
+}
+
+// Body: meter addresses separated by whitespace or commas, read in small pieces.
+static esp_err_t recv_filter_list(httpd_req_t *req, uint64_t *keys, uint32_t *count)
+{
+    char buf[256];
+    char tok[ADDR_FILTER_ENTRY_CHARS];
+    size_t tok_len = 0;
+    bool tok_long = false;
+    size_t remaining = req->content_len;
+    *count = 0;
+    while (remaining > 0)
+    {
+        const int got = httpd_req_recv(req, buf, remaining < sizeof(buf) ? remaining : sizeof(buf));
+        if (got == HTTPD_SOCK_ERR_TIMEOUT)
         {
-            limit = 25;
+            continue;
         }
-        for (size_t i = 0; i < limit; i++)
+        if (got <= 0)
         {
-            const pkt_entry_t *p = &s_pkt_buf[i];
-            const char *hdr = "none";
-            if (p->frame.tpl.tpl.header_type == WMBUS_TPL_HDR_SHORT)
+            return ESP_FAIL;
+        }
+        remaining -= (size_t)got;
+        for (int i = 0; i < got; i++)
+        {
+            const char c = buf[i];
+            if (c == ',' || c == ' ' || c == '\n' || c == '\r' || c == '\t')
             {
-                hdr = "tpl_short";
+                if (tok_long || !filter_add_token(tok, tok_len, keys, count))
+                {
+                    return ESP_ERR_INVALID_ARG;
+                }
+                tok_len = 0;
             }
-            else if (p->frame.tpl.tpl.header_type == WMBUS_TPL_HDR_LONG)
+            else if (tok_len < sizeof(tok))
             {
-                hdr = "tpl_long";
+                tok[tok_len++] = c;
             }
-            char acc_buf[12];
-            const char *acc = p->frame.tpl.has_tpl ? (snprintf(acc_buf, sizeof(acc_buf), "%u", p->frame.tpl.tpl.acc), acc_buf) : "null";
-            char status_buf[12];
-            const char *status = p->frame.tpl.has_tpl ? (snprintf(status_buf, sizeof(status_buf), "%u", p->frame.tpl.tpl.status), status_buf) : "null";
-            char cfg_buf[16];
-            const char *cfg = p->frame.tpl.has_tpl ? (snprintf(cfg_buf, sizeof(cfg_buf), "%u", p->frame.tpl.tpl.cfg), cfg_buf) : "null";
-            char tpl_ci_buf[12];
-            const char *tpl_ci = p->frame.tpl.has_tpl ? (snprintf(tpl_ci_buf, sizeof(tpl_ci_buf), "%u", p->frame.tpl.tpl.ci), tpl_ci_buf) : "null";
-            char tpl_mode_buf[8];
-            const char *tpl_mode = (p->frame.tpl.has_tpl && p->frame.tpl.tpl.cfg_info.mode) ? (snprintf(tpl_mode_buf, sizeof(tpl_mode_buf), "%u", p->frame.tpl.tpl.cfg_info.mode), tpl_mode_buf) : "null";
-            char tpl_content_buf[8];
-            const char *tpl_content = p->frame.tpl.has_tpl ? (snprintf(tpl_content_buf, sizeof(tpl_content_buf), "%u", p->frame.tpl.tpl.cfg_info.content), tpl_content_buf) : "null";
-            char tpl_index_buf[8];
-            const char *tpl_index = p->frame.tpl.has_tpl ? (snprintf(tpl_index_buf, sizeof(tpl_index_buf), "%u", p->frame.tpl.tpl.cfg_info.content_index), tpl_index_buf) : "null";
-            char sec_mode_buf[8];
-            const char *sec_mode = (p->frame.tpl.tpl.header_type && p->frame.tpl.sec.security_mode) ? (snprintf(sec_mode_buf, sizeof(sec_mode_buf), "%u", p->frame.tpl.sec.security_mode), sec_mode_buf) : "null";
-            char sec_len_buf[12];
-            const char *sec_len = (p->frame.tpl.sec.enc_len) ? (snprintf(sec_len_buf, sizeof(sec_len_buf), "%u", p->frame.tpl.sec.enc_len), sec_len_buf) : "null";
-            char ell_ext_buf[20] = {0};
-            if (p->frame.ell.has_ell && p->frame.ell.ell.ext_len)
+            else
             {
-                for (uint8_t j = 0; j < p->frame.ell.ell.ext_len && (j * 2 + 2) < sizeof(ell_ext_buf); j++)
-                {
-                    snprintf(ell_ext_buf + j * 2, sizeof(ell_ext_buf) - j * 2, "%02X", p->frame.ell.ell.ext[j]);
-                }
+                tok_long = true;
+            }
+        }
+    }
+    return (tok_long || !filter_add_token(tok, tok_len, keys, count)) ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+static esp_err_t handle_filter_set(httpd_req_t *req)
+{
+    char query[64] = {0};
+    char mode_str[8] = {0};
+    char clear[4] = {0};
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+    {
+        httpd_query_key_value(query, "mode", mode_str, sizeof(mode_str));
+        httpd_query_key_value(query, "clear", clear, sizeof(clear));
+    }
+    app_filter_status_t cur = {0};
+    services_get_addr_filter_status(&cur);
+    addr_filter_mode_t mode = (addr_filter_mode_t)cur.mode;
+    if (mode_str[0] && !addr_filter_parse_mode(mode_str, &mode))
+    {
+        return send_err(req, "400", "{\"error\":\"mode must be off, allow or deny\"}");
+    }
+    if (req->content_len > (size_t)APP_ADDR_FILTER_MAX * (ADDR_FILTER_ENTRY_CHARS + 2))
+    {
+        return send_err(req, "400", "{\"error\":\"too many entries\"}");
+    }
+
+    // A body replaces the list, clear=1 empties it, neither keeps it
+    uint64_t *keys = NULL;
+    uint32_t count = 0;
+    if (req->content_len > 0 || clear[0] == '1')
+    {
+        keys = malloc(APP_ADDR_FILTER_MAX * sizeof(uint64_t));
+        if (!keys)
+        {
+            return httpd_resp_send_500(req);
+        }
+        esp_err_t err = (req->content_len > 0) ? recv_filter_list(req, keys, &count) : ESP_OK;
+        if (err != ESP_OK)
+        {
+            free(keys);
+            if (err == ESP_FAIL)
+            {
+                return ESP_FAIL;
             }
-            const char *ell_ext = (p->frame.ell.has_ell && p->frame.ell.ell.ext_len) ? ell_ext_buf : "null";
-            char ell_cc_buf[8];
-            const char *ell_cc = p->frame.ell.has_ell ? (snprintf(ell_cc_buf, sizeof(ell_cc_buf), "%u", p->frame.ell.ell.cc), ell_cc_buf) : "null";
-            char ell_acc_buf[8];
-            const char *ell_acc = p->frame.ell.has_ell ? (snprintf(ell_acc_buf, sizeof(ell_acc_buf), "%u", p->frame.ell.ell.acc), ell_acc_buf) : "null";
-            char afl_tag_buf[8];
-            const char *afl_tag = p->frame.afl.has_afl ? (snprintf(afl_tag_buf, sizeof(afl_tag_buf), "%u", p->frame.afl.afl.tag), afl_tag_buf) : "null";
-            char afl_afll_buf[8];
-            const char *afl_afll = p->frame.afl.has_afl ? (snprintf(afl_afll_buf, sizeof(afl_afll_buf), "%u", p->frame.afl.afl.afll), afl_afll_buf) : "null";
-            char afl_mcl_buf[8];
-            const char *afl_mcl = p->frame.afl.has_afl ? (snprintf(afl_mcl_buf, sizeof(afl_mcl_buf), "%u", p->frame.afl.afl.mcl), afl_mcl_buf) : "null";
-            char raw_hex_value[PKT_RAW_MAX * 2 + 1];
-            char raw_hex_json[PKT_RAW_MAX * 2 + 3];
-            const char *raw_hex = "null";
-            if (p->raw_len > 0)
+            return send_err(req, "400", (count >= APP_ADDR_FILTER_MAX) ? "{\"error\":\"too many entries\"}"
+                                                                        : "{\"error\":\"bad address, expected MAN-12345678 or 12345678\"}");
+        }
+    }
+    esp_err_t err = services_set_addr_filter(s_services, (uint8_t)mode, keys, count);
+    free(keys);
+    if (err == ESP_ERR_INVALID_ARG)
+    {
+        return send_err(req, "400", "{\"error\":\"invalid filter\"}");
+    }
+    return send_ok(req);
+}
+
+static esp_err_t handle_filter_get(httpd_req_t *req)
+{
+    app_filter_status_t st = {0};
+    services_get_addr_filter_status(&st);
+    app_rx_status_t rx = {0};
+    app_get_rx_status(&rx);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    char head[192];
+    snprintf(head, sizeof(head),
+             "{\"mode\":\"%s\",\"count\":%" PRIu32 ",\"capacity\":%" PRIu32 ",\"filtered\":%" PRIu32 ",\"filtered_bytes\":%" PRIu32 ",\"entries\":[",
+             addr_filter_mode_name((addr_filter_mode_t)st.mode), st.count, st.capacity, rx.filtered, rx.filtered_bytes);
+    if (httpd_resp_sendstr_chunk(req, head) != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+
+    // Entries go out in slices so the list is never copied or rendered whole
+    uint64_t keys[32];
+    char chunk[sizeof(keys) / sizeof(keys[0]) * (ADDR_FILTER_ENTRY_CHARS + 3) + 1];
+    uint32_t offset = 0;
+    uint32_t n;
+    while ((n = services_get_addr_filter_keys(offset, keys, sizeof(keys) / sizeof(keys[0]))) > 0)
+    {
+        size_t len = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            if (offset + i > 0)
             {
-                bytes_to_hex(p->raw, p->raw_len, raw_hex_value, sizeof(raw_hex_value));
-                snprintf(raw_hex_json, sizeof(raw_hex_json), "\"%s\"", raw_hex_value);
-                raw_hex = raw_hex_json;
+                chunk[len++] = ',';
             }
-            char entry[1024];
-            int written = snprintf(entry, sizeof(entry),
-                                   "%s{\"gateway\":\"%s\",\"manuf\":%u,\"id\":\"%s\",\"control\":%u,\"dev_type\":%u,"
-                                   "\"version\":%u,\"ci\":%u,\"ci_class\":%u,\"hdr\":\"%s\",\"acc\":%s,\"status\":%s,\"cfg\":%s,"
-                                   "\"tpl_ci\":%s,\"tpl_mode\":%s,\"tpl_content\":%s,\"tpl_index\":%s,"
-                                   "\"sec_mode\":%s,\"sec_len\":%s,\"encrypted\":%s,"
-                                   "\"ell_cc\":%s,\"ell_acc\":%s,\"ell_ext\":%s,"
-                                   "\"afl_tag\":%s,\"afl_afll\":%s,\"afl_mcl\":%s,\"afl_offset\":%" PRIu16 ",\"afl_payload_len\":%" PRIu16 ","
-                                   "\"raw_hex\":%s,"
-                                   "\"rssi\":%.1f,\"payload_len\":%" PRIu32 "}",
-                                   (i == 0) ? "" : ",",
-                                   p->frame.dll.gateway,
-                                   p->frame.dll.manuf,
-                                   p->frame.dll.id_str,
-                                   p->frame.dll.c,
-                                   p->frame.dll.dev_type,
-                                   p->frame.dll.version,
-                                   p->frame.dll.ci,
-                                   p->frame.ci_class,
-                                   hdr,
-                                   acc,
-                                   status,
-                                   cfg,
-                                   tpl_ci,
-                                   tpl_mode,
-                                   tpl_content,
-                                   tpl_index,
-                                   sec_mode,
-                                   sec_len,
-                                   p->frame.encrypted ? "true" : "false",
-                                   ell_cc,
-                                   ell_acc,
-                                   ell_ext,
-                                   afl_tag,
-                                   afl_afll,
-                                   afl_mcl,
-                                   p->frame.afl.afl.offset,
-                                   p->frame.afl.afl.payload_len,
-                                   raw_hex,
-                                   p->rssi,
-                                   p->payload_len);
-            if (written < 0)
+            chunk[len++] = '"';
+            addr_filter_format_entry(keys[i], &chunk[len]);
+            len += strlen(&chunk[len]);
+            chunk[len++] = '"';
+        }
+        if (httpd_resp_send_chunk(req, chunk, len) != ESP_OK)
+        {
+            return ESP_FAIL;
+        }
+        offset += n;
+    }
+    httpd_resp_sendstr_chunk(req, "]}");
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Compile the filter= query parameter (absent or empty = match all). On a syntax
+// error the 400 response is sent, *resp holds its result and false is returned.
+static bool query_filter(httpd_req_t *req, const char *query, frame_filter_t *out, esp_err_t *resp)
+{
+    char expr[FRAME_FILTER_EXPR_MAX] = {0};
+    if (query && httpd_query_key_value(query, "filter", expr, sizeof(expr)) == ESP_ERR_HTTPD_RESULT_TRUNC)
+    {
+        *resp = send_err(req, "400", "{\"error\":\"filter too long\"}");
+        return false;
+    }
+    url_decode_inplace(expr);
+    size_t pos = 0;
+    const esp_err_t err = frame_filter_compile(expr, out, &pos);
+    if (err != ESP_OK)
+    {
+        char msg[96];
+        if (err == ESP_ERR_INVALID_SIZE)
+        {
+            snprintf(msg, sizeof(msg), "{\"error\":\"filter too complex\"}");
+        }
+        else
+        {
+            snprintf(msg, sizeof(msg), "{\"error\":\"filter syntax error at character %u\"}", (unsigned)pos + 1);
+        }
+        *resp = send_err(req, "400", msg);
+        return false;
+    }
+    return true;
+}
+
+// POST /api/sinks?name=...&filter=... attaches a filter to a router sink (empty clears it).
+static esp_err_t handle_sink_filter(httpd_req_t *req)
+{
+    char query[FRAME_FILTER_EXPR_MAX * 3 + 48] = {0};
+    char name[WMBUS_SINK_NAME_MAX] = {0};
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "name", name, sizeof(name)) != ESP_OK)
+    {
+        return send_err(req, "400", "{\"error\":\"name required\"}");
+    }
+    frame_filter_t filter;
+    esp_err_t resp;
+    if (!query_filter(req, query, &filter, &resp))
+    {
+        return resp;
+    }
+    if (wmbus_packet_router_set_filter(name, &filter) != ESP_OK)
+    {
+        return send_err(req, "404", "{\"error\":\"no such sink\"}");
+    }
+    return send_ok(req);
+}
+
+static esp_err_t handle_packets_stream(httpd_req_t *req)
+{
+    char query[FRAME_FILTER_EXPR_MAX * 3 + 16] = {0};
+    const bool has_query = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK;
+    frame_filter_t filter;
+    esp_err_t resp;
+    if (!query_filter(req, has_query ? query : NULL, &filter, &resp))
+    {
+        return resp;
+    }
+
+    // ?since=<seq> returns only newer frames, ?limit=N at most N entries
+    char num[12] = {0};
+    const bool has_since = has_query && httpd_query_key_value(query, "since", num, sizeof(num)) == ESP_OK;
+    const uint32_t since = has_since ? (uint32_t)strtoul(num, NULL, 10) : 0;
+    size_t max_entries = APP_UI_PACKETS;
+    if (has_query && httpd_query_key_value(query, "limit", num, sizeof(num)) == ESP_OK)
+    {
+        const unsigned long n = strtoul(num, NULL, 10);
+        max_entries = (n < APP_UI_PACKETS_MAX) ? (size_t)n : APP_UI_PACKETS_MAX;
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    char chunk[APP_JSON_CHUNK];
+    json_writer_t w;
+    json_init(&w, chunk, sizeof(chunk), json_send_chunk, req);
+    json_obj_begin(&w, NULL);
+    json_arr_begin(&w, "packets");
+
+    // Newest first, one record copied out at a time; frames arriving meanwhile are left for the next request
+    wmbus_frame_history_stats_t info = {0};
+    wmbus_history_entry_t rec;
+    wmbus_frame_history_iter_t it = {0};
+    if (s_pkt_ready)
+    {
+        wmbus_frame_history_get_stats(&s_pkt_history, &info);
+        wmbus_frame_history_iter_begin(&s_pkt_history, &it);
+    }
+    uint32_t head = info.seq;
+    uint32_t oldest_read = 0;
+    bool reached = false;
+    bool truncated = false;
+    size_t emitted = 0;
+    while (w.err == ESP_OK && wmbus_frame_history_iter_next(&s_pkt_history, &it, &rec))
+    {
+        head = (rec.meta.seq > head) ? rec.meta.seq : head;
+        if (has_since && rec.meta.seq <= since)
+        {
+            reached = true;
+            break;
+        }
+        if (emitted == max_entries)
+        {
+            truncated = true;
+            break;
+        }
+        oldest_read = rec.meta.seq;
+        pkt_entry_t entry_view;
+        pkt_entry_from_record(&rec, &entry_view);
+        if (!pkt_entry_match(&filter, &entry_view))
+        {
+            continue;
+        }
+        pkt_entry_write(&w, &entry_view);
+        emitted++;
+    }
+    json_arr_end(&w);
+    // Cursor from before a reboot, or frames after it no longer (or not all) in the reply
+    const uint32_t first_seq = oldest_read ? oldest_read : head + 1;
+    const bool reset = has_since && (since > head || truncated || (!reached && first_seq > since + 1));
+    json_u32(&w, "seq", head);
+    if (reset)
+    {
+        json_bool(&w, "reset", true);
+    }
+    json_obj_end(&w);
+    if (json_finish(&w) != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// ?offset=N&limit=M pages through the meter table in row order
+static esp_err_t handle_meters(httpd_req_t *req)
+{
+    char query[48] = {0};
+    const bool has_query = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK;
+    char num[12] = {0};
+    uint32_t offset = 0;
+    uint32_t limit = APP_UI_METERS;
+    if (has_query && httpd_query_key_value(query, "offset", num, sizeof(num)) == ESP_OK)
+    {
+        offset = (uint32_t)strtoul(num, NULL, 10);
+    }
+    if (has_query && httpd_query_key_value(query, "limit", num, sizeof(num)) == ESP_OK)
+    {
+        const unsigned long n = strtoul(num, NULL, 10);
+        limit = (n < APP_METERS) ? (uint32_t)n : APP_METERS;
+    }
+
+    app_meters_status_t table = {0};
+    app_get_meters_status(&table);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    char chunk[APP_JSON_CHUNK];
+    json_writer_t w;
+    json_init(&w, chunk, sizeof(chunk), json_send_chunk, req);
+    json_obj_begin(&w, NULL);
+    JSON_FIELDS(&w, &table, METERS_JSON);
+    json_ratio(&w, "rx_1h", table.received_1h, table.expected_1h);
+    json_ratio(&w, "rx_24h", table.received_24h, table.expected_24h);
+    json_u32(&w, "offset", offset);
+    json_u32(&w, "now_ms", (uint32_t)(esp_timer_get_time() / 1000));
+    json_arr_begin(&w, "meters");
+    // One row copied at a time, so the table lock is never held across a send
+    app_meter_status_t m;
+    for (uint32_t i = 0; i < limit && w.err == ESP_OK && app_get_meter(offset + i, &m); i++)
+    {
+        const uint8_t id[4] = {m.id[3], m.id[2], m.id[1], m.id[0]};
+        json_obj_begin(&w, NULL);
+        json_u32(&w, "manuf", m.manuf);
+        json_hex(&w, "id", id, sizeof(id));
+        JSON_FIELDS(&w, &m, METER_JSON);
+        json_fixed1(&w, "rssi_avg", m.rssi_avg);
+        json_fixed1(&w, "rssi_min", m.rssi_min);
+        json_fixed1(&w, "rssi_max", m.rssi_max);
+        json_u32_opt(&w, "acc", m.has_acc, m.acc);
+        json_ratio(&w, "rx_1h", m.received_1h, m.expected_1h);
+        json_ratio(&w, "rx_24h", m.received_24h, m.expected_24h);
+        json_obj_end(&w);
+    }
+    json_arr_end(&w);
+    json_obj_end(&w);
+    if (json_finish(&w) != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static esp_err_t sse_send(void *ctx, const char *data, size_t len)
+{
+    const int fd = (int)(intptr_t)ctx;
+    while (len > 0)
+    {
+        const int n = httpd_socket_send(s_server, fd, data, len, 0);
+        if (n <= 0)
+        {
+            return ESP_FAIL;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return ESP_OK;
+}
+
+// One event for rec unless the client's filter rejects it.
+static esp_err_t sse_send_record(int fd, const frame_filter_t *filter, const wmbus_history_entry_t *rec)
+{
+    pkt_entry_t entry_view;
+    pkt_entry_from_record(rec, &entry_view);
+    if (!pkt_entry_match(filter, &entry_view))
+    {
+        return ESP_OK;
+    }
+    char chunk[APP_JSON_CHUNK];
+    char id[24];
+    const int id_len = snprintf(id, sizeof(id), "id: %" PRIu32 "\ndata: ", rec->meta.seq);
+    json_writer_t w;
+    json_init(&w, chunk, sizeof(chunk), sse_send, (void *)(intptr_t)fd);
+    json_raw(&w, id, (size_t)id_len);
+    pkt_entry_write(&w, &entry_view);
+    json_raw(&w, "\n\n", 2);
+    const esp_err_t err = json_finish(&w);
+    if (err == ESP_OK)
+    {
+        s_sse_sent++;
+    }
+    return err;
+}
+
+// httpd work item: send one stream client the frames it has not seen, one event each.
+static void sse_work(void *arg)
+{
+    const uintptr_t slot = (uintptr_t)arg & 0xF;
+    const uint32_t gen = (uint32_t)((uintptr_t)arg >> 4);
+    sse_client_t *c = &s_sse[slot];
+    wmbus_history_entry_t rec;
+    while (true)
+    {
+        wmbus_frame_history_stats_t info;
+        portENTER_CRITICAL(&s_sse_lock);
+        // Read under the lock: a frame recorded after this finds work_queued cleared and wakes us again
+        wmbus_frame_history_get_stats(&s_pkt_history, &info);
+        if (c->gen != gen || c->fd < 0 || c->closing || c->next > info.seq)
+        {
+            if (c->gen == gen)
             {
-                continue;
+                c->work_queued = false;
             }
-            // Ensure chunked send does not include truncated garbage
-            entry[sizeof(entry) - 1] = '\0';
-            if (httpd_resp_send_chunk(req, entry, strlen(entry)) != ESP_OK)
+            portEXIT_CRITICAL(&s_sse_lock);
+            return;
+        }
+        const uint32_t seq = c->next;
+        const int fd = c->fd;
+        portEXIT_CRITICAL(&s_sse_lock);
+
+        // Filter and socket are only used by this task, so no lock while sending
+        esp_err_t err = ESP_ERR_NOT_FOUND;
+        if (wmbus_frame_history_get(&s_pkt_history, seq, &rec))
+        {
+            err = sse_send_record(fd, &c->filter, &rec);
+        }
+        else
+        {
+            ESP_LOGW(TAG, "packet stream client %d fell behind the history, closing", fd);
+        }
+        portENTER_CRITICAL(&s_sse_lock);
+        if (c->gen == gen)
+        {
+            c->next = seq + 1;
+            if (err != ESP_OK)
             {
-                break;
+                c->closing = true;
+                c->work_queued = false;
             }
         }
-        xSemaphoreGive(s_pkt_mutex);
+        portEXIT_CRITICAL(&s_sse_lock);
+        if (err != ESP_OK)
+        {
+            httpd_sess_trigger_close(s_server, fd);
+            return;
+        }
     }
-    const char *end = "]}";
-    httpd_resp_send_chunk(req, end, strlen(end));
-    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Server-Sent Events: every recorded frame is pushed once as an /api/packets entry
+// (event id = frame sequence). Takes ?filter= like /api/packets.
+static esp_err_t handle_packets_sse(httpd_req_t *req)
+{
+    char query[FRAME_FILTER_EXPR_MAX * 3 + 16] = {0};
+    const bool has_query = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK;
+    frame_filter_t filter;
+    esp_err_t resp;
+    if (!query_filter(req, has_query ? query : NULL, &filter, &resp))
+    {
+        return resp;
+    }
+
+    const int fd = httpd_req_to_sockfd(req);
+    portENTER_CRITICAL(&s_sse_lock);
+    sse_client_t *c = NULL;
+    for (size_t i = 0; i < APP_SSE_CLIENTS && !c; i++)
+    {
+        c = (s_sse[i].fd < 0) ? &s_sse[i] : NULL;
+    }
+    portEXIT_CRITICAL(&s_sse_lock);
+    if (!c)
+    {
+        return send_err(req, "503", "{\"error\":\"too many packet streams\"}");
+    }
+
+    // Raw head: the body is written straight to the socket for the life of the connection
+    static const char head[] = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+                               "Cache-Control: no-store\r\nConnection: keep-alive\r\n\r\nretry: 3000\n\n";
+    if (httpd_send(req, head, sizeof(head) - 1) != (int)(sizeof(head) - 1))
+    {
+        return ESP_FAIL;
+    }
+    // Only this task assigns slots, so the free slot is still free
+    wmbus_frame_history_stats_t info;
+    portENTER_CRITICAL(&s_sse_lock);
+    wmbus_frame_history_get_stats(&s_pkt_history, &info);
+    c->gen = ++s_sse_gen & 0x0FFFFFFF;
+    c->fd = fd;
+    c->closing = false;
+    c->work_queued = false;
+    c->next = info.seq + 1;
+    c->filter = filter;
+    portEXIT_CRITICAL(&s_sse_lock);
+    ESP_LOGI(TAG, "packet stream client %d connected", fd);
+    return ESP_OK;
+}
+
+// Session close hook: release a stream client's slot, then close the socket.
+static void on_sock_close(httpd_handle_t hd, int fd)
+{
+    (void)hd;
+    portENTER_CRITICAL(&s_sse_lock);
+    for (size_t i = 0; i < APP_SSE_CLIENTS; i++)
+    {
+        if (s_sse[i].fd == fd)
+        {
+            s_sse[i].fd = -1;
+            s_sse[i].gen = 0;
+        }
+    }
+    portEXIT_CRITICAL(&s_sse_lock);
+    close(fd);
 }
 
 static const httpd_uri_t URI_ROOT = {.uri = "/", .method = HTTP_GET, .handler = handle_root};
@@ -575,7 +1364,12 @@ static const httpd_uri_t URI_BACKEND_TEST = {.uri = "/api/backend/test", .method
 static const httpd_uri_t URI_WIFI = {.uri = "/api/wifi", .method = HTTP_POST, .handler = handle_wifi};
 static const httpd_uri_t URI_AP = {.uri = "/api/ap", .method = HTTP_POST, .handler = handle_ap};
 static const httpd_uri_t URI_RADIO = {.uri = "/api/radio", .method = HTTP_POST, .handler = handle_radio};
+static const httpd_uri_t URI_FILTER_GET = {.uri = "/api/filter", .method = HTTP_GET, .handler = handle_filter_get};
+static const httpd_uri_t URI_FILTER_SET = {.uri = "/api/filter", .method = HTTP_POST, .handler = handle_filter_set};
 static const httpd_uri_t URI_PKTS = {.uri = "/api/packets", .method = HTTP_GET, .handler = handle_packets_stream};
+static const httpd_uri_t URI_PKTS_SSE = {.uri = "/api/packets/stream", .method = HTTP_GET, .handler = handle_packets_sse};
+static const httpd_uri_t URI_METERS = {.uri = "/api/meters", .method = HTTP_GET, .handler = handle_meters};
+static const httpd_uri_t URI_SINKS = {.uri = "/api/sinks", .method = HTTP_POST, .handler = handle_sink_filter};
 static const httpd_uri_t URI_STATIC_ICON = {.uri = "/static/icons/*", .method = HTTP_GET, .handler = handle_static_icon};
 static const httpd_uri_t URI_STATIC_JS = {.uri = "/static/app.js", .method = HTTP_GET, .handler = handle_static_js};
 static const httpd_uri_t URI_STATIC_CSS = {.uri = "/static/style.css", .method = HTTP_GET, .handler = handle_static_css};
@@ -605,13 +1399,19 @@ esp_err_t http_server_start(services_state_t *svc)
         return ESP_OK;
     }
     s_services = svc;
-    s_pkt_mutex = xSemaphoreCreateMutex();
+    s_pkt_ready = wmbus_frame_history_init(&s_pkt_history, s_pkt_ring, sizeof(s_pkt_ring)) == ESP_OK;
+    for (size_t i = 0; i < APP_SSE_CLIENTS; i++)
+    {
+        s_sse[i].fd = -1;
+    }
 
     httpd_config_t cfg = HTTPD_DEFAULT_CONFIG();
-    cfg.stack_size = 6144;
+    cfg.stack_size = 8192;
     cfg.server_port = 80;
     cfg.uri_match_fn = httpd_uri_match_wildcard;
-    cfg.max_uri_handlers = 16;
+    cfg.max_uri_handlers = 20;
+    cfg.close_fn = on_sock_close;
+    cfg.lru_purge_enable = true; // A forgotten stream tab must not starve new requests of sockets
 
     esp_err_t err = httpd_start(&s_server, &cfg);
     if (err != ESP_OK)
@@ -627,7 +1427,12 @@ esp_err_t http_server_start(services_state_t *svc)
     httpd_register_uri_handler(s_server, &URI_WIFI);
     httpd_register_uri_handler(s_server, &URI_AP);
     httpd_register_uri_handler(s_server, &URI_RADIO);
+    httpd_register_uri_handler(s_server, &URI_FILTER_GET);
+    httpd_register_uri_handler(s_server, &URI_FILTER_SET);
     httpd_register_uri_handler(s_server, &URI_PKTS);
+    httpd_register_uri_handler(s_server, &URI_PKTS_SSE);
+    httpd_register_uri_handler(s_server, &URI_METERS);
+    httpd_register_uri_handler(s_server, &URI_SINKS);
     httpd_register_uri_handler(s_server, &URI_STATIC_JS);
     httpd_register_uri_handler(s_server, &URI_STATIC_CSS);
     httpd_register_uri_handler(s_server, &URI_STATIC_ICON);
@@ -652,7 +1457,8 @@ esp_err_t http_server_register_packet_sink(void)
     {
         return ESP_OK;
     }
-    esp_err_t err = wmbus_packet_router_register(http_pkt_sink, NULL);
+    const wmbus_sink_opts_t opts = {.name = "packets"};
+    esp_err_t err = wmbus_packet_router_register_ex(http_pkt_sink, NULL, &opts);
     if (err == ESP_OK)
     {
         s_sink_registered = true;
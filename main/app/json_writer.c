@@ -0,0 +1,270 @@
+#include "app/json_writer.h"
+
+#include <string.h>
+
+static const char HEX[] = "0123456789ABCDEF";
+
+// Hand the buffer to the callback; false once the writer has failed.
+static bool drain(json_writer_t *w)
+{
+    if (w->err != ESP_OK)
+    {
+        return false;
+    }
+    if (!w->flush)
+    {
+        w->err = ESP_ERR_NO_MEM;
+        return false;
+    }
+    const esp_err_t err = w->flush(w->ctx, w->buf, w->len);
+    w->flushed += w->len;
+    w->len = 0;
+    if (err != ESP_OK)
+    {
+        w->err = err;
+        return false;
+    }
+    return true;
+}
+
+static void put(json_writer_t *w, const char *s, size_t n)
+{
+    while (n > 0)
+    {
+        if (w->len == w->cap && !drain(w))
+        {
+            return;
+        }
+        size_t k = w->cap - w->len;
+        k = (n < k) ? n : k;
+        memcpy(w->buf + w->len, s, k);
+        w->len += k;
+        s += k;
+        n -= k;
+    }
+}
+
+static inline void put_char(json_writer_t *w, char c)
+{
+    if (w->len < w->cap || drain(w))
+    {
+        w->buf[w->len++] = c;
+    }
+}
+
+// Separator and "key": ahead of a value
+static void lead(json_writer_t *w, const char *key)
+{
+    if (!w->first)
+    {
+        put_char(w, ',');
+    }
+    w->first = false;
+    if (key)
+    {
+        put_char(w, '"');
+        put(w, key, strlen(key));
+        put(w, "\":", 2);
+    }
+}
+
+static void put_u32(json_writer_t *w, uint32_t v)
+{
+    char tmp[10];
+    size_t i = sizeof(tmp);
+    do
+    {
+        tmp[--i] = (char)('0' + (v % 10));
+        v /= 10;
+    } while (v);
+    put(w, tmp + i, sizeof(tmp) - i);
+}
+
+void json_init(json_writer_t *w, char *buf, size_t cap, json_flush_fn flush, void *ctx)
+{
+    w->buf = buf;
+    w->cap = cap;
+    w->len = 0;
+    w->flushed = 0;
+    w->flush = flush;
+    w->ctx = ctx;
+    w->err = (buf && cap) ? ESP_OK : ESP_ERR_INVALID_ARG;
+    w->first = true;
+}
+
+esp_err_t json_finish(json_writer_t *w)
+{
+    if (w->flush && w->len > 0)
+    {
+        drain(w);
+    }
+    return w->err;
+}
+
+void json_obj_begin(json_writer_t *w, const char *key)
+{
+    lead(w, key);
+    put_char(w, '{');
+    w->first = true;
+}
+
+void json_obj_end(json_writer_t *w)
+{
+    put_char(w, '}');
+    w->first = false;
+}
+
+void json_arr_begin(json_writer_t *w, const char *key)
+{
+    lead(w, key);
+    put_char(w, '[');
+    w->first = true;
+}
+
+void json_arr_end(json_writer_t *w)
+{
+    put_char(w, ']');
+    w->first = false;
+}
+
+void json_null(json_writer_t *w, const char *key)
+{
+    lead(w, key);
+    put(w, "null", 4);
+}
+
+void json_bool(json_writer_t *w, const char *key, bool v)
+{
+    lead(w, key);
+    if (v)
+    {
+        put(w, "true", 4);
+    }
+    else
+    {
+        put(w, "false", 5);
+    }
+}
+
+void json_u32(json_writer_t *w, const char *key, uint32_t v)
+{
+    lead(w, key);
+    put_u32(w, v);
+}
+
+void json_i32(json_writer_t *w, const char *key, int32_t v)
+{
+    lead(w, key);
+    if (v < 0)
+    {
+        put_char(w, '-');
+    }
+    put_u32(w, (v < 0) ? (uint32_t)0 - (uint32_t)v : (uint32_t)v);
+}
+
+void json_fixed1(json_writer_t *w, const char *key, int32_t tenths)
+{
+    lead(w, key);
+    const uint32_t mag = (tenths < 0) ? (uint32_t)0 - (uint32_t)tenths : (uint32_t)tenths;
+    if (tenths < 0)
+    {
+        put_char(w, '-');
+    }
+    put_u32(w, mag / 10);
+    put_char(w, '.');
+    put_char(w, (char)('0' + mag % 10));
+}
+
+void json_str(json_writer_t *w, const char *key, const char *s)
+{
+    if (!s)
+    {
+        json_null(w, key);
+        return;
+    }
+    lead(w, key);
+    put_char(w, '"');
+    const char *run = s;
+    for (; *s; s++)
+    {
+        const unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        put(w, run, (size_t)(s - run));
+        run = s + 1;
+        if (c == '"' || c == '\\')
+        {
+            const char esc[2] = {'\\', (char)c};
+            put(w, esc, 2);
+        }
+        else
+        {
+            const char esc[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF]};
+            put(w, esc, 6);
+        }
+    }
+    put(w, run, (size_t)(s - run));
+    put_char(w, '"');
+}
+
+void json_hex(json_writer_t *w, const char *key, const uint8_t *bytes, size_t len)
+{
+    lead(w, key);
+    put_char(w, '"');
+    for (size_t i = 0; i < len; i++)
+    {
+        // Two digits at once while the chunk has room
+        if (w->cap - w->len >= 2)
+        {
+            w->buf[w->len++] = HEX[bytes[i] >> 4];
+            w->buf[w->len++] = HEX[bytes[i] & 0xF];
+            continue;
+        }
+        put_char(w, HEX[bytes[i] >> 4]);
+        put_char(w, HEX[bytes[i] & 0xF]);
+    }
+    put_char(w, '"');
+}
+
+void json_raw(json_writer_t *w, const char *s, size_t len)
+{
+    put(w, s, len);
+}
+
+void json_write_fields(json_writer_t *w, const void *obj, const json_field_t *fields, size_t count)
+{
+    const uint8_t *base = (const uint8_t *)obj;
+    for (size_t i = 0; i < count; i++)
+    {
+        const json_field_t *f = &fields[i];
+        const void *p = base + f->offset;
+        switch (f->type)
+        {
+        case JSON_T_BOOL:
+            json_bool(w, f->key, *(const bool *)p);
+            break;
+        case JSON_T_U8:
+            json_u32(w, f->key, *(const uint8_t *)p);
+            break;
+        case JSON_T_U16:
+            json_u32(w, f->key, *(const uint16_t *)p);
+            break;
+        case JSON_T_U32:
+            json_u32(w, f->key, *(const uint32_t *)p);
+            break;
+        case JSON_T_INT:
+            json_i32(w, f->key, *(const int *)p);
+            break;
+        case JSON_T_STR:
+            json_str(w, f->key, (const char *)p);
+            break;
+        case JSON_T_CSTR:
+            json_str(w, f->key, *(const char *const *)p);
+            break;
+        default:
+            break;
+        }
+    }
+}
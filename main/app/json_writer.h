@@ -0,0 +1,83 @@
+// Streaming JSON writer. Values are appended straight into a caller-supplied
+// chunk buffer; a full buffer is handed to the flush callback (an httpd chunk,
+// an HTTP client write) and reused, so a body of any size needs no heap and no
+// per-field scratch strings. Without a callback the buffer holds the whole
+// document and running out of room is an error.
+//
+// Commas are placed automatically: pass the key inside objects and NULL inside
+// arrays. Errors are sticky; check json_finish() once at the end.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef esp_err_t (*json_flush_fn)(void *ctx, const char *data, size_t len);
+
+typedef struct
+{
+    char *buf;
+    size_t cap;
+    size_t len;     // Bytes waiting in buf
+    size_t flushed; // Bytes already handed to flush
+    json_flush_fn flush;
+    void *ctx;
+    esp_err_t err;  // First failure: ESP_ERR_NO_MEM without flush, else the flush result
+    bool first;     // Next value opens its container (no comma)
+} json_writer_t;
+
+// Field types of a json_field_t descriptor.
+typedef enum
+{
+    JSON_T_BOOL,
+    JSON_T_U8,
+    JSON_T_U16,
+    JSON_T_U32,
+    JSON_T_INT,
+    JSON_T_STR,  // char array member
+    JSON_T_CSTR, // const char * member (NULL writes null)
+} json_type_t;
+
+// One struct member written as "key":value by json_write_fields.
+typedef struct
+{
+    const char *key;
+    uint8_t type; // json_type_t
+    uint16_t offset;
+} json_field_t;
+
+#define JSON_FIELD(st, type_, key_, member) {.key = (key_), .type = JSON_T_##type_, .offset = (uint16_t)offsetof(st, member)}
+
+void json_init(json_writer_t *w, char *buf, size_t cap, json_flush_fn flush, void *ctx);
+
+// Flush what is left (with a callback) and return the first error, if any.
+esp_err_t json_finish(json_writer_t *w);
+
+// Bytes produced so far, flushed or not.
+static inline size_t json_size(const json_writer_t *w)
+{
+    return w->flushed + w->len;
+}
+
+void json_obj_begin(json_writer_t *w, const char *key);
+void json_obj_end(json_writer_t *w);
+void json_arr_begin(json_writer_t *w, const char *key);
+void json_arr_end(json_writer_t *w);
+
+void json_null(json_writer_t *w, const char *key);
+void json_bool(json_writer_t *w, const char *key, bool v);
+void json_u32(json_writer_t *w, const char *key, uint32_t v);
+void json_i32(json_writer_t *w, const char *key, int32_t v);
+// Fixed point with one decimal: -675 writes -67.5.
+void json_fixed1(json_writer_t *w, const char *key, int32_t tenths);
+// Escaped string; NULL writes null.
+void json_str(json_writer_t *w, const char *key, const char *s);
+// Bytes as a quoted upper-case hex string.
+void json_hex(json_writer_t *w, const char *key, const uint8_t *bytes, size_t len);
+
+// Verbatim bytes around or between documents (e.g. SSE framing); no comma logic.
+void json_raw(json_writer_t *w, const char *s, size_t len);
+
+// Members of obj listed in fields, in order.
+void json_write_fields(json_writer_t *w, const void *obj, const json_field_t *fields, size_t count);
@@ -4,11 +4,21 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "esp_err.h"
+#include "app/net/uplink_format.h"
 #include "app/wmbus/packet_router.h"
 
+typedef struct
+{
+    uint16_t max_frames; // Flush once this many frames are buffered
+    uint16_t max_age_ms; // ... or the oldest one waited this long (0: send every frame at once)
+    uint16_t max_bytes;  // ... or the JSON body reached this size
+} backend_batch_t;
+
 typedef struct
 {
     char url[192]; // e.g., http://host:port/path (kept short on purpose)
+    backend_batch_t batch;
+    uplink_format_t format; // Body encoding of the next batch
 } backend_config_t;
 
 // Initialize backend config (load from NVS or keep empty).
@@ -19,8 +29,11 @@ esp_err_t backend_set_url(backend_config_t *cfg, const char *url);
 // Read current URL into buffer; buffer is null-terminated.
 esp_err_t backend_get_url(const backend_config_t *cfg, char *out, size_t out_len);
 
+// Set/persist batching thresholds; ESP_ERR_INVALID_ARG when out of range.
+esp_err_t backend_set_batch(backend_config_t *cfg, const backend_batch_t *batch);
+
+// Set/persist the uplink body encoding; ESP_ERR_INVALID_ARG when unknown.
+esp_err_t backend_set_format(backend_config_t *cfg, uplink_format_t format);
+
 // Check reachability (HEAD); timeout in ms.
 esp_err_t backend_check_url(const char *url, int timeout_ms);
-
-// Forward packet to backend (POST JSON). Requires non-empty cfg->url.
-esp_err_t backend_forward_packet(const backend_config_t *cfg, const WmbusPacketEvent *evt);
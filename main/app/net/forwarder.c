@@ -0,0 +1,520 @@
+#include "app/net/forwarder.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_http_client.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "wmbus/pipeline.h"
+#include "wmbus/packet.h"
+#include "app/net/framelog.h"
+#include "app/net/uplink_format.h"
+#include "app/net/wifi.h"
+#include "app/config.h"
+
+static const char *TAG = "forwarder";
+
+// Largest body: threshold plus one record that crossed it, brackets and NUL.
+#define BATCH_BUF_SIZE (APP_FORWARD_BATCH_BYTES_MAX + UPLINK_JSON_FIXED_LEN + (2 * WMBUS_MAX_PACKET_BYTES) + 4)
+// Binary copy of the same frames for the frame log; a frame takes fewer than
+// half the bytes of its JSON object, so with JSON this never fills before data
+// does. CBOR records are barely larger than the copy, so the batch is also
+// flushed once the copy has less than one full frame of room left.
+#define SPOOL_BUF_SIZE (BATCH_BUF_SIZE / 2)
+#define SPOOL_FLUSH_AT (SPOOL_BUF_SIZE - sizeof(spool_hdr_t) - WMBUS_MAX_PACKET_BYTES)
+
+typedef struct
+{
+    framelog_meta_t meta;
+    uint16_t len; // Logical frame bytes following the header
+} spool_hdr_t;
+
+typedef struct
+{
+    char *data;
+    size_t len;
+    uint32_t count;
+    uplink_format_t format; // Encoding of this batch, fixed by its first frame
+    int64_t first_us; // When the oldest frame of the batch was appended
+    uint8_t *spool;   // spool_hdr_t + frame per entry; NULL without a frame log
+    size_t spool_len;
+} batch_buf_t;
+
+// Double buffer: sinks append to s_buf[s_active] under s_lock while the task
+// POSTs the other one without holding the lock.
+static batch_buf_t s_buf[2];
+static uint8_t s_active;
+static SemaphoreHandle_t s_lock;
+static TaskHandle_t s_task;
+static const backend_config_t *s_cfg;
+static const char *s_gateway;
+static bool s_log_ok;
+static int64_t s_replay_at_us; // Earliest start of the next replay batch
+
+static esp_http_client_handle_t s_client;
+static char s_client_url[sizeof(((backend_config_t *)0)->url)];
+static uplink_format_t s_client_format;
+
+static forwarder_stats_t s_stats; // dropped/queued under s_lock, the rest task-owned
+
+static void count_dropped(uint32_t n)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_stats.dropped += n;
+    xSemaphoreGive(s_lock);
+}
+
+static void client_close(void)
+{
+    if (s_client)
+    {
+        esp_http_client_cleanup(s_client);
+        s_client = NULL;
+    }
+    s_client_url[0] = '\0';
+}
+
+// One client for the task's lifetime; rebuilt only when the URL changes or a POST failed.
+static esp_http_client_handle_t client_get(const char *url, uplink_format_t format)
+{
+    if (s_client && strcmp(s_client_url, url) == 0)
+    {
+        if (format != s_client_format)
+        {
+            esp_http_client_set_header(s_client, "Content-Type", uplink_content_type(format));
+            s_client_format = format;
+        }
+        return s_client;
+    }
+    client_close();
+
+    esp_http_client_config_t cfg = {
+        .url = url,
+        .timeout_ms = APP_FORWARD_HTTP_TIMEOUT_MS,
+        .method = HTTP_METHOD_POST,
+        .keep_alive_enable = true,
+    };
+    s_client = esp_http_client_init(&cfg);
+    if (!s_client)
+    {
+        return NULL;
+    }
+    esp_http_client_set_header(s_client, "Content-Type", uplink_content_type(format));
+    s_client_format = format;
+    strncpy(s_client_url, url, sizeof(s_client_url) - 1);
+    return s_client;
+}
+
+static esp_err_t post_once(esp_http_client_handle_t client, const char *body, size_t len)
+{
+    esp_http_client_set_post_field(client, body, (int)len);
+    esp_err_t err = esp_http_client_perform(client);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    const int status = esp_http_client_get_status_code(client);
+    if (status < 200 || status >= 300)
+    {
+        ESP_LOGW(TAG, "backend HTTP status %d", status);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+// POST a finished batch array, reconnecting once if the kept-alive connection went stale.
+static esp_err_t post_batch(const char *url, uplink_format_t format, const char *body, size_t len, uint32_t frames)
+{
+    const int64_t start_us = esp_timer_get_time();
+    esp_err_t err = ESP_ERR_NO_MEM;
+    esp_http_client_handle_t client = client_get(url, format);
+    if (client)
+    {
+        err = post_once(client, body, len);
+        if (err != ESP_OK)
+        {
+            // The server may have closed the idle connection: reconnect once
+            esp_http_client_close(client);
+            err = post_once(client, body, len);
+        }
+    }
+
+    s_stats.last_post_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "POST of %" PRIu32 " frames failed: %s", frames, esp_err_to_name(err));
+        client_close();
+        s_stats.failed++;
+        return err;
+    }
+    s_stats.batches++;
+    ESP_LOGI(TAG, "POST %" PRIu32 " frames, %u bytes %s, %" PRIu32 " ms", frames, (unsigned)len, uplink_format_name(format),
+             s_stats.last_post_ms);
+    return ESP_OK;
+}
+
+// Keep the frames of an undeliverable batch in the frame log (dropped without one).
+static void spool_batch(const batch_buf_t *b)
+{
+    if (!b->spool)
+    {
+        count_dropped(b->count);
+        return;
+    }
+    uint32_t failed = 0;
+    size_t off = 0;
+    while (off + sizeof(spool_hdr_t) <= b->spool_len)
+    {
+        spool_hdr_t hdr;
+        memcpy(&hdr, b->spool + off, sizeof(hdr));
+        off += sizeof(hdr);
+        if (framelog_append(&hdr.meta, b->spool + off, hdr.len) == ESP_OK)
+        {
+            s_stats.spooled++;
+        }
+        else
+        {
+            failed++;
+        }
+        off += hdr.len;
+    }
+    if (failed > 0)
+    {
+        count_dropped(failed);
+    }
+    framelog_stats_t log;
+    framelog_get_stats(&log);
+    s_replay_at_us = esp_timer_get_time() + (int64_t)APP_FRAMELOG_RETRY_MS * 1000;
+    ESP_LOGI(TAG, "kept %" PRIu32 " frames in flash, %" PRIu32 " pending", b->count - failed, log.backlog);
+}
+
+static void send_batch(batch_buf_t *b)
+{
+    b->data[b->len++] = (char)uplink_batch_close(b->format);
+    b->data[b->len] = '\0';
+
+    char url[sizeof(s_client_url)];
+    strncpy(url, s_cfg->url, sizeof(url) - 1);
+    url[sizeof(url) - 1] = '\0';
+    if (url[0] == '\0')
+    {
+        ESP_LOGD(TAG, "no backend, dropping %" PRIu32 " frames", b->count);
+        count_dropped(b->count);
+        return;
+    }
+    if (!wifi_sta_is_connected() || post_batch(url, b->format, b->data, b->len, b->count) != ESP_OK)
+    {
+        spool_batch(b);
+        return;
+    }
+    s_stats.sent += b->count;
+    s_stats.last_batch_frames = b->count;
+}
+
+static TickType_t ticks_until(int64_t at_us)
+{
+    const int64_t now_us = esp_timer_get_time();
+    const TickType_t t = (at_us > now_us) ? pdMS_TO_TICKS((at_us - now_us + 999) / 1000) : 0;
+    return t ? t : 1;
+}
+
+// Send the oldest logged frames as one batch in the task-owned buffer b,
+// marking them delivered on success. Returns true when a POST was made;
+// *wait is the time until the next replay is allowed.
+static bool replay_batch(batch_buf_t *b, TickType_t *wait)
+{
+    *wait = portMAX_DELAY;
+    framelog_stats_t log;
+    framelog_get_stats(&log);
+    if (log.backlog == 0)
+    {
+        return false;
+    }
+    const int64_t now_us = esp_timer_get_time();
+    if (now_us < s_replay_at_us)
+    {
+        *wait = ticks_until(s_replay_at_us);
+        return false;
+    }
+    char url[sizeof(s_client_url)];
+    strncpy(url, s_cfg->url, sizeof(url) - 1);
+    url[sizeof(url) - 1] = '\0';
+    if (url[0] == '\0' || !wifi_sta_is_connected())
+    {
+        s_replay_at_us = now_us + (int64_t)APP_FRAMELOG_RETRY_MS * 1000;
+        *wait = ticks_until(s_replay_at_us);
+        return false;
+    }
+
+    const backend_batch_t *t = &s_cfg->batch;
+    const uplink_format_t format = s_cfg->format;
+    const uint8_t sep = uplink_batch_separator(format);
+    const uint32_t now_ms = framelog_now_ms();
+    uint8_t frame[FRAMELOG_FRAME_MAX];
+    uint32_t n = 0;
+    b->len = 0;
+    b->data[b->len++] = (char)uplink_batch_open(format);
+    while (n < t->max_frames && b->len < t->max_bytes)
+    {
+        framelog_meta_t meta;
+        uint16_t len = 0;
+        if (framelog_peek(n, &meta, frame, sizeof(frame), &len) != ESP_OK ||
+            b->len + uplink_max_len(format, len) + 2 > BATCH_BUF_SIZE)
+        {
+            break;
+        }
+        WmbusPacketEvent evt = {
+            .status = meta.status,
+            .rssi_dbm = (float)meta.rssi_ddbm / 10.0f,
+            .lqi = meta.lqi,
+            .gateway_name = s_gateway,
+            .logical_packet = frame,
+            .logical_len = len,
+        };
+        evt.frame_info.logical_len = len;
+        evt.frame_info.parsed = wmbus_parse_frame_header(frame, len, &evt.frame_info.header, NULL, &evt.frame_info.payload_len);
+        const size_t start = b->len;
+        if (n > 0 && sep)
+        {
+            b->data[b->len++] = (char)sep;
+        }
+        const uint32_t delay_ms = (now_ms - meta.rx_ms) ? (now_ms - meta.rx_ms) : 1;
+        const size_t w = uplink_format_record(format, &evt, delay_ms, (uint8_t *)b->data + b->len, BATCH_BUF_SIZE - b->len - 1);
+        if (w == 0)
+        {
+            b->len = start;
+            break;
+        }
+        b->len += w;
+        n++;
+    }
+    if (n == 0)
+    {
+        b->len = 0;
+        s_replay_at_us = now_us + (int64_t)APP_FRAMELOG_RETRY_MS * 1000;
+        *wait = ticks_until(s_replay_at_us);
+        return false;
+    }
+    b->data[b->len++] = (char)uplink_batch_close(format);
+    b->data[b->len] = '\0';
+
+    esp_err_t err = post_batch(url, format, b->data, b->len, n);
+    b->len = 0;
+    if (err == ESP_OK)
+    {
+        err = framelog_consume(n);
+    }
+    if (err != ESP_OK)
+    {
+        s_replay_at_us = esp_timer_get_time() + (int64_t)APP_FRAMELOG_RETRY_MS * 1000;
+    }
+    else
+    {
+        s_stats.replayed += n;
+        s_replay_at_us = esp_timer_get_time() + ((int64_t)n * 1000000) / APP_FRAMELOG_REPLAY_FPS;
+        ESP_LOGI(TAG, "replayed %" PRIu32 " frames, %" PRIu32 " pending", n, log.backlog - n);
+    }
+    *wait = ticks_until(s_replay_at_us);
+    return true;
+}
+
+// Under s_lock: true when the open batch must go out now, else *wait is the
+// time until its age threshold.
+static bool batch_due(const batch_buf_t *b, TickType_t *wait)
+{
+    *wait = portMAX_DELAY;
+    if (b->count == 0)
+    {
+        return false;
+    }
+    const backend_batch_t *t = &s_cfg->batch;
+    const int64_t age_ms = (esp_timer_get_time() - b->first_us) / 1000;
+    if (b->count >= t->max_frames || b->len >= t->max_bytes || age_ms >= t->max_age_ms ||
+        (b->spool && b->spool_len >= SPOOL_FLUSH_AT))
+    {
+        return true;
+    }
+    *wait = pdMS_TO_TICKS(t->max_age_ms - age_ms);
+    if (*wait == 0)
+    {
+        *wait = 1;
+    }
+    return false;
+}
+
+static void forwarder_task(void *arg)
+{
+    (void)arg;
+    while (true)
+    {
+        TickType_t wait;
+        uint8_t sending = 0;
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        const bool due = batch_due(&s_buf[s_active], &wait);
+        if (due)
+        {
+            sending = s_active;
+            s_active ^= 1;
+        }
+        xSemaphoreGive(s_lock);
+
+        if (!due)
+        {
+            // Replay from flash while the live batch fills; only this task
+            // writes s_active and touches the inactive buffer
+            TickType_t replay_wait = portMAX_DELAY;
+            if (s_log_ok && replay_batch(&s_buf[s_active ^ 1], &replay_wait))
+            {
+                continue; // The live batch may have come due meanwhile
+            }
+            ulTaskNotifyTake(pdTRUE, (replay_wait < wait) ? replay_wait : wait);
+            continue;
+        }
+
+        send_batch(&s_buf[sending]);
+        s_buf[sending].len = 0;
+        s_buf[sending].count = 0;
+        s_buf[sending].spool_len = 0;
+    }
+}
+
+esp_err_t forwarder_start(const backend_config_t *cfg, const char *gateway_name)
+{
+    if (!cfg)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_cfg = cfg;
+    s_gateway = gateway_name;
+    // Without the partition, undeliverable batches are dropped as before
+    s_log_ok = (framelog_init(APP_FRAMELOG_PARTITION) == ESP_OK);
+    s_lock = xSemaphoreCreateMutex();
+    for (size_t i = 0; i < 2; i++)
+    {
+        s_buf[i].data = malloc(BATCH_BUF_SIZE);
+        s_buf[i].spool = s_log_ok ? malloc(SPOOL_BUF_SIZE) : NULL;
+        s_buf[i].len = 0;
+        s_buf[i].count = 0;
+        s_buf[i].spool_len = 0;
+    }
+    if (!s_lock || !s_buf[0].data || !s_buf[1].data || (s_log_ok && (!s_buf[0].spool || !s_buf[1].spool)))
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(forwarder_task, "forwarder", APP_FORWARD_TASK_STACK, NULL, APP_FORWARD_TASK_PRIORITY, &s_task) != pdPASS)
+    {
+        s_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t forwarder_submit(const WmbusPacketEvent *evt)
+{
+    if (!evt)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_task)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const uint16_t logical_len = uplink_logical_len(evt, NULL);
+    if (logical_len == 0)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    batch_buf_t *b = &s_buf[s_active];
+    // A new batch takes the current encoding; a change applies from the next batch on
+    const uplink_format_t format = (b->count == 0) ? s_cfg->format : b->format;
+    // Separator or opening byte up front, closing byte and NUL at flush
+    if (b->len + uplink_max_len(format, logical_len) + 3 > BATCH_BUF_SIZE ||
+        (b->spool && b->spool_len + sizeof(spool_hdr_t) + logical_len > SPOOL_BUF_SIZE))
+    {
+        s_stats.dropped++;
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_NO_MEM;
+    }
+
+    const size_t start = b->len;
+    if (b->count == 0)
+    {
+        b->format = format;
+        b->data[b->len++] = (char)uplink_batch_open(format);
+        b->first_us = esp_timer_get_time();
+    }
+    else if (uplink_batch_separator(format))
+    {
+        b->data[b->len++] = (char)uplink_batch_separator(format);
+    }
+    const size_t n = uplink_format_record(format, evt, 0, (uint8_t *)b->data + b->len, BATCH_BUF_SIZE - b->len - 1);
+    if (n == 0)
+    {
+        b->len = start;
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    b->len += n;
+    b->count++;
+    s_stats.queued++;
+
+    if (b->spool)
+    {
+        const uint8_t *logical = NULL;
+        uplink_logical_len(evt, &logical);
+        const spool_hdr_t hdr = {
+            .meta = {
+                .rx_ms = framelog_now_ms(),
+                .rssi_ddbm = (int16_t)lroundf(evt->rssi_dbm * 10.0f),
+                .lqi = evt->lqi,
+                .status = (uint8_t)evt->status,
+            },
+            .len = logical_len,
+        };
+        memcpy(b->spool + b->spool_len, &hdr, sizeof(hdr));
+        memcpy(b->spool + b->spool_len + sizeof(hdr), logical, logical_len);
+        b->spool_len += sizeof(hdr) + logical_len;
+    }
+
+    const backend_batch_t *t = &s_cfg->batch;
+    const bool flush = b->count >= t->max_frames || b->len >= t->max_bytes || t->max_age_ms == 0 ||
+                       (b->spool && b->spool_len >= SPOOL_FLUSH_AT);
+    const bool first = b->count == 1;
+    xSemaphoreGive(s_lock);
+
+    if (flush || first)
+    {
+        // First frame starts the age timer; thresholds hit flush right away
+        xTaskNotifyGive(s_task);
+    }
+    return ESP_OK;
+}
+
+void forwarder_kick(void)
+{
+    if (s_task)
+    {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+void forwarder_get_stats(forwarder_stats_t *out)
+{
+    if (out)
+    {
+        *out = s_stats;
+    }
+}
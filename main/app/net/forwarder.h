@@ -0,0 +1,40 @@
+// Batching backend uplink. Sinks append frames to a JSON or CBOR array
+// (uplink_format.h, chosen per batch by backend_config_t.format) in RAM; a
+// dedicated task POSTs each batch over one keep-alive HTTP connection once
+// the frame, age or size threshold of backend_batch_t is reached. Batches that
+// cannot be delivered go to the flash frame log (framelog.h) and are replayed,
+// rate limited, once the backend is reachable again.
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "app/net/backend.h"
+#include "app/wmbus/packet_router.h"
+
+typedef struct
+{
+    uint32_t queued;
+    uint32_t sent;
+    uint32_t dropped;
+    uint32_t batches;
+    uint32_t failed;
+    uint32_t last_batch_frames;
+    uint32_t last_post_ms;
+    uint32_t spooled;  // Frames written to the frame log
+    uint32_t replayed; // Frames delivered from the frame log
+} forwarder_stats_t;
+
+// Allocate the batch buffers, mount the frame log and start the forwarding
+// task. cfg (URL and thresholds) is read on every flush, so later changes
+// apply without restart; gateway_name labels replayed frames.
+esp_err_t forwarder_start(const backend_config_t *cfg, const char *gateway_name);
+
+// Append a frame to the open batch. Never waits for the network; returns
+// ESP_ERR_NO_MEM (and counts a drop) while both batch buffers are occupied.
+esp_err_t forwarder_submit(const WmbusPacketEvent *evt);
+
+// Re-evaluate the flush thresholds now (e.g. after they were changed).
+void forwarder_kick(void);
+
+// Snapshot counters (fields are updated independently; no cross-field consistency).
+void forwarder_get_stats(forwarder_stats_t *out);
@@ -0,0 +1,494 @@
+#include "app/net/framelog.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+static const char *TAG = "framelog";
+
+// Segment = one flash sector: 16-byte header, then records back to back.
+#define SEG_MAGIC 0x474C4D46u // "FMLG"
+#define SEG_HDR_SIZE 16
+#define REC_HDR_SIZE 8
+#define REC_LEN_ERASED 0xFFFF
+#define REC_STATE_LIVE 0xFFFF
+#define REC_STATE_CONSUMED 0x0000 // Programmed on the last record of a delivered batch
+#define REC_PAYLOAD_MAX (sizeof(framelog_meta_t) + FRAMELOG_FRAME_MAX)
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t seq;     // Increases by one per recycled segment; the highest is the head
+    uint32_t seq_inv; // ~seq, rejects a header torn by a power cut
+    uint32_t reserved;
+} seg_hdr_t;
+
+// Record header; crc covers len and the payload, not state, so state can be
+// programmed later without rewriting the record.
+typedef struct
+{
+    uint16_t len; // Payload bytes: framelog_meta_t + logical frame
+    uint16_t state;
+    uint32_t crc;
+} rec_hdr_t;
+
+typedef struct
+{
+    uint16_t sector;
+    uint16_t idx;  // Valid records before off in this sector
+    uint32_t off;
+} log_pos_t;
+
+static const esp_partition_t *s_part;
+static uint16_t s_sectors;
+static uint16_t *s_count; // Valid records per sector
+static uint16_t *s_fill;  // End of written records per sector; 0 = segment not in use
+static uint16_t s_head;
+static uint32_t s_head_seq;
+static log_pos_t s_cur;   // First unconsumed record (or where it will be appended)
+static log_pos_t s_peek;
+static uint32_t s_peek_idx;
+static int64_t s_clock_offset_ms;
+static framelog_stats_t s_stats;
+static uint8_t s_rec[REC_HDR_SIZE + REC_PAYLOAD_MAX + 3];
+
+static inline uint32_t rec_size(uint16_t len)
+{
+    return (REC_HDR_SIZE + (uint32_t)len + 3u) & ~3u;
+}
+
+static inline size_t sector_addr(uint16_t sector)
+{
+    return (size_t)sector * FRAMELOG_SECTOR_SIZE;
+}
+
+static uint32_t rec_crc(uint16_t len, const uint8_t *payload)
+{
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)&len, sizeof(len));
+    return esp_rom_crc32_le(crc, payload, len);
+}
+
+static bool seg_read_hdr(uint16_t sector, uint32_t *seq)
+{
+    seg_hdr_t hdr;
+    if (esp_partition_read(s_part, sector_addr(sector), &hdr, sizeof(hdr)) != ESP_OK)
+    {
+        return false;
+    }
+    if (hdr.magic != SEG_MAGIC || hdr.seq != ~hdr.seq_inv)
+    {
+        return false;
+    }
+    *seq = hdr.seq;
+    return true;
+}
+
+static esp_err_t seg_start(uint16_t sector, uint32_t seq)
+{
+    esp_err_t err = esp_partition_erase_range(s_part, sector_addr(sector), FRAMELOG_SECTOR_SIZE);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    s_stats.erases++;
+    const seg_hdr_t hdr = {.magic = SEG_MAGIC, .seq = seq, .seq_inv = ~seq, .reserved = 0xFFFFFFFFu};
+    err = esp_partition_write(s_part, sector_addr(sector), &hdr, sizeof(hdr));
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    s_count[sector] = 0;
+    s_fill[sector] = SEG_HDR_SIZE;
+    s_head = sector;
+    s_head_seq = seq;
+    return ESP_OK;
+}
+
+// Next record with a valid CRC at or after *pos, walking segments up to the
+// head. On success *at is its position, pos points past it and s_rec holds it.
+static esp_err_t next_record(log_pos_t *pos, log_pos_t *at)
+{
+    while (true)
+    {
+        if (pos->off + REC_HDR_SIZE > s_fill[pos->sector])
+        {
+            if (pos->sector == s_head)
+            {
+                return ESP_ERR_NOT_FOUND;
+            }
+            pos->sector = (uint16_t)((pos->sector + 1) % s_sectors);
+            pos->idx = 0;
+            pos->off = SEG_HDR_SIZE;
+            continue;
+        }
+
+        rec_hdr_t *hdr = (rec_hdr_t *)s_rec;
+        esp_err_t err = esp_partition_read(s_part, sector_addr(pos->sector) + pos->off, s_rec, REC_HDR_SIZE);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        if (hdr->len == REC_LEN_ERASED || hdr->len < sizeof(framelog_meta_t) || hdr->len > REC_PAYLOAD_MAX ||
+            pos->off + rec_size(hdr->len) > s_fill[pos->sector])
+        {
+            pos->off = FRAMELOG_SECTOR_SIZE; // Unreadable tail: skip the rest of the segment
+            continue;
+        }
+        err = esp_partition_read(s_part, sector_addr(pos->sector) + pos->off + REC_HDR_SIZE, s_rec + REC_HDR_SIZE, hdr->len);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        const log_pos_t here = *pos;
+        pos->off += rec_size(hdr->len);
+        if (rec_crc(hdr->len, s_rec + REC_HDR_SIZE) != hdr->crc)
+        {
+            continue; // Torn write
+        }
+        pos->idx++;
+        if (at)
+        {
+            *at = here;
+        }
+        return ESP_OK;
+    }
+}
+
+static void refresh_oldest(void)
+{
+    log_pos_t pos = s_cur;
+    framelog_meta_t meta;
+    if (s_stats.backlog > 0 && next_record(&pos, NULL) == ESP_OK)
+    {
+        memcpy(&meta, s_rec + REC_HDR_SIZE, sizeof(meta));
+        s_stats.oldest_ms = meta.rx_ms;
+    }
+    else
+    {
+        s_stats.oldest_ms = 0;
+    }
+}
+
+// Find the end of the written records in one segment.
+static void scan_segment(uint16_t sector)
+{
+    uint32_t off = SEG_HDR_SIZE;
+    uint16_t count = 0;
+    while (off + REC_HDR_SIZE <= FRAMELOG_SECTOR_SIZE)
+    {
+        rec_hdr_t hdr;
+        if (esp_partition_read(s_part, sector_addr(sector) + off, &hdr, sizeof(hdr)) != ESP_OK || hdr.len == REC_LEN_ERASED)
+        {
+            break;
+        }
+        if (hdr.len < sizeof(framelog_meta_t) || hdr.len > REC_PAYLOAD_MAX || off + rec_size(hdr.len) > FRAMELOG_SECTOR_SIZE)
+        {
+            off = FRAMELOG_SECTOR_SIZE; // Garbage length: close the segment
+            break;
+        }
+        uint8_t *payload = s_rec + REC_HDR_SIZE;
+        if (esp_partition_read(s_part, sector_addr(sector) + off + REC_HDR_SIZE, payload, hdr.len) == ESP_OK &&
+            rec_crc(hdr.len, payload) == hdr.crc)
+        {
+            count++;
+        }
+        off += rec_size(hdr.len);
+    }
+    s_count[sector] = count;
+    s_fill[sector] = (uint16_t)off;
+}
+
+esp_err_t framelog_init(const char *label)
+{
+    if (!label)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_part)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!part)
+    {
+        ESP_LOGW(TAG, "no \"%s\" partition, frames cannot be kept offline", label);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (part->size < 2 * FRAMELOG_SECTOR_SIZE)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const uint16_t sectors = (uint16_t)(part->size / FRAMELOG_SECTOR_SIZE);
+    s_count = calloc(sectors, sizeof(*s_count));
+    s_fill = calloc(sectors, sizeof(*s_fill));
+    if (!s_count || !s_fill)
+    {
+        free(s_count);
+        free(s_fill);
+        s_count = NULL;
+        s_fill = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    s_part = part;
+    s_sectors = sectors;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.capacity_bytes = (uint32_t)sectors * (FRAMELOG_SECTOR_SIZE - SEG_HDR_SIZE);
+
+    // Head = segment with the highest sequence number
+    bool any = false;
+    for (uint16_t i = 0; i < sectors; i++)
+    {
+        uint32_t seq;
+        if (seg_read_hdr(i, &seq))
+        {
+            s_fill[i] = SEG_HDR_SIZE; // In use; scanned below
+            if (!any || seq > s_head_seq)
+            {
+                s_head = i;
+                s_head_seq = seq;
+            }
+            any = true;
+        }
+    }
+    if (!any)
+    {
+        ESP_LOGI(TAG, "formatting %u segments", (unsigned)sectors);
+        esp_err_t err = seg_start(0, 1);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        s_cur = (log_pos_t){.sector = 0, .idx = 0, .off = SEG_HDR_SIZE};
+        s_stats.mounted = true;
+        return ESP_OK;
+    }
+
+    // Oldest segment: first one in use after the head, going round the ring
+    uint16_t tail = (uint16_t)((s_head + 1) % sectors);
+    while (s_fill[tail] == 0)
+    {
+        tail = (uint16_t)((tail + 1) % sectors);
+    }
+    for (uint16_t i = tail;; i = (uint16_t)((i + 1) % sectors))
+    {
+        if (s_fill[i] != 0)
+        {
+            scan_segment(i);
+        }
+        if (i == s_head)
+        {
+            break;
+        }
+    }
+
+    // Everything up to the last record marked consumed has been delivered
+    log_pos_t pos = {.sector = tail, .idx = 0, .off = SEG_HDR_SIZE};
+    log_pos_t at;
+    s_cur = pos;
+    uint32_t newest_ms = 0;
+    bool have_newest = false;
+    while (next_record(&pos, &at) == ESP_OK)
+    {
+        const rec_hdr_t *hdr = (const rec_hdr_t *)s_rec;
+        framelog_meta_t meta;
+        memcpy(&meta, s_rec + REC_HDR_SIZE, sizeof(meta));
+        if (!have_newest || (int32_t)(meta.rx_ms - newest_ms) > 0)
+        {
+            newest_ms = meta.rx_ms;
+            have_newest = true;
+        }
+        if (hdr->state != REC_STATE_LIVE)
+        {
+            s_cur = pos;
+            s_stats.backlog = 0;
+            s_stats.used_bytes = 0;
+            continue;
+        }
+        s_stats.backlog++;
+        s_stats.used_bytes += rec_size(hdr->len);
+    }
+    s_clock_offset_ms = (int64_t)newest_ms + 1 - (esp_timer_get_time() / 1000);
+    refresh_oldest();
+    s_stats.mounted = true;
+    ESP_LOGI(TAG, "mounted: %" PRIu32 " frames pending, head segment %u seq %" PRIu32,
+             s_stats.backlog, (unsigned)s_head, s_head_seq);
+    return ESP_OK;
+}
+
+void framelog_deinit(void)
+{
+    free(s_count);
+    free(s_fill);
+    s_count = NULL;
+    s_fill = NULL;
+    s_part = NULL;
+    s_peek_idx = 0;
+    memset(&s_stats, 0, sizeof(s_stats));
+}
+
+uint32_t framelog_now_ms(void)
+{
+    return (uint32_t)(s_clock_offset_ms + (esp_timer_get_time() / 1000));
+}
+
+// Recycle the segment after the head; unconsumed frames in it are lost.
+static esp_err_t advance_head(void)
+{
+    const uint16_t next = (uint16_t)((s_head + 1) % s_sectors);
+    if (s_cur.sector == next)
+    {
+        const uint32_t lost = (uint32_t)s_count[next] - s_cur.idx;
+        if (lost > 0)
+        {
+            ESP_LOGW(TAG, "log full, dropping %" PRIu32 " oldest frames", lost);
+            s_stats.lost += lost;
+            s_stats.backlog -= lost;
+            s_stats.used_bytes -= (uint32_t)s_fill[next] - s_cur.off;
+        }
+        s_cur = (log_pos_t){.sector = (uint16_t)((next + 1) % s_sectors), .idx = 0, .off = SEG_HDR_SIZE};
+    }
+    s_fill[next] = 0;
+    esp_err_t err = seg_start(next, s_head_seq + 1);
+    s_peek_idx = 0;
+    refresh_oldest();
+    return err;
+}
+
+esp_err_t framelog_append(const framelog_meta_t *meta, const uint8_t *frame, uint16_t len)
+{
+    if (!meta || !frame || len == 0 || len > FRAMELOG_FRAME_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_part)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    rec_hdr_t *hdr = (rec_hdr_t *)s_rec;
+    hdr->len = (uint16_t)(sizeof(*meta) + len);
+    hdr->state = REC_STATE_LIVE;
+    memcpy(s_rec + REC_HDR_SIZE, meta, sizeof(*meta));
+    memcpy(s_rec + REC_HDR_SIZE + sizeof(*meta), frame, len);
+    hdr->crc = rec_crc(hdr->len, s_rec + REC_HDR_SIZE);
+    const uint32_t size = rec_size(hdr->len);
+    memset(s_rec + REC_HDR_SIZE + hdr->len, 0xFF, size - REC_HDR_SIZE - hdr->len);
+
+    if (s_fill[s_head] + size > FRAMELOG_SECTOR_SIZE)
+    {
+        // advance_head reuses s_rec; the record is rebuilt below
+        framelog_meta_t m = *meta;
+        esp_err_t err = advance_head();
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        return framelog_append(&m, frame, len);
+    }
+
+    esp_err_t err = esp_partition_write(s_part, sector_addr(s_head) + s_fill[s_head], s_rec, size);
+    s_fill[s_head] = (uint16_t)(s_fill[s_head] + size);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    s_count[s_head]++;
+    if (s_stats.backlog == 0)
+    {
+        s_stats.oldest_ms = meta->rx_ms;
+    }
+    s_stats.backlog++;
+    s_stats.used_bytes += size;
+    s_stats.appended++;
+    return ESP_OK;
+}
+
+esp_err_t framelog_peek(uint32_t idx, framelog_meta_t *meta, uint8_t *frame, uint16_t cap, uint16_t *len)
+{
+    if (!meta || !frame || !len)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_part || idx >= s_stats.backlog)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (idx == 0)
+    {
+        s_peek = s_cur;
+        s_peek_idx = 0;
+    }
+    else if (idx != s_peek_idx)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = next_record(&s_peek, NULL);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    const rec_hdr_t *hdr = (const rec_hdr_t *)s_rec;
+    const uint16_t frame_len = (uint16_t)(hdr->len - sizeof(*meta));
+    if (frame_len > cap)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(meta, s_rec + REC_HDR_SIZE, sizeof(*meta));
+    memcpy(frame, s_rec + REC_HDR_SIZE + sizeof(*meta), frame_len);
+    *len = frame_len;
+    s_peek_idx = idx + 1;
+    return ESP_OK;
+}
+
+esp_err_t framelog_consume(uint32_t count)
+{
+    if (!s_part)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (count == 0 || count > s_stats.backlog)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    log_pos_t pos = s_cur;
+    log_pos_t at = pos;
+    uint32_t bytes = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        esp_err_t err = next_record(&pos, &at);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        bytes += rec_size(((const rec_hdr_t *)s_rec)->len);
+    }
+    const uint16_t consumed = REC_STATE_CONSUMED;
+    esp_err_t err = esp_partition_write(s_part, sector_addr(at.sector) + at.off + offsetof(rec_hdr_t, state), &consumed, sizeof(consumed));
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    s_cur = pos;
+    s_peek_idx = 0;
+    s_stats.backlog -= count;
+    s_stats.used_bytes -= bytes;
+    s_stats.consumed += count;
+    refresh_oldest();
+    return ESP_OK;
+}
+
+void framelog_get_stats(framelog_stats_t *out)
+{
+    if (out)
+    {
+        *out = s_stats;
+    }
+}
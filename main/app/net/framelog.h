@@ -0,0 +1,57 @@
+// Append-only flash log of frames that could not be forwarded (store-and-forward).
+// The "framelog" data partition is a ring of sector-sized segments; each
+// record carries a CRC32 so torn writes after a power cut are skipped.
+// Records are consumed strictly in order. Single writer: every call except
+// framelog_get_stats and framelog_now_ms must come from the same task.
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define FRAMELOG_SECTOR_SIZE 4096
+#define FRAMELOG_FRAME_MAX 256 // Largest logical frame (L-field + 1)
+
+// Metadata stored ahead of each logical frame.
+typedef struct
+{
+    uint32_t rx_ms;    // Log clock at reception (framelog_now_ms)
+    int16_t rssi_ddbm; // RSSI in 0.1 dBm
+    uint8_t lqi;
+    uint8_t status;
+} framelog_meta_t;
+
+typedef struct
+{
+    bool mounted;
+    uint32_t capacity_bytes;
+    uint32_t used_bytes;  // Bytes of unconsumed records
+    uint32_t backlog;     // Unconsumed frames
+    uint32_t oldest_ms;   // rx_ms of the oldest unconsumed frame (0 when empty)
+    uint32_t appended;    // Frames written since boot
+    uint32_t consumed;    // Frames replayed since boot
+    uint32_t lost;        // Unconsumed frames overwritten because the log was full
+    uint32_t erases;      // Sector erases since boot
+} framelog_stats_t;
+
+// Mount the partition labelled `label`: scan all segments, restore the write
+// head, the read cursor and the log clock. ESP_ERR_NOT_FOUND without the partition.
+esp_err_t framelog_init(const char *label);
+void framelog_deinit(void);
+
+// Append one frame. When the ring is full, the oldest segment is recycled and
+// its unconsumed frames are counted as lost.
+esp_err_t framelog_append(const framelog_meta_t *meta, const uint8_t *frame, uint16_t len);
+
+// Read the idx-th unconsumed frame (0 = oldest) without consuming it. Reads are
+// sequential: idx must be 0 or one past the previous call. ESP_ERR_NOT_FOUND past the end.
+esp_err_t framelog_peek(uint32_t idx, framelog_meta_t *meta, uint8_t *frame, uint16_t cap, uint16_t *len);
+
+// Mark the `count` oldest frames as delivered (one flash write for the batch).
+esp_err_t framelog_consume(uint32_t count);
+
+// Milliseconds on the log clock: uptime continued from the newest record found
+// at mount, so ages survive reboots (time spent powered off is not counted).
+uint32_t framelog_now_ms(void);
+
+void framelog_get_stats(framelog_stats_t *out);
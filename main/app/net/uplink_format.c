@@ -0,0 +1,263 @@
+#include "app/net/uplink_format.h"
+
+#include <string.h>
+#include "wmbus/pipeline.h"
+#include "app/json_writer.h"
+#include "app/wmbus/meter_table.h"
+
+// CBOR major types (RFC 8949 3.1)
+#define CBOR_UINT  0
+#define CBOR_NINT  1
+#define CBOR_BYTES 2
+#define CBOR_TEXT  3
+#define CBOR_MAP   5
+
+// Map keys of the uplink schema (uplink_format.h)
+enum
+{
+    KEY_GATEWAY,
+    KEY_STATUS,
+    KEY_RSSI,
+    KEY_LQI,
+    KEY_MANUF,
+    KEY_ID,
+    KEY_DEV_TYPE,
+    KEY_VERSION,
+    KEY_CI,
+    KEY_PAYLOAD_LEN,
+    KEY_LOGICAL,
+    KEY_DELAY_MS,
+    KEY_MISSED,
+    KEY_RX_1H,
+    KEY_RX_24H,
+};
+
+const char *uplink_format_name(uplink_format_t format)
+{
+    return (format == UPLINK_FORMAT_CBOR) ? "cbor" : "json";
+}
+
+const char *uplink_content_type(uplink_format_t format)
+{
+    return (format == UPLINK_FORMAT_CBOR) ? "application/cbor" : "application/json";
+}
+
+bool uplink_format_from_name(const char *name, uplink_format_t *out)
+{
+    if (!name || !out)
+    {
+        return false;
+    }
+    if (strcmp(name, "json") == 0)
+    {
+        *out = UPLINK_FORMAT_JSON;
+        return true;
+    }
+    if (strcmp(name, "cbor") == 0)
+    {
+        *out = UPLINK_FORMAT_CBOR;
+        return true;
+    }
+    return false;
+}
+
+uint16_t uplink_logical_len(const WmbusPacketEvent *evt, const uint8_t **bytes)
+{
+    if (!evt)
+    {
+        return 0;
+    }
+    const uint8_t *src = evt->logical_packet ? evt->logical_packet : evt->raw_packet;
+    uint16_t len = evt->logical_len ? evt->logical_len : evt->frame_info.logical_len;
+    if (len > WMBUS_MAX_PACKET_BYTES)
+    {
+        len = WMBUS_MAX_PACKET_BYTES;
+    }
+    if (!src)
+    {
+        len = 0;
+    }
+    if (bytes)
+    {
+        *bytes = src;
+    }
+    return len;
+}
+
+size_t uplink_format_json(const WmbusPacketEvent *evt, char *out, size_t out_cap)
+{
+    return uplink_format_json_delayed(evt, 0, out, out_cap);
+}
+
+// RSSI in 0.1 dBm, rounded half away from zero
+static int32_t rssi_ddbm(float rssi_dbm)
+{
+    return (int32_t)(rssi_dbm * 10.0f + ((rssi_dbm < 0) ? -0.5f : 0.5f));
+}
+
+size_t uplink_format_json_delayed(const WmbusPacketEvent *evt, uint32_t delay_ms, char *out, size_t out_cap)
+{
+    const uint8_t *logical = NULL;
+    const uint16_t logical_len = uplink_logical_len(evt, &logical);
+    if (logical_len == 0 || !out || out_cap < 2)
+    {
+        return 0;
+    }
+
+    // Written in place; the last byte is kept for the NUL
+    const uint8_t *id = evt->frame_info.header.id;
+    const uint8_t id_printed[4] = {id[3], id[2], id[1], id[0]};
+    json_writer_t w;
+    json_init(&w, out, out_cap - 1, NULL, NULL);
+    json_obj_begin(&w, NULL);
+    json_str(&w, "gateway", evt->gateway_name ? evt->gateway_name : "");
+    json_u32(&w, "status", evt->status);
+    json_fixed1(&w, "rssi", rssi_ddbm(evt->rssi_dbm));
+    json_u32(&w, "lqi", evt->lqi);
+    json_u32(&w, "manuf", evt->frame_info.header.manufacturer_le);
+    json_hex(&w, "id", id_printed, sizeof(id_printed));
+    json_u32(&w, "dev_type", evt->frame_info.header.device_type);
+    json_u32(&w, "version", evt->frame_info.header.version);
+    json_u32(&w, "ci", evt->frame_info.header.ci_field);
+    json_u32(&w, "payload_len", evt->frame_info.payload_len);
+    json_hex(&w, "logical_hex", logical, logical_len);
+    if (delay_ms > 0)
+    {
+        json_u32(&w, "delay_ms", delay_ms);
+    }
+    const wmbus_meter_loss_t *loss = evt->loss;
+    if (loss && loss->gap != WMBUS_METER_GAP_UNKNOWN)
+    {
+        json_u32(&w, "missed", loss->gap);
+    }
+    if (loss && loss->expected_1h)
+    {
+        json_fixed1(&w, "rx_1h", wmbus_meter_ratio_permille(loss->received_1h, loss->expected_1h));
+    }
+    if (loss && loss->expected_24h)
+    {
+        json_fixed1(&w, "rx_24h", wmbus_meter_ratio_permille(loss->received_24h, loss->expected_24h));
+    }
+    json_obj_end(&w);
+    if (json_finish(&w) != ESP_OK)
+    {
+        return 0;
+    }
+    out[w.len] = '\0';
+    return w.len;
+}
+
+// Initial byte and argument in the shortest form; the caller checked for 5 bytes of room.
+static size_t cbor_head(uint8_t *out, uint8_t major, uint32_t val)
+{
+    const uint8_t mt = (uint8_t)(major << 5);
+    if (val < 24)
+    {
+        out[0] = mt | (uint8_t)val;
+        return 1;
+    }
+    if (val <= 0xFF)
+    {
+        out[0] = mt | 24;
+        out[1] = (uint8_t)val;
+        return 2;
+    }
+    if (val <= 0xFFFF)
+    {
+        out[0] = mt | 25;
+        out[1] = (uint8_t)(val >> 8);
+        out[2] = (uint8_t)val;
+        return 3;
+    }
+    out[0] = mt | 26;
+    out[1] = (uint8_t)(val >> 24);
+    out[2] = (uint8_t)(val >> 16);
+    out[3] = (uint8_t)(val >> 8);
+    out[4] = (uint8_t)val;
+    return 5;
+}
+
+// Key and integer value (both at most 5 bytes)
+static size_t cbor_int_field(uint8_t *out, uint8_t key, int32_t val)
+{
+    size_t n = cbor_head(out, CBOR_UINT, key);
+    if (val < 0)
+    {
+        return n + cbor_head(out + n, CBOR_NINT, (uint32_t)(-1 - val));
+    }
+    return n + cbor_head(out + n, CBOR_UINT, (uint32_t)val);
+}
+
+size_t uplink_format_cbor(const WmbusPacketEvent *evt, uint32_t delay_ms, uint8_t *out, size_t out_cap)
+{
+    const uint8_t *logical = NULL;
+    const uint16_t logical_len = uplink_logical_len(evt, &logical);
+    if (logical_len == 0 || !out)
+    {
+        return 0;
+    }
+    const char *gateway = evt->gateway_name ? evt->gateway_name : "";
+    const size_t gateway_len = strnlen(gateway, UPLINK_CBOR_FIXED_LEN / 2);
+    if (out_cap < uplink_cbor_max_len(logical_len))
+    {
+        return 0;
+    }
+
+    const WmbusFrameHeaderRaw *h = &evt->frame_info.header;
+    const uint32_t id = (uint32_t)h->id[0] | ((uint32_t)h->id[1] << 8) | ((uint32_t)h->id[2] << 16) |
+                        ((uint32_t)h->id[3] << 24);
+    const int32_t rssi = rssi_ddbm(evt->rssi_dbm);
+    const wmbus_meter_loss_t *loss = evt->loss;
+    const bool has_gap = loss && loss->gap != WMBUS_METER_GAP_UNKNOWN;
+    const bool has_1h = loss && loss->expected_1h;
+    const bool has_24h = loss && loss->expected_24h;
+
+    const uint32_t pairs = KEY_DELAY_MS + (delay_ms > 0) + has_gap + has_1h + has_24h;
+    size_t pos = cbor_head(out, CBOR_MAP, pairs);
+    pos += cbor_head(out + pos, CBOR_UINT, KEY_GATEWAY);
+    pos += cbor_head(out + pos, CBOR_TEXT, (uint32_t)gateway_len);
+    memcpy(out + pos, gateway, gateway_len);
+    pos += gateway_len;
+    pos += cbor_int_field(out + pos, KEY_STATUS, evt->status);
+    pos += cbor_int_field(out + pos, KEY_RSSI, rssi);
+    pos += cbor_int_field(out + pos, KEY_LQI, evt->lqi);
+    pos += cbor_int_field(out + pos, KEY_MANUF, h->manufacturer_le);
+    pos += cbor_head(out + pos, CBOR_UINT, KEY_ID);
+    pos += cbor_head(out + pos, CBOR_UINT, id);
+    pos += cbor_int_field(out + pos, KEY_DEV_TYPE, h->device_type);
+    pos += cbor_int_field(out + pos, KEY_VERSION, h->version);
+    pos += cbor_int_field(out + pos, KEY_CI, h->ci_field);
+    pos += cbor_int_field(out + pos, KEY_PAYLOAD_LEN, (int32_t)evt->frame_info.payload_len);
+    pos += cbor_head(out + pos, CBOR_UINT, KEY_LOGICAL);
+    pos += cbor_head(out + pos, CBOR_BYTES, logical_len);
+    memcpy(out + pos, logical, logical_len);
+    pos += logical_len;
+    if (delay_ms > 0)
+    {
+        pos += cbor_head(out + pos, CBOR_UINT, KEY_DELAY_MS);
+        pos += cbor_head(out + pos, CBOR_UINT, delay_ms);
+    }
+    if (has_gap)
+    {
+        pos += cbor_int_field(out + pos, KEY_MISSED, loss->gap);
+    }
+    if (has_1h)
+    {
+        pos += cbor_int_field(out + pos, KEY_RX_1H, wmbus_meter_ratio_permille(loss->received_1h, loss->expected_1h));
+    }
+    if (has_24h)
+    {
+        pos += cbor_int_field(out + pos, KEY_RX_24H, wmbus_meter_ratio_permille(loss->received_24h, loss->expected_24h));
+    }
+    return pos;
+}
+
+size_t uplink_format_record(uplink_format_t format, const WmbusPacketEvent *evt, uint32_t delay_ms, uint8_t *out,
+                            size_t out_cap)
+{
+    if (format == UPLINK_FORMAT_CBOR)
+    {
+        return uplink_format_cbor(evt, delay_ms, out, out_cap);
+    }
+    return uplink_format_json_delayed(evt, delay_ms, (char *)out, out_cap);
+}
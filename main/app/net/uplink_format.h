@@ -0,0 +1,98 @@
+// Backend uplink encoding of a received frame: a JSON object per telegram, or
+// the same fields as a compact CBOR map (RFC 8949) selected per backend.
+//
+// CBOR schema: a batch is an indefinite-length array (0x9F ... 0xFF) of maps
+// with small unsigned integer keys:
+//    0 gateway      text string
+//    1 status       uint (wmbus_packet_status)
+//    2 rssi         int, RSSI in 0.1 dBm (-705 = -70.5 dBm)
+//    3 lqi          uint
+//    4 manuf        uint, manufacturer code as on air (little endian M-field)
+//    5 id           uint, meter ID whose hex digits read as printed (0x12345678)
+//    6 dev_type     uint
+//    7 version      uint
+//    8 ci           uint
+//    9 payload_len  uint
+//   10 logical      byte string, CRC-free logical frame (L first)
+//   11 delay_ms     uint, only for frames held back (e.g. replayed from the log)
+//   12 missed       uint, frames of this meter lost right before this one (ACC gap)
+//   13 rx_1h        uint, meter's reception ratio over the last hour in 0.1 %
+//   14 rx_24h       uint, same over the last 24 hours
+// Keys 12-14 are only present when known at reception (not for replayed frames).
+// Integers use the shortest encoding. Receivers should ignore unknown keys.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "app/wmbus/packet_router.h"
+
+typedef enum
+{
+    UPLINK_FORMAT_JSON = 0,
+    UPLINK_FORMAT_CBOR = 1,
+} uplink_format_t;
+
+// Room for the fixed fields; the logical frame adds two hex digits per byte.
+#define UPLINK_JSON_FIXED_LEN 320
+// Map head, keys, integers and a gateway name of up to 64 bytes.
+#define UPLINK_CBOR_FIXED_LEN 128
+
+static inline size_t uplink_json_max_len(uint16_t logical_len)
+{
+    return UPLINK_JSON_FIXED_LEN + ((size_t)logical_len * 2) + 1;
+}
+
+static inline size_t uplink_cbor_max_len(uint16_t logical_len)
+{
+    return UPLINK_CBOR_FIXED_LEN + logical_len;
+}
+
+static inline size_t uplink_max_len(uplink_format_t format, uint16_t logical_len)
+{
+    return (format == UPLINK_FORMAT_CBOR) ? uplink_cbor_max_len(logical_len) : uplink_json_max_len(logical_len);
+}
+
+// "json" / "cbor", and the HTTP Content-Type of a batch.
+const char *uplink_format_name(uplink_format_t format);
+const char *uplink_content_type(uplink_format_t format);
+// Parse a format name; false when unknown.
+bool uplink_format_from_name(const char *name, uplink_format_t *out);
+
+// CRC-free frame carried by evt (logical_packet, else raw_packet), capped to
+// WMBUS_MAX_PACKET_BYTES. Returns 0 when the event carries no frame.
+uint16_t uplink_logical_len(const WmbusPacketEvent *evt, const uint8_t **bytes);
+
+// Write the JSON object for evt into out (NUL-terminated): header fields,
+// radio quality, the logical frame as hex and, with evt->loss, "missed" and
+// the meter's "rx_1h" / "rx_24h" in percent. Returns the length written,
+// or 0 if the event carries no frame or out_cap is too small.
+size_t uplink_format_json(const WmbusPacketEvent *evt, char *out, size_t out_cap);
+
+// Same object with "delay_ms" (time from reception to upload) for frames that
+// were held back, e.g. replayed from the offline log. delay_ms 0 omits the field.
+size_t uplink_format_json_delayed(const WmbusPacketEvent *evt, uint32_t delay_ms, char *out, size_t out_cap);
+
+// Write the CBOR map for evt (schema above; delay_ms 0 omits key 11). Returns
+// the length written, or 0 if the event carries no frame or out_cap is too small.
+size_t uplink_format_cbor(const WmbusPacketEvent *evt, uint32_t delay_ms, uint8_t *out, size_t out_cap);
+
+// Record of evt in the given format, binary-safe (JSON is NUL-terminated).
+size_t uplink_format_record(uplink_format_t format, const WmbusPacketEvent *evt, uint32_t delay_ms, uint8_t *out,
+                            size_t out_cap);
+
+// Batch framing: JSON "[" a "," b "]", CBOR 0x9F a b 0xFF (no separator: 0).
+static inline uint8_t uplink_batch_open(uplink_format_t format)
+{
+    return (format == UPLINK_FORMAT_CBOR) ? 0x9F : '[';
+}
+
+static inline uint8_t uplink_batch_separator(uplink_format_t format)
+{
+    return (format == UPLINK_FORMAT_CBOR) ? 0 : ',';
+}
+
+static inline uint8_t uplink_batch_close(uplink_format_t format)
+{
+    return (format == UPLINK_FORMAT_CBOR) ? 0xFF : ']';
+}
@@ -5,11 +5,14 @@
 #include "esp_log.h"
 #include "nvs_flash.h"
 #include "app/storage.h"
+#include "app/config.h"
+#include "wmbus/pipeline.h"
 
 static const char *TAG = "radio_cfg";
 static const char *NAMESPACE = "radio";
 static const char *KEY_CS = "cs_level";
 static const char *KEY_SYNC = "sync_mode";
+static const char *KEY_DEDUP = "dedup_s";
 
 static bool is_valid_cs(uint8_t v)
 {
@@ -28,6 +31,10 @@ static esp_err_t save_cfg(const radio_config_t *cfg)
     {
         err = storage_set_u8(NAMESPACE, KEY_SYNC, (uint8_t)cfg->sync_mode);
     }
+    if (err == ESP_OK)
+    {
+        err = storage_set_u8(NAMESPACE, KEY_DEDUP, cfg->dedup_window_s);
+    }
     if (err != ESP_OK)
     {
         ESP_LOGW(TAG, "radio cfg save failed: %s", esp_err_to_name(err));
@@ -48,6 +55,11 @@ static esp_err_t load_cfg(radio_config_t *cfg)
     {
         cfg->sync_mode = (cc1101_sync_mode_t)sync;
     }
+    uint8_t dedup = 0;
+    if (err == ESP_OK && storage_get_u8(NAMESPACE, KEY_DEDUP, &dedup) == ESP_OK)
+    {
+        cfg->dedup_window_s = dedup;
+    }
     return err;
 }
 
@@ -55,6 +67,7 @@ static void set_defaults(radio_config_t *cfg)
 {
     cfg->cs_level = CC1101_CS_LEVEL_DEFAULT;
     cfg->sync_mode = CC1101_SYNC_MODE_DEFAULT;
+    cfg->dedup_window_s = APP_DEDUP_WINDOW_S;
 }
 
 esp_err_t radio_config_init(radio_config_t *cfg)
@@ -96,12 +109,26 @@ esp_err_t radio_config_set_sync_mode(radio_config_t *cfg, cc1101_sync_mode_t mod
     return save_cfg(cfg);
 }
 
+esp_err_t radio_config_set_dedup_window(radio_config_t *cfg, uint8_t seconds)
+{
+    if (!cfg)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    cfg->dedup_window_s = seconds;
+    return save_cfg(cfg);
+}
+
 esp_err_t radio_config_apply(const radio_config_t *cfg, cc1101_hal_t *dev)
 {
     if (!cfg || !dev)
     {
         return ESP_ERR_INVALID_ARG;
     }
+    // Keep the RX pipeline knobs in sync so its re-arm does not revert them.
+    wmbus_rx_set_cs_level(cfg->cs_level);
+    wmbus_rx_set_sync_mode(cfg->sync_mode);
+
     esp_err_t err = cc1101_hal_set_cs_threshold(dev, cfg->cs_level);
     if (err != ESP_OK)
     {
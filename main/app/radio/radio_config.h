@@ -1,4 +1,5 @@
-// Persisted radio configuration helpers (CS threshold + sync mode) for CC1101.
+// Persisted radio configuration helpers (CS threshold + sync mode) for CC1101,
+// plus the duplicate-suppression window applied to received telegrams.
 #pragma once
 
 #include "esp_err.h"
@@ -8,6 +9,7 @@ typedef struct
 {
     cc1101_cs_level_t cs_level;
     cc1101_sync_mode_t sync_mode;
+    uint8_t dedup_window_s; // 0 = forward every copy
 } radio_config_t;
 
 // Load config from NVS (or defaults) into cfg.
@@ -16,5 +18,7 @@ esp_err_t radio_config_init(radio_config_t *cfg);
 esp_err_t radio_config_set_cs_level(radio_config_t *cfg, cc1101_cs_level_t level);
 // Persist and update sync mode selection.
 esp_err_t radio_config_set_sync_mode(radio_config_t *cfg, cc1101_sync_mode_t mode);
+// Persist and update the duplicate-suppression window (seconds).
+esp_err_t radio_config_set_dedup_window(radio_config_t *cfg, uint8_t seconds);
 // Apply current config to a CC1101 instance.
 esp_err_t radio_config_apply(const radio_config_t *cfg, cc1101_hal_t *dev);
@@ -6,6 +6,8 @@
 #include "esp_netif.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
 #include "esp_event.h"
 
 #include "radio/pins.h"
@@ -13,7 +15,14 @@
 #include "wmbus/pipeline.h"
 #include "wmbus/packet.h"
 #include "app/wmbus/packet_router.h"
+#include "app/wmbus/frame_pool.h"
+#include "app/wmbus/frame_queue.h"
+#include "app/wmbus/dedup.h"
+#include "app/wmbus/meter_table.h"
+#include "app/wmbus/parsed_frame.h"
+#include "app/wmbus/filter_config.h"
 #include "app/net/backend.h"
+#include "app/net/forwarder.h"
 #include "app/net/wifi.h"
 #include "app/radio/radio_config.h"
 #include "app/services.h"
@@ -29,53 +38,45 @@ typedef struct
     services_state_t services;
     cc1101_hal_t cc1101;
     cc1101_pin_config_t pins;
-    uint8_t rx_packet[WMBUS_MAX_PACKET_BYTES];
-    uint8_t rx_bytes[WMBUS_MAX_ENCODED_BYTES];
-    uint8_t rx_logical[WMBUS_MAX_PACKET_BYTES];
+    wmbus_frame_pool_t frame_pool;
+    wmbus_frame_t frames[APP_FRAME_POOL_SIZE];
+    wmbus_frame_queue_t rx_queue;
+    wmbus_frame_t *rx_slots[APP_RX_QUEUE_DEPTH];
+    wmbus_frame_t rx_overflow; // Keeps the radio drained while no pooled frame is free
+    TaskHandle_t rx_task;
+    TaskHandle_t dispatch_task;
+    wmbus_dedup_t dedup;          // Dispatch task only, except snapshots under dedup_lock
+    SemaphoreHandle_t dedup_lock;
+    wmbus_meter_table_t meters;   // Meter sink only, except snapshots under meters_lock
+    SemaphoreHandle_t meters_lock;
 } app_ctx_t;
 
 static app_ctx_t s_app;
 
-static void log_packet_summary(const wmbus_rx_result_t *res, const WmbusFrameInfo *info)
-{
-    if (!res || !info || !info->parsed)
-    {
-        return;
-    }
-
-    char manuf_hex[5] = {0};
-    char id_hex[9] = {0};
-    snprintf(manuf_hex, sizeof(manuf_hex), "%02X%02X", (uint8_t)(info->header.manufacturer_le & 0xFF), (uint8_t)((info->header.manufacturer_le >> 8) & 0xFF));
-    snprintf(id_hex, sizeof(id_hex), "%02X%02X%02X%02X", info->header.id[3], info->header.id[2], info->header.id[1], info->header.id[0]);
-
-    ESP_LOGI(TAG, "RX manuf=%s id=%s dev=0x%02X ver=0x%02X ci=0x%02X payload_len=%u rssi=%.1f",
-             manuf_hex,
-             id_hex,
-             info->header.device_type,
-             info->header.version,
-             info->header.ci_field,
-             info->payload_len,
-             res->rssi_dbm);
-}
-
+// Runs on the "log" sink's worker, so the UART never holds up dispatch.
 static void ui_sink(const WmbusPacketEvent *evt, void *user)
 {
     (void)user;
-    if (!evt)
+    if (!evt || evt->status != WMBUS_PKT_OK)
     {
         return;
     }
 
-    if (evt->status != WMBUS_PKT_OK || !evt->frame_info.parsed)
+    const WmbusFrameInfo *info = &evt->frame_info;
+    if (!info->parsed)
     {
+        ESP_LOGW(TAG, "Header parse failed");
         return;
     }
 
-    ESP_LOGI(TAG, "[UI] gw=\"%s\" manuf=0x%04X id=%02X%02X%02X%02X dev=0x%02X rssi=%.1f",
+    ESP_LOGI(TAG, "RX gw=\"%s\" manuf=0x%04X id=%02X%02X%02X%02X dev=0x%02X ver=0x%02X ci=0x%02X payload_len=%u rssi=%.1f",
              evt->gateway_name ? evt->gateway_name : "-",
-             evt->frame_info.header.manufacturer_le,
-             evt->frame_info.header.id[3], evt->frame_info.header.id[2], evt->frame_info.header.id[1], evt->frame_info.header.id[0],
-             evt->frame_info.header.device_type,
+             info->header.manufacturer_le,
+             info->header.id[3], info->header.id[2], info->header.id[1], info->header.id[0],
+             info->header.device_type,
+             info->header.version,
+             info->header.ci_field,
+             info->payload_len,
              evt->rssi_dbm);
 }
 
@@ -87,12 +88,6 @@ static void forwarder_sink(const WmbusPacketEvent *evt, void *user)
         return;
     }
 
-    if (!wifi_sta_is_connected())
-    {
-        ESP_LOGI(TAG, "[FW] skip (no network)");
-        return;
-    }
-
     backend_config_t *backend = services_backend(svc);
     if (!backend || backend->url[0] == '\0')
     {
@@ -100,14 +95,22 @@ static void forwarder_sink(const WmbusPacketEvent *evt, void *user)
         return;
     }
 
-    esp_err_t err = backend_forward_packet(backend, evt);
+    // Batched and POSTed by the forwarder task (kept in flash while offline);
+    // never blocks on the network here.
+    WmbusPacketEvent fwd = *evt;
+    wmbus_meter_loss_t loss;
+    if (app_get_meter_loss(evt->frame_info.header.manufacturer_le, evt->frame_info.header.id, &loss))
+    {
+        fwd.loss = &loss;
+    }
+    esp_err_t err = forwarder_submit(&fwd);
     if (err != ESP_OK)
     {
-        ESP_LOGW(TAG, "[FW] forward failed: %s", esp_err_to_name(err));
+        ESP_LOGW(TAG, "[FW] queue failed: %s", esp_err_to_name(err));
     }
     else
     {
-        ESP_LOGI(TAG, "[FW] forwarded manuf=0x%04X id=%02X%02X%02X%02X payload_len=%u gw=\"%s\"",
+        ESP_LOGD(TAG, "[FW] queued manuf=0x%04X id=%02X%02X%02X%02X payload_len=%u gw=\"%s\"",
                  evt->frame_info.header.manufacturer_le,
                  evt->frame_info.header.id[3], evt->frame_info.header.id[2], evt->frame_info.header.id[1], evt->frame_info.header.id[0],
                  evt->frame_info.payload_len,
@@ -115,6 +118,51 @@ static void forwarder_sink(const WmbusPacketEvent *evt, void *user)
     }
 }
 
+// Per-meter reception statistics; also sees frames that failed a CRC.
+static void meter_sink(const WmbusPacketEvent *evt, void *user)
+{
+    app_ctx_t *ctx = (app_ctx_t *)user;
+    if (!evt || !ctx)
+    {
+        return;
+    }
+    // The L-field is only published once block 0 (the address) passed its CRC
+    const WmbusFrameHeaderRaw *hdr = &evt->frame_info.header;
+    if (hdr->length == 0)
+    {
+        xSemaphoreTake(ctx->meters_lock, portMAX_DELAY);
+        wmbus_meter_table_note_unattributed(&ctx->meters);
+        xSemaphoreGive(ctx->meters_lock);
+        return;
+    }
+
+    wmbus_meter_sample_t sample = {
+        .manuf = hdr->manufacturer_le,
+        .dev_type = hdr->device_type,
+        .intact = evt->status == WMBUS_PKT_OK && evt->frame_info.parsed,
+        .rssi_ddbm = (int16_t)(evt->rssi_dbm * 10.0f + ((evt->rssi_dbm < 0) ? -0.5f : 0.5f)),
+        .lqi = evt->lqi,
+    };
+    memcpy(sample.id, hdr->id, sizeof(sample.id));
+    // ELL ACC, else TPL ACC (as for duplicate detection)
+    if (sample.intact && evt->parsed)
+    {
+        if (evt->parsed->ell.has_ell)
+        {
+            sample.has_acc = true;
+            sample.acc = evt->parsed->ell.ell.acc;
+        }
+        else if (evt->parsed->tpl.has_tpl)
+        {
+            sample.has_acc = true;
+            sample.acc = evt->parsed->tpl.tpl.acc;
+        }
+    }
+    xSemaphoreTake(ctx->meters_lock, portMAX_DELAY);
+    wmbus_meter_table_update(&ctx->meters, &sample, (uint32_t)(esp_timer_get_time() / 1000));
+    xSemaphoreGive(ctx->meters_lock);
+}
+
 static esp_err_t system_init(void)
 {
     ESP_ERROR_CHECK(nvs_flash_init());
@@ -136,16 +184,30 @@ static esp_err_t app_setup(app_ctx_t *ctx)
 {
     ESP_ERROR_CHECK(system_init());
     ESP_ERROR_CHECK(services_init(&ctx->services));
+    ESP_ERROR_CHECK(forwarder_start(services_backend(&ctx->services), services_hostname(&ctx->services)));
     ESP_ERROR_CHECK(status_led_init(STATUS_LED_GPIO, STATUS_LED_ACTIVE_LOW));
 
     ESP_ERROR_CHECK(wmbus_packet_router_init());
-    wmbus_packet_router_register(ui_sink, NULL);
-    wmbus_packet_router_register(forwarder_sink, &ctx->services);
+    // Log lines go out over the UART; a worker keeps that off the dispatch path
+    const wmbus_sink_opts_t log_opts = {
+        .flags = WMBUS_SINK_FLAG_ASYNC,
+        .name = "log",
+        .queue_depth = APP_LOG_SINK_DEPTH,
+        .drop = WMBUS_SINK_DROP_OLDEST,
+        .priority = APP_LOG_SINK_PRIORITY,
+    };
+    const wmbus_sink_opts_t fwd_opts = {.name = "forwarder"};
+    const wmbus_sink_opts_t meter_opts = {.flags = WMBUS_SINK_FLAG_META, .name = "meters"};
+    wmbus_packet_router_register_ex(ui_sink, NULL, &log_opts);
+    // Ahead of the forwarder, which attaches the meter's loss figures to the uplink
+    wmbus_packet_router_register_ex(meter_sink, ctx, &meter_opts);
+    wmbus_packet_router_register_ex(forwarder_sink, &ctx->services, &fwd_opts);
     http_server_register_packet_sink();
 
     ctx->pins = cc1101_default_pins();
     ESP_ERROR_CHECK(cc1101_hal_init(&ctx->pins, &ctx->cc1101));
     ESP_ERROR_CHECK(wmbus_pipeline_init(&ctx->cc1101));
+    wmbus_rx_set_header_filter(filter_config_accept, NULL);
     ESP_ERROR_CHECK(radio_config_apply(services_radio(&ctx->services), &ctx->cc1101));
 
     ESP_ERROR_CHECK(wifi_start_with_fallback(&ctx->services));
@@ -164,69 +226,306 @@ static esp_err_t app_setup(app_ctx_t *ctx)
     return ESP_OK;
 }
 
-static void app_loop(app_ctx_t *ctx)
+static void update_wifi_led(void)
 {
-    wmbus_rx_result_t res = {
-        .rx_packet = ctx->rx_packet,
-        .rx_bytes = ctx->rx_bytes,
-        .rx_logical = ctx->rx_logical,
-    };
+    bool wifi_connected = wifi_sta_is_connected();
+    if (wifi_connected == s_wifi_connected_prev)
+    {
+        return;
+    }
+    if (wifi_connected)
+    {
+        status_led_set_base(STATUS_LED_PATTERN_OFF);
+        status_led_trigger_once(STATUS_LED_PATTERN_DOUBLE_BLINK);
+    }
+    else
+    {
+        status_led_set_base(STATUS_LED_PATTERN_FADE_SLOW);
+    }
+    s_wifi_connected_prev = wifi_connected;
+}
+
+// High-priority producer: keeps the radio serviced and never waits on sinks.
+static void rx_task(void *arg)
+{
+    app_ctx_t *ctx = (app_ctx_t *)arg;
+    wmbus_frame_t *frame = NULL; // Kept across timeouts until a frame is handed on
 
     while (true)
     {
-        bool wifi_connected = wifi_sta_is_connected();
-        if (wifi_connected != s_wifi_connected_prev)
+        if (!frame)
         {
-            if (wifi_connected)
-            {
-                status_led_set_base(STATUS_LED_PATTERN_OFF);
-                status_led_trigger_once(STATUS_LED_PATTERN_DOUBLE_BLINK);
-            }
-            else
-            {
-                status_led_set_base(STATUS_LED_PATTERN_FADE_SLOW);
-            }
-            s_wifi_connected_prev = wifi_connected;
+            frame = wmbus_frame_alloc(&ctx->frame_pool);
         }
+        wmbus_frame_t *target = frame ? frame : &ctx->rx_overflow;
+        wmbus_rx_result_t *res = &target->res;
+
+        // Debug copies are only produced when some sink asked for them.
+        const uint32_t sink_flags = wmbus_packet_router_flags();
+        wmbus_frame_want_debug(target, sink_flags & WMBUS_SINK_FLAG_RAW, sink_flags & WMBUS_SINK_FLAG_ENCODED);
 
-        ESP_ERROR_CHECK(wmbus_pipeline_receive(&ctx->cc1101, &res, APP_RX_TIMEOUT_MS));
+        ESP_ERROR_CHECK(wmbus_pipeline_receive(&ctx->cc1101, res, APP_RX_TIMEOUT_MS));
 
-        if (!res.complete || res.packet_size == 0 || res.encoded_len == 0)
+        if (!res->complete || res->packet_size == 0 || res->encoded_len == 0)
         {
-            ESP_LOGD(TAG, "RX incomplete: complete=%d packet_size=%u encoded_len=%u status=%u", res.complete, res.packet_size, res.encoded_len, res.status);
-            vTaskDelay(pdMS_TO_TICKS(APP_RX_INCOMPLETE_DELAY_MS));
+            ESP_LOGD(TAG, "RX incomplete: complete=%d packet_size=%u encoded_len=%u status=%u", res->complete, res->packet_size, res->encoded_len, res->status);
             continue;
         }
 
-        if (res.status == WMBUS_PKT_OK)
+        if (!frame || !wmbus_frame_queue_push(&ctx->rx_queue, frame))
+        {
+            wmbus_frame_queue_note_drop(&ctx->rx_queue);
+            continue;
+        }
+        frame = NULL; // The reference now belongs to the dispatch task
+        xTaskNotifyGive(ctx->dispatch_task);
+    }
+}
+
+// True for a repeat of a telegram seen within the configured window.
+static bool is_duplicate(app_ctx_t *ctx, const wmbus_rx_result_t *res)
+{
+    const uint32_t window_ms = (uint32_t)services_radio(&ctx->services)->dedup_window_s * 1000;
+    wmbus_dedup_key_t key;
+    if (window_ms == 0 || res->status != WMBUS_PKT_OK ||
+        !wmbus_dedup_make_key(&res->frame_info, res->rx_logical, res->logical_len, &key))
+    {
+        return false;
+    }
+    xSemaphoreTake(ctx->dedup_lock, portMAX_DELAY);
+    const bool dup = wmbus_dedup_check(&ctx->dedup, &key, (uint32_t)(esp_timer_get_time() / 1000), window_ms);
+    xSemaphoreGive(ctx->dedup_lock);
+    return dup;
+}
+
+static void dispatch_frame(app_ctx_t *ctx, wmbus_frame_t *frame)
+{
+    const wmbus_rx_result_t *res = &frame->res;
+    if (is_duplicate(ctx, res))
+    {
+        ESP_LOGD(TAG, "duplicate manuf=0x%04X id=%02X%02X%02X%02X dropped",
+                 res->frame_info.header.manufacturer_le,
+                 res->frame_info.header.id[3], res->frame_info.header.id[2], res->frame_info.header.id[1], res->frame_info.header.id[0]);
+        return;
+    }
+
+    if (res->status == WMBUS_PKT_OK)
+    {
+        status_led_pulse();
+    }
+
+    WmbusPacketEvent evt = {
+        .frame_info = res->frame_info,
+        .status = res->status,
+        .rssi_dbm = res->rssi_dbm,
+        .lqi = res->lqi,
+        .raw_packet = res->rx_packet,
+        .raw_len = res->rx_packet ? res->packet_size : 0,
+        .encoded = res->rx_bytes,
+        .encoded_len = res->rx_bytes ? res->encoded_len : 0,
+        .gateway_name = services_hostname(&ctx->services),
+        .logical_packet = res->rx_logical,
+        .logical_len = res->logical_len,
+        .frame = frame,
+    };
+    wmbus_packet_router_dispatch(&evt);
+}
+
+// Consumer: drains the frame queue and runs the (possibly slow) sinks.
+static void dispatch_task(void *arg)
+{
+    app_ctx_t *ctx = (app_ctx_t *)arg;
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(APP_DISPATCH_IDLE_MS));
+        update_wifi_led();
+
+        wmbus_frame_t *frame;
+        while ((frame = wmbus_frame_queue_pop(&ctx->rx_queue)) != NULL)
+        {
+            dispatch_frame(ctx, frame);
+            wmbus_frame_unref(frame); // Sinks that keep the frame hold their own reference
+        }
+    }
+}
+
+void app_get_rx_status(app_rx_status_t *out)
+{
+    if (!out)
+    {
+        return;
+    }
+    wmbus_frame_queue_stats_t stats = {0};
+    wmbus_frame_queue_get_stats(&s_app.rx_queue, &stats);
+    memset(out, 0, sizeof(*out));
+    out->queue_capacity = stats.capacity;
+    out->queue_depth = stats.depth;
+    out->queue_high_water = stats.high_water;
+    out->queue_drops = stats.drops;
+
+    wmbus_frame_pool_stats_t pool = {0};
+    wmbus_frame_pool_get_stats(&s_app.frame_pool, &pool);
+    out->pool_capacity = pool.capacity;
+    out->pool_in_use = pool.in_use;
+    out->pool_high_water = pool.high_water;
+    out->pool_exhausted = pool.exhausted;
+
+    wmbus_rx_stats_t rx = {0};
+    wmbus_pipeline_get_stats(&rx);
+    out->frames = rx.frames;
+    out->rearms = rx.rearms;
+    out->aborted = rx.aborted;
+    out->filtered = rx.filtered;
+    out->filtered_bytes = rx.filtered_bytes;
+    out->dead_time_last_us = rx.dead_time_last_us;
+    out->dead_time_avg_us = rx.dead_time_avg_us;
+    out->dead_time_max_us = rx.dead_time_max_us;
+}
+
+void app_get_dedup_status(app_dedup_status_t *out)
+{
+    if (!out)
+    {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    if (!s_app.dedup_lock)
+    {
+        return;
+    }
+    xSemaphoreTake(s_app.dedup_lock, portMAX_DELAY);
+    const wmbus_dedup_t *d = &s_app.dedup;
+    out->checked = d->checked;
+    out->duplicates = d->duplicates;
+    out->evicted = d->evicted;
+    for (size_t i = 0; i < APP_DEDUP_METERS; i++)
+    {
+        if (d->meters[i].duplicates > 0)
         {
-            status_led_pulse();
-            if (res.frame_info.parsed)
-            {
-                log_packet_summary(&res, &res.frame_info);
-            }
-            else
-            {
-                ESP_LOGW(TAG, "Header parse failed");
-            }
+            app_dedup_meter_t *m = &out->meters[out->meter_count++];
+            m->manuf = d->meters[i].manuf;
+            memcpy(m->id, d->meters[i].id, sizeof(m->id));
+            m->duplicates = d->meters[i].duplicates;
         }
+    }
+    xSemaphoreGive(s_app.dedup_lock);
+}
 
-        WmbusPacketEvent evt = {
-            .frame_info = res.frame_info,
-            .status = res.status,
-            .rssi_dbm = res.rssi_dbm,
-            .lqi = res.lqi,
-            .raw_packet = res.rx_packet,
-            .raw_len = res.packet_size,
-            .encoded = res.rx_bytes,
-            .encoded_len = res.encoded_len,
-            .gateway_name = services_hostname(&ctx->services),
-            .logical_packet = res.rx_logical,
-            .logical_len = res.logical_len,
-        };
-        wmbus_packet_router_dispatch(&evt);
+void app_get_meters_status(app_meters_status_t *out)
+{
+    if (!out)
+    {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    out->capacity = APP_METERS;
+    if (!s_app.meters_lock)
+    {
+        return;
+    }
+    const uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    xSemaphoreTake(s_app.meters_lock, portMAX_DELAY);
+    const wmbus_meter_table_t *t = &s_app.meters;
+    out->count = t->count;
+    out->evicted = t->evicted;
+    out->unattributed = t->unattributed;
+    for (uint32_t i = 0; i < t->count; i++)
+    {
+        wmbus_meter_loss_t loss;
+        wmbus_meter_get_loss(&t->meters[i], now_ms, &loss);
+        out->missed += t->meters[i].missed;
+        out->expected_1h += loss.expected_1h;
+        out->received_1h += loss.received_1h;
+        out->expected_24h += loss.expected_24h;
+        out->received_24h += loss.received_24h;
+    }
+    xSemaphoreGive(s_app.meters_lock);
+}
 
-        vTaskDelay(pdMS_TO_TICKS(APP_RX_LOOP_DELAY_MS));
+bool app_get_meter(uint32_t index, app_meter_status_t *out)
+{
+    if (!out || !s_app.meters_lock)
+    {
+        return false;
+    }
+    const uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    xSemaphoreTake(s_app.meters_lock, portMAX_DELAY);
+    const wmbus_meter_table_t *t = &s_app.meters;
+    const bool found = index < t->count;
+    if (found)
+    {
+        const wmbus_meter_t *m = &t->meters[index];
+        const uint32_t samples = m->frames + m->crc_errors; // At least 1 for a used row
+        memset(out, 0, sizeof(*out));
+        out->manuf = m->manuf;
+        memcpy(out->id, m->id, sizeof(out->id));
+        out->dev_type = m->dev_type;
+        out->first_ms = m->first_ms;
+        out->last_ms = m->last_ms;
+        out->frames = m->frames;
+        out->crc_errors = m->crc_errors;
+        out->rssi_avg = (int16_t)(m->rssi_sum / (int64_t)samples);
+        out->rssi_min = m->rssi_min;
+        out->rssi_max = m->rssi_max;
+        out->lqi_avg = (uint8_t)(m->lqi_sum / samples);
+        out->lqi_min = m->lqi_min;
+        out->lqi_max = m->lqi_max;
+        out->has_acc = m->has_acc;
+        out->acc = m->acc;
+        out->interval_ms = m->interval_ms;
+        out->missed = m->missed;
+        out->repeats = m->repeats;
+        wmbus_meter_loss_t loss;
+        wmbus_meter_get_loss(m, now_ms, &loss);
+        out->expected_1h = loss.expected_1h;
+        out->received_1h = loss.received_1h;
+        out->expected_24h = loss.expected_24h;
+        out->received_24h = loss.received_24h;
+    }
+    xSemaphoreGive(s_app.meters_lock);
+    return found;
+}
+
+bool app_get_meter_loss(uint16_t manuf, const uint8_t id[4], wmbus_meter_loss_t *out)
+{
+    if (!out || !id || !s_app.meters_lock)
+    {
+        return false;
+    }
+    const uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    xSemaphoreTake(s_app.meters_lock, portMAX_DELAY);
+    const wmbus_meter_t *m = wmbus_meter_table_find(&s_app.meters, manuf, id);
+    if (m)
+    {
+        wmbus_meter_get_loss(m, now_ms, out);
+    }
+    xSemaphoreGive(s_app.meters_lock);
+    return m != NULL;
+}
+
+void app_get_sink_status(app_sinks_status_t *out)
+{
+    if (!out)
+    {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    wmbus_sink_stats_t stats[APP_SINKS_MAX];
+    const size_t n = wmbus_packet_router_get_sink_stats(stats, APP_SINKS_MAX);
+    for (size_t i = 0; i < n; i++)
+    {
+        app_sink_status_t *o = &out->sinks[out->count++];
+        memcpy(o->name, stats[i].name, sizeof(o->name));
+        o->async = stats[i].async;
+        o->calls = stats[i].calls;
+        o->avg_us = stats[i].avg_us;
+        o->max_us = stats[i].max_us;
+        o->queued = stats[i].queued;
+        o->high_water = stats[i].high_water;
+        o->dropped = stats[i].dropped;
+        o->filtered = stats[i].filtered;
+        o->has_filter = stats[i].has_filter;
     }
 }
 
@@ -234,6 +533,24 @@ void app_run(void)
 {
     app_ctx_t *ctx = &s_app;
     memset(ctx, 0, sizeof(*ctx));
+    ESP_ERROR_CHECK(wmbus_frame_pool_init(&ctx->frame_pool, ctx->frames, APP_FRAME_POOL_SIZE));
+    ESP_ERROR_CHECK(wmbus_frame_queue_init(&ctx->rx_queue, ctx->rx_slots, APP_RX_QUEUE_DEPTH));
+    wmbus_frame_init(&ctx->rx_overflow);
+    wmbus_dedup_init(&ctx->dedup);
+    ctx->dedup_lock = xSemaphoreCreateMutex();
+    wmbus_meter_table_init(&ctx->meters);
+    ctx->meters_lock = xSemaphoreCreateMutex();
+    if (!ctx->dedup_lock || !ctx->meters_lock)
+    {
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    }
     ESP_ERROR_CHECK(app_setup(ctx));
-    app_loop(ctx);
+
+    // Dispatch task first so the RX task always has a valid notification target.
+    if (xTaskCreate(dispatch_task, "wmbus_dispatch", APP_DISPATCH_TASK_STACK, ctx, APP_DISPATCH_TASK_PRIORITY, &ctx->dispatch_task) != pdPASS ||
+        xTaskCreate(rx_task, "wmbus_rx", APP_RX_TASK_STACK, ctx, APP_RX_TASK_PRIORITY, &ctx->rx_task) != pdPASS)
+    {
+        ESP_LOGE(TAG, "failed to start RX/dispatch tasks");
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    }
 }
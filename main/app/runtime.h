@@ -1,7 +1,23 @@
 // Application runtime wiring: init services, radio, routing, and run RX loop.
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "esp_err.h"
+#include "app/config.h"
+#include "app/wmbus/meter_table.h"
 
-// Initialize subsystems and start the main receive/dispatch loop (blocking).
+// Initialize subsystems and start the RX task and the dispatch task (returns once both run).
 void app_run(void);
+// Snapshot RX -> dispatch queue counters for status reporting.
+void app_get_rx_status(app_rx_status_t *out);
+// Snapshot duplicate-suppression counters (meters with at least one duplicate).
+void app_get_dedup_status(app_dedup_status_t *out);
+// Snapshot meter table counters.
+void app_get_meters_status(app_meters_status_t *out);
+// Meter table row 0 .. count-1 (a replaced meter's successor takes its row); false past the end.
+bool app_get_meter(uint32_t index, app_meter_status_t *out);
+// Reception figures of one meter (O(1) lookup); false when it is not in the table.
+bool app_get_meter_loss(uint16_t manuf, const uint8_t id[4], wmbus_meter_loss_t *out);
+// Snapshot per-sink execution and queue counters of the packet router.
+void app_get_sink_status(app_sinks_status_t *out);
@@ -2,6 +2,10 @@
 
 #include <string.h>
 #include "esp_log.h"
+#include "wmbus/pipeline.h"
+#include "app/net/forwarder.h"
+#include "app/net/framelog.h"
+#include "app/wmbus/filter_config.h"
 
 static const char *TAG = "services";
 
@@ -25,6 +29,7 @@ esp_err_t services_init(services_state_t *svc)
 
     ESP_ERROR_CHECK(backend_init(&svc->backend));
     ESP_ERROR_CHECK(radio_config_init(&svc->radio));
+    ESP_ERROR_CHECK(filter_config_init());
 
     esp_err_t err = wifi_hostname_init();
     if (err != ESP_OK)
@@ -49,6 +54,66 @@ esp_err_t services_get_backend_url(const services_state_t *svc, char *out, size_
     return backend_get_url(services_backend((services_state_t *)svc), out, out_len);
 }
 
+esp_err_t services_set_backend_batch(services_state_t *svc, uint16_t max_frames, uint16_t max_age_ms, uint16_t max_bytes)
+{
+    const backend_batch_t batch = {
+        .max_frames = max_frames,
+        .max_age_ms = max_age_ms,
+        .max_bytes = max_bytes,
+    };
+    esp_err_t err = backend_set_batch(services_backend(svc), &batch);
+    if (err == ESP_OK)
+    {
+        forwarder_kick();
+    }
+    return err;
+}
+
+esp_err_t services_set_backend_format(services_state_t *svc, const char *name)
+{
+    uplink_format_t format;
+    if (!uplink_format_from_name(name, &format))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return backend_set_format(services_backend(svc), format);
+}
+
+esp_err_t services_get_backend_status(const services_state_t *svc, app_backend_status_t *out)
+{
+    if (!svc || !out)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(out, 0, sizeof(*out));
+    out->batch_frames = svc->backend.batch.max_frames;
+    out->batch_ms = svc->backend.batch.max_age_ms;
+    out->batch_bytes = svc->backend.batch.max_bytes;
+    out->format = uplink_format_name(svc->backend.format);
+
+    forwarder_stats_t stats = {0};
+    forwarder_get_stats(&stats);
+    out->queued = stats.queued;
+    out->sent = stats.sent;
+    out->dropped = stats.dropped;
+    out->batches = stats.batches;
+    out->failed = stats.failed;
+    out->last_post_ms = stats.last_post_ms;
+    out->log_spooled = stats.spooled;
+    out->log_replayed = stats.replayed;
+    out->replay_fps = APP_FRAMELOG_REPLAY_FPS;
+
+    framelog_stats_t log = {0};
+    framelog_get_stats(&log);
+    out->log_mounted = log.mounted;
+    out->log_capacity = log.capacity_bytes;
+    out->log_used = log.used_bytes;
+    out->log_backlog = log.backlog;
+    out->log_oldest_s = log.backlog ? (framelog_now_ms() - log.oldest_ms) / 1000 : 0;
+    out->log_lost = log.lost;
+    return ESP_OK;
+}
+
 esp_err_t services_set_wifi_credentials(services_state_t *svc, const char *ssid, const char *pass)
 {
     (void)svc;
@@ -128,12 +193,27 @@ esp_err_t services_get_hostname(char *out, size_t out_len)
 
 esp_err_t services_set_radio_cs_level(services_state_t *svc, uint8_t level)
 {
-    return radio_config_set_cs_level(services_radio(svc), (cc1101_cs_level_t)level);
+    esp_err_t err = radio_config_set_cs_level(services_radio(svc), (cc1101_cs_level_t)level);
+    if (err == ESP_OK)
+    {
+        wmbus_rx_set_cs_level((cc1101_cs_level_t)level);
+    }
+    return err;
 }
 
 esp_err_t services_set_radio_sync_mode(services_state_t *svc, uint8_t mode)
 {
-    return radio_config_set_sync_mode(services_radio(svc), (cc1101_sync_mode_t)mode);
+    esp_err_t err = radio_config_set_sync_mode(services_radio(svc), (cc1101_sync_mode_t)mode);
+    if (err == ESP_OK)
+    {
+        wmbus_rx_set_sync_mode((cc1101_sync_mode_t)mode);
+    }
+    return err;
+}
+
+esp_err_t services_set_radio_dedup_window(services_state_t *svc, uint8_t seconds)
+{
+    return radio_config_set_dedup_window(services_radio(svc), seconds);
 }
 
 esp_err_t services_get_radio_status(const services_state_t *svc, app_radio_status_t *out)
@@ -145,5 +225,31 @@ esp_err_t services_get_radio_status(const services_state_t *svc, app_radio_statu
     memset(out, 0, sizeof(*out));
     out->cs_level = (uint8_t)svc->radio.cs_level;
     out->sync_mode = (uint8_t)svc->radio.sync_mode;
+    out->dedup_window_s = svc->radio.dedup_window_s;
     return ESP_OK;
 }
+
+esp_err_t services_set_addr_filter(services_state_t *svc, uint8_t mode, uint64_t *keys, uint32_t count)
+{
+    (void)svc;
+    return filter_config_set((addr_filter_mode_t)mode, keys, count);
+}
+
+esp_err_t services_get_addr_filter_status(app_filter_status_t *out)
+{
+    if (!out)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(out, 0, sizeof(*out));
+    addr_filter_mode_t mode = ADDR_FILTER_OFF;
+    filter_config_get(&mode, &out->count);
+    out->mode = (uint8_t)mode;
+    out->capacity = APP_ADDR_FILTER_MAX;
+    return ESP_OK;
+}
+
+uint32_t services_get_addr_filter_keys(uint32_t offset, uint64_t *out, uint32_t max)
+{
+    return filter_config_copy_keys(offset, out, max);
+}
@@ -34,6 +34,11 @@ const char *services_hostname(const services_state_t *svc);
 // Setters/Getters as facade for UI/handlers (persistent).
 esp_err_t services_set_backend_url(services_state_t *svc, const char *url);
 esp_err_t services_get_backend_url(const services_state_t *svc, char *out, size_t out_len);
+// Batching thresholds for the forwarder (persistent, applied to the open batch at once).
+esp_err_t services_set_backend_batch(services_state_t *svc, uint16_t max_frames, uint16_t max_age_ms, uint16_t max_bytes);
+// Uplink body encoding by name ("json" / "cbor"; persistent, applies from the next batch).
+esp_err_t services_set_backend_format(services_state_t *svc, const char *name);
+esp_err_t services_get_backend_status(const services_state_t *svc, app_backend_status_t *out);
 
 esp_err_t services_set_wifi_credentials(services_state_t *svc, const char *ssid, const char *pass);
 esp_err_t services_get_wifi_status(app_wifi_status_t *out);
@@ -46,4 +51,13 @@ esp_err_t services_get_hostname(char *out, size_t out_len);
 
 esp_err_t services_set_radio_cs_level(services_state_t *svc, uint8_t level);
 esp_err_t services_set_radio_sync_mode(services_state_t *svc, uint8_t mode);
+// Duplicate-suppression window in seconds (persistent, takes effect with the next frame).
+esp_err_t services_set_radio_dedup_window(services_state_t *svc, uint8_t seconds);
 esp_err_t services_get_radio_status(const services_state_t *svc, app_radio_status_t *out);
+
+// Address filter checked after block 0 (persistent). keys (sorted in place) replaces
+// the list, NULL keeps it; mode is addr_filter_mode_t.
+esp_err_t services_set_addr_filter(services_state_t *svc, uint8_t mode, uint64_t *keys, uint32_t count);
+esp_err_t services_get_addr_filter_status(app_filter_status_t *out);
+// Copy list entries [offset, offset + max); returns the number copied.
+uint32_t services_get_addr_filter_keys(uint32_t offset, uint64_t *out, uint32_t max);
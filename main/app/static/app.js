@@ -273,56 +273,69 @@ function toggleCard(bodyId, btnId){
   }
 }
 
+const PKT_ROWS=20;
+function packetRow(p){
+  const tr=document.createElement('tr');
+  const manufHex=hex(p.manuf||0,4);
+  const ci=hex(p.ci||0,2);
+  const devName=deviceTypeName(p.dev_type);
+  const manufStr=manufCodeToString(p.manuf);
+  const cName=cFieldName(p.control);
+  const ciName=ciFieldName(p.ci);
+  const cShort=shortLabel(cName,'C');
+  const ciShort=ciShortLabel(p, ciName);
+  const enc=encStatus(p);
+  tr.innerHTML=`
+    <td>
+      <div class="dev-name" title="${cName}">${cShort}</div>
+      <div class="muted mono">${hex(p.control||0,2)}</div>
+    </td>
+    <td>
+      <div class="dev-name" title="${ciName}">${ciShort}</div>
+      <div class="muted mono">${ci}</div>
+    </td>
+    <td>
+      <div class="dev-name">${manufStr}</div>
+      <div class="muted mono">${manufHex}</div>
+    </td>
+    <td><span class="mono">${p.id||''}</span></td>
+    <td>
+      <div class="dev-name">${devName}</div>
+      <div class="muted mono">${hex(p.dev_type||0,2)}</div>
+    </td>
+    <td class="mono">${p.version??''}</td>
+    <td class="mono">${(p.rssi??0).toFixed(1)} dBm</td>
+    <td class="mono">${p.payload_len??0}</td>
+    <td class="mono" title="${enc.hint}">${enc.label}</td>`;
+  tr.onclick=()=>showPacketModal(p);
+  return tr;
+}
+function packetSummary(count){
+  const empty=document.getElementById('pkt-empty');
+  document.getElementById('card-monitor-sub').textContent=`${count} packets`;
+  empty.style.display=count?'none':'block';
+  if(count){setCard('card-monitor','info',`${count} packets`,'sensors');}
+  else{setCard('card-monitor','warn','No packets','sensors');}
+}
 function renderPackets(list){
   const tbody=document.getElementById('pkt-body');
   const empty=document.getElementById('pkt-empty');
   if(!tbody||!empty) return;
   tbody.innerHTML='';
-  const count = list ? list.length : 0;
-  document.getElementById('card-monitor-sub').textContent=`${count} packets`;
-  if(!list||!list.length){
-    empty.style.display='block';
-    setCard('card-monitor','warn','No packets','sensors');
-    return;
-  }
-  empty.style.display='none';
-  list.slice(0,20).forEach(p=>{
-    const tr=document.createElement('tr');
-    const manufHex=hex(p.manuf||0,4);
-    const ci=hex(p.ci||0,2);
-    const devName=deviceTypeName(p.dev_type);
-    const manufStr=manufCodeToString(p.manuf);
-    const cName=cFieldName(p.control);
-    const ciName=ciFieldName(p.ci);
-    const cShort=shortLabel(cName,'C');
-    const ciShort=ciShortLabel(p, ciName);
-    const enc=encStatus(p);
-    tr.innerHTML=`
-      <td>
-        <div class="dev-name" title="${cName}">${cShort}</div>
-        <div class="muted mono">${hex(p.control||0,2)}</div>
-      </td>
-      <td>
-        <div class="dev-name" title="${ciName}">${ciShort}</div>
-        <div class="muted mono">${ci}</div>
-      </td>
-      <td>
-        <div class="dev-name">${manufStr}</div>
-        <div class="muted mono">${manufHex}</div>
-      </td>
-      <td><span class="mono">${p.id||''}</span></td>
-      <td>
-        <div class="dev-name">${devName}</div>
-        <div class="muted mono">${hex(p.dev_type||0,2)}</div>
-      </td>
-      <td class="mono">${p.version??''}</td>
-      <td class="mono">${(p.rssi??0).toFixed(1)} dBm</td>
-      <td class="mono">${p.payload_len??0}</td>
-      <td class="mono" title="${enc.hint}">${enc.label}</td>`;
-    tr.onclick=()=>showPacketModal(p);
-    tbody.appendChild(tr);
-  });
-  setCard('card-monitor','info',`${count} packets`,'sensors');
+  const rows=(list||[]).slice(0,PKT_ROWS);
+  rows.forEach(p=>tbody.appendChild(packetRow(p)));
+  packetSummary(rows.length);
+}
+// Newer packets (newest first) go on top; existing rows are kept
+function prependPackets(list){
+  const tbody=document.getElementById('pkt-body');
+  const empty=document.getElementById('pkt-empty');
+  if(!tbody||!empty||!list.length) return;
+  const frag=document.createDocumentFragment();
+  list.slice(0,PKT_ROWS).forEach(p=>frag.appendChild(packetRow(p)));
+  tbody.insertBefore(frag,tbody.firstChild);
+  while(tbody.rows.length>PKT_ROWS){tbody.deleteRow(-1);}
+  packetSummary(tbody.rows.length);
 }
 
 function closePacketModal(){
@@ -492,8 +505,8 @@ async function fetchJSON(path){
   return r.json();
 }
 
-async function postExpectOk(url){
-  const r=await fetch(url,{method:'POST'});
+async function postExpectOk(url,body){
+  const r=await fetch(url,{method:'POST',body});
   if(!r.ok){
     let msg=`Error ${r.status}`;
     try{const j=await r.json();if(j.error) msg=j.error;}catch(_){/* ignore */}
@@ -519,6 +532,7 @@ function fillStatus(data){
   document.getElementById('ap-pass').value='';
   document.getElementById('cs-level').value=data.radio.cs_level;
   document.getElementById('sync-mode').value=data.radio.sync_mode;
+  document.getElementById('dedup-window').value=data.radio.dedup_window_s;
   setBadge('status-wifi','status-wifi-value',data.wifi.connected?`Connected (${data.wifi.ip})`:'Not connected',data.wifi.connected?'ok':'warn');
   setBadge('status-radio','status-radio-value',`CS ${data.radio.cs_level} · Sync ${data.radio.sync_mode}`,'ok');
   updateBackendIndicators(data.backend.url,data.backend.reachable);
@@ -579,13 +593,60 @@ async function saveRadio(){
   try{
     const cs=document.getElementById('cs-level').value;
     const sync=document.getElementById('sync-mode').value;
-    await postExpectOk(`/api/radio?cs=${qs(cs)}&sync=${qs(sync)}`);
+    const dedup=document.getElementById('dedup-window').value;
+    await postExpectOk(`/api/radio?cs=${qs(cs)}&sync=${qs(sync)}&dedup=${qs(dedup)}`);
     toast('Radio saved','success');
     loadStatus();
   }catch(e){toast(e.message,'error');}
 }
-async function loadPackets(){try{const data=await fetchJSON('/api/packets');if(data.packets){renderPackets(data.packets);} }catch(e){/* ignore */}}
-setInterval(loadPackets,3000);
+async function loadFilter(){
+  try{
+    const data=await fetchJSON('/api/filter');
+    document.getElementById('filter-mode').value=data.mode;
+    document.getElementById('filter-list').value=data.entries.join('\n');
+    document.getElementById('filter-status').textContent=`${data.count}/${data.capacity} meters · ${data.filtered} frames skipped (${data.filtered_bytes} bytes)`;
+  }catch(e){/* ignore */}
+}
+async function saveFilter(){
+  try{
+    const mode=document.getElementById('filter-mode').value;
+    const list=document.getElementById('filter-list').value.trim();
+    await postExpectOk(`/api/filter?mode=${qs(mode)}${list?'':'&clear=1'}`,list||undefined);
+    toast('Filter saved','success');
+    loadFilter();
+  }catch(e){toast(e.message,'error');}
+}
+let pktSeq=null;
+let pktPoll=null;
+// Only frames newer than pktSeq are fetched; "reset" (reboot, or frames missed) redraws the table
+async function loadPackets(){
+  try{
+    const data=await fetchJSON(pktSeq===null?'/api/packets':`/api/packets?since=${pktSeq}&limit=${PKT_ROWS}`);
+    if(!data.packets) return;
+    if(pktSeq===null||data.reset){renderPackets(data.packets);}
+    else{prependPackets(data.packets);}
+    pktSeq=data.seq;
+  }catch(e){/* ignore */}
+}
+function pollPackets(){if(!pktPoll){pktPoll=setInterval(loadPackets,3000);}}
+// Live packets over SSE; fall back to polling while the stream is down or refused (503)
+function streamPackets(){
+  if(!window.EventSource){pollPackets();return;}
+  const es=new EventSource('/api/packets/stream');
+  es.onopen=()=>{if(pktPoll){clearInterval(pktPoll);pktPoll=null;}loadPackets();};
+  es.onmessage=ev=>{
+    let p;
+    try{p=JSON.parse(ev.data);}catch(e){return;}
+    if(pktSeq!==null&&p.seq<=pktSeq) return;
+    prependPackets([p]);
+    pktSeq=p.seq;
+  };
+  es.onerror=()=>{
+    pollPackets();
+    if(es.readyState===EventSource.CLOSED){setTimeout(streamPackets,30000);}
+  };
+}
+streamPackets();
 setInterval(loadStatus,5000);
 
 if (themeToggle) {
@@ -598,6 +659,7 @@ applyTheme(localStorage.getItem(THEME_KEY) || 'light');
 
 loadStatus();
 loadPackets();
+loadFilter();
 // apply icon masks so external SVGs inherit currentColor
 document.addEventListener('DOMContentLoaded', ()=>{
   document.querySelectorAll('.icon').forEach(el=>{
@@ -118,3 +118,24 @@ esp_err_t storage_set_blob(const char *ns, const char *key, const void *data, si
     nvs_close(nvs);
     return err;
 }
+
+esp_err_t storage_erase(const char *ns, const char *key)
+{
+    if (!ns || !key)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(ns, NVS_READWRITE, &nvs);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    err = nvs_erase_key(nvs, key);
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    return err;
+}
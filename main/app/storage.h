@@ -13,3 +13,6 @@ esp_err_t storage_set_u8(const char *ns, const char *key, uint8_t val);
 
 esp_err_t storage_get_blob(const char *ns, const char *key, void *out, size_t *len_inout);
 esp_err_t storage_set_blob(const char *ns, const char *key, const void *data, size_t len);
+
+// ESP_ERR_NVS_NOT_FOUND when the key does not exist.
+esp_err_t storage_erase(const char *ns, const char *key);
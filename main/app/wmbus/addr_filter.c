@@ -0,0 +1,193 @@
+#include "app/wmbus/addr_filter.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define KEY_WILDCARD_MASK 0xFFFFFFFFull
+
+uint64_t addr_filter_key(uint16_t manuf, const uint8_t id[4])
+{
+    const uint32_t id_le = (uint32_t)id[0] | ((uint32_t)id[1] << 8) | ((uint32_t)id[2] << 16) | ((uint32_t)id[3] << 24);
+    return ((uint64_t)manuf << 32) | id_le;
+}
+
+static int key_cmp(const void *a, const void *b)
+{
+    const uint64_t ka = *(const uint64_t *)a;
+    const uint64_t kb = *(const uint64_t *)b;
+    return (ka > kb) - (ka < kb);
+}
+
+uint32_t addr_filter_sort(uint64_t *keys, uint32_t count)
+{
+    if (!keys || count == 0)
+    {
+        return 0;
+    }
+    qsort(keys, count, sizeof(keys[0]), key_cmp);
+    uint32_t out = 1;
+    for (uint32_t i = 1; i < count; i++)
+    {
+        if (keys[i] != keys[out - 1])
+        {
+            keys[out++] = keys[i];
+        }
+    }
+    return out;
+}
+
+static bool find_key(const uint64_t *keys, uint32_t count, uint64_t key)
+{
+    uint32_t lo = 0;
+    uint32_t hi = count;
+    while (lo < hi)
+    {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (keys[mid] < key)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo < count && keys[lo] == key;
+}
+
+bool addr_filter_contains(const addr_filter_t *f, uint16_t manuf, const uint8_t id[4])
+{
+    if (!f || !f->keys || f->count == 0 || !id)
+    {
+        return false;
+    }
+    const uint64_t key = addr_filter_key(manuf, id);
+    // Wildcard entries (manufacturer 0) sort first; skip their search when there are none
+    return find_key(f->keys, f->count, key) ||
+           (f->keys[0] <= KEY_WILDCARD_MASK && find_key(f->keys, f->count, key & KEY_WILDCARD_MASK));
+}
+
+bool addr_filter_accept(const addr_filter_t *f, const WmbusFrameHeaderRaw *hdr)
+{
+    if (!f || !hdr || f->mode == ADDR_FILTER_OFF)
+    {
+        return true;
+    }
+    const bool listed = addr_filter_contains(f, hdr->manufacturer_le, hdr->id);
+    return (f->mode == ADDR_FILTER_ALLOW) ? listed : !listed;
+}
+
+static int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool addr_filter_parse_entry(const char *s, size_t len, uint64_t *key)
+{
+    if (!s || !key)
+    {
+        return false;
+    }
+    uint16_t manuf = 0;
+    if (len == 11 || len == 12)
+    {
+        // Three-letter manufacturer code (EN 13757-3: 5 bits per letter, 'A' = 1)
+        for (size_t i = 0; i < 3; i++)
+        {
+            const char c = (char)(s[i] & ~0x20);
+            if (c < 'A' || c > 'Z')
+            {
+                return false;
+            }
+            manuf = (uint16_t)((manuf << 5) | (uint16_t)(c - 'A' + 1));
+        }
+        if (len == 12 && s[3] != '-')
+        {
+            return false;
+        }
+        s += len - 8;
+        len = 8;
+    }
+    if (len != 8)
+    {
+        return false;
+    }
+    uint32_t id = 0;
+    for (size_t i = 0; i < 8; i++)
+    {
+        const int d = hex_digit(s[i]);
+        if (d < 0)
+        {
+            return false;
+        }
+        id = (id << 4) | (uint32_t)d;
+    }
+    *key = ((uint64_t)manuf << 32) | id;
+    return true;
+}
+
+void addr_filter_format_entry(uint64_t key, char *out)
+{
+    if (!out)
+    {
+        return;
+    }
+    static const char HEX[] = "0123456789ABCDEF";
+    const uint16_t manuf = (uint16_t)(key >> 32);
+    const uint32_t id = (uint32_t)key;
+    size_t n = 0;
+    if (manuf)
+    {
+        out[n++] = (char)('A' - 1 + ((manuf >> 10) & 0x1F));
+        out[n++] = (char)('A' - 1 + ((manuf >> 5) & 0x1F));
+        out[n++] = (char)('A' - 1 + (manuf & 0x1F));
+        out[n++] = '-';
+    }
+    for (int shift = 28; shift >= 0; shift -= 4)
+    {
+        out[n++] = HEX[(id >> shift) & 0xF];
+    }
+    out[n] = '\0';
+}
+
+const char *addr_filter_mode_name(addr_filter_mode_t mode)
+{
+    switch (mode)
+    {
+    case ADDR_FILTER_ALLOW:
+        return "allow";
+    case ADDR_FILTER_DENY:
+        return "deny";
+    default:
+        return "off";
+    }
+}
+
+bool addr_filter_parse_mode(const char *s, addr_filter_mode_t *out)
+{
+    if (!s || !out)
+    {
+        return false;
+    }
+    for (int m = ADDR_FILTER_OFF; m <= ADDR_FILTER_DENY; m++)
+    {
+        if (strcmp(s, addr_filter_mode_name((addr_filter_mode_t)m)) == 0)
+        {
+            *out = (addr_filter_mode_t)m;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,48 @@
+// Meter address allow/deny list, checked by the RX pipeline right after block 0.
+// Entries are sorted 48-bit keys (manufacturer, ID) searched by bisection, so a
+// list of thousands of meters costs a dozen compares per frame. An entry with
+// manufacturer 0 matches its ID from any manufacturer.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "wmbus/packet.h"
+
+#define ADDR_FILTER_ENTRY_CHARS 12 // "KAM-12345678"
+
+typedef enum
+{
+    ADDR_FILTER_OFF = 0, // Every frame is received
+    ADDR_FILTER_ALLOW,   // Only listed meters are received
+    ADDR_FILTER_DENY,    // Listed meters are dropped
+} addr_filter_mode_t;
+
+typedef struct
+{
+    addr_filter_mode_t mode;
+    uint32_t count;
+    const uint64_t *keys; // Sorted and unique (addr_filter_sort)
+} addr_filter_t;
+
+// Key of one address: M-field in the upper 16 bits, ID (little-endian as on air) below.
+uint64_t addr_filter_key(uint16_t manuf, const uint8_t id[4]);
+
+// Sort keys ascending and drop repeats in place; returns the unique count.
+uint32_t addr_filter_sort(uint64_t *keys, uint32_t count);
+
+// True when the address is in the list (exact or manufacturer wildcard).
+bool addr_filter_contains(const addr_filter_t *f, uint16_t manuf, const uint8_t id[4]);
+
+// Filter decision for a link-layer header: true = receive the frame.
+bool addr_filter_accept(const addr_filter_t *f, const WmbusFrameHeaderRaw *hdr);
+
+// Parse "KAM-12345678", "KAM12345678" or "12345678" (any manufacturer). The ID is
+// written as printed on the meter (most significant BCD digit first).
+bool addr_filter_parse_entry(const char *s, size_t len, uint64_t *key);
+
+// Inverse of addr_filter_parse_entry; out needs ADDR_FILTER_ENTRY_CHARS + 1 bytes.
+void addr_filter_format_entry(uint64_t key, char *out);
+
+const char *addr_filter_mode_name(addr_filter_mode_t mode);
+bool addr_filter_parse_mode(const char *s, addr_filter_mode_t *out);
@@ -0,0 +1,143 @@
+#include "app/wmbus/dedup.h"
+
+#include <string.h>
+#include "app/wmbus/frame_parse.h"
+
+_Static_assert((APP_DEDUP_SLOTS & (APP_DEDUP_SLOTS - 1)) == 0, "APP_DEDUP_SLOTS must be a power of two");
+
+static uint32_t fnv1a(const uint8_t *p, uint16_t len)
+{
+    uint32_t h = 2166136261u;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+static uint32_t key_hash(const wmbus_dedup_key_t *k)
+{
+    uint32_t h = k->digest;
+    h ^= ((uint32_t)k->manuf << 16) | ((uint32_t)k->ci << 8) | k->acc;
+    h = (h ^ (h >> 16)) * 0x7FEB352Du;
+    h ^= ((uint32_t)k->id[0] | ((uint32_t)k->id[1] << 8) | ((uint32_t)k->id[2] << 16) | ((uint32_t)k->id[3] << 24));
+    h = (h ^ (h >> 15)) * 0x846CA68Bu;
+    h ^= h >> 16;
+    return h ? h : 1;
+}
+
+static bool key_equal(const wmbus_dedup_key_t *a, const wmbus_dedup_key_t *b)
+{
+    return a->digest == b->digest && a->manuf == b->manuf && a->ci == b->ci && a->acc == b->acc &&
+           memcmp(a->id, b->id, sizeof(a->id)) == 0;
+}
+
+void wmbus_dedup_init(wmbus_dedup_t *d)
+{
+    if (d)
+    {
+        memset(d, 0, sizeof(*d));
+    }
+}
+
+bool wmbus_dedup_make_key(const WmbusFrameInfo *info, const uint8_t *logical, uint16_t logical_len, wmbus_dedup_key_t *out)
+{
+    if (!info || !info->parsed || !logical || !out || logical_len < WMBUS_FIXED_HEADER_BYTES)
+    {
+        return false;
+    }
+    memset(out, 0, sizeof(*out));
+    out->manuf = info->header.manufacturer_le;
+    memcpy(out->id, info->header.id, sizeof(out->id));
+    out->ci = info->header.ci_field;
+
+    // The digest skips the ELL/TPL header so a repeater's hop bit does not matter
+    uint16_t digest_from = WMBUS_FIXED_HEADER_BYTES;
+    wmbus_ell_meta_t ell;
+    wmbus_tpl_meta_t tpl;
+    if (wmbus_parse_ell_meta(info, logical, logical_len, &ell))
+    {
+        out->acc = ell.acc;
+        digest_from = ell.payload_offset;
+    }
+    else if (wmbus_parse_tpl_meta(out->ci, WMBUS_FIXED_HEADER_BYTES - 1, logical, logical_len, &tpl))
+    {
+        out->acc = tpl.acc;
+        digest_from = tpl.payload_offset;
+    }
+    if (digest_from > logical_len)
+    {
+        digest_from = logical_len;
+    }
+    out->digest = fnv1a(logical + digest_from, (uint16_t)(logical_len - digest_from));
+    return true;
+}
+
+static void count_meter(wmbus_dedup_t *d, const wmbus_dedup_key_t *key, uint32_t now_ms)
+{
+    // First free row, else the meter whose last duplicate is the oldest
+    wmbus_dedup_meter_t *victim = NULL;
+    for (size_t i = 0; i < APP_DEDUP_METERS; i++)
+    {
+        wmbus_dedup_meter_t *m = &d->meters[i];
+        if (m->duplicates > 0 && m->manuf == key->manuf && memcmp(m->id, key->id, sizeof(m->id)) == 0)
+        {
+            m->duplicates++;
+            m->last_ms = now_ms;
+            return;
+        }
+        if (!victim || (victim->duplicates > 0 && (m->duplicates == 0 || (int32_t)(m->last_ms - victim->last_ms) < 0)))
+        {
+            victim = m;
+        }
+    }
+    victim->manuf = key->manuf;
+    memcpy(victim->id, key->id, sizeof(victim->id));
+    victim->duplicates = 1;
+    victim->last_ms = now_ms;
+}
+
+bool wmbus_dedup_check(wmbus_dedup_t *d, const wmbus_dedup_key_t *key, uint32_t now_ms, uint32_t window_ms)
+{
+    if (!d || !key || window_ms == 0)
+    {
+        return false;
+    }
+    d->checked++;
+
+    // Every entry lives within WMBUS_DEDUP_PROBE slots of its home slot, so a
+    // lookup inspects exactly that window; expired entries count as free.
+    const uint32_t hash = key_hash(key);
+    wmbus_dedup_entry_t *free_slot = NULL;
+    wmbus_dedup_entry_t *oldest = NULL;
+    for (uint32_t i = 0; i < WMBUS_DEDUP_PROBE; i++)
+    {
+        wmbus_dedup_entry_t *e = &d->slots[(hash + i) & (APP_DEDUP_SLOTS - 1)];
+        const bool live = e->hash != 0 && (now_ms - e->seen_ms) < window_ms;
+        if (live && e->hash == hash && key_equal(&e->key, key))
+        {
+            d->duplicates++;
+            count_meter(d, key, now_ms);
+            return true;
+        }
+        if (!live)
+        {
+            free_slot = free_slot ? free_slot : e;
+        }
+        else if (!oldest || (int32_t)(e->seen_ms - oldest->seen_ms) < 0)
+        {
+            oldest = e;
+        }
+    }
+
+    wmbus_dedup_entry_t *slot = free_slot;
+    if (!slot)
+    {
+        slot = oldest;
+        d->evicted++;
+    }
+    slot->hash = hash;
+    slot->seen_ms = now_ms;
+    slot->key = *key;
+    return false;
+}
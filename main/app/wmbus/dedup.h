@@ -0,0 +1,55 @@
+// Duplicate-telegram suppression: meters repeat telegrams and repeaters relay
+// them again. A fixed open-addressing cache remembers each telegram (address,
+// CI, access number, payload digest) for a time window; later copies are
+// counted per meter and reported as duplicates.
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "wmbus/packet.h"
+#include "app/config.h"
+
+#define WMBUS_DEDUP_PROBE 8 // Slots inspected per lookup (bounded linear probing)
+
+typedef struct
+{
+    uint16_t manuf;
+    uint8_t id[4];
+    uint8_t ci;
+    uint8_t acc;     // ELL ACC, else TPL ACC, else 0
+    uint32_t digest; // FNV-1a over the bytes after the ACC-bearing header
+} wmbus_dedup_key_t;
+
+typedef struct
+{
+    uint32_t hash; // 0 = empty slot
+    uint32_t seen_ms;
+    wmbus_dedup_key_t key;
+} wmbus_dedup_entry_t;
+
+typedef struct
+{
+    uint16_t manuf;
+    uint8_t id[4];
+    uint32_t duplicates;
+    uint32_t last_ms; // Last duplicate; the stalest meter is replaced when the table is full
+} wmbus_dedup_meter_t;
+
+typedef struct
+{
+    wmbus_dedup_entry_t slots[APP_DEDUP_SLOTS]; // Power of two
+    wmbus_dedup_meter_t meters[APP_DEDUP_METERS];
+    uint32_t checked;
+    uint32_t duplicates;
+    uint32_t evicted; // Live entries overwritten because their probe window was full
+} wmbus_dedup_t;
+
+void wmbus_dedup_init(wmbus_dedup_t *d);
+
+// Build the key of a parsed frame from its CRC-free logical bytes.
+bool wmbus_dedup_make_key(const WmbusFrameInfo *info, const uint8_t *logical, uint16_t logical_len, wmbus_dedup_key_t *out);
+
+// True when the same telegram was first seen less than window_ms ago (the
+// duplicate is counted); otherwise it is remembered from now_ms on.
+// window_ms 0 disables suppression.
+bool wmbus_dedup_check(wmbus_dedup_t *d, const wmbus_dedup_key_t *key, uint32_t now_ms, uint32_t window_ms);
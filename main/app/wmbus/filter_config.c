@@ -0,0 +1,266 @@
+#include "app/wmbus/filter_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "app/storage.h"
+#include "app/config.h"
+
+static const char *TAG = "filter_cfg";
+static const char *NAMESPACE = "filter";
+static const char *KEY_MODE = "mode";
+static const char *KEY_COUNT = "count";
+
+// The list is stored in chunks so an update never needs room for two copies of
+// the whole blob in the small NVS partition. 6 bytes per entry: M-field, ID (LE).
+#define CHUNK_ENTRIES 256
+#define ENTRY_BYTES 6
+#define CHUNK_COUNT ((APP_ADDR_FILTER_MAX + CHUNK_ENTRIES - 1) / CHUNK_ENTRIES)
+
+static SemaphoreHandle_t s_lock;
+static addr_filter_t s_filter; // keys are heap-owned; replaced only under s_lock
+
+static void chunk_key(uint32_t chunk, char *out, size_t len)
+{
+    snprintf(out, len, "keys%u", (unsigned)chunk);
+}
+
+static void pack_key(uint64_t key, uint8_t *out)
+{
+    for (size_t i = 0; i < ENTRY_BYTES; i++)
+    {
+        out[i] = (uint8_t)(key >> (8 * ((i + 4) % ENTRY_BYTES)));
+    }
+}
+
+static uint64_t unpack_key(const uint8_t *in)
+{
+    uint64_t key = 0;
+    for (size_t i = 0; i < ENTRY_BYTES; i++)
+    {
+        key |= (uint64_t)in[i] << (8 * ((i + 4) % ENTRY_BYTES));
+    }
+    return key;
+}
+
+// Mode goes to "off" first and back last, so an interrupted save can never
+// leave an allowlist with half its entries (which would drop wanted meters).
+static esp_err_t save_cfg(addr_filter_mode_t mode, const uint64_t *keys, uint32_t count)
+{
+    esp_err_t err = storage_set_u8(NAMESPACE, KEY_MODE, ADDR_FILTER_OFF);
+    uint8_t *buf = NULL;
+    if (err == ESP_OK && keys)
+    {
+        buf = malloc(CHUNK_ENTRIES * ENTRY_BYTES);
+        err = buf ? ESP_OK : ESP_ERR_NO_MEM;
+        for (uint32_t first = 0; err == ESP_OK && first < count; first += CHUNK_ENTRIES)
+        {
+            const uint32_t n = (count - first < CHUNK_ENTRIES) ? count - first : CHUNK_ENTRIES;
+            for (uint32_t i = 0; i < n; i++)
+            {
+                pack_key(keys[first + i], &buf[i * ENTRY_BYTES]);
+            }
+            char name[8];
+            chunk_key(first / CHUNK_ENTRIES, name, sizeof(name));
+            err = storage_set_blob(NAMESPACE, name, buf, n * ENTRY_BYTES);
+        }
+        if (err == ESP_OK)
+        {
+            const uint16_t stored = (uint16_t)count;
+            err = storage_set_blob(NAMESPACE, KEY_COUNT, &stored, sizeof(stored));
+        }
+        // Chunks past the new count are dead once count is written; free their space
+        for (uint32_t chunk = (count + CHUNK_ENTRIES - 1) / CHUNK_ENTRIES; err == ESP_OK && chunk < CHUNK_COUNT; chunk++)
+        {
+            char name[8];
+            chunk_key(chunk, name, sizeof(name));
+            const esp_err_t erase_err = storage_erase(NAMESPACE, name);
+            err = (erase_err == ESP_ERR_NVS_NOT_FOUND) ? ESP_OK : erase_err;
+        }
+    }
+    if (err == ESP_OK && mode != ADDR_FILTER_OFF)
+    {
+        err = storage_set_u8(NAMESPACE, KEY_MODE, (uint8_t)mode);
+    }
+    free(buf);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "filter save failed: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+static esp_err_t load_cfg(addr_filter_mode_t *mode, uint64_t **keys, uint32_t *count)
+{
+    uint8_t m = 0;
+    esp_err_t err = storage_get_u8(NAMESPACE, KEY_MODE, &m);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    uint16_t stored = 0;
+    size_t len = sizeof(stored);
+    if (storage_get_blob(NAMESPACE, KEY_COUNT, &stored, &len) != ESP_OK || stored > APP_ADDR_FILTER_MAX)
+    {
+        stored = 0;
+    }
+
+    uint64_t *list = stored ? malloc(stored * sizeof(uint64_t)) : NULL;
+    uint8_t *buf = stored ? malloc(CHUNK_ENTRIES * ENTRY_BYTES) : NULL;
+    if (stored && (!list || !buf))
+    {
+        free(list);
+        free(buf);
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint32_t first = 0; err == ESP_OK && first < stored; first += CHUNK_ENTRIES)
+    {
+        const uint32_t n = (stored - first < CHUNK_ENTRIES) ? stored - first : CHUNK_ENTRIES;
+        char name[8];
+        chunk_key(first / CHUNK_ENTRIES, name, sizeof(name));
+        len = n * ENTRY_BYTES;
+        err = storage_get_blob(NAMESPACE, name, buf, &len);
+        if (err == ESP_OK && len != n * ENTRY_BYTES)
+        {
+            err = ESP_ERR_INVALID_SIZE;
+        }
+        for (uint32_t i = 0; err == ESP_OK && i < n; i++)
+        {
+            list[first + i] = unpack_key(&buf[i * ENTRY_BYTES]);
+        }
+    }
+    free(buf);
+    if (err != ESP_OK || m > ADDR_FILTER_DENY)
+    {
+        free(list);
+        return (err != ESP_OK) ? err : ESP_ERR_INVALID_STATE;
+    }
+    *mode = (addr_filter_mode_t)m;
+    *count = addr_filter_sort(list, stored);
+    *keys = list;
+    return ESP_OK;
+}
+
+esp_err_t filter_config_init(void)
+{
+    if (!s_lock)
+    {
+        s_lock = xSemaphoreCreateMutex();
+        if (!s_lock)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    addr_filter_mode_t mode = ADDR_FILTER_OFF;
+    uint64_t *keys = NULL;
+    uint32_t count = 0;
+    esp_err_t err = load_cfg(&mode, &keys, &count);
+    if (err != ESP_OK)
+    {
+        if (err != ESP_ERR_NVS_NOT_FOUND)
+        {
+            ESP_LOGW(TAG, "load filter failed: %s", esp_err_to_name(err));
+        }
+        return ESP_OK; // Filter stays off
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    free((void *)s_filter.keys);
+    s_filter.keys = keys;
+    s_filter.count = count;
+    s_filter.mode = mode;
+    xSemaphoreGive(s_lock);
+    ESP_LOGI(TAG, "address filter %s, %u entries", addr_filter_mode_name(mode), (unsigned)count);
+    return ESP_OK;
+}
+
+esp_err_t filter_config_set(addr_filter_mode_t mode, uint64_t *keys, uint32_t count)
+{
+    if (!s_lock || mode > ADDR_FILTER_DENY || (keys && count > APP_ADDR_FILTER_MAX))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint64_t *table = NULL;
+    if (keys)
+    {
+        count = addr_filter_sort(keys, count);
+        if (count)
+        {
+            table = malloc(count * sizeof(uint64_t));
+            if (!table)
+            {
+                return ESP_ERR_NO_MEM;
+            }
+            memcpy(table, keys, count * sizeof(uint64_t));
+        }
+    }
+
+    const uint64_t *old = NULL;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (keys)
+    {
+        old = s_filter.keys;
+        s_filter.keys = table;
+        s_filter.count = count;
+    }
+    s_filter.mode = mode;
+    xSemaphoreGive(s_lock);
+    free((void *)old);
+
+    // Persist from the caller's (sorted) copy; the live table may be replaced meanwhile
+    return save_cfg(mode, keys, count);
+}
+
+bool filter_config_accept(const WmbusFrameHeaderRaw *hdr, void *ctx)
+{
+    (void)ctx;
+    if (!s_lock || s_filter.mode == ADDR_FILTER_OFF)
+    {
+        return true;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    const bool accept = addr_filter_accept(&s_filter, hdr);
+    xSemaphoreGive(s_lock);
+    return accept;
+}
+
+void filter_config_get(addr_filter_mode_t *mode, uint32_t *count)
+{
+    if (!s_lock)
+    {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (mode)
+    {
+        *mode = s_filter.mode;
+    }
+    if (count)
+    {
+        *count = s_filter.count;
+    }
+    xSemaphoreGive(s_lock);
+}
+
+uint32_t filter_config_copy_keys(uint32_t offset, uint64_t *out, uint32_t max)
+{
+    if (!s_lock || !out)
+    {
+        return 0;
+    }
+    uint32_t n = 0;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (offset < s_filter.count)
+    {
+        n = s_filter.count - offset;
+        n = (n > max) ? max : n;
+        memcpy(out, &s_filter.keys[offset], n * sizeof(uint64_t));
+    }
+    xSemaphoreGive(s_lock);
+    return n;
+}
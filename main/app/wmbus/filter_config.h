@@ -0,0 +1,24 @@
+// Persisted address filter (mode + meter list) and the live copy consulted by the
+// RX task. Updates build a new sorted table and swap it in under a short lock.
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "wmbus/packet.h"
+#include "app/wmbus/addr_filter.h"
+
+// Load mode and list from NVS (filter off when nothing is stored).
+esp_err_t filter_config_init(void);
+
+// Replace the list (keys may be NULL to keep the current one) and set the mode,
+// then persist both. keys is sorted in place; at most APP_ADDR_FILTER_MAX entries.
+esp_err_t filter_config_set(addr_filter_mode_t mode, uint64_t *keys, uint32_t count);
+
+// wmbus_rx_header_filter_t for wmbus_rx_set_header_filter (ctx unused).
+bool filter_config_accept(const WmbusFrameHeaderRaw *hdr, void *ctx);
+
+// Current mode and entry count.
+void filter_config_get(addr_filter_mode_t *mode, uint32_t *count);
+
+// Copy up to max keys starting at entry `offset` (sorted order); returns the number copied.
+uint32_t filter_config_copy_keys(uint32_t offset, uint64_t *out, uint32_t max);
@@ -0,0 +1,482 @@
+#include "app/wmbus/frame_filter.h"
+
+#include <ctype.h>
+#include <string.h>
+
+// Accumulator machine: comparisons set acc, jumps short-circuit && and ||.
+enum
+{
+    OP_EQ = 1,
+    OP_NE,
+    OP_LT,
+    OP_LE,
+    OP_GT,
+    OP_GE,
+    OP_IN,   // The count values follow as OP_DATA
+    OP_DATA,
+    OP_NOT,
+    OP_JT,   // Jump when acc is true
+    OP_JF,   // Jump when acc is false
+};
+
+enum
+{
+    F_C,
+    F_MANUF,
+    F_ID,
+    F_VERSION,
+    F_DEV_TYPE,
+    F_CI,
+    F_LEN,
+    F_PAYLOAD_LEN,
+    F_RSSI,
+    F_LQI,
+    F_FIRST_META,
+    F_ACC = F_FIRST_META,
+    F_HDR,
+    F_STATUS,
+    F_SEC_MODE,
+    F_ENCRYPTED,
+    F_ELL,
+    F_AFL,
+    F_COUNT,
+};
+
+static const char *const FIELD_NAMES[F_COUNT] = {
+    "c", "manuf", "id", "version", "dev_type", "ci", "len", "payload_len", "rssi", "lqi",
+    "acc", "hdr", "status", "sec_mode", "encrypted", "ell", "afl",
+};
+
+typedef struct
+{
+    const char *p;
+    frame_filter_t *out;
+    esp_err_t err;
+    const char *err_at;
+    uint8_t depth;
+} compiler_t;
+
+static bool fail(compiler_t *c, esp_err_t err, const char *at)
+{
+    if (c->err == ESP_OK)
+    {
+        c->err = err;
+        c->err_at = at;
+    }
+    return false;
+}
+
+static void skip_ws(compiler_t *c)
+{
+    while (*c->p == ' ' || *c->p == '\t' || *c->p == '\r' || *c->p == '\n')
+    {
+        c->p++;
+    }
+}
+
+// Consume tok (after whitespace) if it comes next.
+static bool accept(compiler_t *c, const char *tok)
+{
+    skip_ws(c);
+    const size_t n = strlen(tok);
+    if (strncmp(c->p, tok, n) != 0)
+    {
+        return false;
+    }
+    c->p += n;
+    return true;
+}
+
+static int emit(compiler_t *c, uint8_t op, uint8_t field, int32_t imm)
+{
+    frame_filter_t *f = c->out;
+    if (f->len >= FRAME_FILTER_MAX_INSNS)
+    {
+        fail(c, ESP_ERR_INVALID_SIZE, c->p);
+        return -1;
+    }
+    f->code[f->len] = (frame_filter_insn_t){.op = op, .field = field, .imm = imm};
+    return f->len++;
+}
+
+static size_t word_len(const char *s)
+{
+    size_t n = 0;
+    while (isalnum((unsigned char)s[n]) || s[n] == '_')
+    {
+        n++;
+    }
+    return n;
+}
+
+static bool parse_field(compiler_t *c, uint8_t *field)
+{
+    skip_ws(c);
+    const size_t n = word_len(c->p);
+    for (uint8_t i = 0; i < F_COUNT; i++)
+    {
+        if (n && strlen(FIELD_NAMES[i]) == n && strncmp(c->p, FIELD_NAMES[i], n) == 0)
+        {
+            *field = i;
+            c->p += n;
+            return true;
+        }
+    }
+    return fail(c, ESP_ERR_INVALID_ARG, c->p);
+}
+
+// Literal for field: id as printed hex digits, manuf also as a three-letter code.
+static bool parse_value(compiler_t *c, uint8_t field, int32_t *out)
+{
+    skip_ws(c);
+    const char *start = c->p;
+    const size_t n = word_len(c->p);
+    if (field == F_MANUF && n == 3 && isalpha((unsigned char)start[0]))
+    {
+        uint32_t manuf = 0;
+        for (size_t i = 0; i < 3; i++)
+        {
+            const char ch = (char)toupper((unsigned char)start[i]);
+            if (ch < 'A' || ch > 'Z')
+            {
+                return fail(c, ESP_ERR_INVALID_ARG, start + i);
+            }
+            manuf = (manuf << 5) | (uint32_t)(ch - 'A' + 1);
+        }
+        *out = (int32_t)manuf;
+        c->p += 3;
+        return true;
+    }
+
+    const bool neg = (*c->p == '-');
+    if (neg)
+    {
+        c->p++;
+    }
+    int base = 10;
+    if (field == F_ID)
+    {
+        base = 16;
+    }
+    else if (c->p[0] == '0' && (c->p[1] == 'x' || c->p[1] == 'X'))
+    {
+        base = 16;
+        c->p += 2;
+    }
+    uint64_t v = 0;
+    size_t digits = 0;
+    for (;; c->p++, digits++)
+    {
+        const char ch = (char)tolower((unsigned char)*c->p);
+        int d;
+        if (ch >= '0' && ch <= '9')
+        {
+            d = ch - '0';
+        }
+        else if (base == 16 && ch >= 'a' && ch <= 'f')
+        {
+            d = ch - 'a' + 10;
+        }
+        else
+        {
+            break;
+        }
+        v = v * (uint64_t)base + (uint64_t)d;
+        if (v > (base == 16 ? UINT32_MAX : INT32_MAX))
+        {
+            return fail(c, ESP_ERR_INVALID_ARG, c->p); // Out of range
+        }
+    }
+    if (digits == 0 || isalnum((unsigned char)*c->p) || (neg && field == F_ID))
+    {
+        return fail(c, ESP_ERR_INVALID_ARG, start);
+    }
+    *out = neg ? -(int32_t)v : (int32_t)(uint32_t)v;
+    return true;
+}
+
+static bool parse_or(compiler_t *c);
+
+// field op literal | field in (v, ...) | field
+static bool parse_compare(compiler_t *c)
+{
+    uint8_t field;
+    if (!parse_field(c, &field))
+    {
+        return false;
+    }
+    if (field >= F_FIRST_META)
+    {
+        c->out->needs_meta = true;
+    }
+
+    static const struct
+    {
+        const char *tok;
+        uint8_t op;
+    } OPS[] = {{"==", OP_EQ}, {"!=", OP_NE}, {"<=", OP_LE}, {">=", OP_GE}, {"<", OP_LT}, {">", OP_GT}};
+    const char *op_at = (skip_ws(c), c->p);
+    for (size_t i = 0; i < sizeof(OPS) / sizeof(OPS[0]); i++)
+    {
+        if (accept(c, OPS[i].tok))
+        {
+            if (field == F_ID && OPS[i].op != OP_EQ && OPS[i].op != OP_NE)
+            {
+                return fail(c, ESP_ERR_INVALID_ARG, op_at);
+            }
+            int32_t v;
+            return parse_value(c, field, &v) && emit(c, OPS[i].op, field, v) >= 0;
+        }
+    }
+
+    if (strncmp(c->p, "in", 2) == 0 && !isalnum((unsigned char)c->p[2]) && c->p[2] != '_')
+    {
+        c->p += 2;
+        if (!accept(c, "("))
+        {
+            return fail(c, ESP_ERR_INVALID_ARG, c->p);
+        }
+        const int at = emit(c, OP_IN, field, 0);
+        if (at < 0)
+        {
+            return false;
+        }
+        uint8_t count = 0;
+        do
+        {
+            int32_t v;
+            if (!parse_value(c, field, &v) || emit(c, OP_DATA, 0, v) < 0)
+            {
+                return false;
+            }
+            count++;
+        } while (accept(c, ","));
+        if (!accept(c, ")"))
+        {
+            return fail(c, ESP_ERR_INVALID_ARG, c->p);
+        }
+        c->out->code[at].count = count;
+        return true;
+    }
+
+    // Bare field: true when positive (flags such as "encrypted" or "ell")
+    return emit(c, OP_GT, field, 0) >= 0;
+}
+
+static bool parse_unary(compiler_t *c)
+{
+    if (++c->depth > FRAME_FILTER_MAX_DEPTH)
+    {
+        return fail(c, ESP_ERR_INVALID_ARG, c->p);
+    }
+    bool ok;
+    if (accept(c, "!"))
+    {
+        ok = parse_unary(c) && emit(c, OP_NOT, 0, 0) >= 0;
+    }
+    else if (accept(c, "("))
+    {
+        ok = parse_or(c) && (accept(c, ")") || fail(c, ESP_ERR_INVALID_ARG, c->p));
+    }
+    else
+    {
+        ok = parse_compare(c);
+    }
+    c->depth--;
+    return ok;
+}
+
+// Chain of terms joined by tok; each term but the last jumps to the end when it
+// already decides the result (jump_op).
+static bool parse_chain(compiler_t *c, bool (*term)(compiler_t *), const char *tok, uint8_t jump_op)
+{
+    int jumps[FRAME_FILTER_MAX_INSNS];
+    size_t n = 0;
+    if (!term(c))
+    {
+        return false;
+    }
+    while (accept(c, tok))
+    {
+        const int at = emit(c, jump_op, 0, 0);
+        if (at < 0 || !term(c))
+        {
+            return false;
+        }
+        jumps[n++] = at;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        c->out->code[jumps[i]].jump = c->out->len;
+    }
+    return true;
+}
+
+static bool parse_and(compiler_t *c)
+{
+    return parse_chain(c, parse_unary, "&&", OP_JF);
+}
+
+static bool parse_or(compiler_t *c)
+{
+    return parse_chain(c, parse_and, "||", OP_JT);
+}
+
+esp_err_t frame_filter_compile(const char *expr, frame_filter_t *out, size_t *err_pos)
+{
+    if (!out)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(out, 0, sizeof(*out));
+    if (!expr)
+    {
+        return ESP_OK;
+    }
+    compiler_t c = {.p = expr, .out = out, .err = ESP_OK};
+    skip_ws(&c);
+    if (*c.p == '\0')
+    {
+        return ESP_OK;
+    }
+    if (parse_or(&c))
+    {
+        skip_ws(&c);
+        if (*c.p != '\0')
+        {
+            fail(&c, ESP_ERR_INVALID_ARG, c.p);
+        }
+    }
+    if (c.err != ESP_OK)
+    {
+        if (err_pos)
+        {
+            *err_pos = (size_t)(c.err_at - expr);
+        }
+        memset(out, 0, sizeof(*out));
+    }
+    return c.err;
+}
+
+static int32_t field_value(const frame_filter_input_t *in, uint8_t field)
+{
+    const WmbusFrameHeaderRaw *h = &in->info->header;
+    const wmbus_parsed_frame_t *p = in->parsed;
+    if (field >= F_FIRST_META && !p)
+    {
+        return -1;
+    }
+    switch (field)
+    {
+    case F_C:
+        return h->control;
+    case F_MANUF:
+        return h->manufacturer_le;
+    case F_ID:
+        return (int32_t)((uint32_t)h->id[0] | ((uint32_t)h->id[1] << 8) | ((uint32_t)h->id[2] << 16) |
+                         ((uint32_t)h->id[3] << 24));
+    case F_VERSION:
+        return h->version;
+    case F_DEV_TYPE:
+        return h->device_type;
+    case F_CI:
+        return h->ci_field;
+    case F_LEN:
+        return in->info->logical_len;
+    case F_PAYLOAD_LEN:
+        return in->info->payload_len;
+    case F_RSSI:
+        return (int32_t)in->rssi_dbm;
+    case F_LQI:
+        return in->lqi;
+    case F_ACC:
+        return p->tpl.has_tpl ? p->tpl.tpl.acc : (p->ell.has_ell ? p->ell.ell.acc : -1);
+    case F_HDR:
+        return p->tpl.tpl.header_type;
+    case F_STATUS:
+        return p->tpl.has_tpl ? p->tpl.tpl.status : -1;
+    case F_SEC_MODE:
+        return p->tpl.sec.security_mode;
+    case F_ENCRYPTED:
+        return p->encrypted || p->tpl.sec.encrypted;
+    case F_ELL:
+        return p->ell.has_ell;
+    case F_AFL:
+        return p->afl.has_afl;
+    default:
+        return -1;
+    }
+}
+
+bool frame_filter_match(const frame_filter_t *f, const frame_filter_input_t *in)
+{
+    if (!f || f->len == 0)
+    {
+        return true;
+    }
+    if (!in || !in->info)
+    {
+        return false;
+    }
+    bool acc = true;
+    uint32_t pc = 0;
+    while (pc < f->len)
+    {
+        const frame_filter_insn_t *i = &f->code[pc];
+        switch (i->op)
+        {
+        case OP_EQ:
+            acc = field_value(in, i->field) == i->imm;
+            break;
+        case OP_NE:
+            acc = field_value(in, i->field) != i->imm;
+            break;
+        case OP_LT:
+            acc = field_value(in, i->field) < i->imm;
+            break;
+        case OP_LE:
+            acc = field_value(in, i->field) <= i->imm;
+            break;
+        case OP_GT:
+            acc = field_value(in, i->field) > i->imm;
+            break;
+        case OP_GE:
+            acc = field_value(in, i->field) >= i->imm;
+            break;
+        case OP_IN:
+        {
+            if (pc + i->count >= f->len)
+            {
+                return false;
+            }
+            const int32_t v = field_value(in, i->field);
+            acc = false;
+            for (uint32_t k = 1; k <= i->count; k++)
+            {
+                acc |= (i[k].imm == v);
+            }
+            pc += 1u + i->count;
+            continue;
+        }
+        case OP_NOT:
+            acc = !acc;
+            break;
+        case OP_JT:
+        case OP_JF:
+            if (acc == (i->op == OP_JT))
+            {
+                if (i->jump <= pc)
+                {
+                    return false; // Malformed program: only forward jumps are valid
+                }
+                pc = i->jump;
+                continue;
+            }
+            break;
+        default:
+            return false;
+        }
+        pc++;
+    }
+    return acc;
+}
@@ -0,0 +1,60 @@
+// Small filter language for received frames, compiled once into bytecode:
+//
+//   dev_type in (7, 22) && rssi > -95 && ci == 0x7A
+//   manuf == KAM && !(acc < 16) || id == 12345678
+//
+// Operands are a field and a literal: ==, !=, <, <=, >, >= or "in (v, ...)"; a bare
+// field is true when > 0. Terms combine with !, &&, || and parentheses. Numbers are
+// decimal or 0x hex; manuf also takes the three-letter code, and id is written as
+// printed on the meter (hex digits, equality and "in" only).
+//
+// Header fields: c, manuf, id, version, dev_type, ci, len, payload_len, rssi, lqi.
+// Layer fields (need the parsed frame, else -1): acc (TPL, else ELL), hdr (TPL
+// header type 0/1/2), status, sec_mode, encrypted, ell, afl.
+//
+// Evaluation uses no heap and runs at most FRAME_FILTER_MAX_INSNS instructions:
+// every jump goes forward.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "wmbus/packet.h"
+#include "app/wmbus/parsed_frame.h"
+
+#define FRAME_FILTER_MAX_INSNS 32
+#define FRAME_FILTER_MAX_DEPTH 8   // Nesting of parentheses / negations
+#define FRAME_FILTER_EXPR_MAX  160 // Longest expression accepted over HTTP (incl. NUL)
+
+typedef struct
+{
+    uint8_t op;
+    uint8_t field; // Field operand
+    uint8_t jump;  // Jump target (always > own index)
+    uint8_t count; // "in": number of values following as data
+    int32_t imm;
+} frame_filter_insn_t;
+
+typedef struct
+{
+    uint8_t len;     // 0 = match everything
+    bool needs_meta; // Reads layer fields; pass the parsed frame
+    frame_filter_insn_t code[FRAME_FILTER_MAX_INSNS];
+} frame_filter_t;
+
+typedef struct
+{
+    const WmbusFrameInfo *info;
+    float rssi_dbm;
+    uint8_t lqi;
+    const wmbus_parsed_frame_t *parsed; // NULL: layer fields read as -1
+} frame_filter_input_t;
+
+// Compile expr (NULL or blank = match everything). On a syntax error returns
+// ESP_ERR_INVALID_ARG with *err_pos at the offending character; ESP_ERR_INVALID_SIZE
+// when the program does not fit FRAME_FILTER_MAX_INSNS.
+esp_err_t frame_filter_compile(const char *expr, frame_filter_t *out, size_t *err_pos);
+
+// True when the frame passes (an empty filter passes everything).
+bool frame_filter_match(const frame_filter_t *f, const frame_filter_input_t *in);
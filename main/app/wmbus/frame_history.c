@@ -0,0 +1,211 @@
+#include "app/wmbus/frame_history.h"
+
+#include <string.h>
+
+// Record header; records start 4-byte aligned and never wrap around the end.
+typedef struct
+{
+    wmbus_history_meta_t meta;
+    uint16_t len;  // Frame bytes, or REC_SKIP
+    uint16_t back; // Distance to the previous record's start (0: first record)
+} rec_hdr_t;
+
+_Static_assert(sizeof(rec_hdr_t) == 16, "record header is 16 bytes");
+
+#define REC_SKIP 0xFFFF // Rest of the buffer unused; the next record is at offset 0
+
+static inline uint32_t rec_size(uint16_t len)
+{
+    return (uint32_t)(sizeof(rec_hdr_t) + len + 3u) & ~3u;
+}
+
+// pos is at or after the tail (positions are free-running and wrap at 2^32)
+static inline bool at_or_after(uint32_t pos, uint32_t tail)
+{
+    return (int32_t)(pos - tail) >= 0;
+}
+
+esp_err_t wmbus_frame_history_init(wmbus_frame_history_t *h, uint8_t *buf, uint32_t size)
+{
+    if (!h || !buf || size < 1024 || size > 65536 || (size & (size - 1)) != 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    h->buf = buf;
+    h->size = size;
+    atomic_init(&h->head, 0);
+    atomic_init(&h->tail, 0);
+    atomic_init(&h->newest, 0);
+    atomic_init(&h->seq, 0);
+    atomic_init(&h->oldest_seq, 1);
+    atomic_init(&h->count, 0);
+    atomic_init(&h->overwritten, 0);
+    return ESP_OK;
+}
+
+// Writer: start of the record after the one at pos (skipping the unused end).
+static uint32_t next_record(const wmbus_frame_history_t *h, uint32_t pos, uint32_t head)
+{
+    rec_hdr_t hdr;
+    memcpy(&hdr, h->buf + (pos & (h->size - 1)), sizeof(hdr));
+    pos += rec_size(hdr.len);
+    const uint32_t room = h->size - (pos & (h->size - 1));
+    if (room < sizeof(rec_hdr_t))
+    {
+        return pos + room;
+    }
+    memcpy(&hdr, h->buf + (pos & (h->size - 1)), sizeof(hdr));
+    return (hdr.len == REC_SKIP && pos != head) ? pos + room : pos;
+}
+
+uint32_t wmbus_frame_history_push(wmbus_frame_history_t *h, const wmbus_history_meta_t *meta, const uint8_t *frame,
+                                  uint16_t len)
+{
+    if (!h || !meta || !frame || len == 0 || len > WMBUS_MAX_PACKET_BYTES)
+    {
+        return 0;
+    }
+    const uint32_t need = rec_size(len);
+    const uint32_t head = atomic_load_explicit(&h->head, memory_order_relaxed);
+    uint32_t pos = head;
+    const uint32_t room = h->size - (pos & (h->size - 1));
+    const bool skip = room < need;
+    if (skip)
+    {
+        pos += room;
+    }
+    const uint32_t end = pos + need;
+
+    // Recycle every record that starts in the buffer image of [head, end)
+    uint32_t tail = atomic_load_explicit(&h->tail, memory_order_relaxed);
+    uint32_t count = atomic_load_explicit(&h->count, memory_order_relaxed);
+    uint32_t oldest_seq = atomic_load_explicit(&h->oldest_seq, memory_order_relaxed);
+    while (count > 0 && !at_or_after(tail, end - h->size))
+    {
+        tail = next_record(h, tail, head);
+        count--;
+        oldest_seq++;
+    }
+    if (count == 0)
+    {
+        tail = pos;
+    }
+    atomic_store_explicit(&h->tail, tail, memory_order_relaxed);
+    atomic_store_explicit(&h->oldest_seq, oldest_seq, memory_order_relaxed);
+    // Release fence: a reader that sees any byte written below also sees the new tail.
+    atomic_thread_fence(memory_order_release);
+
+    if (skip && room >= sizeof(rec_hdr_t))
+    {
+        const rec_hdr_t marker = {.len = REC_SKIP};
+        memcpy(h->buf + (head & (h->size - 1)), &marker, sizeof(marker));
+    }
+    const uint32_t seq = atomic_load_explicit(&h->seq, memory_order_relaxed) + 1;
+    const uint32_t newest = atomic_load_explicit(&h->newest, memory_order_relaxed);
+    rec_hdr_t hdr = {
+        .meta = *meta,
+        .len = len,
+        .back = (count > 0) ? (uint16_t)(pos - newest) : 0,
+    };
+    hdr.meta.seq = seq;
+    uint8_t *dst = h->buf + (pos & (h->size - 1));
+    memcpy(dst, &hdr, sizeof(hdr));
+    memcpy(dst + sizeof(hdr), frame, len);
+    atomic_store_explicit(&h->head, end, memory_order_relaxed);
+
+    // Release: the record is complete before readers can start from it.
+    atomic_store_explicit(&h->count, count + 1, memory_order_relaxed);
+    atomic_store_explicit(&h->seq, seq, memory_order_release);
+    atomic_store_explicit(&h->newest, pos, memory_order_release);
+    return seq;
+}
+
+// Copy the record at pos; false when it was (being) recycled.
+static bool read_record(wmbus_frame_history_t *h, uint32_t pos, rec_hdr_t *hdr, wmbus_history_entry_t *out)
+{
+    if (!at_or_after(pos, atomic_load_explicit(&h->tail, memory_order_acquire)))
+    {
+        return false;
+    }
+    const uint32_t off = pos & (h->size - 1);
+    const uint8_t *src = h->buf + off;
+    memcpy(hdr, src, sizeof(*hdr));
+    // A header torn by the writer must not send the copy past the buffer
+    const bool fits = hdr->len <= WMBUS_MAX_PACKET_BYTES && off + rec_size(hdr->len) <= h->size;
+    const uint16_t len = fits ? hdr->len : 0;
+    if (out)
+    {
+        memcpy(out->bytes, src + sizeof(*hdr), len);
+    }
+    // Acquire fence: if the writer touched these bytes, the tail below has moved past pos.
+    atomic_thread_fence(memory_order_acquire);
+    if (!at_or_after(pos, atomic_load_explicit(&h->tail, memory_order_relaxed)) || len == 0)
+    {
+        atomic_fetch_add_explicit(&h->overwritten, 1, memory_order_relaxed);
+        return false;
+    }
+    if (out)
+    {
+        out->meta = hdr->meta;
+        out->len = len;
+    }
+    return true;
+}
+
+void wmbus_frame_history_iter_begin(wmbus_frame_history_t *h, wmbus_frame_history_iter_t *it)
+{
+    // seq first: a non-zero seq guarantees the record at newest (even the initial 0) is complete
+    it->more = atomic_load_explicit(&h->seq, memory_order_acquire) != 0;
+    it->pos = atomic_load_explicit(&h->newest, memory_order_acquire);
+}
+
+bool wmbus_frame_history_iter_next(wmbus_frame_history_t *h, wmbus_frame_history_iter_t *it,
+                                   wmbus_history_entry_t *out)
+{
+    rec_hdr_t hdr;
+    if (!it->more || !read_record(h, it->pos, &hdr, out))
+    {
+        it->more = false;
+        return false;
+    }
+    it->more = hdr.back != 0;
+    it->pos -= hdr.back;
+    return true;
+}
+
+bool wmbus_frame_history_get(wmbus_frame_history_t *h, uint32_t seq, wmbus_history_entry_t *out)
+{
+    wmbus_frame_history_iter_t it;
+    wmbus_frame_history_iter_begin(h, &it);
+    rec_hdr_t hdr;
+    while (it.more && read_record(h, it.pos, &hdr, NULL))
+    {
+        if (hdr.meta.seq == seq)
+        {
+            return read_record(h, it.pos, &hdr, out) && hdr.meta.seq == seq;
+        }
+        if (hdr.meta.seq < seq || hdr.back == 0)
+        {
+            return false;
+        }
+        it.pos -= hdr.back;
+    }
+    return false;
+}
+
+void wmbus_frame_history_get_stats(wmbus_frame_history_t *h, wmbus_frame_history_stats_t *out)
+{
+    if (!h || !out)
+    {
+        return;
+    }
+    const uint32_t count = atomic_load_explicit(&h->count, memory_order_relaxed);
+    const uint32_t seq = atomic_load_explicit(&h->seq, memory_order_relaxed);
+    out->capacity_bytes = h->size;
+    const uint32_t head = atomic_load_explicit(&h->head, memory_order_relaxed);
+    out->used_bytes = count ? (head - atomic_load_explicit(&h->tail, memory_order_relaxed)) : 0;
+    out->count = count;
+    out->seq = seq;
+    out->oldest = count ? atomic_load_explicit(&h->oldest_seq, memory_order_relaxed) : seq + 1;
+    out->overwritten = atomic_load_explicit(&h->overwritten, memory_order_relaxed);
+}
@@ -0,0 +1,88 @@
+// Most recent RX frames for the web UI, packed into a byte ring: each record is
+// a 16-byte header (sequence, time, RSSI, LQI) plus the CRC-free logical frame,
+// so the bench corpus (96-byte frames on average) takes 114 bytes per record and
+// 32 KB hold 286 frames. Layer fields are parsed again when a frame is read.
+//
+// One writer (the router sink) appends in O(1) and never waits. Readers copy a
+// record out and then check that the writer has not recycled its bytes in the
+// meantime; an overwritten record ends the walk instead of blocking the writer.
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "wmbus/pipeline.h"
+
+// Metadata stored ahead of each frame.
+typedef struct
+{
+    uint32_t seq;      // 1, 2, ... per frame since boot
+    uint32_t rx_ms;    // Uptime at reception
+    int16_t rssi_ddbm; // RSSI in 0.1 dBm
+    uint8_t lqi;
+    uint8_t status;    // WMBUS_PKT_xxx
+} wmbus_history_meta_t;
+
+// One frame copied out of the history.
+typedef struct
+{
+    wmbus_history_meta_t meta;
+    uint16_t len;
+    uint8_t bytes[WMBUS_MAX_PACKET_BYTES];
+} wmbus_history_entry_t;
+
+typedef struct
+{
+    uint8_t *buf;
+    uint32_t size;              // Power of two
+    _Atomic uint32_t head;      // Absolute position of the next record (written by the writer only)
+    _Atomic uint32_t tail;      // Absolute position of the oldest record
+    _Atomic uint32_t newest;    // Absolute position of the newest record
+    _Atomic uint32_t seq;       // Newest sequence number (0: empty)
+    _Atomic uint32_t oldest_seq;
+    _Atomic uint32_t count;
+    _Atomic uint32_t overwritten; // Reads that found their record recycled
+} wmbus_frame_history_t;
+
+typedef struct
+{
+    uint32_t capacity_bytes;
+    uint32_t used_bytes;
+    uint32_t count;       // Frames held
+    uint32_t seq;         // Newest sequence number
+    uint32_t oldest;      // Sequence number of the oldest frame held (seq + 1 when empty)
+    uint32_t overwritten;
+} wmbus_frame_history_stats_t;
+
+// Newest-first walk over the history.
+typedef struct
+{
+    uint32_t pos;
+    bool more;
+} wmbus_frame_history_iter_t;
+
+// Bind a caller-owned buffer (size a power of two, 1-64 KB: record back-links are
+// 16 bit); starts empty.
+esp_err_t wmbus_frame_history_init(wmbus_frame_history_t *h, uint8_t *buf, uint32_t size);
+
+// Writer (single task): append a frame, recycling the oldest records as needed.
+// meta->seq is ignored. Returns the frame's sequence number, 0 when len is 0 or
+// larger than WMBUS_MAX_PACKET_BYTES.
+uint32_t wmbus_frame_history_push(wmbus_frame_history_t *h, const wmbus_history_meta_t *meta, const uint8_t *frame,
+                                  uint16_t len);
+
+// Reader (any task): start at the newest frame, then step to older ones. next
+// returns false at the oldest frame or when the writer has recycled the next
+// record; records between calls may be overwritten, never torn.
+void wmbus_frame_history_iter_begin(wmbus_frame_history_t *h, wmbus_frame_history_iter_t *it);
+bool wmbus_frame_history_iter_next(wmbus_frame_history_t *h, wmbus_frame_history_iter_t *it,
+                                   wmbus_history_entry_t *out);
+
+// Reader: the frame with sequence number seq. False when it is not recorded yet
+// or already recycled. Walks back from the newest frame, so cheap for recent ones.
+bool wmbus_frame_history_get(wmbus_frame_history_t *h, uint32_t seq, wmbus_history_entry_t *out);
+
+// Counters (safe from any task; fields may be a frame apart).
+void wmbus_frame_history_get_stats(wmbus_frame_history_t *h, wmbus_frame_history_stats_t *out);
@@ -0,0 +1,117 @@
+#include "app/wmbus/frame_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void wmbus_frame_init(wmbus_frame_t *f)
+{
+    if (!f)
+    {
+        return;
+    }
+    memset(&f->res, 0, sizeof(f->res));
+    f->res.rx_logical = f->logical;
+    atomic_init(&f->refs, 0);
+    f->index = 0;
+    f->pool = NULL;
+    f->debug = NULL;
+}
+
+esp_err_t wmbus_frame_pool_init(wmbus_frame_pool_t *pool, wmbus_frame_t *frames, uint32_t capacity)
+{
+    if (!pool || !frames || capacity == 0 || capacity > WMBUS_FRAME_POOL_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pool->frames = frames;
+    pool->capacity = capacity;
+    for (uint32_t i = 0; i < capacity; i++)
+    {
+        wmbus_frame_init(&frames[i]);
+        frames[i].index = (uint8_t)i;
+        frames[i].pool = pool;
+    }
+    atomic_init(&pool->in_use, 0);
+    atomic_init(&pool->high_water, 0);
+    atomic_init(&pool->exhausted, 0);
+    return ESP_OK;
+}
+
+wmbus_frame_t *wmbus_frame_alloc(wmbus_frame_pool_t *pool)
+{
+    if (!pool)
+    {
+        return NULL;
+    }
+    const uint32_t all = (pool->capacity == 32) ? UINT32_MAX : ((1u << pool->capacity) - 1);
+    uint32_t used = atomic_load_explicit(&pool->in_use, memory_order_acquire);
+    uint32_t bit;
+    do
+    {
+        const uint32_t free_mask = ~used & all;
+        if (free_mask == 0)
+        {
+            atomic_fetch_add_explicit(&pool->exhausted, 1, memory_order_relaxed);
+            return NULL;
+        }
+        bit = free_mask & (0u - free_mask); // Lowest free frame
+    } while (!atomic_compare_exchange_weak_explicit(&pool->in_use, &used, used | bit, memory_order_acquire,
+                                                    memory_order_acquire));
+
+    const uint32_t count = (uint32_t)__builtin_popcount(used | bit);
+    if (count > atomic_load_explicit(&pool->high_water, memory_order_relaxed))
+    {
+        atomic_store_explicit(&pool->high_water, count, memory_order_relaxed);
+    }
+    wmbus_frame_t *f = &pool->frames[__builtin_ctz(bit)];
+    atomic_store_explicit(&f->refs, 1, memory_order_relaxed);
+    return f;
+}
+
+wmbus_frame_t *wmbus_frame_ref(wmbus_frame_t *f)
+{
+    if (f)
+    {
+        atomic_fetch_add_explicit(&f->refs, 1, memory_order_relaxed);
+    }
+    return f;
+}
+
+void wmbus_frame_unref(wmbus_frame_t *f)
+{
+    if (!f || !f->pool)
+    {
+        return;
+    }
+    // Release: every read of the frame happens before it can be handed out again.
+    if (atomic_fetch_sub_explicit(&f->refs, 1, memory_order_acq_rel) == 1)
+    {
+        atomic_fetch_and_explicit(&f->pool->in_use, ~(1u << f->index), memory_order_release);
+    }
+}
+
+void wmbus_frame_want_debug(wmbus_frame_t *f, bool raw, bool encoded)
+{
+    if (!f)
+    {
+        return;
+    }
+    if ((raw || encoded) && !f->debug)
+    {
+        f->debug = calloc(1, WMBUS_MAX_PACKET_BYTES + WMBUS_MAX_ENCODED_BYTES);
+    }
+    f->res.rx_packet = (raw && f->debug) ? f->debug : NULL;
+    f->res.rx_bytes = (encoded && f->debug) ? f->debug + WMBUS_MAX_PACKET_BYTES : NULL;
+}
+
+void wmbus_frame_pool_get_stats(wmbus_frame_pool_t *pool, wmbus_frame_pool_stats_t *out)
+{
+    if (!pool || !out)
+    {
+        return;
+    }
+    out->capacity = pool->capacity;
+    out->in_use = (uint32_t)__builtin_popcount(atomic_load_explicit(&pool->in_use, memory_order_relaxed));
+    out->high_water = atomic_load_explicit(&pool->high_water, memory_order_relaxed);
+    out->exhausted = atomic_load_explicit(&pool->exhausted, memory_order_relaxed);
+}
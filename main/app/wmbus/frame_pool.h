@@ -0,0 +1,64 @@
+// Fixed pool of reference-counted RX frame buffers. The RX task fills a frame,
+// the dispatch task hands it to the sinks by handle, and a sink that keeps a
+// frame past its callback takes a reference instead of copying the bytes. The
+// frame returns to the pool when the last reference is dropped, from any task.
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "wmbus/pipeline.h"
+
+#define WMBUS_FRAME_POOL_MAX 32 // One bit per frame in the free mask
+
+struct wmbus_frame_pool;
+
+typedef struct wmbus_frame
+{
+    wmbus_rx_result_t res;          // rx_logical is wired to logical[]; debug copies via wmbus_frame_want_debug
+    _Atomic uint16_t refs;
+    uint8_t index;
+    struct wmbus_frame_pool *pool;  // NULL for a standalone frame (never returned anywhere)
+    uint8_t *debug;                 // Lazily allocated on-air + encoded copies (WMBUS_MAX_PACKET_BYTES + WMBUS_MAX_ENCODED_BYTES)
+    uint8_t logical[WMBUS_MAX_PACKET_BYTES];
+} wmbus_frame_t;
+
+typedef struct wmbus_frame_pool
+{
+    wmbus_frame_t *frames;
+    uint32_t capacity;
+    _Atomic uint32_t in_use;     // Bit i set while frames[i] is referenced
+    _Atomic uint32_t high_water; // Most frames in use at once
+    _Atomic uint32_t exhausted;  // Allocations that found no free frame
+} wmbus_frame_pool_t;
+
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t in_use;
+    uint32_t high_water;
+    uint32_t exhausted;
+} wmbus_frame_pool_stats_t;
+
+// Bind caller-owned frames (capacity 1..WMBUS_FRAME_POOL_MAX); all start free.
+esp_err_t wmbus_frame_pool_init(wmbus_frame_pool_t *pool, wmbus_frame_t *frames, uint32_t capacity);
+
+// Wire a frame's buffers without a pool (scratch frame that is never released).
+void wmbus_frame_init(wmbus_frame_t *f);
+
+// Take a free frame with one reference, or NULL when every frame is referenced.
+// Lock-free; safe from any task.
+wmbus_frame_t *wmbus_frame_alloc(wmbus_frame_pool_t *pool);
+
+// Add a reference (returns f). Only valid while the caller already holds one.
+wmbus_frame_t *wmbus_frame_ref(wmbus_frame_t *f);
+
+// Drop a reference; the last one returns the frame to its pool. NULL is ignored.
+void wmbus_frame_unref(wmbus_frame_t *f);
+
+// Point res.rx_packet / res.rx_bytes at the frame's debug copies (or NULL when not
+// wanted). The copies are allocated on first use and kept with the frame.
+void wmbus_frame_want_debug(wmbus_frame_t *f, bool raw, bool encoded);
+
+void wmbus_frame_pool_get_stats(wmbus_frame_pool_t *pool, wmbus_frame_pool_stats_t *out);
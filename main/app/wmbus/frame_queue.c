@@ -0,0 +1,76 @@
+#include "app/wmbus/frame_queue.h"
+
+#include <string.h>
+
+esp_err_t wmbus_frame_queue_init(wmbus_frame_queue_t *q, wmbus_frame_t **slots, uint32_t capacity)
+{
+    if (!q || !slots || capacity == 0 || (capacity & (capacity - 1)) != 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    q->slots = slots;
+    q->capacity = capacity;
+    memset(slots, 0, capacity * sizeof(slots[0]));
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->high_water, 0);
+    atomic_init(&q->drops, 0);
+    atomic_init(&q->committed, 0);
+    return ESP_OK;
+}
+
+bool wmbus_frame_queue_push(wmbus_frame_queue_t *q, wmbus_frame_t *frame)
+{
+    const uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    const uint32_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    if ((head - tail) >= q->capacity)
+    {
+        return false;
+    }
+    q->slots[head & (q->capacity - 1)] = frame;
+    // Release: frame contents become visible to the consumer together with the new head.
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    atomic_fetch_add_explicit(&q->committed, 1, memory_order_relaxed);
+
+    const uint32_t depth = head + 1 - tail;
+    if (depth > atomic_load_explicit(&q->high_water, memory_order_relaxed))
+    {
+        atomic_store_explicit(&q->high_water, depth, memory_order_relaxed);
+    }
+    return true;
+}
+
+void wmbus_frame_queue_note_drop(wmbus_frame_queue_t *q)
+{
+    atomic_fetch_add_explicit(&q->drops, 1, memory_order_relaxed);
+}
+
+wmbus_frame_t *wmbus_frame_queue_pop(wmbus_frame_queue_t *q)
+{
+    const uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    const uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    if (head == tail)
+    {
+        return NULL;
+    }
+    wmbus_frame_t *frame = q->slots[tail & (q->capacity - 1)];
+    // Release: the producer may reuse the slot once the handle has been read.
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return frame;
+}
+
+void wmbus_frame_queue_get_stats(wmbus_frame_queue_t *q, wmbus_frame_queue_stats_t *out)
+{
+    if (!q || !out)
+    {
+        return;
+    }
+    const uint32_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    const uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    out->capacity = q->capacity;
+    out->depth = head - tail;
+    out->high_water = atomic_load_explicit(&q->high_water, memory_order_relaxed);
+    out->drops = atomic_load_explicit(&q->drops, memory_order_relaxed);
+    out->committed = atomic_load_explicit(&q->committed, memory_order_relaxed);
+}
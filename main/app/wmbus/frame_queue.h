@@ -0,0 +1,45 @@
+// Lock-free single-producer/single-consumer ring of pooled RX frame handles.
+// The RX task pushes each filled frame (with the reference it allocated); the
+// dispatch task pops them in order. No locks, no copies, no allocation.
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "app/wmbus/frame_pool.h"
+
+typedef struct
+{
+    wmbus_frame_t **slots;
+    uint32_t capacity;         // Power of two
+    _Atomic uint32_t head;     // Free-running write index (producer-owned)
+    _Atomic uint32_t tail;     // Free-running read index (consumer-owned)
+    _Atomic uint32_t high_water;
+    _Atomic uint32_t drops;
+    _Atomic uint32_t committed;
+} wmbus_frame_queue_t;
+
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t depth;      // Frames pushed but not yet popped
+    uint32_t high_water; // Max depth observed since init
+    uint32_t drops;      // Frames received while the ring was full
+    uint32_t committed;  // Total frames handed to the consumer
+} wmbus_frame_queue_stats_t;
+
+// Bind caller-owned handle slots (capacity must be a power of two).
+esp_err_t wmbus_frame_queue_init(wmbus_frame_queue_t *q, wmbus_frame_t **slots, uint32_t capacity);
+
+// Producer: publish a frame, handing its reference to the consumer. False when
+// the ring is full (the caller keeps the reference).
+bool wmbus_frame_queue_push(wmbus_frame_queue_t *q, wmbus_frame_t *frame);
+// Producer: account a frame that had to be discarded (ring full or no free frame).
+void wmbus_frame_queue_note_drop(wmbus_frame_queue_t *q);
+
+// Consumer: oldest frame together with its reference, or NULL when empty.
+wmbus_frame_t *wmbus_frame_queue_pop(wmbus_frame_queue_t *q);
+
+// Snapshot counters (safe from any task).
+void wmbus_frame_queue_get_stats(wmbus_frame_queue_t *q, wmbus_frame_queue_stats_t *out);
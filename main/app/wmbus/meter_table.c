@@ -0,0 +1,345 @@
+#include "app/wmbus/meter_table.h"
+
+#include <string.h>
+
+_Static_assert((APP_METER_SLOTS & (APP_METER_SLOTS - 1)) == 0, "APP_METER_SLOTS must be a power of two");
+_Static_assert(APP_METER_SLOTS >= 2 * APP_METERS, "meter index must stay at most half full");
+_Static_assert(APP_METERS < WMBUS_METER_NONE, "row numbers must fit below WMBUS_METER_NONE");
+
+#define SLOT_MASK (APP_METER_SLOTS - 1)
+
+static uint32_t key_hash(uint16_t manuf, const uint8_t id[4])
+{
+    uint32_t h = (uint32_t)id[0] | ((uint32_t)id[1] << 8) | ((uint32_t)id[2] << 16) | ((uint32_t)id[3] << 24);
+    h ^= (uint32_t)manuf * 0x9E3779B1u;
+    h = (h ^ (h >> 16)) * 0x7FEB352Du;
+    h = (h ^ (h >> 15)) * 0x846CA68Bu;
+    return h ^ (h >> 16);
+}
+
+static bool key_equal(const wmbus_meter_t *m, uint16_t manuf, const uint8_t id[4])
+{
+    return m->manuf == manuf && memcmp(m->id, id, sizeof(m->id)) == 0;
+}
+
+// Slot holding the meter, or the empty slot that ends its probe sequence.
+static uint32_t probe(const wmbus_meter_table_t *t, uint32_t hash, uint16_t manuf, const uint8_t id[4])
+{
+    uint32_t i = hash & SLOT_MASK;
+    while (t->slots[i] != 0)
+    {
+        const wmbus_meter_t *m = &t->meters[t->slots[i] - 1];
+        if (m->hash == hash && key_equal(m, manuf, id))
+        {
+            break;
+        }
+        i = (i + 1) & SLOT_MASK;
+    }
+    return i;
+}
+
+// Remove a row from the index, shifting later members of the cluster back so
+// no probe sequence is broken (no tombstones).
+static void unindex(wmbus_meter_table_t *t, uint16_t row)
+{
+    const wmbus_meter_t *m = &t->meters[row];
+    uint32_t i = probe(t, m->hash, m->manuf, m->id);
+    uint32_t j = i;
+    while (true)
+    {
+        j = (j + 1) & SLOT_MASK;
+        if (t->slots[j] == 0)
+        {
+            break;
+        }
+        // The entry at j may fill the hole at i unless its home lies in (i, j]
+        const uint32_t home = t->meters[t->slots[j] - 1].hash & SLOT_MASK;
+        if (((j - home) & SLOT_MASK) >= ((j - i) & SLOT_MASK))
+        {
+            t->slots[i] = t->slots[j];
+            i = j;
+        }
+    }
+    t->slots[i] = 0;
+}
+
+static void lru_unlink(wmbus_meter_table_t *t, uint16_t row)
+{
+    wmbus_meter_t *m = &t->meters[row];
+    if (m->newer != WMBUS_METER_NONE)
+    {
+        t->meters[m->newer].older = m->older;
+    }
+    else
+    {
+        t->newest = m->older;
+    }
+    if (m->older != WMBUS_METER_NONE)
+    {
+        t->meters[m->older].newer = m->newer;
+    }
+    else
+    {
+        t->oldest = m->newer;
+    }
+}
+
+static void lru_push(wmbus_meter_table_t *t, uint16_t row)
+{
+    wmbus_meter_t *m = &t->meters[row];
+    m->newer = WMBUS_METER_NONE;
+    m->older = t->newest;
+    if (t->newest != WMBUS_METER_NONE)
+    {
+        t->meters[t->newest].newer = row;
+    }
+    else
+    {
+        t->oldest = row;
+    }
+    t->newest = row;
+}
+
+void wmbus_meter_table_init(wmbus_meter_table_t *t)
+{
+    if (!t)
+    {
+        return;
+    }
+    memset(t, 0, sizeof(*t));
+    t->newest = WMBUS_METER_NONE;
+    t->oldest = WMBUS_METER_NONE;
+}
+
+// Row for the sample's meter, most recent on the list; a new meter takes a free
+// row or the least recently heard one.
+static wmbus_meter_t *touch(wmbus_meter_table_t *t, const wmbus_meter_sample_t *s, uint32_t now_ms)
+{
+    const uint32_t hash = key_hash(s->manuf, s->id);
+    uint32_t slot = probe(t, hash, s->manuf, s->id);
+    uint16_t row;
+    if (t->slots[slot] != 0)
+    {
+        row = (uint16_t)(t->slots[slot] - 1);
+        if (row != t->newest)
+        {
+            lru_unlink(t, row);
+            lru_push(t, row);
+        }
+        return &t->meters[row];
+    }
+
+    if (t->count < APP_METERS)
+    {
+        row = t->count++;
+    }
+    else
+    {
+        row = t->oldest;
+        unindex(t, row);
+        lru_unlink(t, row);
+        t->evicted++;
+        slot = probe(t, hash, s->manuf, s->id); // The shift may have opened an earlier slot
+    }
+    wmbus_meter_t *m = &t->meters[row];
+    memset(m, 0, sizeof(*m));
+    m->manuf = s->manuf;
+    memcpy(m->id, s->id, sizeof(m->id));
+    m->hash = hash;
+    m->first_ms = now_ms;
+    m->rssi_min = INT16_MAX;
+    m->rssi_max = INT16_MIN;
+    m->lqi_min = UINT8_MAX;
+    m->gap = WMBUS_METER_GAP_UNKNOWN;
+    m->loss_hour = now_ms / WMBUS_METER_HOUR_MS;
+    t->slots[slot] = (uint16_t)(row + 1);
+    lru_push(t, row);
+    return m;
+}
+
+// Transmissions since the previous intact frame: the ACC difference, with whole
+// wraps of the 8-bit counter filled in from the interval estimate. 0 for a
+// repeat (same ACC, or a copy of a telegram just before it). A slightly older
+// ACC only counts as a copy while the time since the previous frame is short;
+// after an outage of 249-255 transmissions it is a real step forward.
+static uint32_t acc_steps(const wmbus_meter_t *m, uint8_t acc, uint32_t now_ms)
+{
+    const uint32_t delta = (uint8_t)(acc - m->acc);
+    const uint32_t est = m->interval_ms ? (now_ms - m->intact_ms) / m->interval_ms : 0;
+    if (delta == 0 || (delta > 256 - WMBUS_METER_STALE_ACC && (m->interval_ms == 0 || est < WMBUS_METER_STALE_ACC)))
+    {
+        return 0;
+    }
+    return (est > delta + 128) ? delta + ((est - delta + 128) / 256) * 256 : delta;
+}
+
+// Interval between transmissions: the gap since the previous intact frame
+// divided by the transmissions it spans, so missed frames do not inflate it.
+// Smoothed with a 1/8 moving average.
+static void update_interval(wmbus_meter_t *m, uint32_t steps, uint32_t now_ms)
+{
+    const uint32_t sample = (now_ms - m->intact_ms) / steps;
+    if (m->interval_ms == 0)
+    {
+        m->interval_ms = sample;
+    }
+    else
+    {
+        m->interval_ms = (uint32_t)((int32_t)m->interval_ms + ((int32_t)(sample - m->interval_ms) / 8));
+    }
+}
+
+static inline void add_sat(uint16_t *v, uint32_t n)
+{
+    *v = (*v + n > UINT16_MAX) ? UINT16_MAX : (uint16_t)(*v + n);
+}
+
+// Make hour the newest bucket, clearing the hours skipped since the last frame.
+static void advance_hours(wmbus_meter_t *m, uint32_t hour)
+{
+    uint32_t n = hour - m->loss_hour; // Huge after the uptime clock wraps: clears all
+    n = (n > WMBUS_METER_LOSS_HOURS) ? WMBUS_METER_LOSS_HOURS : n;
+    for (uint32_t i = 1; i <= n; i++)
+    {
+        const wmbus_meter_hour_t empty = {0};
+        m->hours[(m->loss_hour + i) % WMBUS_METER_LOSS_HOURS] = empty;
+    }
+    m->loss_hour = hour;
+}
+
+// One intact frame after steps transmissions. The missed ones are spread over
+// the hours since the previous intact frame (shares older than the buckets are
+// dropped); the rest goes to the current hour.
+static void record_reception(wmbus_meter_t *m, uint32_t steps, uint32_t now_ms)
+{
+    const uint32_t hour = now_ms / WMBUS_METER_HOUR_MS;
+    advance_hours(m, hour);
+    const uint32_t missed = steps - 1;
+    uint32_t left = missed;
+    const uint32_t from = m->intact_ms / WMBUS_METER_HOUR_MS;
+    const uint32_t span = (m->frames > 0 && hour > from) ? hour - from : 0;
+    if (missed > 0 && span > 0)
+    {
+        const uint32_t share = missed / (span + 1);
+        for (uint32_t age = 1; age <= span; age++)
+        {
+            if (age < WMBUS_METER_LOSS_HOURS)
+            {
+                add_sat(&m->hours[(hour - age) % WMBUS_METER_LOSS_HOURS].expected, share);
+            }
+            left -= share;
+        }
+    }
+    wmbus_meter_hour_t *cur = &m->hours[hour % WMBUS_METER_LOSS_HOURS];
+    add_sat(&cur->expected, left + 1);
+    add_sat(&cur->received, 1);
+    m->missed += missed;
+    m->gap = (missed < WMBUS_METER_GAP_UNKNOWN) ? (uint16_t)missed : WMBUS_METER_GAP_UNKNOWN - 1;
+}
+
+void wmbus_meter_table_update(wmbus_meter_table_t *t, const wmbus_meter_sample_t *s, uint32_t now_ms)
+{
+    if (!t || !s)
+    {
+        return;
+    }
+    wmbus_meter_t *m = touch(t, s, now_ms);
+    m->last_ms = now_ms;
+    m->dev_type = s->dev_type; // Part of block 0, verified either way
+    m->rssi_sum += s->rssi_ddbm;
+    m->lqi_sum += s->lqi;
+    m->rssi_min = (s->rssi_ddbm < m->rssi_min) ? s->rssi_ddbm : m->rssi_min;
+    m->rssi_max = (s->rssi_ddbm > m->rssi_max) ? s->rssi_ddbm : m->rssi_max;
+    m->lqi_min = (s->lqi < m->lqi_min) ? s->lqi : m->lqi_min;
+    m->lqi_max = (s->lqi > m->lqi_max) ? s->lqi : m->lqi_max;
+    if (!s->intact)
+    {
+        m->crc_errors++;
+        return;
+    }
+
+    m->gap = WMBUS_METER_GAP_UNKNOWN;
+    if (s->has_acc && m->has_acc)
+    {
+        const uint32_t steps = acc_steps(m, s->acc, now_ms);
+        if (steps == 0)
+        {
+            m->frames++;
+            m->repeats++;
+            return; // Neither a new transmission nor a new reference point
+        }
+        update_interval(m, steps, now_ms);
+        record_reception(m, steps, now_ms);
+    }
+    else if (s->has_acc)
+    {
+        record_reception(m, 1, now_ms); // First ACC: counting starts here
+    }
+    else if (m->frames > 0)
+    {
+        update_interval(m, 1, now_ms);
+    }
+    m->frames++;
+    m->intact_ms = now_ms;
+    if (s->has_acc)
+    {
+        m->acc = s->acc;
+        m->has_acc = true;
+    }
+}
+
+void wmbus_meter_get_loss(const wmbus_meter_t *m, uint32_t now_ms, wmbus_meter_loss_t *out)
+{
+    if (!out)
+    {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    out->gap = WMBUS_METER_GAP_UNKNOWN;
+    if (!m)
+    {
+        return;
+    }
+    out->gap = m->gap;
+    const uint32_t hour = now_ms / WMBUS_METER_HOUR_MS;
+    const uint32_t inside = WMBUS_METER_HOUR_MS - (now_ms % WMBUS_METER_HOUR_MS); // Part of the oldest hour still in the window
+    for (uint32_t age = 0; age < WMBUS_METER_LOSS_HOURS; age++)
+    {
+        // Buckets after the newest one are empty, those before the oldest were reused
+        const uint32_t h = hour - age;
+        if (m->loss_hour - h >= WMBUS_METER_LOSS_HOURS)
+        {
+            continue;
+        }
+        const wmbus_meter_hour_t *b = &m->hours[h % WMBUS_METER_LOSS_HOURS];
+        const bool edge_1h = (age == 1);
+        const bool edge_24h = (age == WMBUS_METER_LOSS_HOURS - 1);
+        const uint32_t exp_part = (uint32_t)(((uint64_t)b->expected * inside) / WMBUS_METER_HOUR_MS);
+        const uint32_t rcv_part = (uint32_t)(((uint64_t)b->received * inside) / WMBUS_METER_HOUR_MS);
+        if (age <= 1)
+        {
+            out->expected_1h += edge_1h ? exp_part : b->expected;
+            out->received_1h += edge_1h ? rcv_part : b->received;
+        }
+        out->expected_24h += edge_24h ? exp_part : b->expected;
+        out->received_24h += edge_24h ? rcv_part : b->received;
+    }
+}
+
+void wmbus_meter_table_note_unattributed(wmbus_meter_table_t *t)
+{
+    if (t)
+    {
+        t->unattributed++;
+    }
+}
+
+const wmbus_meter_t *wmbus_meter_table_find(const wmbus_meter_table_t *t, uint16_t manuf, const uint8_t id[4])
+{
+    if (!t || !id)
+    {
+        return NULL;
+    }
+    const uint32_t slot = probe(t, key_hash(manuf, id), manuf, id);
+    return t->slots[slot] ? &t->meters[t->slots[slot] - 1] : NULL;
+}
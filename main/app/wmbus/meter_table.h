@@ -0,0 +1,115 @@
+// Per-meter reception statistics: one row per (manufacturer, ID) heard, found
+// through an open-addressing index (linear probing, at most half full) and kept
+// on a recency list, so a frame updates its row in O(1) and a full table
+// recycles the meter heard least recently.
+//
+// Frames that fail a CRC after block 0 still carry a verified address and are
+// counted against their meter; earlier failures are only counted in total.
+//
+// Lost frames are counted from access number (ACC) gaps between intact frames:
+// the 8-bit counter advances once per transmission, whole wraps are filled in
+// from the interval estimate, and a repeated ACC, or a slightly older one
+// shortly after the previous frame (repeater copy), is ignored. Hourly buckets
+// give the reception ratio over the last hour and the last day.
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "app/config.h"
+
+#define WMBUS_METER_NONE 0xFFFF
+#define WMBUS_METER_HOUR_MS 3600000u
+#define WMBUS_METER_LOSS_HOURS 25    // Current hour, 23 full ones and the partly covered 24th
+#define WMBUS_METER_STALE_ACC 8      // ACCs up to this far back, within this many intervals, are copies
+#define WMBUS_METER_GAP_UNKNOWN 0xFFFF
+
+// What the table needs from one received frame.
+typedef struct
+{
+    uint16_t manuf;
+    uint8_t id[4];
+    uint8_t dev_type;
+    bool intact;       // All blocks passed their CRC (else only the address is trusted)
+    bool has_acc;      // ELL or TPL access number present (intact frames only)
+    uint8_t acc;
+    int16_t rssi_ddbm; // RSSI in 0.1 dBm
+    uint8_t lqi;
+} wmbus_meter_sample_t;
+
+// Frames expected (by ACC) and received intact within one hour.
+typedef struct
+{
+    uint16_t expected;
+    uint16_t received;
+} wmbus_meter_hour_t;
+
+// Reception of one meter; ratios are received / expected.
+typedef struct wmbus_meter_loss
+{
+    uint32_t expected_1h;
+    uint32_t received_1h;
+    uint32_t expected_24h;
+    uint32_t received_24h;
+    uint16_t gap; // Frames missed right before the latest intact frame (WMBUS_METER_GAP_UNKNOWN: no ACC step)
+} wmbus_meter_loss_t;
+
+typedef struct
+{
+    uint16_t manuf;
+    uint8_t id[4];
+    uint8_t dev_type;
+    uint8_t acc;          // Last access number (valid if has_acc)
+    bool has_acc;
+    uint32_t first_ms;    // Uptime of the first frame
+    uint32_t last_ms;     // Uptime of the latest frame, intact or not
+    uint32_t intact_ms;   // Uptime of the latest intact frame
+    uint32_t frames;      // Intact frames
+    uint32_t crc_errors;  // Frames that failed a CRC after the address block
+    int64_t rssi_sum;     // 0.1 dBm over frames + crc_errors
+    uint32_t lqi_sum;
+    int16_t rssi_min;
+    int16_t rssi_max;
+    uint8_t lqi_min;
+    uint8_t lqi_max;
+    uint32_t interval_ms; // Estimated transmit interval (0 until two intact frames)
+    uint32_t missed;      // Frames lost according to ACC gaps
+    uint32_t repeats;     // Intact frames with an ACC already seen (left out of the loss count)
+    uint16_t gap;         // See wmbus_meter_loss_t
+    uint32_t loss_hour;   // Uptime hour of the newest bucket
+    wmbus_meter_hour_t hours[WMBUS_METER_LOSS_HOURS]; // Indexed by hour % WMBUS_METER_LOSS_HOURS
+    uint32_t hash;
+    uint16_t newer;       // Recency list (WMBUS_METER_NONE at the ends)
+    uint16_t older;
+} wmbus_meter_t;
+
+typedef struct
+{
+    wmbus_meter_t meters[APP_METERS];
+    uint16_t slots[APP_METER_SLOTS]; // Row + 1, 0 = empty (power of two, >= 2 * APP_METERS)
+    uint16_t count;
+    uint16_t newest;
+    uint16_t oldest;
+    uint32_t evicted;       // Rows recycled for a new meter
+    uint32_t unattributed;  // Frames that failed before the address was verified
+} wmbus_meter_table_t;
+
+void wmbus_meter_table_init(wmbus_meter_table_t *t);
+
+// Account one frame to its meter, adding (or recycling) a row for a new one.
+void wmbus_meter_table_update(wmbus_meter_table_t *t, const wmbus_meter_sample_t *s, uint32_t now_ms);
+
+// A frame with no trustworthy address (failed in block 0).
+void wmbus_meter_table_note_unattributed(wmbus_meter_table_t *t);
+
+// Reception over the hour and the day up to now_ms. The oldest bucket of each
+// window counts with the part of its hour still inside the window.
+void wmbus_meter_get_loss(const wmbus_meter_t *m, uint32_t now_ms, wmbus_meter_loss_t *out);
+
+// Ratio in 0.1 % (1000 = nothing lost); -1 when no frame was expected.
+static inline int32_t wmbus_meter_ratio_permille(uint32_t received, uint32_t expected)
+{
+    return expected ? (int32_t)(((uint64_t)received * 1000u) / expected) : -1;
+}
+
+// Row lookup; NULL when the meter is not in the table.
+const wmbus_meter_t *wmbus_meter_table_find(const wmbus_meter_table_t *t, uint16_t manuf, const uint8_t id[4]);
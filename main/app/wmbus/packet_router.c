@@ -1,59 +1,442 @@
 #include "app/wmbus/packet_router.h"
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "app/wmbus/frame_pool.h"
+#include "app/wmbus/parsed_frame.h"
 
 static const char *TAG = "packet_router";
 
-#define MAX_SINKS 4
+#define ASYNC_DEFAULT_DEPTH    4
+#define ASYNC_DEFAULT_PRIORITY 3
+#define ASYNC_DEFAULT_STACK    3072
+
+typedef struct
+{
+    WmbusPacketEvent evt; // evt.frame holds a reference while queued
+    bool stop;            // Sent by unregister: discard the rest and exit
+} async_item_t;
 
 typedef struct
 {
     wmbus_packet_sink_fn fn;
     void *user;
+    uint32_t flags;
+    char name[WMBUS_SINK_NAME_MAX];
+    frame_filter_t filter;
+    // Async only
+    QueueHandle_t queue;
+    SemaphoreHandle_t done; // Given by the worker right before it exits
+    wmbus_sink_drop_t drop;
+    TickType_t block_ticks;
+    // Written by the context that runs the sink (dispatch caller or worker)
+    uint32_t calls;
+    uint32_t avg_us;
+    uint32_t max_us;
+    // Written by the dispatch caller
+    uint32_t high_water;
+    uint32_t dropped;
+    uint32_t filtered;
 } sink_entry_t;
 
-static sink_entry_t s_sinks[MAX_SINKS];
+static sink_entry_t *s_sinks[WMBUS_ROUTER_MAX_SINKS];
+static SemaphoreHandle_t s_lock; // Guards s_sinks; held while dispatching
+static volatile uint32_t s_flags;
+static wmbus_packet_router_stats_t s_stats;
+
+static void update_flags(void)
+{
+    uint32_t flags = 0;
+    for (size_t i = 0; i < WMBUS_ROUTER_MAX_SINKS; i++)
+    {
+        if (s_sinks[i])
+        {
+            flags |= s_sinks[i]->flags;
+        }
+    }
+    s_flags = flags;
+}
+
+static bool parse_layers(const WmbusPacketEvent *evt, wmbus_parsed_frame_t *out)
+{
+    if (!evt->frame_info.parsed || !evt->logical_packet || evt->logical_len == 0)
+    {
+        return false;
+    }
+    const wmbus_raw_frame_t raw = {
+        .bytes = evt->logical_packet,
+        .len = evt->logical_len,
+    };
+    wmbus_parsed_frame_init(out, &raw, &evt->frame_info);
+    wmbus_parsed_frame_parse_meta(out);
+    if (evt->gateway_name)
+    {
+        snprintf(out->dll.gateway, sizeof(out->dll.gateway), "%s", evt->gateway_name);
+    }
+    return true;
+}
+
+static void run_sink(sink_entry_t *s, const WmbusPacketEvent *evt)
+{
+    const int64_t t0 = esp_timer_get_time();
+    s->fn(evt, s->user);
+    const uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    // EMA with 1/8 weight; the first call seeds it
+    s->avg_us = s->calls ? s->avg_us - (s->avg_us >> 3) + (us >> 3) : us;
+    if (us > s->max_us)
+    {
+        s->max_us = us;
+    }
+    s->calls++;
+}
+
+static void async_worker(void *arg)
+{
+    sink_entry_t *s = (sink_entry_t *)arg;
+    async_item_t item;
+    while (xQueueReceive(s->queue, &item, portMAX_DELAY) == pdTRUE && !item.stop)
+    {
+        wmbus_parsed_frame_t parsed;
+        if ((s->flags & WMBUS_SINK_FLAG_META) && parse_layers(&item.evt, &parsed))
+        {
+            item.evt.parsed = &parsed;
+        }
+        run_sink(s, &item.evt);
+        wmbus_frame_unref(item.evt.frame);
+    }
+    while (xQueueReceive(s->queue, &item, 0) == pdTRUE)
+    {
+        wmbus_frame_unref(item.evt.frame);
+    }
+    xSemaphoreGive(s->done);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t async_start(sink_entry_t *s, const wmbus_sink_opts_t *opts)
+{
+    const uint16_t depth = opts->queue_depth ? opts->queue_depth : ASYNC_DEFAULT_DEPTH;
+    s->drop = opts->drop;
+    s->block_ticks = pdMS_TO_TICKS(opts->block_ms);
+    s->queue = xQueueCreate(depth, sizeof(async_item_t));
+    s->done = xSemaphoreCreateBinary();
+    if (!s->queue || !s->done ||
+        xTaskCreate(async_worker, s->name, opts->stack_size ? opts->stack_size : ASYNC_DEFAULT_STACK, s,
+                    opts->priority ? opts->priority : ASYNC_DEFAULT_PRIORITY, NULL) != pdPASS)
+    {
+        if (s->queue)
+        {
+            vQueueDelete(s->queue);
+        }
+        if (s->done)
+        {
+            vSemaphoreDelete(s->done);
+        }
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static void async_stop(sink_entry_t *s)
+{
+    const async_item_t stop = {.stop = true};
+    xQueueSendToFront(s->queue, &stop, portMAX_DELAY);
+    xSemaphoreTake(s->done, portMAX_DELAY);
+    vQueueDelete(s->queue);
+    vSemaphoreDelete(s->done);
+}
+
+// Queue evt for an async sink, applying its drop policy when the queue is full.
+static void async_post(sink_entry_t *s, const WmbusPacketEvent *evt)
+{
+    if (!evt->frame)
+    {
+        s->dropped++; // Nothing would keep the buffers alive once dispatch returns
+        return;
+    }
+    async_item_t item = {.evt = *evt};
+    item.evt.parsed = NULL;
+    item.evt.loss = NULL;
+    wmbus_frame_ref(evt->frame);
+
+    const TickType_t wait = (s->drop == WMBUS_SINK_BLOCK) ? s->block_ticks : 0;
+    bool queued = xQueueSend(s->queue, &item, wait) == pdTRUE;
+    if (!queued && s->drop == WMBUS_SINK_DROP_OLDEST)
+    {
+        async_item_t old;
+        if (xQueueReceive(s->queue, &old, 0) == pdTRUE)
+        {
+            wmbus_frame_unref(old.evt.frame);
+            s->dropped++;
+        }
+        queued = xQueueSend(s->queue, &item, 0) == pdTRUE;
+    }
+    if (!queued)
+    {
+        wmbus_frame_unref(evt->frame);
+        s->dropped++;
+        return;
+    }
+    const uint32_t depth = (uint32_t)uxQueueMessagesWaiting(s->queue);
+    if (depth > s->high_water)
+    {
+        s->high_water = depth;
+    }
+}
+
+static void sink_free(sink_entry_t *s)
+{
+    if (s->flags & WMBUS_SINK_FLAG_ASYNC)
+    {
+        async_stop(s);
+    }
+    free(s);
+}
 
 esp_err_t wmbus_packet_router_init(void)
 {
+    if (!s_lock)
+    {
+        s_lock = xSemaphoreCreateMutex();
+        if (!s_lock)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    sink_entry_t *old[WMBUS_ROUTER_MAX_SINKS];
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    memcpy(old, s_sinks, sizeof(old));
     memset(s_sinks, 0, sizeof(s_sinks));
+    s_flags = 0;
+    memset(&s_stats, 0, sizeof(s_stats));
+    xSemaphoreGive(s_lock);
+    for (size_t i = 0; i < WMBUS_ROUTER_MAX_SINKS; i++)
+    {
+        if (old[i])
+        {
+            sink_free(old[i]);
+        }
+    }
     return ESP_OK;
 }
 
 esp_err_t wmbus_packet_router_register(wmbus_packet_sink_fn fn, void *user)
 {
-    if (!fn)
+    return wmbus_packet_router_register_ex(fn, user, NULL);
+}
+
+esp_err_t wmbus_packet_router_register_ex(wmbus_packet_sink_fn fn, void *user, const wmbus_sink_opts_t *opts)
+{
+    if (!fn || !s_lock)
     {
         return ESP_ERR_INVALID_ARG;
     }
+    const wmbus_sink_opts_t defaults = {0};
+    if (!opts)
+    {
+        opts = &defaults;
+    }
 
-    for (size_t i = 0; i < MAX_SINKS; i++)
+    sink_entry_t *s = calloc(1, sizeof(*s));
+    if (!s)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    s->fn = fn;
+    s->user = user;
+    s->flags = opts->flags;
+    snprintf(s->name, sizeof(s->name), "%s", opts->name ? opts->name : "sink");
+    if (opts->filter)
+    {
+        s->filter = *opts->filter;
+    }
+    if ((s->flags & WMBUS_SINK_FLAG_ASYNC) && async_start(s, opts) != ESP_OK)
     {
-        if (!s_sinks[i].fn)
+        ESP_LOGW(TAG, "No memory for async sink %s", s->name);
+        free(s);
+        return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (size_t i = 0; i < WMBUS_ROUTER_MAX_SINKS; i++)
+    {
+        if (!s_sinks[i])
         {
-            s_sinks[i].fn = fn;
-            s_sinks[i].user = user;
+            s_sinks[i] = s;
+            update_flags();
+            xSemaphoreGive(s_lock);
             return ESP_OK;
         }
     }
+    xSemaphoreGive(s_lock);
 
     ESP_LOGW(TAG, "No slot left to register sink");
+    sink_free(s);
     return ESP_ERR_NO_MEM;
 }
 
+esp_err_t wmbus_packet_router_unregister(wmbus_packet_sink_fn fn, void *user)
+{
+    if (!fn || !s_lock)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sink_entry_t *found = NULL;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (size_t i = 0; i < WMBUS_ROUTER_MAX_SINKS; i++)
+    {
+        if (s_sinks[i] && s_sinks[i]->fn == fn && s_sinks[i]->user == user)
+        {
+            found = s_sinks[i];
+            s_sinks[i] = NULL;
+            update_flags();
+            break;
+        }
+    }
+    xSemaphoreGive(s_lock);
+    if (!found)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    // Out of the table and the lock: dispatch no longer reaches it, the worker can drain
+    sink_free(found);
+    return ESP_OK;
+}
+
+esp_err_t wmbus_packet_router_set_filter(const char *name, const frame_filter_t *filter)
+{
+    if (!name || !s_lock)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (size_t i = 0; i < WMBUS_ROUTER_MAX_SINKS; i++)
+    {
+        sink_entry_t *s = s_sinks[i];
+        if (s && strcmp(s->name, name) == 0)
+        {
+            if (filter)
+            {
+                s->filter = *filter;
+            }
+            else
+            {
+                memset(&s->filter, 0, sizeof(s->filter));
+            }
+            s->filtered = 0;
+            err = ESP_OK;
+        }
+    }
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+uint32_t wmbus_packet_router_flags(void)
+{
+    return s_flags;
+}
+
 void wmbus_packet_router_dispatch(const WmbusPacketEvent *evt)
 {
-    if (!evt)
+    if (!evt || !s_lock)
     {
         return;
     }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_stats.dispatched++;
 
-    for (size_t i = 0; i < MAX_SINKS; i++)
+    // Sinks get a copy so the lazily parsed layers can be attached without touching the caller's event.
+    WmbusPacketEvent view = *evt;
+    wmbus_parsed_frame_t parsed;
+    bool parse_tried = (view.parsed != NULL);
+    for (size_t i = 0; i < WMBUS_ROUTER_MAX_SINKS; i++)
+    {
+        sink_entry_t *s = s_sinks[i];
+        if (!s)
+        {
+            continue;
+        }
+        const bool meta_now = (s->filter.len && s->filter.needs_meta) ||
+                              ((s->flags & WMBUS_SINK_FLAG_META) && !(s->flags & WMBUS_SINK_FLAG_ASYNC));
+        if (meta_now && !parse_tried)
+        {
+            parse_tried = true;
+            if (parse_layers(evt, &parsed))
+            {
+                view.parsed = &parsed;
+                s_stats.parsed++;
+            }
+        }
+        if (s->filter.len)
+        {
+            const frame_filter_input_t in = {
+                .info = &view.frame_info,
+                .rssi_dbm = view.rssi_dbm,
+                .lqi = view.lqi,
+                .parsed = view.parsed,
+            };
+            if (!frame_filter_match(&s->filter, &in))
+            {
+                s->filtered++;
+                continue;
+            }
+        }
+        if (s->flags & WMBUS_SINK_FLAG_ASYNC)
+        {
+            async_post(s, evt);
+            continue;
+        }
+        run_sink(s, &view);
+    }
+    xSemaphoreGive(s_lock);
+}
+
+void wmbus_packet_router_get_stats(wmbus_packet_router_stats_t *out)
+{
+    if (!out)
+    {
+        return;
+    }
+    *out = s_stats;
+}
+
+size_t wmbus_packet_router_get_sink_stats(wmbus_sink_stats_t *out, size_t max)
+{
+    if (!out || !s_lock)
+    {
+        return 0;
+    }
+    size_t n = 0;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (size_t i = 0; i < WMBUS_ROUTER_MAX_SINKS && n < max; i++)
     {
-        if (s_sinks[i].fn)
+        const sink_entry_t *s = s_sinks[i];
+        if (!s)
         {
-            s_sinks[i].fn(evt, s_sinks[i].user);
+            continue;
         }
+        const bool async = (s->flags & WMBUS_SINK_FLAG_ASYNC) != 0;
+        wmbus_sink_stats_t *o = &out[n++];
+        *o = (wmbus_sink_stats_t){
+            .async = async,
+            .calls = s->calls,
+            .avg_us = s->avg_us,
+            .max_us = s->max_us,
+            .queued = async ? (uint32_t)uxQueueMessagesWaiting(s->queue) : 0,
+            .high_water = s->high_water,
+            .dropped = s->dropped,
+            .filtered = s->filtered,
+            .has_filter = s->filter.len > 0,
+        };
+        memcpy(o->name, s->name, sizeof(o->name));
     }
+    xSemaphoreGive(s_lock);
+    return n;
 }
@@ -2,8 +2,14 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 #include "wmbus/packet.h"
+#include "app/wmbus/frame_filter.h"
+
+struct wmbus_frame;        // app/wmbus/frame_pool.h
+struct wmbus_parsed_frame; // app/wmbus/parsed_frame.h
+struct wmbus_meter_loss;   // app/wmbus/meter_table.h
 
 typedef struct
 {
@@ -11,20 +17,96 @@ typedef struct
     uint8_t status;            // WMBUS_PKT_xxx
     float rssi_dbm;
     uint8_t lqi;
-    const uint8_t *raw_packet; // On-air bytes incl. CRC blocks
+    const uint8_t *raw_packet; // On-air bytes incl. CRC blocks (NULL unless a sink sets WMBUS_SINK_FLAG_RAW)
     uint16_t raw_len;
     const uint8_t *logical_packet; // CRC-free packet (L|C|M|ID|Ver|Dev|CI|payload)
     uint16_t logical_len;
-    const uint8_t *encoded;    // Encoded (3-of-6) bytes
+    const uint8_t *encoded;    // Encoded (3-of-6) bytes (NULL unless a sink sets WMBUS_SINK_FLAG_ENCODED)
     uint16_t encoded_len;
     const char *gateway_name;  // Optional identifier/hostname for backend tagging
+    struct wmbus_frame *frame; // Pooled frame owning the buffers above (may be NULL). The pointers are
+                               // only valid during the callback; wmbus_frame_ref keeps the frame longer.
+    const struct wmbus_parsed_frame *parsed; // TPL/ELL/AFL/security layers, parsed once by the router.
+                                             // Set for sinks with WMBUS_SINK_FLAG_META (NULL if unparseable).
+    const struct wmbus_meter_loss *loss; // Reception of the sending meter up to this frame, attached by the
+                                         // runtime for the uplink (NULL otherwise).
 } WmbusPacketEvent;
 
 typedef void (*wmbus_packet_sink_fn)(const WmbusPacketEvent *evt, void *user);
 
-// Initialize router storage.
+// Sink capability flags: what a sink needs beyond the logical frame.
+#define WMBUS_SINK_FLAG_RAW     (1u << 0) // On-air packet incl. CRC fields (debug)
+#define WMBUS_SINK_FLAG_ENCODED (1u << 1) // 3-of-6 encoded bytes as read from the FIFO (debug)
+#define WMBUS_SINK_FLAG_META    (1u << 2) // Layer metadata in evt->parsed (header-only sinks skip the parse)
+#define WMBUS_SINK_FLAG_ASYNC   (1u << 3) // Run in an own worker task behind a bounded queue
+
+#define WMBUS_ROUTER_MAX_SINKS 8
+
+// What an asynchronous sink does with an event when its queue is full.
+typedef enum
+{
+    WMBUS_SINK_DROP_OLDEST = 0, // Discard the oldest queued event to make room
+    WMBUS_SINK_DROP_NEWEST,     // Discard the new event
+    WMBUS_SINK_BLOCK,           // Wait up to block_ms for room, then discard the new event
+} wmbus_sink_drop_t;
+
+typedef struct
+{
+    uint32_t flags; // WMBUS_SINK_FLAG_xxx
+    const char *name; // Shown in the sink stats (and the worker task name); NULL for "sink"
+    const frame_filter_t *filter; // Only matching events reach the sink (copied; NULL = all)
+    // WMBUS_SINK_FLAG_ASYNC only; zero selects the defaults below.
+    uint16_t queue_depth;  // Events (each holding a pooled frame reference); default 4
+    wmbus_sink_drop_t drop;
+    uint16_t block_ms;     // WMBUS_SINK_BLOCK: longest wait for room
+    uint8_t priority;      // Worker priority; default 3
+    uint32_t stack_size;   // Worker stack; default 3072
+} wmbus_sink_opts_t;
+
+typedef struct
+{
+    uint32_t dispatched; // Events handed to the sinks
+    uint32_t parsed;     // Layer parses (at most one per event, none without a META sink)
+} wmbus_packet_router_stats_t;
+
+#define WMBUS_SINK_NAME_MAX 16
+
+typedef struct
+{
+    char name[WMBUS_SINK_NAME_MAX];
+    bool async;
+    uint32_t calls;      // Completed sink calls
+    uint32_t avg_us;     // Mean time per call (exponential moving average)
+    uint32_t max_us;
+    uint32_t queued;     // Async: events waiting now
+    uint32_t high_water; // Async: most events waiting at once
+    uint32_t dropped;    // Async: events discarded by the drop policy
+    uint32_t filtered;   // Events rejected by the sink's filter
+    bool has_filter;
+} wmbus_sink_stats_t;
+
+// Initialize router storage (unregisters any sinks left from a previous init).
 esp_err_t wmbus_packet_router_init(void);
 // Register a sink; returns ESP_ERR_NO_MEM if max sinks reached.
 esp_err_t wmbus_packet_router_register(wmbus_packet_sink_fn fn, void *user);
-// Dispatch event to all registered sinks (runs synchronously).
+// Register a sink with options (opts may be NULL). An async sink gets its queue and
+// worker task here; its events must carry a pooled frame (evt->frame), which stays
+// referenced while queued. Async META sinks parse the layers in their own worker.
+esp_err_t wmbus_packet_router_register_ex(wmbus_packet_sink_fn fn, void *user, const wmbus_sink_opts_t *opts);
+// Remove a sink (ESP_ERR_NOT_FOUND if fn/user is not registered). Returns once the sink
+// can no longer run; queued events of an async sink are discarded. Not from a sink.
+esp_err_t wmbus_packet_router_unregister(wmbus_packet_sink_fn fn, void *user);
+// Replace the filter of every sink registered under name (NULL or empty filter = all
+// events); ESP_ERR_NOT_FOUND when no sink has that name.
+esp_err_t wmbus_packet_router_set_filter(const char *name, const frame_filter_t *filter);
+// Union of the flags of all registered sinks (lets the RX path skip unused debug copies).
+uint32_t wmbus_packet_router_flags(void);
+// Dispatch event to all registered sinks. Synchronous sinks run in the caller in
+// registration order; asynchronous sinks get the event queued. The frame is parsed
+// into evt->parsed just before the first synchronous WMBUS_SINK_FLAG_META sink runs;
+// later sinks see the same result.
 void wmbus_packet_router_dispatch(const WmbusPacketEvent *evt);
+// Counters since init (dispatch context only, readers get a relaxed snapshot).
+void wmbus_packet_router_get_stats(wmbus_packet_router_stats_t *out);
+// Per-sink counters in registration order; returns the number of entries written.
+size_t wmbus_packet_router_get_sink_stats(wmbus_sink_stats_t *out, size_t max);
@@ -61,7 +61,7 @@ typedef struct
     // Placeholder for DIF/VIF or other app-layer parsing.
 } wmbus_layer_apl_t;
 
-typedef struct
+typedef struct wmbus_parsed_frame
 {
     wmbus_raw_frame_t raw;
     WmbusFrameInfo info;
@@ -3,10 +3,23 @@
 #include <string.h>
 #include <stdbool.h>
 #include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
 
 static const char *TAG = "cc1101_hal";
 static bool s_bus_initialized = false;
 
+#ifndef CONFIG_CC1101_SPI_CLOCK_HZ
+#define CONFIG_CC1101_SPI_CLOCK_HZ 6000000
+#endif
+#ifndef CONFIG_CC1101_SPI_QUEUED_MIN_BYTES
+#define CONFIG_CC1101_SPI_QUEUED_MIN_BYTES 16
+#endif
+
+// FIFO payload rounded up to the 4-byte DMA alignment
+#define CC1101_HAL_DMA_BUF ((CC1101_FIFO_SIZE + 3) & ~3)
+
 static esp_err_t cc1101_spi_transfer(cc1101_hal_t *dev, const uint8_t *tx, uint8_t *rx, size_t len_bits)
 {
     spi_transaction_t t;
@@ -33,14 +46,26 @@ esp_err_t cc1101_hal_init(const cc1101_pin_config_t *pins, cc1101_hal_t *out)
         .max_transfer_sz = 128,
     };
 
+    // Burst access is specified up to 6.5 MHz (Kconfig caps the clock there)
     spi_device_interface_config_t devcfg = {
-        .clock_speed_hz = 6 * 1000 * 1000, // lower speed to improve margin
+        .clock_speed_hz = CONFIG_CC1101_SPI_CLOCK_HZ,
         .mode = 0,
         .spics_io_num = pins->cs,
         .queue_size = 2,
         .flags = 0, // full duplex (required for tx+rx in one transaction)
     };
 
+    out->dma_rx = heap_caps_malloc(CC1101_HAL_DMA_BUF, MALLOC_CAP_DMA);
+    out->dma_tx = heap_caps_calloc(1, CC1101_HAL_DMA_BUF, MALLOC_CAP_DMA);
+    if (!out->dma_rx || !out->dma_tx)
+    {
+        heap_caps_free(out->dma_rx);
+        heap_caps_free(out->dma_tx);
+        out->dma_rx = NULL;
+        out->dma_tx = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
     if (!s_bus_initialized)
     {
         esp_err_t bus_err = spi_bus_initialize(pins->host, &buscfg, SPI_DMA_CH_AUTO);
@@ -82,6 +107,10 @@ void cc1101_hal_deinit(cc1101_hal_t *dev)
     spi_device_handle_t handle = dev->spi;
     dev->spi = NULL;
     spi_bus_remove_device(handle);
+    heap_caps_free(dev->dma_rx);
+    heap_caps_free(dev->dma_tx);
+    dev->dma_rx = NULL;
+    dev->dma_tx = NULL;
 }
 
 esp_err_t cc1101_hal_strobe(cc1101_hal_t *dev, uint8_t strobe, uint8_t *status_out)
@@ -152,34 +181,103 @@ esp_err_t cc1101_hal_write_fifo(cc1101_hal_t *dev, const uint8_t *data, size_t l
     return spi_device_polling_transmit(dev->spi, &t);
 }
 
+// Burst-read len FIFO bytes into dev->dma_rx. The header byte goes out in the
+// command phase, so the data lands at the start of the buffer. Long bursts are
+// queued (the task sleeps while DMA runs), short ones are polled.
+static esp_err_t cc1101_fifo_burst(cc1101_hal_t *dev, size_t len)
+{
+    spi_transaction_ext_t t;
+    memset(&t, 0, sizeof(t));
+    t.base.flags = SPI_TRANS_VARIABLE_CMD;
+    t.base.cmd = CC1101_RXFIFO | CC1101_READ_BURST;
+    t.command_bits = 8;
+    t.base.length = 8 * len;
+    t.base.tx_buffer = dev->dma_tx;
+    t.base.rx_buffer = dev->dma_rx;
+
+    if (CONFIG_CC1101_SPI_QUEUED_MIN_BYTES == 0 || len < CONFIG_CC1101_SPI_QUEUED_MIN_BYTES)
+    {
+        return spi_device_polling_transmit(dev->spi, &t.base);
+    }
+    esp_err_t err = spi_device_queue_trans(dev->spi, &t.base, portMAX_DELAY);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    spi_transaction_t *done = NULL;
+    return spi_device_get_trans_result(dev->spi, &done, portMAX_DELAY);
+}
+
 esp_err_t cc1101_hal_read_fifo(cc1101_hal_t *dev, uint8_t *data, size_t len)
 {
     if (!dev || !data || len == 0)
     {
         return ESP_ERR_INVALID_ARG;
     }
-
-    uint8_t buffer[65];
-    if (len > 64)
+    if (len > CC1101_FIFO_SIZE)
     {
         return ESP_ERR_INVALID_ARG;
     }
 
-    buffer[0] = CC1101_RXFIFO | CC1101_READ_BURST;
-    memset(&buffer[1], 0, len);
+    esp_err_t err = cc1101_fifo_burst(dev, len);
+    if (err == ESP_OK)
+    {
+        memcpy(data, dev->dma_rx, len);
+    }
+    return err;
+}
+
+esp_err_t cc1101_hal_drain_rx(cc1101_hal_t *dev, size_t min_len, size_t max_len, const uint8_t **data, size_t *len, uint8_t *rxbytes)
+{
+    if (!dev || !data || !len || !rxbytes || max_len > CC1101_FIFO_SIZE)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *data = dev->dma_rx;
+    *len = 0;
 
-    uint8_t rx_buffer[65] = {0};
+    // Hold the bus so RXBYTES and the burst share one CS assertion; with CS kept
+    // low the CC1101 takes the byte after a status read as a new header.
+    esp_err_t err = spi_device_acquire_bus(dev->spi, portMAX_DELAY);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
 
     spi_transaction_t t;
     memset(&t, 0, sizeof(t));
-    t.length = 8 * (len + 1);
-    t.tx_buffer = buffer;
-    t.rx_buffer = rx_buffer;
-    esp_err_t err = spi_device_polling_transmit(dev->spi, &t);
+    t.flags = SPI_TRANS_USE_TXDATA | SPI_TRANS_USE_RXDATA | SPI_TRANS_CS_KEEP_ACTIVE;
+    t.length = 16;
+    t.tx_data[0] = CC1101_RXBYTES | CC1101_READ_BURST; // status registers need the burst bit
+    err = spi_device_polling_transmit(dev->spi, &t);
     if (err == ESP_OK)
     {
-        memcpy(data, &rx_buffer[1], len);
+        *rxbytes = t.rx_data[1];
+        size_t n = *rxbytes & CC1101_RXBYTES_NUM_MASK;
+        if (n > max_len)
+        {
+            n = max_len;
+        }
+        if (!(*rxbytes & CC1101_RX_OVERFLOW_BM) && n && n >= min_len)
+        {
+            err = cc1101_fifo_burst(dev, n);
+            if (err == ESP_OK)
+            {
+                *len = n;
+            }
+        }
+        else
+        {
+            // Nothing to read: end the access with a no-op strobe to release CS.
+            memset(&t, 0, sizeof(t));
+            t.flags = SPI_TRANS_USE_TXDATA;
+            t.length = 8;
+            t.tx_data[0] = CC1101_SNOP | CC1101_READ_SINGLE;
+            err = spi_device_polling_transmit(dev->spi, &t);
+        }
     }
+
+    spi_device_release_bus(dev->spi);
     return err;
 }
 
@@ -10,10 +10,14 @@
 #include "radio/cc1101_regs.h"
 #include "radio/rf_config_tmode.h"
 
+#define CC1101_FIFO_SIZE 64
+
 typedef struct
 {
     spi_device_handle_t spi;
     cc1101_pin_config_t pins;
+    uint8_t *dma_rx; // DMA-capable FIFO burst buffer (>= CC1101_FIFO_SIZE bytes)
+    uint8_t *dma_tx; // DMA-capable zero fill clocked out during FIFO bursts
 } cc1101_hal_t;
 
 esp_err_t cc1101_hal_init(const cc1101_pin_config_t *pins, cc1101_hal_t *out);
@@ -25,6 +29,12 @@ esp_err_t cc1101_hal_read_reg(cc1101_hal_t *dev, uint8_t addr, uint8_t *value);
 esp_err_t cc1101_hal_write_fifo(cc1101_hal_t *dev, const uint8_t *data, size_t len);
 esp_err_t cc1101_hal_read_fifo(cc1101_hal_t *dev, uint8_t *data, size_t len);
 
+// Drain the RX FIFO without a CPU copy: RXBYTES is read and, if at least min_len
+// bytes are available (and no overflow is flagged), a burst of min(available, max_len)
+// follows under the same chip select. *data points into the HAL's DMA buffer and stays
+// valid until the next FIFO access; *len is 0 when nothing was read.
+esp_err_t cc1101_hal_drain_rx(cc1101_hal_t *dev, size_t min_len, size_t max_len, const uint8_t **data, size_t *len, uint8_t *rxbytes);
+
 esp_err_t cc1101_hal_configure_tmode(cc1101_hal_t *dev);
 esp_err_t cc1101_hal_load_pa_table(cc1101_hal_t *dev, const uint8_t *table, size_t len);
 // Carrier-sense threshold presets (adjust AGCCTRL0 CS bits at runtime)
@@ -69,6 +69,7 @@
 #define CC1101_RXBYTES        0x3B
 #define CC1101_RX_OVERFLOW_BM 0x80
 #define CC1101_RXBYTES_NUM_MASK 0x7F
+#define CC1101_MCSM1_RXOFF_RX   0x0C // RXOFF_MODE: stay in RX after a packet
 
 // FIFOs / PATABLE
 #define CC1101_PATABLE 0x3E
@@ -13,8 +13,8 @@ esp_err_t radio_rx_configure_tmode(cc1101_hal_t *dev)
     ESP_ERROR_CHECK(cc1101_hal_configure_tmode(dev));
     ESP_ERROR_CHECK(cc1101_hal_load_pa_table(dev, cc1101_tmode_pa_table, sizeof(cc1101_tmode_pa_table)));
 
-    // IDLE after RX/TX
-    ESP_ERROR_CHECK(cc1101_hal_write_reg(dev, CC1101_MCSM1, 0x00));
+    // Stay in RX after a packet (continuous reception), IDLE after TX
+    ESP_ERROR_CHECK(cc1101_hal_write_reg(dev, CC1101_MCSM1, CC1101_MCSM1_RXOFF_RX));
 
     // T-mode sync word 0x543D
     ESP_ERROR_CHECK(cc1101_hal_write_reg(dev, CC1101_SYNC1, 0x54));
@@ -29,6 +29,12 @@ esp_err_t radio_rx_configure_tmode(cc1101_hal_t *dev)
     return ESP_OK;
 }
 
+float radio_rx_rssi_to_dbm(uint8_t rssi_raw)
+{
+    int16_t rssi_dec = (rssi_raw >= 128) ? (int16_t)rssi_raw - 256 : rssi_raw;
+    return ((float)rssi_dec / 2.0f) - 74.0f;
+}
+
 esp_err_t radio_rx_read_rssi_lqi(cc1101_hal_t *dev, float *rssi_dbm, uint8_t *lqi_raw)
 {
     if (!dev)
@@ -41,10 +47,9 @@ esp_err_t radio_rx_read_rssi_lqi(cc1101_hal_t *dev, float *rssi_dbm, uint8_t *lq
     ESP_ERROR_CHECK(cc1101_hal_read_reg(dev, CC1101_RSSI, &rssi_raw));
     ESP_ERROR_CHECK(cc1101_hal_read_reg(dev, CC1101_LQI, &lqi));
 
-    int16_t rssi_dec = (rssi_raw >= 128) ? (int16_t)rssi_raw - 256 : rssi_raw;
     if (rssi_dbm)
     {
-        *rssi_dbm = ((float)rssi_dec / 2.0f) - 74.0f;
+        *rssi_dbm = radio_rx_rssi_to_dbm(rssi_raw);
     }
     if (lqi_raw)
     {
@@ -6,3 +6,5 @@
 
 esp_err_t radio_rx_configure_tmode(cc1101_hal_t *dev);
 esp_err_t radio_rx_read_rssi_lqi(cc1101_hal_t *dev, float *rssi_dbm, uint8_t *lqi_raw);
+// Convert a raw RSSI register value to dBm.
+float radio_rx_rssi_to_dbm(uint8_t rssi_raw);
@@ -1,5 +1,7 @@
 #include "wmbus/3of6.h"
 
+#include "sdkconfig.h"
+
 // Tables ported from TI SWRA234A
 static const uint8_t encode_tab[16] = {
     0x16, 0x0D, 0x0E, 0x0B,
@@ -7,7 +9,7 @@ static const uint8_t encode_tab[16] = {
     0x2C, 0x25, 0x26, 0x23,
     0x34, 0x31, 0x32, 0x29};
 
-static const uint8_t decode_tab[64] = {
+const uint8_t wmbus_3of6_decode_tab[64] = {
     0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
     0xFF, 0xFF, 0xFF, 0x03, 0xFF, 0x01, 0x02, 0xFF,
     0xFF, 0xFF, 0xFF, 0x07, 0xFF, 0xFF, 0x00, 0xFF,
@@ -17,7 +19,7 @@ static const uint8_t decode_tab[64] = {
     0xFF, 0x0D, 0x0E, 0xFF, 0x0C, 0xFF, 0xFF, 0xFF,
     0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
-void wmbus_encode_3of6(const uint8_t *uncoded, uint8_t *encoded, uint8_t last_byte)
+void wmbus_encode_3of6_scalar(const uint8_t *uncoded, uint8_t *encoded, uint8_t last_byte)
 {
     uint8_t data[4];
 
@@ -43,14 +45,14 @@ void wmbus_encode_3of6(const uint8_t *uncoded, uint8_t *encoded, uint8_t last_by
     }
 }
 
-uint8_t wmbus_decode_3of6(const uint8_t *encoded, uint8_t *decoded, uint8_t last_byte)
+uint8_t wmbus_decode_3of6_scalar(const uint8_t *encoded, uint8_t *decoded, uint8_t last_byte)
 {
     uint8_t data[4];
 
     if (!last_byte)
     {
-        data[0] = decode_tab[(*(encoded + 2) & 0x3F)];
-        data[1] = decode_tab[((*(encoded + 2) & 0xC0) >> 6) | ((*(encoded + 1) & 0x0F) << 2)];
+        data[0] = wmbus_3of6_decode_tab[(*(encoded + 2) & 0x3F)];
+        data[1] = wmbus_3of6_decode_tab[((*(encoded + 2) & 0xC0) >> 6) | ((*(encoded + 1) & 0x0F) << 2)];
     }
     else
     {
@@ -58,8 +60,8 @@ uint8_t wmbus_decode_3of6(const uint8_t *encoded, uint8_t *decoded, uint8_t last
         data[1] = 0x00;
     }
 
-    data[2] = decode_tab[((*(encoded + 1) & 0xF0) >> 4) | ((*encoded & 0x03) << 4)];
-    data[3] = decode_tab[((*encoded & 0xFC) >> 2)];
+    data[2] = wmbus_3of6_decode_tab[((*(encoded + 1) & 0xF0) >> 4) | ((*encoded & 0x03) << 4)];
+    data[3] = wmbus_3of6_decode_tab[((*encoded & 0xFC) >> 2)];
 
     if ((data[0] == 0xFF) || (data[1] == 0xFF) || (data[2] == 0xFF) || (data[3] == 0xFF))
     {
@@ -74,3 +76,58 @@ uint8_t wmbus_decode_3of6(const uint8_t *encoded, uint8_t *decoded, uint8_t last
 
     return WMBUS_3OF6_OK;
 }
+
+void wmbus_encode_3of6_lut(const uint8_t *uncoded, uint8_t *encoded, uint8_t last_byte)
+{
+    const uint16_t hi = wmbus_3of6_lut_encode[uncoded[0]];
+    encoded[0] = (uint8_t)(hi >> 4);
+    if (last_byte)
+    {
+        encoded[1] = (uint8_t)((hi << 4) | 0x05); // 0x14 postamble symbol, upper 4 bits
+        return;
+    }
+    const uint16_t lo = wmbus_3of6_lut_encode[uncoded[1]];
+    encoded[1] = (uint8_t)((hi << 4) | (lo >> 8));
+    encoded[2] = (uint8_t)lo;
+}
+
+uint8_t wmbus_decode_3of6_lut(const uint8_t *encoded, uint8_t *decoded, uint8_t last_byte)
+{
+    const uint16_t hi = wmbus_3of6_lut_decode[((uint16_t)encoded[0] << 4) | (encoded[1] >> 4)];
+    if (last_byte)
+    {
+        if (hi & WMBUS_3OF6_LUT_ERROR)
+        {
+            return WMBUS_3OF6_ERROR;
+        }
+        decoded[0] = (uint8_t)hi;
+        return WMBUS_3OF6_OK;
+    }
+
+    const uint16_t lo = wmbus_3of6_lut_decode[((uint16_t)(encoded[1] & 0x0F) << 8) | encoded[2]];
+    if ((hi | lo) & WMBUS_3OF6_LUT_ERROR)
+    {
+        return WMBUS_3OF6_ERROR;
+    }
+    decoded[0] = (uint8_t)hi;
+    decoded[1] = (uint8_t)lo;
+    return WMBUS_3OF6_OK;
+}
+
+void wmbus_encode_3of6(const uint8_t *uncoded, uint8_t *encoded, uint8_t last_byte)
+{
+#if CONFIG_WMBUS_3OF6_LUT
+    wmbus_encode_3of6_lut(uncoded, encoded, last_byte);
+#else
+    wmbus_encode_3of6_scalar(uncoded, encoded, last_byte);
+#endif
+}
+
+uint8_t wmbus_decode_3of6(const uint8_t *encoded, uint8_t *decoded, uint8_t last_byte)
+{
+#if CONFIG_WMBUS_3OF6_LUT
+    return wmbus_decode_3of6_lut(encoded, decoded, last_byte);
+#else
+    return wmbus_decode_3of6_scalar(encoded, decoded, last_byte);
+#endif
+}
@@ -1,10 +1,49 @@
 // 3-out-of-6 encoding/decoding used for wM-Bus T-mode
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
+#include "sdkconfig.h"
 
 #define WMBUS_3OF6_OK    0
 #define WMBUS_3OF6_ERROR 1
 
+#define WMBUS_3OF6_LUT_ERROR 0x100 // Invalid-pair marker in wmbus_3of6_lut_decode
+
+// Variant selected in Kconfig (CONFIG_WMBUS_3OF6_LUT: 12-bit tables, else scalar).
 void wmbus_encode_3of6(const uint8_t *uncoded, uint8_t *encoded, uint8_t last_byte);
 uint8_t wmbus_decode_3of6(const uint8_t *encoded, uint8_t *decoded, uint8_t last_byte);
+
+// Individual variants, callable regardless of the Kconfig choice (benchmarks, equivalence checks).
+void wmbus_encode_3of6_scalar(const uint8_t *uncoded, uint8_t *encoded, uint8_t last_byte);
+uint8_t wmbus_decode_3of6_scalar(const uint8_t *encoded, uint8_t *decoded, uint8_t last_byte);
+void wmbus_encode_3of6_lut(const uint8_t *uncoded, uint8_t *encoded, uint8_t last_byte);
+uint8_t wmbus_decode_3of6_lut(const uint8_t *encoded, uint8_t *decoded, uint8_t last_byte);
+
+// 6-bit symbol -> nibble, 0xFF for invalid symbols.
+extern const uint8_t wmbus_3of6_decode_tab[64];
+// Two 6-bit symbols (12 bits) -> byte, or WMBUS_3OF6_LUT_ERROR. 8 KiB.
+extern const uint16_t wmbus_3of6_lut_decode[4096];
+// Byte -> two 6-bit symbols (12 bits), high nibble's symbol first.
+extern const uint16_t wmbus_3of6_lut_encode[256];
+
+// Inline full-group decode for hot loops: 3 encoded bytes -> 2 bytes.
+// Returns false on a coding error (out is then undefined).
+static inline bool wmbus_decode_3of6_pair(const uint8_t *encoded, uint8_t *out)
+{
+#if CONFIG_WMBUS_3OF6_LUT
+    const uint16_t hi = wmbus_3of6_lut_decode[((uint16_t)encoded[0] << 4) | (encoded[1] >> 4)];
+    const uint16_t lo = wmbus_3of6_lut_decode[((uint16_t)(encoded[1] & 0x0F) << 8) | encoded[2]];
+    out[0] = (uint8_t)hi;
+    out[1] = (uint8_t)lo;
+    return ((hi | lo) & WMBUS_3OF6_LUT_ERROR) == 0;
+#else
+    const uint8_t d3 = wmbus_3of6_decode_tab[encoded[0] >> 2];
+    const uint8_t d2 = wmbus_3of6_decode_tab[((encoded[0] & 0x03) << 4) | (encoded[1] >> 4)];
+    const uint8_t d1 = wmbus_3of6_decode_tab[((encoded[1] & 0x0F) << 2) | (encoded[2] >> 6)];
+    const uint8_t d0 = wmbus_3of6_decode_tab[encoded[2] & 0x3F];
+    out[0] = (uint8_t)((d3 << 4) | (d2 & 0x0F));
+    out[1] = (uint8_t)((d1 << 4) | (d0 & 0x0F));
+    return ((d0 | d1 | d2 | d3) & 0xF0) == 0;
+#endif
+}
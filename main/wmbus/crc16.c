@@ -1,5 +1,87 @@
 #include "wmbus/crc16.h"
 
+#include "sdkconfig.h"
+
+// Lookup tables are generated for WMBUS_CRC_POLY (MSB-first, init 0). Each
+// variant lives in its own function/data section, so the linker keeps only
+// what the configured wmbus_crc16_update (or an explicit caller) references.
+
+static const uint16_t s_crc16_nibble[16] = {
+    0x0000, 0x3D65, 0x7ACA, 0x47AF, 0xF594, 0xC8F1, 0x8F5E, 0xB23B,
+    0xD64D, 0xEB28, 0xAC87, 0x91E2, 0x23D9, 0x1EBC, 0x5913, 0x6476,
+};
+
+static const uint16_t s_crc16_table[256] = {
+    0x0000, 0x3D65, 0x7ACA, 0x47AF, 0xF594, 0xC8F1, 0x8F5E, 0xB23B,
+    0xD64D, 0xEB28, 0xAC87, 0x91E2, 0x23D9, 0x1EBC, 0x5913, 0x6476,
+    0x91FF, 0xAC9A, 0xEB35, 0xD650, 0x646B, 0x590E, 0x1EA1, 0x23C4,
+    0x47B2, 0x7AD7, 0x3D78, 0x001D, 0xB226, 0x8F43, 0xC8EC, 0xF589,
+    0x1E9B, 0x23FE, 0x6451, 0x5934, 0xEB0F, 0xD66A, 0x91C5, 0xACA0,
+    0xC8D6, 0xF5B3, 0xB21C, 0x8F79, 0x3D42, 0x0027, 0x4788, 0x7AED,
+    0x8F64, 0xB201, 0xF5AE, 0xC8CB, 0x7AF0, 0x4795, 0x003A, 0x3D5F,
+    0x5929, 0x644C, 0x23E3, 0x1E86, 0xACBD, 0x91D8, 0xD677, 0xEB12,
+    0x3D36, 0x0053, 0x47FC, 0x7A99, 0xC8A2, 0xF5C7, 0xB268, 0x8F0D,
+    0xEB7B, 0xD61E, 0x91B1, 0xACD4, 0x1EEF, 0x238A, 0x6425, 0x5940,
+    0xACC9, 0x91AC, 0xD603, 0xEB66, 0x595D, 0x6438, 0x2397, 0x1EF2,
+    0x7A84, 0x47E1, 0x004E, 0x3D2B, 0x8F10, 0xB275, 0xF5DA, 0xC8BF,
+    0x23AD, 0x1EC8, 0x5967, 0x6402, 0xD639, 0xEB5C, 0xACF3, 0x9196,
+    0xF5E0, 0xC885, 0x8F2A, 0xB24F, 0x0074, 0x3D11, 0x7ABE, 0x47DB,
+    0xB252, 0x8F37, 0xC898, 0xF5FD, 0x47C6, 0x7AA3, 0x3D0C, 0x0069,
+    0x641F, 0x597A, 0x1ED5, 0x23B0, 0x918B, 0xACEE, 0xEB41, 0xD624,
+    0x7A6C, 0x4709, 0x00A6, 0x3DC3, 0x8FF8, 0xB29D, 0xF532, 0xC857,
+    0xAC21, 0x9144, 0xD6EB, 0xEB8E, 0x59B5, 0x64D0, 0x237F, 0x1E1A,
+    0xEB93, 0xD6F6, 0x9159, 0xAC3C, 0x1E07, 0x2362, 0x64CD, 0x59A8,
+    0x3DDE, 0x00BB, 0x4714, 0x7A71, 0xC84A, 0xF52F, 0xB280, 0x8FE5,
+    0x64F7, 0x5992, 0x1E3D, 0x2358, 0x9163, 0xAC06, 0xEBA9, 0xD6CC,
+    0xB2BA, 0x8FDF, 0xC870, 0xF515, 0x472E, 0x7A4B, 0x3DE4, 0x0081,
+    0xF508, 0xC86D, 0x8FC2, 0xB2A7, 0x009C, 0x3DF9, 0x7A56, 0x4733,
+    0x2345, 0x1E20, 0x598F, 0x64EA, 0xD6D1, 0xEBB4, 0xAC1B, 0x917E,
+    0x475A, 0x7A3F, 0x3D90, 0x00F5, 0xB2CE, 0x8FAB, 0xC804, 0xF561,
+    0x9117, 0xAC72, 0xEBDD, 0xD6B8, 0x6483, 0x59E6, 0x1E49, 0x232C,
+    0xD6A5, 0xEBC0, 0xAC6F, 0x910A, 0x2331, 0x1E54, 0x59FB, 0x649E,
+    0x00E8, 0x3D8D, 0x7A22, 0x4747, 0xF57C, 0xC819, 0x8FB6, 0xB2D3,
+    0x59C1, 0x64A4, 0x230B, 0x1E6E, 0xAC55, 0x9130, 0xD69F, 0xEBFA,
+    0x8F8C, 0xB2E9, 0xF546, 0xC823, 0x7A18, 0x477D, 0x00D2, 0x3DB7,
+    0xC83E, 0xF55B, 0xB2F4, 0x8F91, 0x3DAA, 0x00CF, 0x4760, 0x7A05,
+    0x1E73, 0x2316, 0x64B9, 0x59DC, 0xEBE7, 0xD682, 0x912D, 0xAC48,
+};
+
+// s_crc16_table advanced by a further 8 zero bits (second slice).
+static const uint16_t s_crc16_slice1[256] = {
+    0x0000, 0xF4D8, 0xD4D5, 0x200D, 0x94CF, 0x6017, 0x401A, 0xB4C2,
+    0x14FB, 0xE023, 0xC02E, 0x34F6, 0x8034, 0x74EC, 0x54E1, 0xA039,
+    0x29F6, 0xDD2E, 0xFD23, 0x09FB, 0xBD39, 0x49E1, 0x69EC, 0x9D34,
+    0x3D0D, 0xC9D5, 0xE9D8, 0x1D00, 0xA9C2, 0x5D1A, 0x7D17, 0x89CF,
+    0x53EC, 0xA734, 0x8739, 0x73E1, 0xC723, 0x33FB, 0x13F6, 0xE72E,
+    0x4717, 0xB3CF, 0x93C2, 0x671A, 0xD3D8, 0x2700, 0x070D, 0xF3D5,
+    0x7A1A, 0x8EC2, 0xAECF, 0x5A17, 0xEED5, 0x1A0D, 0x3A00, 0xCED8,
+    0x6EE1, 0x9A39, 0xBA34, 0x4EEC, 0xFA2E, 0x0EF6, 0x2EFB, 0xDA23,
+    0xA7D8, 0x5300, 0x730D, 0x87D5, 0x3317, 0xC7CF, 0xE7C2, 0x131A,
+    0xB323, 0x47FB, 0x67F6, 0x932E, 0x27EC, 0xD334, 0xF339, 0x07E1,
+    0x8E2E, 0x7AF6, 0x5AFB, 0xAE23, 0x1AE1, 0xEE39, 0xCE34, 0x3AEC,
+    0x9AD5, 0x6E0D, 0x4E00, 0xBAD8, 0x0E1A, 0xFAC2, 0xDACF, 0x2E17,
+    0xF434, 0x00EC, 0x20E1, 0xD439, 0x60FB, 0x9423, 0xB42E, 0x40F6,
+    0xE0CF, 0x1417, 0x341A, 0xC0C2, 0x7400, 0x80D8, 0xA0D5, 0x540D,
+    0xDDC2, 0x291A, 0x0917, 0xFDCF, 0x490D, 0xBDD5, 0x9DD8, 0x6900,
+    0xC939, 0x3DE1, 0x1DEC, 0xE934, 0x5DF6, 0xA92E, 0x8923, 0x7DFB,
+    0x72D5, 0x860D, 0xA600, 0x52D8, 0xE61A, 0x12C2, 0x32CF, 0xC617,
+    0x662E, 0x92F6, 0xB2FB, 0x4623, 0xF2E1, 0x0639, 0x2634, 0xD2EC,
+    0x5B23, 0xAFFB, 0x8FF6, 0x7B2E, 0xCFEC, 0x3B34, 0x1B39, 0xEFE1,
+    0x4FD8, 0xBB00, 0x9B0D, 0x6FD5, 0xDB17, 0x2FCF, 0x0FC2, 0xFB1A,
+    0x2139, 0xD5E1, 0xF5EC, 0x0134, 0xB5F6, 0x412E, 0x6123, 0x95FB,
+    0x35C2, 0xC11A, 0xE117, 0x15CF, 0xA10D, 0x55D5, 0x75D8, 0x8100,
+    0x08CF, 0xFC17, 0xDC1A, 0x28C2, 0x9C00, 0x68D8, 0x48D5, 0xBC0D,
+    0x1C34, 0xE8EC, 0xC8E1, 0x3C39, 0x88FB, 0x7C23, 0x5C2E, 0xA8F6,
+    0xD50D, 0x21D5, 0x01D8, 0xF500, 0x41C2, 0xB51A, 0x9517, 0x61CF,
+    0xC1F6, 0x352E, 0x1523, 0xE1FB, 0x5539, 0xA1E1, 0x81EC, 0x7534,
+    0xFCFB, 0x0823, 0x282E, 0xDCF6, 0x6834, 0x9CEC, 0xBCE1, 0x4839,
+    0xE800, 0x1CD8, 0x3CD5, 0xC80D, 0x7CCF, 0x8817, 0xA81A, 0x5CC2,
+    0x86E1, 0x7239, 0x5234, 0xA6EC, 0x122E, 0xE6F6, 0xC6FB, 0x3223,
+    0x921A, 0x66C2, 0x46CF, 0xB217, 0x06D5, 0xF20D, 0xD200, 0x26D8,
+    0xAF17, 0x5BCF, 0x7BC2, 0x8F1A, 0x3BD8, 0xCF00, 0xEF0D, 0x1BD5,
+    0xBBEC, 0x4F34, 0x6F39, 0x9BE1, 0x2F23, 0xDBFB, 0xFBF6, 0x0F2E,
+};
+
 uint16_t wmbus_crc16_step(uint16_t crc, uint8_t data)
 {
     for (uint8_t i = 0; i < 8; i++)
@@ -16,3 +98,61 @@ uint16_t wmbus_crc16_step(uint16_t crc, uint8_t data)
     }
     return crc;
 }
+
+uint16_t wmbus_crc16_update_bitwise(uint16_t crc, const uint8_t *data, size_t len)
+{
+    while (len--)
+    {
+        crc = wmbus_crc16_step(crc, *data++);
+    }
+    return crc;
+}
+
+uint16_t wmbus_crc16_update_nibble(uint16_t crc, const uint8_t *data, size_t len)
+{
+    while (len--)
+    {
+        const uint8_t b = *data++;
+        crc = (uint16_t)((crc << 4) ^ s_crc16_nibble[(crc >> 12) ^ (b >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ s_crc16_nibble[(crc >> 12) ^ (b & 0x0F)]);
+    }
+    return crc;
+}
+
+uint16_t wmbus_crc16_update_table(uint16_t crc, const uint8_t *data, size_t len)
+{
+    while (len--)
+    {
+        crc = (uint16_t)((crc << 8) ^ s_crc16_table[(crc >> 8) ^ *data++]);
+    }
+    return crc;
+}
+
+uint16_t wmbus_crc16_update_slice2(uint16_t crc, const uint8_t *data, size_t len)
+{
+    while (len >= 2)
+    {
+        const uint16_t x = crc ^ (uint16_t)((data[0] << 8) | data[1]);
+        crc = s_crc16_slice1[x >> 8] ^ s_crc16_table[x & 0xFF];
+        data += 2;
+        len -= 2;
+    }
+    if (len)
+    {
+        crc = (uint16_t)((crc << 8) ^ s_crc16_table[(crc >> 8) ^ *data]);
+    }
+    return crc;
+}
+
+uint16_t wmbus_crc16_update(uint16_t crc, const uint8_t *data, size_t len)
+{
+#if defined(CONFIG_WMBUS_CRC16_BITWISE)
+    return wmbus_crc16_update_bitwise(crc, data, len);
+#elif defined(CONFIG_WMBUS_CRC16_NIBBLE)
+    return wmbus_crc16_update_nibble(crc, data, len);
+#elif defined(CONFIG_WMBUS_CRC16_SLICE2)
+    return wmbus_crc16_update_slice2(crc, data, len);
+#else
+    return wmbus_crc16_update_table(crc, data, len);
+#endif
+}
@@ -1,8 +1,25 @@
 // CRC16 implementation for Wireless M-Bus (polynom 0x3D65)
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define WMBUS_CRC_POLY 0x3D65
 
+// Single-byte bitwise step (reference implementation).
 uint16_t wmbus_crc16_step(uint16_t crc, uint8_t data);
+
+// Block update using the variant selected in Kconfig (CONFIG_WMBUS_CRC16_*).
+// Frames carry the complement (~crc) big-endian after each block.
+uint16_t wmbus_crc16_update(uint16_t crc, const uint8_t *data, size_t len);
+
+static inline uint16_t wmbus_crc16(const uint8_t *data, size_t len)
+{
+    return wmbus_crc16_update(0, data, len);
+}
+
+// Individual variants, callable regardless of the Kconfig choice (benchmarks, cross-checks).
+uint16_t wmbus_crc16_update_bitwise(uint16_t crc, const uint8_t *data, size_t len);
+uint16_t wmbus_crc16_update_nibble(uint16_t crc, const uint8_t *data, size_t len);  // 32 B table
+uint16_t wmbus_crc16_update_table(uint16_t crc, const uint8_t *data, size_t len);   // 512 B table
+uint16_t wmbus_crc16_update_slice2(uint16_t crc, const uint8_t *data, size_t len);  // 1 KiB, 2 bytes per step
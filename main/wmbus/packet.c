@@ -7,6 +7,15 @@
 #define HI_UINT16(a) ((uint8_t)(((a) >> 8) & 0xFF))
 #define LO_UINT16(a) ((uint8_t)((a) & 0xFF))
 
+// Append ~CRC (big-endian) after a block of len bytes; returns the next write position.
+static uint8_t *append_block_crc(uint8_t *block, uint16_t len)
+{
+    const uint16_t crc = (uint16_t)~wmbus_crc16(block, len);
+    block[len] = HI_UINT16(crc);
+    block[len + 1] = LO_UINT16(crc);
+    return block + len + 2;
+}
+
 uint16_t wmbus_packet_size(uint8_t l_field)
 {
     uint16_t nr_bytes;
@@ -78,10 +87,7 @@ void wmbus_encode_tx_packet_with_header(uint8_t *packet, const WmbusFrameHeaderR
         return;
     }
 
-    uint8_t loop_cnt;
     uint8_t data_remaining = data_size;
-    uint8_t data_encoded = 0;
-    uint16_t crc = 0;
 
     const uint8_t expected_l_field = (uint8_t)(data_size + WMBUS_L_FIELD_FIXED_BYTES);
     uint8_t l_field = header->length ? header->length : expected_l_field;
@@ -90,121 +96,34 @@ void wmbus_encode_tx_packet_with_header(uint8_t *packet, const WmbusFrameHeaderR
         l_field = expected_l_field; // keep L-field consistent with payload size
     }
 
-    *packet = l_field;
-    crc = wmbus_crc16_step(crc, *packet);
-    packet++;
-
-    *packet = header->control;
-    crc = wmbus_crc16_step(crc, *packet);
-    packet++;
-
-    *packet = (uint8_t)header->manufacturer_le;
-    crc = wmbus_crc16_step(crc, *packet);
-    packet++;
-    *packet = (uint8_t)(header->manufacturer_le >> 8);
-    crc = wmbus_crc16_step(crc, *packet);
-    packet++;
-
-    *packet = header->id[0];
-    crc = wmbus_crc16_step(crc, *packet);
-    packet++;
-    *packet = header->id[1];
-    crc = wmbus_crc16_step(crc, *packet);
-    packet++;
-    *packet = header->id[2];
-    crc = wmbus_crc16_step(crc, *packet);
-    packet++;
-    *packet = header->id[3];
-    crc = wmbus_crc16_step(crc, *packet);
-    packet++;
-    *packet = header->version;
-    crc = wmbus_crc16_step(crc, *packet);
-    packet++;
-    *packet = header->device_type;
-    crc = wmbus_crc16_step(crc, *packet);
-    packet++;
-
-    *packet = HI_UINT16(~crc);
-    packet++;
-    *packet = LO_UINT16(~crc);
-    packet++;
-    crc = 0;
-
-    *packet = header->ci_field;
-    crc = wmbus_crc16_step(crc, *packet);
-    packet++;
-
-    if (data_remaining < 16)
-    {
-        for (loop_cnt = 0; loop_cnt < data_remaining; loop_cnt++)
-        {
-            *packet = data[data_encoded];
-            crc = wmbus_crc16_step(crc, *packet);
-            packet++;
-            data_encoded++;
-        }
-
-        *packet = HI_UINT16(~crc);
-        packet++;
-        *packet = LO_UINT16(~crc);
-        packet++;
-        crc = 0;
-        data_remaining = 0;
-    }
-    else
-    {
-        for (loop_cnt = 0; loop_cnt < 15; loop_cnt++)
-        {
-            *packet = data[data_encoded];
-            crc = wmbus_crc16_step(crc, *packet);
-            packet++;
-            data_encoded++;
-        }
-
-        *packet = HI_UINT16(~crc);
-        packet++;
-        *packet = LO_UINT16(~crc);
-        packet++;
-        crc = 0;
-        data_remaining -= 15;
-    }
-
+    // Block 1: L, C, M, A (10 bytes) + CRC
+    uint8_t *block = packet;
+    packet[0] = l_field;
+    packet[1] = header->control;
+    packet[2] = (uint8_t)header->manufacturer_le;
+    packet[3] = (uint8_t)(header->manufacturer_le >> 8);
+    memcpy(&packet[4], header->id, 4);
+    packet[8] = header->version;
+    packet[9] = header->device_type;
+    packet = append_block_crc(block, 10);
+
+    // Block 2: CI + up to 15 data bytes + CRC
+    uint8_t chunk = (data_remaining < 16) ? data_remaining : 15;
+    block = packet;
+    *packet++ = header->ci_field;
+    memcpy(packet, data, chunk);
+    packet = append_block_crc(block, (uint16_t)(chunk + 1));
+    data += chunk;
+    data_remaining -= chunk;
+
+    // Further blocks: up to 16 data bytes + CRC
     while (data_remaining)
     {
-        if (data_remaining < 17)
-        {
-            for (loop_cnt = 0; loop_cnt < data_remaining; loop_cnt++)
-            {
-                *packet = data[data_encoded];
-                crc = wmbus_crc16_step(crc, *packet);
-                packet++;
-                data_encoded++;
-            }
-
-            *packet = HI_UINT16(~crc);
-            packet++;
-            *packet = LO_UINT16(~crc);
-            packet++;
-            crc = 0;
-            data_remaining = 0;
-        }
-        else
-        {
-            for (loop_cnt = 0; loop_cnt < 16; loop_cnt++)
-            {
-                *packet = data[data_encoded];
-                crc = wmbus_crc16_step(crc, *packet);
-                packet++;
-                data_encoded++;
-            }
-
-            *packet = HI_UINT16(~crc);
-            packet++;
-            *packet = LO_UINT16(~crc);
-            packet++;
-            crc = 0;
-            data_remaining -= 16;
-        }
+        chunk = (data_remaining < 17) ? data_remaining : 16;
+        memcpy(packet, data, chunk);
+        packet = append_block_crc(packet, chunk);
+        data += chunk;
+        data_remaining -= chunk;
     }
 }
 
@@ -238,80 +157,42 @@ void wmbus_encode_tx_bytes_tmode(uint8_t *encoded, const uint8_t *packet, uint16
 
 uint16_t wmbus_decode_rx_bytes_tmode(const uint8_t *encoded, uint8_t *packet, uint16_t packet_size)
 {
-    uint16_t bytes_remaining = packet_size;
-    uint16_t bytes_encoded = 0;
-    uint16_t crc = 0;
-    uint16_t crc_field = 0;
+    // Blocks are 12 (first) or 18 bytes incl. CRC, so every block starts on a
+    // 3-of-6 pair boundary; only the very last byte of a packet may be odd.
+    uint16_t offset = 0;
+    uint16_t block_len = 12;
 
-    while (bytes_remaining)
+    while (offset < packet_size)
     {
-        if (bytes_remaining == 1)
+        uint16_t len = packet_size - offset;
+        if (len > block_len)
         {
-            uint16_t status = wmbus_decode_3of6(encoded, packet, 1);
-            if (status != WMBUS_3OF6_OK)
-            {
-                return WMBUS_PKT_CODING_ERROR;
-            }
-
-            bytes_remaining -= 1;
-            bytes_encoded += 1;
-
-            if (LO_UINT16(~crc) != *(packet))
-            {
-                return WMBUS_PKT_CRC_ERROR;
-            }
+            len = block_len;
         }
-        else
+        if (len < 3)
         {
-            uint16_t status = wmbus_decode_3of6(encoded, packet, 0);
-            if (status != WMBUS_3OF6_OK)
-            {
-                return WMBUS_PKT_CODING_ERROR;
-            }
-
-            bytes_remaining -= 2;
-            bytes_encoded += 2;
-
-            if (bytes_remaining == 0)
-            {
-                crc_field = 1;
-            }
-            else if (bytes_encoded > 10)
-            {
-                crc_field = !((bytes_encoded - 12) % 18);
-            }
+            return WMBUS_PKT_CODING_ERROR;
+        }
 
-            if (crc_field)
-            {
-                if (LO_UINT16(~crc) != *(packet + 1))
-                {
-                    return WMBUS_PKT_CRC_ERROR;
-                }
-                if (HI_UINT16(~crc) != *packet)
-                {
-                    return WMBUS_PKT_CRC_ERROR;
-                }
-
-                crc_field = 0;
-                crc = 0;
-            }
-            else if (bytes_remaining == 1)
-            {
-                crc = wmbus_crc16_step(crc, *(packet));
-                if (HI_UINT16(~crc) != *(packet + 1))
-                {
-                    return WMBUS_PKT_CRC_ERROR;
-                }
-            }
-            else
+        uint8_t *block = packet + offset;
+        for (uint16_t i = 0; i < len; i += 2)
+        {
+            const uint8_t last = (uint8_t)((len - i) == 1);
+            if (wmbus_decode_3of6(encoded, block + i, last) != WMBUS_3OF6_OK)
             {
-                crc = wmbus_crc16_step(crc, *(packet));
-                crc = wmbus_crc16_step(crc, *(packet + 1));
+                return WMBUS_PKT_CODING_ERROR;
             }
-
             encoded += 3;
-            packet += 2;
         }
+
+        const uint16_t crc = (uint16_t)~wmbus_crc16(block, len - 2);
+        if (block[len - 2] != HI_UINT16(crc) || block[len - 1] != LO_UINT16(crc))
+        {
+            return WMBUS_PKT_CRC_ERROR;
+        }
+
+        offset += len;
+        block_len = 18;
     }
 
     return WMBUS_PKT_OK;
@@ -13,6 +13,7 @@
 #include "radio/radio_rx.h"
 #include "wmbus/packet.h"
 #include "wmbus/3of6.h"
+#include "wmbus/tmode_stream.h"
 #include "radio/cc1101_hal.h"
 
 // This file mirrors the TI SWRA234A RX logic for CC1101 T-mode, with minimal deviations.
@@ -96,20 +97,47 @@ static cc1101_cs_level_t wmbus_rx_cs_level = CC1101_CS_LEVEL_DEFAULT;
 //       so marginal links may no longer be detected.
 static cc1101_sync_mode_t wmbus_rx_sync_mode = CC1101_SYNC_MODE_TIGHT;
 
-// Setters for runtime adjustment (call wmbus_rx_apply_settings to write to radio)
+// Set by the setters, consumed by wmbus_pipeline_receive: knobs are only
+// written to the radio when they actually changed.
+static volatile bool wmbus_rx_settings_dirty = true;
+
+// Header filter consulted once per frame after block 0 (see wmbus_rx_set_header_filter).
+static wmbus_rx_header_filter_t s_filter_fn;
+static void *s_filter_ctx;
+
+// Setters for runtime adjustment (applied by the next wmbus_pipeline_receive,
+// or immediately via wmbus_rx_apply_settings while the radio is idle)
 void wmbus_rx_set_low_sensitivity(bool enable)
 {
-    wmbus_rx_low_sensitivity = enable;
+    if (wmbus_rx_low_sensitivity != enable)
+    {
+        wmbus_rx_low_sensitivity = enable;
+        wmbus_rx_settings_dirty = true;
+    }
 }
 
 void wmbus_rx_set_cs_level(cc1101_cs_level_t level)
 {
-    wmbus_rx_cs_level = level;
+    if (wmbus_rx_cs_level != level)
+    {
+        wmbus_rx_cs_level = level;
+        wmbus_rx_settings_dirty = true;
+    }
 }
 
 void wmbus_rx_set_sync_mode(cc1101_sync_mode_t mode)
 {
-    wmbus_rx_sync_mode = mode;
+    if (wmbus_rx_sync_mode != mode)
+    {
+        wmbus_rx_sync_mode = mode;
+        wmbus_rx_settings_dirty = true;
+    }
+}
+
+void wmbus_rx_set_header_filter(wmbus_rx_header_filter_t fn, void *ctx)
+{
+    s_filter_ctx = ctx;
+    s_filter_fn = fn;
 }
 
 esp_err_t wmbus_rx_apply_settings(cc1101_hal_t *dev)
@@ -119,11 +147,10 @@ esp_err_t wmbus_rx_apply_settings(cc1101_hal_t *dev)
         return ESP_ERR_INVALID_ARG;
     }
 
-    // AGC tweak
-    if (wmbus_rx_low_sensitivity)
-    {
-        cc1101_hal_write_reg(dev, CC1101_AGCCTRL2, 0x03);
-    }
+    wmbus_rx_settings_dirty = false;
+
+    // AGC tweak (0x43 is the AGCCTRL2 value of the T-mode profile)
+    cc1101_hal_write_reg(dev, CC1101_AGCCTRL2, wmbus_rx_low_sensitivity ? 0x03 : 0x43);
 
     // Carrier sense threshold preset
     ESP_RETURN_ON_ERROR(cc1101_hal_set_cs_threshold(dev, wmbus_rx_cs_level), TAG, "set CS level");
@@ -152,6 +179,79 @@ static bool s_isr_installed = false;
 static cc1101_hal_t *s_dev;
 static wmbus_rx_result_t *s_res;
 
+// Continuous RX: MCSM1.RXOFF_MODE=RX returns the radio to RX by itself after
+// each packet, so a full SIDLE/SFRX/SRX cycle is only needed after errors,
+// timeouts mid-frame or settings changes.
+static bool s_rx_armed = false;
+static bool s_rx_aborted = false; // Decoder rejected the frame before its end
+static bool s_rx_filtered = false; // Header filter rejected the frame after block 0
+static bool s_filter_checked = false;
+static wmbus_tmode_stream_t s_stream;
+static volatile int64_t s_pkt_end_us = 0; // Timestamp of the last packet-end edge (GDO2)
+static wmbus_rx_stats_t s_stats;
+static uint64_t s_dead_time_sum_us = 0;
+
+// Shadow of the packet-control registers rewritten per frame; writes that
+// would not change the radio state are skipped.
+static int16_t s_shadow_fifothr = -1;
+static int16_t s_shadow_pktctrl0 = -1;
+static int16_t s_shadow_pktlen = -1;
+
+static void rx_write_cached(uint8_t addr, int16_t *shadow, uint8_t value)
+{
+    if (*shadow == value)
+    {
+        return;
+    }
+    if (cc1101_hal_write_reg(s_dev, addr, value) == ESP_OK)
+    {
+        *shadow = value;
+    }
+    else
+    {
+        *shadow = -1;
+    }
+}
+
+static void rx_invalidate_shadow(void)
+{
+    s_shadow_fifothr = -1;
+    s_shadow_pktctrl0 = -1;
+    s_shadow_pktlen = -1;
+}
+
+// Dead time: packet-end edge until the radio is configured for the next sync.
+static void rx_record_dead_time(void)
+{
+    const int64_t pkt_end_us = s_pkt_end_us;
+    if (pkt_end_us == 0)
+    {
+        return;
+    }
+    s_pkt_end_us = 0;
+    const int64_t dead_us = esp_timer_get_time() - pkt_end_us;
+    if (dead_us < 0)
+    {
+        return;
+    }
+    const uint32_t dead = (dead_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)dead_us;
+    s_stats.dead_time_last_us = dead;
+    if (dead > s_stats.dead_time_max_us)
+    {
+        s_stats.dead_time_max_us = dead;
+    }
+    s_dead_time_sum_us += dead;
+    s_stats.dead_time_samples++;
+    s_stats.dead_time_avg_us = (uint32_t)(s_dead_time_sum_us / s_stats.dead_time_samples);
+}
+
+// Packet-control registers expected when the next sync word arrives.
+static void rx_restore_start_config(void)
+{
+    rx_write_cached(CC1101_FIFOTHR, &s_shadow_fifothr, RX_FIFO_START_THRESHOLD);
+    rx_write_cached(CC1101_PKTCTRL0, &s_shadow_pktctrl0, INFINITE_PACKET_LENGTH);
+}
+
 static const uint32_t RX_EVT_FIFO = (1 << 0);
 static const uint32_t RX_EVT_PKT = (1 << 1);
 
@@ -167,6 +267,7 @@ static void IRAM_ATTR gdo0_isr(void *arg)
 
 static void IRAM_ATTR gdo2_isr(void *arg)
 {
+    s_pkt_end_us = esp_timer_get_time();
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     xEventGroupSetBitsFromISR(s_rx_events, RX_EVT_PKT, &xHigherPriorityTaskWoken);
     if (xHigherPriorityTaskWoken)
@@ -175,52 +276,88 @@ static void IRAM_ATTR gdo2_isr(void *arg)
     }
 }
 
-static void rx_handle_fifo_event(void)
+static void rx_fail_overflow(void)
 {
-    if (!s_dev || !s_res)
+    cc1101_hal_flush_rx(s_dev);
+    s_rxinfo.complete = true;
+    s_res->status = WMBUS_PKT_CODING_ERROR;
+    s_rxinfo.bytesLeft = 1;
+}
+
+// Drain up to max_len FIFO bytes (nothing if fewer than min_len are waiting) and
+// feed them straight from the HAL's DMA buffer into the incremental decoder; the
+// encoded bytes are only copied out when the caller asked for them.
+// Returns the number of bytes consumed, or -1 once the frame has been abandoned.
+static int rx_drain(size_t min_len, size_t max_len)
+{
+    const uint8_t *data = NULL;
+    size_t n = 0;
+    uint8_t rxbytes = 0;
+    if (cc1101_hal_drain_rx(s_dev, min_len, max_len, &data, &n, &rxbytes) != ESP_OK)
     {
-        return;
+        return 0;
+    }
+    if (rxbytes & CC1101_RX_OVERFLOW_BM)
+    {
+        rx_fail_overflow();
+        return -1;
+    }
+    if (n == 0)
+    {
+        return 0;
     }
 
-    // Abort if RX overflow is indicated and get available bytes
-    uint8_t rxbytes = 0;
-    if (cc1101_hal_read_reg(s_dev, CC1101_RXBYTES, &rxbytes) == ESP_OK && (rxbytes & CC1101_RX_OVERFLOW_BM))
+    if (s_res->rx_bytes)
     {
-        cc1101_hal_flush_rx(s_dev);
+        memcpy(s_rxinfo.pByteIndex, data, n);
+        s_rxinfo.pByteIndex += n;
+    }
+    s_res->encoded_len += n;
+
+    const wmbus_stream_state_t state = wmbus_tmode_stream_feed(&s_stream, data, n);
+
+    // Address known: frames nobody wants are dropped before the rest is read
+    // (checked first so an unwanted frame with a later error is not an abort)
+    if (s_stream.header_ok && !s_filter_checked)
+    {
+        s_filter_checked = true;
+        const wmbus_rx_header_filter_t fn = s_filter_fn;
+        if (fn && !fn(&s_res->frame_info.header, s_filter_ctx))
+        {
+            s_rxinfo.complete = true;
+            s_rx_filtered = true;
+            return -1;
+        }
+    }
+    if (state == WMBUS_STREAM_ERROR)
+    {
+        s_res->status = s_stream.status;
         s_rxinfo.complete = true;
-        s_res->status = WMBUS_PKT_CODING_ERROR;
-        s_rxinfo.bytesLeft = 1;
+        s_rx_aborted = true;
+        return -1;
+    }
+    return (int)n;
+}
+
+static void rx_handle_fifo_event(void)
+{
+    if (!s_dev || !s_res)
+    {
         return;
     }
-    uint8_t available = rxbytes & CC1101_RXBYTES_NUM_MASK;
 
     if (s_rxinfo.start)
     {
-        // Read the first 3 bytes
+        // Read the first 3 bytes; the first group carries L and C
         const size_t to_read = 3;
-        if (available < to_read)
-        {
-            return;
-        }
-        if (to_read > RX_FIFO_SIZE)
-        {
-            return;
-        }
-        cc1101_hal_read_fifo(s_dev, s_rxinfo.pByteIndex, to_read);
-
-        // Decode length
-        uint8_t decoded[2] = {0};
-        if (wmbus_decode_3of6(s_rxinfo.pByteIndex, decoded, 0) != WMBUS_3OF6_OK)
+        if (rx_drain(to_read, to_read) <= 0)
         {
-            s_rxinfo.complete = true;
-            s_res->status = WMBUS_PKT_CODING_ERROR;
-            s_rxinfo.bytesLeft = 1; // force incomplete exit
             return;
         }
 
-        s_rxinfo.lengthField = decoded[0];
-        s_res->l_field = decoded[0];
-        uint16_t pkt_size = wmbus_packet_size(s_rxinfo.lengthField);
+        s_rxinfo.lengthField = s_stream.logical[0];
+        s_res->l_field = s_rxinfo.lengthField;
+        uint16_t pkt_size = s_stream.packet_size;
         if (pkt_size == 0 || pkt_size > WMBUS_MAX_PACKET_BYTES)
         {
             s_rxinfo.complete = true;
@@ -239,58 +376,48 @@ static void rx_handle_fifo_event(void)
         }
 
         s_rxinfo.bytesLeft = s_rxinfo.length - to_read;
-        s_rxinfo.pByteIndex += to_read;
-        s_res->encoded_len = to_read;
 
         // Switch to fixed length if less than 256 bytes remain
         if (s_rxinfo.length < MAX_FIXED_LENGTH)
         {
-            cc1101_hal_write_reg(s_dev, CC1101_PKTLEN, (uint8_t)(s_rxinfo.length));
-            cc1101_hal_write_reg(s_dev, CC1101_PKTCTRL0, FIXED_PACKET_LENGTH);
+            rx_write_cached(CC1101_PKTLEN, &s_shadow_pktlen, (uint8_t)(s_rxinfo.length));
+            rx_write_cached(CC1101_PKTCTRL0, &s_shadow_pktctrl0, FIXED_PACKET_LENGTH);
             s_rxinfo.format = FIXED;
         }
         else
         {
             uint16_t fixedLength = s_rxinfo.length % MAX_FIXED_LENGTH;
-            cc1101_hal_write_reg(s_dev, CC1101_PKTLEN, (uint8_t)fixedLength);
+            rx_write_cached(CC1101_PKTLEN, &s_shadow_pktlen, (uint8_t)fixedLength);
         }
 
         // Threshold to half FIFO
-        cc1101_hal_write_reg(s_dev, CC1101_FIFOTHR, RX_FIFO_THRESHOLD);
+        rx_write_cached(CC1101_FIFOTHR, &s_shadow_fifothr, RX_FIFO_THRESHOLD);
         s_rxinfo.start = false;
+
+        // Signal strength while the frame is on air (RSSI keeps tracking the
+        // channel once the radio has returned to RX after packet end).
+        cc1101_hal_read_reg(s_dev, CC1101_RSSI, &s_res->rssi_raw);
     }
     else
     {
         // Switch to fixed if appropriate
         if ((s_rxinfo.bytesLeft < MAX_FIXED_LENGTH) && (s_rxinfo.format == INFINITE))
         {
-            cc1101_hal_write_reg(s_dev, CC1101_PKTCTRL0, FIXED_PACKET_LENGTH);
+            rx_write_cached(CC1101_PKTCTRL0, &s_shadow_pktctrl0, FIXED_PACKET_LENGTH);
             s_rxinfo.format = FIXED;
         }
 
-        if (available == 0)
-        {
-            return;
-        }
-
         size_t chunk = (s_rxinfo.bytesLeft > (RX_AVAILABLE_FIFO - 1)) ? (RX_AVAILABLE_FIFO - 1) : s_rxinfo.bytesLeft;
-        if (chunk > RX_FIFO_SIZE)
-        {
-            chunk = RX_FIFO_SIZE;
-        }
-        if (available < chunk)
-        {
-            chunk = available;
-        }
         if (chunk == 0)
         {
             return;
         }
 
-        cc1101_hal_read_fifo(s_dev, s_rxinfo.pByteIndex, chunk);
-        s_rxinfo.bytesLeft -= chunk;
-        s_rxinfo.pByteIndex += chunk;
-        s_res->encoded_len += chunk;
+        const int got = rx_drain(1, chunk);
+        if (got > 0)
+        {
+            s_rxinfo.bytesLeft -= (uint16_t)got;
+        }
     }
 }
 
@@ -301,71 +428,33 @@ static void rx_handle_packet_event(void)
         return;
     }
 
-    // Abort if RX overflow is indicated
-    uint8_t rxbytes = 0;
-    if (cc1101_hal_read_reg(s_dev, CC1101_RXBYTES, &rxbytes) == ESP_OK && (rxbytes & CC1101_RX_OVERFLOW_BM))
-    {
-        cc1101_hal_flush_rx(s_dev);
-        s_rxinfo.complete = true;
-        s_res->status = WMBUS_PKT_CODING_ERROR;
-        s_rxinfo.bytesLeft = 1;
-        return;
-    }
-
     while (s_rxinfo.bytesLeft)
     {
-        uint8_t available = rxbytes & CC1101_RXBYTES_NUM_MASK;
-        if (available == 0)
-        {
-            // Refresh available
-            if (cc1101_hal_read_reg(s_dev, CC1101_RXBYTES, &rxbytes) != ESP_OK)
-            {
-                break;
-            }
-            available = rxbytes & CC1101_RXBYTES_NUM_MASK;
-            if (rxbytes & CC1101_RX_OVERFLOW_BM)
-            {
-                cc1101_hal_flush_rx(s_dev);
-                s_rxinfo.complete = true;
-                s_res->status = WMBUS_PKT_CODING_ERROR;
-                s_rxinfo.bytesLeft = 1;
-                return;
-            }
-            if (available == 0)
-            {
-                break;
-            }
-        }
-
         size_t to_read = s_rxinfo.bytesLeft;
         if (to_read > RX_FIFO_SIZE)
         {
             to_read = RX_FIFO_SIZE;
         }
-        if (available < to_read)
+        const int got = rx_drain(1, to_read);
+        if (got < 0)
         {
-            to_read = available;
+            return;
         }
-        cc1101_hal_read_fifo(s_dev, s_rxinfo.pByteIndex, to_read);
-        s_res->encoded_len += to_read;
-        s_rxinfo.bytesLeft -= to_read;
-        s_rxinfo.pByteIndex += to_read;
-
-        // Refresh rxbytes for next loop
-        if (cc1101_hal_read_reg(s_dev, CC1101_RXBYTES, &rxbytes) != ESP_OK)
+        if (got == 0)
         {
             break;
         }
-        if (rxbytes & 0x80)
-        {
-            cc1101_hal_flush_rx(s_dev);
-            s_rxinfo.complete = true;
-            s_res->status = WMBUS_PKT_CODING_ERROR;
-            s_rxinfo.bytesLeft = 1;
-            return;
-        }
+        s_rxinfo.bytesLeft -= (uint16_t)got;
     }
     s_rxinfo.complete = true;
+
+    // The radio is already back in RX; get the packet engine ready for the
+    // next sync word before doing anything else.
+    if (s_rxinfo.bytesLeft == 0)
+    {
+        rx_restore_start_config();
+        rx_record_dead_time();
+    }
 }
 
 esp_err_t wmbus_pipeline_init(cc1101_hal_t *dev)
@@ -388,12 +477,50 @@ esp_err_t wmbus_pipeline_init(cc1101_hal_t *dev)
     gpio_isr_handler_add(dev->pins.gdo0, gdo0_isr, NULL);
     gpio_isr_handler_add(dev->pins.gdo2, gdo2_isr, NULL);
 
+    s_rx_armed = false;
+    s_pkt_end_us = 0;
+    rx_invalidate_shadow();
+    wmbus_rx_settings_dirty = true;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_dead_time_sum_us = 0;
+
     return ESP_OK;
 }
 
+// Full re-arm: idle, (re)apply changed knobs, flush and enter RX.
+static void rx_rearm(cc1101_hal_t *dev)
+{
+    gpio_intr_disable(dev->pins.gdo0);
+    gpio_intr_disable(dev->pins.gdo2);
+    ESP_ERROR_CHECK(cc1101_hal_idle(dev));
+    if (wmbus_rx_settings_dirty)
+    {
+        wmbus_rx_apply_settings(dev);
+    }
+    ESP_ERROR_CHECK(cc1101_hal_flush_rx(dev));
+    rx_restore_start_config();
+
+    xEventGroupClearBits(s_rx_events, RX_EVT_FIFO | RX_EVT_PKT);
+    gpio_intr_enable(dev->pins.gdo0);
+    gpio_intr_enable(dev->pins.gdo2);
+
+    cc1101_hal_enter_rx(dev);
+    s_rx_armed = true;
+    s_stats.rearms++;
+    rx_record_dead_time();
+}
+
+void wmbus_pipeline_get_stats(wmbus_rx_stats_t *out)
+{
+    if (out)
+    {
+        *out = s_stats;
+    }
+}
+
 esp_err_t wmbus_pipeline_receive(cc1101_hal_t *dev, wmbus_rx_result_t *res, uint32_t timeout_ms)
 {
-    if (!dev || !res || !res->rx_packet || !res->rx_bytes)
+    if (!dev || !res || !res->rx_logical)
     {
         return ESP_ERR_INVALID_ARG;
     }
@@ -401,19 +528,24 @@ esp_err_t wmbus_pipeline_receive(cc1101_hal_t *dev, wmbus_rx_result_t *res, uint
     s_dev = dev;
     s_res = res;
 
-    memset(res->rx_packet, 0, WMBUS_MAX_PACKET_BYTES);
-    memset(res->rx_bytes, 0, WMBUS_MAX_ENCODED_BYTES);
-    if (res->rx_logical)
+    // Only clear the prefix the previous frame in this result actually used.
+    if (res->rx_packet)
+    {
+        memset(res->rx_packet, 0, res->packet_size);
+    }
+    if (res->rx_bytes)
     {
-        memset(res->rx_logical, 0, WMBUS_MAX_PACKET_BYTES);
+        memset(res->rx_bytes, 0, res->encoded_len);
     }
+    memset(res->rx_logical, 0, res->logical_len);
     res->encoded_len = 0;
     res->packet_size = 0;
     res->logical_len = 0;
-    memset(&res->frame_info, 0, sizeof(res->frame_info));
     res->l_field = 0;
     res->status = WMBUS_PKT_CODING_ERROR;
     res->complete = false;
+    res->rssi_raw = 0;
+    res->lqi_raw = 0;
 
     // Initialize RX info
     s_rxinfo.lengthField = 0;
@@ -424,24 +556,20 @@ esp_err_t wmbus_pipeline_receive(cc1101_hal_t *dev, wmbus_rx_result_t *res, uint
     s_rxinfo.start = true;
     s_rxinfo.complete = false;
     s_rxinfo.mode = 0; // T-mode
+    s_rx_aborted = false;
+    s_rx_filtered = false;
+    s_filter_checked = false;
+    wmbus_tmode_stream_init(&s_stream, res->rx_logical, WMBUS_MAX_PACKET_BYTES, res->rx_packet, &res->frame_info);
 
-    ESP_ERROR_CHECK(cc1101_hal_idle(dev));
-    ESP_ERROR_CHECK(cc1101_hal_flush_rx(dev));
-
-    // Configure thresholds for start
-    cc1101_hal_write_reg(dev, CC1101_FIFOTHR, RX_FIFO_START_THRESHOLD);
-    cc1101_hal_write_reg(dev, CC1101_PKTCTRL0, INFINITE_PACKET_LENGTH);
-
-    // Apply current RX knobs (AGC/CS/Sync)
-    wmbus_rx_apply_settings(dev);
-
-    xEventGroupClearBits(s_rx_events, RX_EVT_FIFO | RX_EVT_PKT);
-
-    // Enable interrupts
-    gpio_intr_enable(dev->pins.gdo0);
-    gpio_intr_enable(dev->pins.gdo2);
-
-    cc1101_hal_enter_rx(dev);
+    if (!s_rx_armed || wmbus_rx_settings_dirty)
+    {
+        rx_rearm(dev);
+    }
+    else
+    {
+        // Normally a no-op: restored right after the previous packet end.
+        rx_restore_start_config();
+    }
 
     int64_t start_us = esp_timer_get_time();
     while (!s_rxinfo.complete)
@@ -467,40 +595,58 @@ esp_err_t wmbus_pipeline_receive(cc1101_hal_t *dev, wmbus_rx_result_t *res, uint
         }
     }
 
-    // Disable interrupts for this session
-    gpio_intr_disable(dev->pins.gdo0);
-    gpio_intr_disable(dev->pins.gdo2);
-
-    cc1101_hal_idle(dev);
+    if (s_rx_aborted)
+    {
+        // Coding/CRC error mid-frame: drop the rest of it and listen again
+        // right away. The error is still reported to the caller.
+        rx_rearm(dev);
+        s_stats.aborted++;
+        res->packet_size = s_stream.packet_size;
+        res->complete = true;
+        return ESP_OK;
+    }
 
-    if (!s_rxinfo.complete || s_rxinfo.bytesLeft != 0 || res->encoded_len < 3)
+    if (s_rx_filtered)
     {
-        cc1101_hal_flush_rx(dev);
+        // Unwanted address: skip the remaining blocks and listen again
+        rx_rearm(dev);
+        s_stats.filtered++;
+        if (s_rxinfo.length > res->encoded_len)
+        {
+            s_stats.filtered_bytes += s_rxinfo.length - res->encoded_len;
+        }
+        res->packet_size = s_stream.packet_size;
         res->complete = false;
         return ESP_OK;
     }
 
-    uint16_t pkt_size = wmbus_packet_size(s_rxinfo.lengthField);
-    res->packet_size = pkt_size;
-    res->status = wmbus_decode_rx_bytes_tmode(res->rx_bytes, res->rx_packet, res->packet_size);
-    res->complete = true;
-
-    if (res->status == WMBUS_PKT_OK && res->rx_logical)
+    if (!s_rxinfo.complete || s_rxinfo.bytesLeft != 0 || res->encoded_len < 3 || s_stream.state != WMBUS_STREAM_DONE)
     {
-        wmbus_extract_frame_info(res->rx_packet, res->packet_size, res->rx_logical, WMBUS_MAX_PACKET_BYTES, &res->frame_info);
-        res->logical_len = res->frame_info.logical_len;
+        // Idle timeout with no frame in flight keeps the radio armed; anything
+        // else (partial frame, length error, overflow) needs a full re-arm.
+        if (!s_rxinfo.start || s_rxinfo.complete)
+        {
+            gpio_intr_disable(dev->pins.gdo0);
+            gpio_intr_disable(dev->pins.gdo2);
+            s_rx_armed = false;
+        }
+        res->complete = false;
+        return ESP_OK;
     }
 
-    // Capture status registers for diagnostics
-    cc1101_hal_read_reg(dev, CC1101_RSSI, &res->rssi_raw);
+    // Blocks were decoded, CRC-checked and the header parsed while the frame was arriving.
+    res->packet_size = s_stream.packet_size;
+    res->status = s_stream.status;
+    res->logical_len = res->frame_info.logical_len;
+    res->complete = true;
+
+    // Capture status registers for diagnostics (RSSI was sampled mid-frame)
     cc1101_hal_read_reg(dev, CC1101_LQI, &res->lqi_raw);
     cc1101_hal_read_reg(dev, CC1101_MARCSTATE, &res->marc_state);
     cc1101_hal_read_reg(dev, CC1101_PKTSTATUS, &res->pkt_status);
+    res->lqi = res->lqi_raw;
+    res->rssi_dbm = radio_rx_rssi_to_dbm(res->rssi_raw);
 
-    float rssi_dbm = 0;
-    radio_rx_read_rssi_lqi(dev, &rssi_dbm, &res->lqi);
-    res->rssi_dbm = rssi_dbm;
-
-    cc1101_hal_flush_rx(dev);
+    s_stats.frames++;
     return ESP_OK;
 }
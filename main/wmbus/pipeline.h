@@ -12,13 +12,13 @@
 
 typedef struct
 {
-    uint8_t *rx_packet;     // Decoded packet buffer (size WMBUS_MAX_PACKET_BYTES)
-    uint8_t *rx_bytes;      // Encoded byte buffer (size WMBUS_MAX_ENCODED_BYTES)
-    uint8_t *rx_logical;    // CRC-free packet buffer (size WMBUS_MAX_PACKET_BYTES)
+    uint8_t *rx_packet;     // Optional: on-air packet incl. CRCs (size WMBUS_MAX_PACKET_BYTES)
+    uint8_t *rx_bytes;      // Optional: encoded bytes as read (size WMBUS_MAX_ENCODED_BYTES)
+    uint8_t *rx_logical;    // Required: CRC-free packet, decoded while the frame arrives (size WMBUS_MAX_PACKET_BYTES)
     uint16_t packet_size;   // Decoded size (incl. all fields)
     uint16_t encoded_len;   // Encoded byte count read
-    uint16_t logical_len;   // CRC-free length (L+1) if rx_logical is provided
-    WmbusFrameInfo frame_info; // Parsed header + payload len if rx_logical provided
+    uint16_t logical_len;   // CRC-free length (L+1) when the header parsed
+    WmbusFrameInfo frame_info; // Parsed header + payload len
     uint8_t l_field;        // L-field value
     bool complete;
     uint8_t status;         // WMBUS_PKT_xxx
@@ -30,11 +30,33 @@ typedef struct
     uint8_t pkt_status;
 } wmbus_rx_result_t;
 
+typedef struct
+{
+    uint32_t frames;             // Complete frames handed out
+    uint32_t rearms;             // Full idle/flush/RX cycles (start, errors, settings changes)
+    uint32_t aborted;            // Frames cut short by a coding/CRC error mid-reception
+    uint32_t filtered;           // Frames abandoned after block 0 by the header filter
+    uint32_t filtered_bytes;     // Encoded bytes of those frames left unread (airtime not spent decoding)
+    uint32_t dead_time_last_us;  // Packet end -> radio ready for the next sync word
+    uint32_t dead_time_avg_us;
+    uint32_t dead_time_max_us;
+    uint32_t dead_time_samples;
+} wmbus_rx_stats_t;
+
+// Header filter, called from the RX task as soon as block 0 (L, C, M, ID,
+// version, device type) has passed its CRC. Return false to abandon the frame:
+// the radio is re-armed right away and wmbus_pipeline_receive reports nothing.
+typedef bool (*wmbus_rx_header_filter_t)(const WmbusFrameHeaderRaw *hdr, void *ctx);
+
 esp_err_t wmbus_pipeline_init(cc1101_hal_t *dev);
 esp_err_t wmbus_pipeline_receive(cc1101_hal_t *dev, wmbus_rx_result_t *res, uint32_t timeout_ms);
 void wmbus_rx_set_low_sensitivity(bool enable);
 void wmbus_rx_set_cs_level(cc1101_cs_level_t level);
 void wmbus_rx_set_sync_mode(cc1101_sync_mode_t mode);
 // Apply current RX knobs (low sensitivity / CS level / sync mode) to the radio.
-// Call when radio is idle (e.g., before starting RX) after updating the setters.
+// Call when radio is idle; wmbus_pipeline_receive does this itself when a setter changed a knob.
 esp_err_t wmbus_rx_apply_settings(cc1101_hal_t *dev);
+// Install (or clear with NULL) the header filter; takes effect with the next frame.
+void wmbus_rx_set_header_filter(wmbus_rx_header_filter_t fn, void *ctx);
+// Snapshot RX session counters (call from the RX task or accept torn reads).
+void wmbus_pipeline_get_stats(wmbus_rx_stats_t *out);
@@ -0,0 +1,257 @@
+#include "wmbus/tmode_stream.h"
+
+#include <string.h>
+#include "wmbus/3of6.h"
+#include "wmbus/crc16.h"
+#include "wmbus/packet.h"
+
+#define FIRST_BLOCK_BYTES 12 // 10 data + CRC
+#define NEXT_BLOCK_BYTES  18 // 16 data + CRC
+
+static wmbus_stream_state_t stream_fail(wmbus_tmode_stream_t *s, uint8_t status)
+{
+    s->status = status;
+    s->state = WMBUS_STREAM_ERROR;
+    return s->state;
+}
+
+void wmbus_tmode_stream_init(wmbus_tmode_stream_t *s, uint8_t *logical, uint16_t logical_cap, uint8_t *packet, WmbusFrameInfo *info)
+{
+    if (!s)
+    {
+        return;
+    }
+    memset(s, 0, sizeof(*s));
+    s->logical = logical;
+    s->logical_cap = logical_cap;
+    s->packet = packet;
+    s->info = info;
+    if (info)
+    {
+        memset(info, 0, sizeof(*info));
+    }
+    s->status = WMBUS_PKT_CODING_ERROR;
+    s->state = WMBUS_STREAM_NEED_MORE;
+}
+
+static uint16_t next_block_end(uint16_t from, uint16_t packet_size, uint16_t block_bytes)
+{
+    const uint16_t end = from + block_bytes;
+    return (end > packet_size) ? packet_size : end;
+}
+
+// Block 0 (L..device type) is CRC-checked: publish the link-layer address fields.
+static void stream_block0_done(wmbus_tmode_stream_t *s)
+{
+    s->header_ok = true;
+    if (!s->info)
+    {
+        return;
+    }
+    const uint8_t *l = s->logical;
+    WmbusFrameHeaderRaw *h = &s->info->header;
+    h->length = l[0];
+    h->control = l[1];
+    h->manufacturer_le = (uint16_t)l[2] | ((uint16_t)l[3] << 8);
+    memcpy(h->id, &l[4], sizeof(h->id));
+    h->version = l[8];
+    h->device_type = l[9];
+}
+
+static void stream_finish(wmbus_tmode_stream_t *s)
+{
+    s->status = WMBUS_PKT_OK;
+    s->state = WMBUS_STREAM_DONE;
+
+    WmbusFrameInfo *info = s->info;
+    if (info) // L >= WMBUS_L_FIELD_FIXED_BYTES was checked on the first byte
+    {
+        info->header.ci_field = s->logical[WMBUS_FIXED_HEADER_BYTES - 1];
+        info->logical_len = s->logical_len;
+        info->payload_len = (uint16_t)(s->logical[0] - WMBUS_L_FIELD_FIXED_BYTES);
+        info->parsed = true;
+    }
+}
+
+// Route one decoded byte: data -> logical buffer, CRC field -> block check.
+static wmbus_stream_state_t stream_put(wmbus_tmode_stream_t *s, uint8_t b)
+{
+    const uint16_t idx = s->decoded;
+    if (s->packet)
+    {
+        s->packet[idx] = b;
+    }
+
+    if (idx == 0)
+    {
+        if (b < WMBUS_L_FIELD_FIXED_BYTES)
+        {
+            s->decoded++;
+            return stream_fail(s, WMBUS_PKT_CODING_ERROR); // Shorter than the fixed header
+        }
+        s->packet_size = wmbus_packet_size(b);
+        s->block_end = next_block_end(0, s->packet_size, FIRST_BLOCK_BYTES);
+    }
+
+    if (idx + 2 < s->block_end)
+    {
+        if (s->logical_len >= s->logical_cap)
+        {
+            return stream_fail(s, WMBUS_PKT_CODING_ERROR);
+        }
+        s->logical[s->logical_len++] = b;
+    }
+    else if (idx + 2 == s->block_end)
+    {
+        s->crc_hi = b;
+    }
+    else
+    {
+        const uint16_t crc = (uint16_t)~wmbus_crc16(s->logical + s->block_start, s->logical_len - s->block_start);
+        if (s->crc_hi != (uint8_t)(crc >> 8) || b != (uint8_t)crc)
+        {
+            s->decoded++;
+            return stream_fail(s, WMBUS_PKT_CRC_ERROR);
+        }
+        if (s->block_start == 0)
+        {
+            stream_block0_done(s);
+        }
+        s->block_start = s->logical_len;
+        s->block_end = next_block_end(s->block_end, s->packet_size, NEXT_BLOCK_BYTES);
+    }
+
+    s->decoded++;
+    if (s->decoded == s->packet_size)
+    {
+        stream_finish(s);
+    }
+    return s->state;
+}
+
+// Decode one group: 3 encoded bytes -> 2 packet bytes, or 2 -> 1 for the odd last byte.
+static wmbus_stream_state_t stream_group(wmbus_tmode_stream_t *s, const uint8_t *group, uint8_t last_byte)
+{
+    uint8_t out[2];
+    if (wmbus_decode_3of6(group, out, last_byte) != WMBUS_3OF6_OK)
+    {
+        return stream_fail(s, WMBUS_PKT_CODING_ERROR);
+    }
+    if (stream_put(s, out[0]) != WMBUS_STREAM_NEED_MORE || last_byte)
+    {
+        return s->state;
+    }
+    return stream_put(s, out[1]);
+}
+
+static uint8_t stream_group_len(const wmbus_tmode_stream_t *s)
+{
+    return (s->packet_size && (s->packet_size - s->decoded) == 1) ? 2 : 3;
+}
+
+wmbus_stream_state_t wmbus_tmode_stream_feed(wmbus_tmode_stream_t *s, const uint8_t *encoded, size_t len)
+{
+    if (!s || !s->logical)
+    {
+        return WMBUS_STREAM_ERROR;
+    }
+
+    // Complete a group split across chunks
+    while (s->carry_len && len && s->state == WMBUS_STREAM_NEED_MORE)
+    {
+        s->carry[s->carry_len++] = *encoded++;
+        len--;
+        const uint8_t group = stream_group_len(s);
+        if (s->carry_len == group)
+        {
+            s->carry_len = 0;
+            stream_group(s, s->carry, group == 2);
+        }
+    }
+    if (s->carry_len)
+    {
+        return s->state; // Chunk exhausted while still completing the carried group
+    }
+
+    while (s->state == WMBUS_STREAM_NEED_MORE)
+    {
+        // Fast path: run of full groups whose bytes are all data of the current
+        // block; they decode straight into the logical buffer.
+        if (s->decoded && (uint16_t)(s->decoded + 4) <= s->block_end)
+        {
+            size_t groups = (size_t)(s->block_end - 2 - s->decoded) / 2;
+            if (groups > len / 3)
+            {
+                groups = len / 3;
+            }
+            if (groups)
+            {
+                if (s->logical_len + groups * 2 > s->logical_cap)
+                {
+                    return stream_fail(s, WMBUS_PKT_CODING_ERROR);
+                }
+                uint8_t *dst = s->logical + s->logical_len;
+                bool ok = true;
+                for (size_t g = 0; g < groups; g++)
+                {
+                    ok &= wmbus_decode_3of6_pair(encoded + g * 3, dst + g * 2);
+                }
+                if (!ok)
+                {
+                    return stream_fail(s, WMBUS_PKT_CODING_ERROR);
+                }
+                if (s->packet)
+                {
+                    memcpy(s->packet + s->decoded, dst, groups * 2);
+                }
+                s->logical_len += (uint16_t)(groups * 2);
+                s->decoded += (uint16_t)(groups * 2);
+                encoded += groups * 3;
+                len -= groups * 3;
+                continue;
+            }
+        }
+
+        const uint8_t group = stream_group_len(s);
+        if (len < group)
+        {
+            memcpy(s->carry, encoded, len);
+            s->carry_len = (uint8_t)len;
+            break;
+        }
+        stream_group(s, encoded, group == 2);
+        encoded += group;
+        len -= group;
+    }
+    return s->state;
+}
+
+uint16_t wmbus_tmode_stream_encoded_left(const wmbus_tmode_stream_t *s)
+{
+    if (!s || s->state != WMBUS_STREAM_NEED_MORE || s->packet_size == 0)
+    {
+        return 0;
+    }
+    const uint16_t left = s->packet_size - s->decoded;
+    return (uint16_t)((left / 2) * 3 + ((left & 1) ? 2 : 0) - s->carry_len);
+}
+
+uint8_t wmbus_decode_tmode_frame(const uint8_t *encoded, uint16_t encoded_len, uint8_t *logical, uint16_t logical_cap,
+                                 uint16_t *logical_len, WmbusFrameInfo *info, uint8_t *packet)
+{
+    wmbus_tmode_stream_t s;
+    wmbus_tmode_stream_init(&s, logical, logical_cap, packet, info);
+    if (!encoded || wmbus_tmode_stream_feed(&s, encoded, encoded_len) != WMBUS_STREAM_DONE)
+    {
+        if (info)
+        {
+            info->parsed = false;
+        }
+        return (s.state == WMBUS_STREAM_NEED_MORE) ? WMBUS_PKT_CODING_ERROR : s.status;
+    }
+    if (logical_len)
+    {
+        *logical_len = s.logical_len;
+    }
+    return s.status;
+}
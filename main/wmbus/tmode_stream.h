@@ -0,0 +1,49 @@
+// Incremental T-mode RX decoder: 3-of-6 groups -> per-block CRC check -> CRC-free bytes
+// and parsed header, in a single pass. Fed with FIFO chunks as they arrive; any chunk
+// size works (partial groups are carried).
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "wmbus/packet.h"
+
+typedef enum
+{
+    WMBUS_STREAM_NEED_MORE = 0, // Frame not finished yet
+    WMBUS_STREAM_DONE,          // All blocks decoded and CRC-checked
+    WMBUS_STREAM_ERROR,         // Coding/CRC/length error; status holds WMBUS_PKT_xxx
+} wmbus_stream_state_t;
+
+typedef struct
+{
+    uint8_t *logical;      // CRC-free output (L|C|M|ID|Ver|Dev|CI|payload), L+1 bytes
+    uint16_t logical_cap;
+    uint8_t *packet;       // Optional on-air copy incl. CRC fields (WMBUS_MAX_PACKET_BYTES), may be NULL
+    WmbusFrameInfo *info;  // Optional header output, filled while block 0 is decoded
+    uint16_t packet_size;  // Decoded size incl. CRCs; 0 until the L-field is decoded
+    uint16_t decoded;      // Packet bytes decoded so far
+    uint16_t logical_len;  // Logical bytes written so far
+    uint16_t block_end;    // Packet offset one past the current block's CRC
+    uint16_t block_start;  // Logical offset of the current block's first data byte
+    uint8_t crc_hi;
+    uint8_t carry[3];      // Partial 3-of-6 group left over from the previous chunk
+    uint8_t carry_len;
+    uint8_t status;        // WMBUS_PKT_xxx (valid once not NEED_MORE)
+    bool header_ok;        // Block 0 (L..device type) passed its CRC; info->header holds the address
+    wmbus_stream_state_t state;
+} wmbus_tmode_stream_t;
+
+// packet and info may be NULL. info->parsed is set once the frame completes with a valid header.
+void wmbus_tmode_stream_init(wmbus_tmode_stream_t *s, uint8_t *logical, uint16_t logical_cap, uint8_t *packet, WmbusFrameInfo *info);
+
+// Consume encoded bytes. Stops at the first error; bytes past the frame end are ignored.
+wmbus_stream_state_t wmbus_tmode_stream_feed(wmbus_tmode_stream_t *s, const uint8_t *encoded, size_t len);
+
+// Encoded bytes still expected (0 while the L-field is unknown or once finished).
+uint16_t wmbus_tmode_stream_encoded_left(const wmbus_tmode_stream_t *s);
+
+// One-shot wrapper for a complete encoded frame (replay, host tools).
+// Returns WMBUS_PKT_xxx; logical_len receives L+1 on success.
+uint8_t wmbus_decode_tmode_frame(const uint8_t *encoded, uint16_t encoded_len, uint8_t *logical, uint16_t logical_cap,
+                                 uint16_t *logical_len, WmbusFrameInfo *info, uint8_t *packet);